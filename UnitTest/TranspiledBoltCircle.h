@@ -0,0 +1,349 @@
+﻿//由MacroTranspiler產生的巨集程式,請勿直接修改
+#pragma once
+
+#include <cmath>
+#include <limits>
+#include "MacroTranspiler.h"
+#include "DegreeTrigonometry.h"
+
+namespace TranspiledBoltCircle {
+//程式號碼
+inline const int program_number = 9010;
+
+//#100=#1*0.5
+inline MacroBytecodeResult Block0(MacroVariableInterface& macro_variable_interface)
+{
+	MacroBytecodeResult result;
+	double s0(0.0);
+	double s1(0.0);
+	s0 = MacroTranspiledRuntime::ReadVariable(macro_variable_interface, 1);
+	s1 = 0x1p-1;
+	s0 = s0 * s1;
+	s0 = MacroTranspiledRuntime::AssignVariable(macro_variable_interface, 100, s0);
+	result.value = s0;
+	return result;
+}
+
+//#101=360/#2
+inline MacroBytecodeResult Block1(MacroVariableInterface& macro_variable_interface)
+{
+	MacroBytecodeResult result;
+	double s0(0.0);
+	double s1(0.0);
+	s0 = 0x1.68p+8;
+	s1 = MacroTranspiledRuntime::ReadVariable(macro_variable_interface, 2);
+	s0 = s0 / s1;
+	s0 = MacroTranspiledRuntime::AssignVariable(macro_variable_interface, 101, s0);
+	result.value = s0;
+	return result;
+}
+
+//#102=#100*COS[#101*#3+#4]
+inline MacroBytecodeResult Block2(MacroVariableInterface& macro_variable_interface)
+{
+	MacroBytecodeResult result;
+	double s0(0.0);
+	double s1(0.0);
+	double s2(0.0);
+	s0 = MacroTranspiledRuntime::ReadVariable(macro_variable_interface, 100);
+	s1 = MacroTranspiledRuntime::ReadVariable(macro_variable_interface, 101);
+	s2 = MacroTranspiledRuntime::ReadVariable(macro_variable_interface, 3);
+	s1 = s1 * s2;
+	s2 = MacroTranspiledRuntime::ReadVariable(macro_variable_interface, 4);
+	s1 = s1 + s2;
+	s1 = DegreeTrigonometry::Cosine(s1);
+	s0 = s0 * s1;
+	s0 = MacroTranspiledRuntime::AssignVariable(macro_variable_interface, 102, s0);
+	result.value = s0;
+	return result;
+}
+
+//#103=#100*SIN[#101*#3+#4]
+inline MacroBytecodeResult Block3(MacroVariableInterface& macro_variable_interface)
+{
+	MacroBytecodeResult result;
+	double s0(0.0);
+	double s1(0.0);
+	double s2(0.0);
+	s0 = MacroTranspiledRuntime::ReadVariable(macro_variable_interface, 100);
+	s1 = MacroTranspiledRuntime::ReadVariable(macro_variable_interface, 101);
+	s2 = MacroTranspiledRuntime::ReadVariable(macro_variable_interface, 3);
+	s1 = s1 * s2;
+	s2 = MacroTranspiledRuntime::ReadVariable(macro_variable_interface, 4);
+	s1 = s1 + s2;
+	s1 = DegreeTrigonometry::Sine(s1);
+	s0 = s0 * s1;
+	s0 = MacroTranspiledRuntime::AssignVariable(macro_variable_interface, 103, s0);
+	result.value = s0;
+	return result;
+}
+
+//IF[#3 GE #2] GOTO 20
+inline MacroBytecodeResult Block4(MacroVariableInterface& macro_variable_interface)
+{
+	MacroBytecodeResult result;
+	double s0(0.0);
+	double s1(0.0);
+	s0 = MacroTranspiledRuntime::ReadVariable(macro_variable_interface, 3);
+	s1 = MacroTranspiledRuntime::ReadVariable(macro_variable_interface, 2);
+	s0 = s0 >= s1 ? 1.0 : 0.0;
+	if (s0 == 0.0) {
+		result.condition = false;
+		result.value = 0.0;
+		return result;
+	}
+	s0 = 0x1.4p+4;
+	result.control = OP_BRANCH;
+	result.number = BranchNumber(s0);
+	result.value = 0.0;
+	return result;
+}
+
+//#104=ATAN[#103,#102]+SQRT[#102*#102+#103*#103]+ABS[-#104]
+inline MacroBytecodeResult Block6(MacroVariableInterface& macro_variable_interface)
+{
+	MacroBytecodeResult result;
+	double s0(0.0);
+	double s1(0.0);
+	double s2(0.0);
+	double s3(0.0);
+	double t0(0.0);
+	double t1(0.0);
+	s0 = MacroTranspiledRuntime::ReadVariable(macro_variable_interface, 103);
+	t0 = s0;
+	s1 = MacroTranspiledRuntime::ReadVariable(macro_variable_interface, 102);
+	t1 = s1;
+	s0 = DegreeTrigonometry::ArcTangent2(s0, s1);
+	s1 = t1;
+	s2 = t1;
+	s1 = s1 * s2;
+	s2 = t0;
+	s3 = t0;
+	s2 = s2 * s3;
+	s1 = s1 + s2;
+	s1 = std::sqrt(s1);
+	s0 = s0 + s1;
+	s1 = MacroTranspiledRuntime::ReadVariable(macro_variable_interface, 104);
+	s1 = -s1;
+	s1 = std::fabs(s1);
+	s0 = s0 + s1;
+	s0 = MacroTranspiledRuntime::AssignVariable(macro_variable_interface, 104, s0);
+	result.value = s0;
+	return result;
+}
+
+//#105=ROUND[#104]+FIX[-#104]+FUP[#104]+BIN[37]+BCD[25]+ADP[12]
+inline MacroBytecodeResult Block7(MacroVariableInterface& macro_variable_interface)
+{
+	MacroBytecodeResult result;
+	double s0(0.0);
+	double s1(0.0);
+	double t0(0.0);
+	s0 = MacroTranspiledRuntime::ReadVariable(macro_variable_interface, 104);
+	t0 = s0;
+	s0 = std::round(s0);
+	s1 = t0;
+	s1 = -s1;
+	s1 = s1 < 0.0 ? std::ceil(s1) : std::floor(s1);
+	s0 = s0 + s1;
+	s1 = t0;
+	s1 = s1 < 0.0 ? std::floor(s1) : std::ceil(s1);
+	s0 = s0 + s1;
+	s1 = 0x1.9p+4;
+	s0 = s0 + s1;
+	s1 = 0x1.28p+5;
+	s0 = s0 + s1;
+	s1 = 0x1.77p+13;
+	s0 = s0 + s1;
+	s0 = MacroTranspiledRuntime::AssignVariable(macro_variable_interface, 105, s0);
+	result.value = s0;
+	return result;
+}
+
+//#106=[#3 EQ 1] AND [[#1*#2]+1 GT 0] OR [[#1*#2]+2 GT 5]
+inline MacroBytecodeResult Block8(MacroVariableInterface& macro_variable_interface)
+{
+	MacroBytecodeResult result;
+	double s0(0.0);
+	double s1(0.0);
+	double s2(0.0);
+	double t0(0.0);
+	s0 = MacroTranspiledRuntime::ReadVariable(macro_variable_interface, 3);
+	s1 = 0x1p+0;
+	s0 = s0 == s1 ? 1.0 : 0.0;
+	if (static_cast<unsigned>(s0) == 0) {
+		s0 = 0.0;
+		goto L13;
+	}
+	s1 = MacroTranspiledRuntime::ReadVariable(macro_variable_interface, 1);
+	s2 = MacroTranspiledRuntime::ReadVariable(macro_variable_interface, 2);
+	s1 = s1 * s2;
+	t0 = s1;
+	s2 = 0x1p+0;
+	s1 = s1 + s2;
+	s2 = 0x0p+0;
+	s1 = s1 > s2 ? 1.0 : 0.0;
+	s0 = static_cast<double>(static_cast<unsigned>(s0) & static_cast<unsigned>(s1));
+L13:
+	if (s0 != 0.0) {
+		goto L23;
+	}
+	s1 = MacroTranspiledRuntime::ReadVariable(macro_variable_interface, 1);
+	s2 = MacroTranspiledRuntime::ReadVariable(macro_variable_interface, 2);
+	s1 = s1 * s2;
+	t0 = s1;
+	s2 = 0x1p+1;
+	s1 = s1 + s2;
+	s2 = 0x1.4p+2;
+	s1 = s1 > s2 ? 1.0 : 0.0;
+	s0 = static_cast<double>(static_cast<unsigned>(s0) | static_cast<unsigned>(s1));
+L23:
+	s0 = MacroTranspiledRuntime::AssignVariable(macro_variable_interface, 106, s0);
+	result.value = s0;
+	return result;
+}
+
+//IF[#1 GT 0] THEN #107=LN[#1]+EXP[1]+POW[#1,2]-TAN[#4]+ASIN[0.5]+ACOS[0.5]
+inline MacroBytecodeResult Block9(MacroVariableInterface& macro_variable_interface)
+{
+	MacroBytecodeResult result;
+	double s0(0.0);
+	double s1(0.0);
+	double s2(0.0);
+	double t0(0.0);
+	s0 = MacroTranspiledRuntime::ReadVariable(macro_variable_interface, 1);
+	t0 = s0;
+	s1 = 0x0p+0;
+	s0 = s0 > s1 ? 1.0 : 0.0;
+	if (s0 == 0.0) {
+		result.condition = false;
+		result.value = 0.0;
+		return result;
+	}
+	s0 = t0;
+	s0 = std::log(s0);
+	s1 = 0x1.5bf0a8b145769p+1;
+	s0 = s0 + s1;
+	s1 = t0;
+	s2 = 0x1p+1;
+	s1 = std::pow(s1, s2);
+	s0 = s0 + s1;
+	s1 = MacroTranspiledRuntime::ReadVariable(macro_variable_interface, 4);
+	s1 = DegreeTrigonometry::Tangent(s1);
+	s0 = s0 - s1;
+	s1 = 0x1.ep+4;
+	s0 = s0 + s1;
+	s1 = 0x1.ep+5;
+	s0 = s0 + s1;
+	s0 = MacroTranspiledRuntime::AssignVariable(macro_variable_interface, 107, s0);
+	result.value = s0;
+	return result;
+}
+
+//WHILE[#3 LT #2] DO 1
+inline MacroBytecodeResult Block10(MacroVariableInterface& macro_variable_interface)
+{
+	MacroBytecodeResult result;
+	double s0(0.0);
+	double s1(0.0);
+	s0 = 0x1p+0;
+	result.control = OP_LOOP;
+	result.number = static_cast<unsigned short>(s0);
+	s0 = MacroTranspiledRuntime::ReadVariable(macro_variable_interface, 3);
+	s1 = MacroTranspiledRuntime::ReadVariable(macro_variable_interface, 2);
+	s0 = s0 < s1 ? 1.0 : 0.0;
+	if (s0 == 0.0) {
+		result.condition = false;
+		result.value = 0.0;
+		return result;
+	}
+	result.value = 0.0;
+	return result;
+}
+
+//#3=#3+1
+inline MacroBytecodeResult Block11(MacroVariableInterface& macro_variable_interface)
+{
+	MacroBytecodeResult result;
+	double s0(0.0);
+	double s1(0.0);
+	s0 = MacroTranspiledRuntime::ReadVariable(macro_variable_interface, 3);
+	s1 = 0x1p+0;
+	s0 = s0 + s1;
+	s0 = MacroTranspiledRuntime::AssignVariable(macro_variable_interface, 3, s0);
+	result.value = s0;
+	return result;
+}
+
+//END 1
+inline MacroBytecodeResult Block12(MacroVariableInterface& macro_variable_interface)
+{
+	MacroBytecodeResult result;
+	double s0(0.0);
+	s0 = 0x1p+0;
+	result.control = OP_LOOP_END;
+	result.number = static_cast<unsigned short>(s0);
+	result.value = 0.0;
+	return result;
+}
+
+//#[#3+500]=[#3 XOR 3] OR [#2 AND 6]
+inline MacroBytecodeResult Block13(MacroVariableInterface& macro_variable_interface)
+{
+	MacroBytecodeResult result;
+	double s0(0.0);
+	double s1(0.0);
+	double s2(0.0);
+	s0 = MacroTranspiledRuntime::ReadVariable(macro_variable_interface, 3);
+	s1 = 0x1.8p+1;
+	s0 = static_cast<double>(static_cast<unsigned>(s0) ^ static_cast<unsigned>(s1));
+	s1 = MacroTranspiledRuntime::ReadVariable(macro_variable_interface, 2);
+	if (static_cast<unsigned>(s1) == 0) {
+		s1 = 0.0;
+		goto L7;
+	}
+	s2 = 0x1.8p+2;
+	s1 = static_cast<double>(static_cast<unsigned>(s1) & static_cast<unsigned>(s2));
+L7:
+	s0 = static_cast<double>(static_cast<unsigned>(s0) | static_cast<unsigned>(s1));
+	s1 = MacroTranspiledRuntime::ReadVariable(macro_variable_interface, 3);
+	s2 = 0x1.f4p+8;
+	s1 = s1 + s2;
+	s0 = MacroTranspiledRuntime::AssignVariable(macro_variable_interface, VariableID(s1), s0);
+	result.value = s0;
+	return result;
+}
+
+//#108=#2000
+inline MacroBytecodeResult Block14(MacroVariableInterface& macro_variable_interface)
+{
+	MacroBytecodeResult result;
+	double s0(0.0);
+	s0 = MacroTranspiledRuntime::ReadVariable(macro_variable_interface, 2000);
+	s0 = MacroTranspiledRuntime::AssignVariable(macro_variable_interface, 108, s0);
+	result.value = s0;
+	return result;
+}
+
+//單節表(索引與MacroProgram::Blocks()相同)
+inline const MacroTranspiledBlock blocks[] = {
+	MacroTranspiledBlock(-1, &Block0),
+	MacroTranspiledBlock(-1, &Block1),
+	MacroTranspiledBlock(10, &Block2),
+	MacroTranspiledBlock(-1, &Block3),
+	MacroTranspiledBlock(-1, &Block4),
+	MacroTranspiledBlock(-1, nullptr),
+	MacroTranspiledBlock(-1, &Block6),
+	MacroTranspiledBlock(-1, &Block7),
+	MacroTranspiledBlock(-1, &Block8),
+	MacroTranspiledBlock(-1, &Block9),
+	MacroTranspiledBlock(-1, &Block10),
+	MacroTranspiledBlock(-1, &Block11),
+	MacroTranspiledBlock(-1, &Block12),
+	MacroTranspiledBlock(-1, &Block13),
+	MacroTranspiledBlock(-1, &Block14),
+	MacroTranspiledBlock(20, nullptr),
+};
+//單節數量
+inline const size_t block_count = 16;
+}
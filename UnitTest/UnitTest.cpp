@@ -2,13 +2,52 @@
 #include "CppUnitTest.h"
 #include "MacroOperator.h"
 #include "FanucMacroParser.h"
+#include "MacroProgram.h"
+#include "MacroBytecode.h"
+#include "MacroNodeArena.h"
+#include "MacroBatch.h"
+#include "MacroJit.h"
+#include "MacroTranspiler.h"
+#include "MacroExecutor.h"
+#include "MacroCallArgument.h"
+#include "TranspiledBoltCircle.h"
+#include "DegreeTrigonometry.h"
 #include <numbers>
 #include <cmath>
+#include <limits>
+#include <bit>
 #include <string>
 #include <queue>
+#include <vector>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <filesystem>
+#include <fstream>
 
 using namespace Microsoft::VisualStudio::CppUnitTestFramework;
 
+//全域記憶體配置次數(驗證剖析工作區模式不再配置記憶體)
+static std::atomic<size_t> allocation_count(0);
+
+void* operator new(std::size_t size)
+{
+	++allocation_count;
+	if (void* memory = std::malloc(size == 0 ? 1 : size)) {
+		return memory; }
+	throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept
+{
+	std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept
+{
+	std::free(memory);
+}
+
 namespace Microsoft {
 	namespace VisualStudio {
 		namespace CppUnitTestFramework {
@@ -196,10 +235,49 @@ namespace UnitTest
 				}
 			}
 
+			TEST_METHOD(ResolvedVariableSlot)
+			{
+				SystemParameter system_parameter;
+				MacroVariableInterface mi(system_parameter);
+
+				//常數ID於建立時解析存取位置
+				auto local(std::static_pointer_cast<VariableOperator>(CreateVariableOperator(mi, 1)));
+				auto common(std::static_pointer_cast<VariableOperator>(CreateVariableOperator(mi, 500)));
+				auto system(std::static_pointer_cast<VariableOperator>(CreateVariableOperator(mi, 4201)));
+				auto missing(std::static_pointer_cast<VariableOperator>(CreateVariableOperator(mi, 2000)));
+				Assert::IsTrue(SLOT_LOCAL == local->Slot().type);
+				Assert::IsTrue(SLOT_COMMON == common->Slot().type);
+				Assert::IsTrue(SLOT_SYSTEM_UNSIGNED_SHORT == system->Slot().type);
+				Assert::IsTrue(SLOT_NOT_EXIST == missing->Slot().type);
+
+				//局部變數依目前變數層讀寫
+				Assert::IsTrue(local->WriteVariable(1.5));
+				std::map<unsigned short, double> arguments{ { 1, 2.5 } };
+				Assert::IsTrue(mi.EnterLevel(arguments));
+				Assert::AreEqual(2.5, local->Evaluate());
+				Assert::IsTrue(mi.ExitLevel());
+				Assert::AreEqual(1.5, local->Evaluate());
+
+				//共同變數及系統變數與動態查詢存取相同位置
+				Assert::IsTrue(common->WriteVariable(7.0));
+				double value(0.0);
+				Assert::IsTrue(mi.ReadVariable(500, value));
+				Assert::AreEqual(7.0, value);
+				system_parameter.current_modal_parameter.motion_command = 3;
+				Assert::AreEqual(3.0, system->Evaluate());
+				Assert::ExpectException<std::out_of_range>([&missing]() { missing->Evaluate(); });
+
+				//間接ID維持動態查詢
+				auto indirect(std::static_pointer_cast<VariableOperator>(make_shared<VariableOperator>(mi, common)));
+				Assert::IsFalse(indirect->Slot().Resolved());
+				Assert::IsTrue(mi.WriteVariable(7, value));
+				Assert::AreEqual(7.0, indirect->Evaluate());
+			}
+
 			TEST_METHOD(Sine)
 			{
 				double angle(30.0);
-				double expected(sin(ConvertAngleToRadians(angle)));
+				double expected(0.5);
 				
 				auto constant(CreateConstantOperator(angle));
 				SineOperator sine(constant);
@@ -211,7 +289,7 @@ namespace UnitTest
 			TEST_METHOD(Cosine)
 			{
 				double angle(30.0);
-				double expected(cos(ConvertAngleToRadians(angle)));
+				double expected(sqrt(3.0) / 2.0);
 				auto constant(CreateConstantOperator(angle));
 				CosineOperator cosine(constant);
 				double actual(cosine.Evaluate());
@@ -222,7 +300,7 @@ namespace UnitTest
 			TEST_METHOD(Tangent)
 			{
 				double angle(30.0);
-				double expected(tan(ConvertAngleToRadians(angle)));
+				double expected(sqrt(3.0) / 3.0);
 				
 				auto constant(CreateConstantOperator(angle));
 				TangentOperator tangent(constant);
@@ -234,7 +312,7 @@ namespace UnitTest
 			TEST_METHOD(ArcSine)
 			{
 				double ratio(0.5);
-				double expected(ConvertRadiansToAngle(asin(ratio)));
+				double expected(30.0);
 
 				auto constant(CreateConstantOperator(ratio));
 				ArcSineOperator arcsine(constant);
@@ -246,7 +324,7 @@ namespace UnitTest
 			TEST_METHOD(ArcCosine)
 			{
 				double ratio(0.5);
-				double expected(ConvertRadiansToAngle(acos(ratio)));
+				double expected(60.0);
 				
 				auto constant(CreateConstantOperator(ratio));
 				ArcCosineOperator arccosine(constant);
@@ -264,7 +342,8 @@ namespace UnitTest
 				ArcTangentOperator arctangent(constant);
 				double actual(arctangent.Evaluate());
 
-				Assert::AreEqual(expected, actual);
+				//非特殊值與徑度換算僅相差捨入誤差
+				Assert::AreEqual(expected, actual, 1e-12);
 			}
 
 			TEST_METHOD(SquareRoot)
@@ -376,7 +455,7 @@ namespace UnitTest
 				double right(1);
 				auto right_operand(CreateConstantOperator(right));
 
-				double expected(atan2(left, right) / pi * 180.0);
+				double expected(45.0);
 				ArcTangent2Operator arctangent2(left_operand, right_operand);
 				double actual(arctangent2.Evaluate());
 
@@ -678,7 +757,7 @@ namespace UnitTest
 				MacroVariableInterface macro_variable_interface(system_parameter);
 				string block("SIN[30]");
 
-				double expected(sin(ConvertAngleToRadians(30.0)));
+				double expected(0.5);
 				double actual(EvaluateArithmeticMacroExpression(macro_variable_interface, block));
 				Assert::AreEqual(expected, actual);
 			}
@@ -689,7 +768,7 @@ namespace UnitTest
 				MacroVariableInterface macro_variable_interface(system_parameter);
 				string block("COS[30]");
 
-				double expected(cos(ConvertAngleToRadians(30.0)));
+				double expected(sqrt(3.0) / 2.0);
 				double actual(EvaluateArithmeticMacroExpression(macro_variable_interface, block));
 				Assert::AreEqual(expected, actual);
 			}
@@ -700,7 +779,7 @@ namespace UnitTest
 				MacroVariableInterface macro_variable_interface(system_parameter);
 				string block("TAN[30]");
 
-				double expected(tan(ConvertAngleToRadians(30.0)));
+				double expected(sqrt(3.0) / 3.0);
 				double actual(EvaluateArithmeticMacroExpression(macro_variable_interface, block));
 				Assert::AreEqual(expected, actual);
 			}
@@ -711,7 +790,7 @@ namespace UnitTest
 				MacroVariableInterface macro_variable_interface(system_parameter);
 				string block("ASIN[0.5]");
 
-				double expected(ConvertRadiansToAngle(asin(0.5)));
+				double expected(30.0);
 				double actual(EvaluateArithmeticMacroExpression(macro_variable_interface, block));
 				Assert::AreEqual(expected, actual);
 			}
@@ -722,7 +801,7 @@ namespace UnitTest
 				MacroVariableInterface macro_variable_interface(system_parameter);
 				string block("ACOS[0.5]");
 
-				double expected(ConvertRadiansToAngle(acos(0.5)));
+				double expected(60.0);
 				double actual(EvaluateArithmeticMacroExpression(macro_variable_interface, block));
 				Assert::AreEqual(expected, actual);
 			}
@@ -735,7 +814,7 @@ namespace UnitTest
 
 				double expected(ConvertRadiansToAngle(atan(0.5)));
 				double actual(EvaluateArithmeticMacroExpression(macro_variable_interface, block));
-				Assert::AreEqual(expected, actual);
+				Assert::AreEqual(expected, actual, 1e-12);
 			}
 
 			TEST_METHOD(SquareRoot)
@@ -814,6 +893,42 @@ namespace UnitTest
 				double actual(EvaluateArithmeticMacroExpression(macro_variable_interface, block));
 				Assert::AreEqual(expected, actual);
 			}
+
+			TEST_METHOD(BinaryCode)
+			{
+				SystemParameter system_parameter;
+				MacroVariableInterface macro_variable_interface(system_parameter);
+				string block("BIN[37]");
+
+				//0x25轉換為25
+				double expected(25.0);
+				double actual(EvaluateArithmeticMacroExpression(macro_variable_interface, block));
+				Assert::AreEqual(expected, actual);
+			}
+
+			TEST_METHOD(BinaryCodedDecimal)
+			{
+				SystemParameter system_parameter;
+				MacroVariableInterface macro_variable_interface(system_parameter);
+				string block("BCD[25]");
+
+				//25轉換為0x25
+				double expected(37.0);
+				double actual(EvaluateArithmeticMacroExpression(macro_variable_interface, block));
+				Assert::AreEqual(expected, actual);
+			}
+
+			TEST_METHOD(AddDecimalPoint)
+			{
+				SystemParameter system_parameter;
+				MacroVariableInterface macro_variable_interface(system_parameter);
+				string block("ADP[0.01]");
+
+				//最小設定單位0.001
+				double expected(10.0);
+				double actual(EvaluateArithmeticMacroExpression(macro_variable_interface, block));
+				Assert::AreEqual(expected, actual, 1e-9);
+			}
 		};
 
 		TEST_CLASS(BinaryArithmeticOperators)
@@ -836,7 +951,7 @@ namespace UnitTest
 				MacroVariableInterface macro_variable_interface(system_parameter);
 				string block("ATAN[1.0,1.0]");
 
-				double expected(ConvertRadiansToAngle(atan2(1.0,1.0)));
+				double expected(45.0);
 				double actual(EvaluateArithmeticMacroExpression(macro_variable_interface, block));
 				Assert::AreEqual(expected, actual);
 			}
@@ -996,6 +1111,103 @@ namespace UnitTest
 				unsigned expected(1);
 				Assert::AreEqual(expected, EvaluateLogicalMacroExpression(macro_variable_interface, block));
 			}
+
+			TEST_METHOD(ShortCircuit)
+			{
+				SystemParameter system_parameter;
+				MacroVariableInterface macro_variable_interface(system_parameter);
+				macro_variable_interface.SetAlarmMode(true);
+				double zero(0.0);
+				macro_variable_interface.WriteVariable(1, zero);
+
+				//AND左運算元為0及布林OR左運算元成立時,不讀取右運算元的不存在變數
+				Assert::AreEqual(0u, EvaluateLogicalMacroExpression(macro_variable_interface, "[#1 EQ 1] AND [#2000 EQ 0]"));
+				Assert::AreEqual(0u, EvaluateLogicalMacroExpression(macro_variable_interface, "[0.5 AND #2000]"));
+				Assert::AreEqual(1u, EvaluateLogicalMacroExpression(macro_variable_interface, "[#1 EQ 0] OR [#2000 EQ 0]"));
+				Assert::IsFalse(macro_variable_interface.HasAlarm());
+				//XOR一律核算右運算元
+				EvaluateLogicalMacroExpression(macro_variable_interface, "[#1 EQ 0] XOR [#2000 EQ 0]");
+				Assert::IsTrue(macro_variable_interface.HasAlarm());
+			}
+
+			TEST_METHOD(BitwiseArithmetic)
+			{
+				SystemParameter system_parameter;
+				MacroVariableInterface macro_variable_interface(system_parameter);
+
+				//算術運算元維持位元運算
+				Assert::AreEqual(3u, EvaluateLogicalMacroExpression(macro_variable_interface, "[1 OR 2]"));
+				Assert::AreEqual(7u, EvaluateLogicalMacroExpression(macro_variable_interface, "[1 OR 2 OR 4]"));
+				Assert::AreEqual(2u, EvaluateLogicalMacroExpression(macro_variable_interface, "[6 AND 3]"));
+			}
+		};
+
+		TEST_CLASS(Precedence)
+		{
+		public:
+			TEST_METHOD(Arithmetic)
+			{
+				SystemParameter system_parameter;
+				MacroVariableInterface macro_variable_interface(system_parameter);
+
+				string block("1+2*3-4/2");
+				double expected(5.0);
+				Assert::AreEqual(expected, EvaluateArithmeticMacroExpression(macro_variable_interface, block));
+			}
+
+			TEST_METHOD(RelationalAndLogical)
+			{
+				SystemParameter system_parameter;
+				MacroVariableInterface macro_variable_interface(system_parameter);
+
+				//AND優先於OR,關係運算子須以[]與邏輯運算子區分
+				string block("[[1 EQ 2] OR [1+1 EQ 2] AND [3 GT 2]]");
+				unsigned expected(1);
+				Assert::AreEqual(expected, EvaluateLogicalMacroExpression(macro_variable_interface, block));
+			}
+
+			TEST_METHOD(UnbracketedLogical)
+			{
+				SystemParameter system_parameter;
+				MacroVariableInterface macro_variable_interface(system_parameter);
+				FanucMacroParser parser(macro_variable_interface);
+
+				//FANUC優先順序與一般優先順序結果不同的組合不可省略[]
+				Assert::AreEqual(CommandType::INVALID_COMMAND, parser.ParseBlock("#33=3 AND 1+4"));
+				Assert::AreEqual(CommandType::INVALID_COMMAND, parser.ParseBlock("#33=2+3 AND 1"));
+				Assert::AreEqual(CommandType::INVALID_COMMAND, parser.ParseBlock("#33=2*3 OR 1"));
+				Assert::AreEqual(CommandType::INVALID_COMMAND, parser.ParseBlock("IF[#1 EQ 1 AND #2 EQ 2] THEN #3=1"));
+				Assert::AreEqual(CommandType::INVALID_COMMAND, parser.ParseBlock("#33=1 OR 2 EQ 2"));
+				//以[]區分時依括號結合
+				Assert::AreEqual(1.0, EvaluateArithmeticMacroExpression(macro_variable_interface, "#33=3 AND [1+4]"));
+				Assert::AreEqual(1.0, EvaluateArithmeticMacroExpression(macro_variable_interface, "#33=[2+3] AND 1"));
+				Assert::AreEqual(CommandType::MACRO_COMMAND, parser.ParseBlock("IF[[#1 EQ 1] AND [#2 EQ 2]] THEN #3=1"));
+			}
+
+			TEST_METHOD(DeepNesting)
+			{
+				SystemParameter system_parameter;
+				MacroVariableInterface macro_variable_interface(system_parameter);
+
+				//超過5層的優先運算範圍
+				string block("[[[[[[[[1+2]*3]]]]]-1]*SIN[[[[[[[90]]]]]]]]");
+				double expected(8.0);
+				Assert::AreEqual(expected, EvaluateArithmeticMacroExpression(macro_variable_interface, block));
+			}
+
+			TEST_METHOD(InvalidExpression)
+			{
+				SystemParameter system_parameter;
+				MacroVariableInterface macro_variable_interface(system_parameter);
+				FanucMacroParser parser(macro_variable_interface);
+
+				Assert::AreEqual(CommandType::INVALID_COMMAND, parser.ParseBlock("#1=SIN 30"));
+				Assert::AreEqual(CommandType::INVALID_COMMAND, parser.ParseBlock("#1=POW[2]"));
+				Assert::AreEqual(CommandType::INVALID_COMMAND, parser.ParseBlock("#1=[1,2]"));
+				Assert::AreEqual(CommandType::INVALID_COMMAND, parser.ParseBlock("#1=[1+2"));
+				Assert::AreEqual(CommandType::INVALID_COMMAND, parser.ParseBlock("#1=2 3"));
+				Assert::AreEqual(CommandType::INVALID_COMMAND, parser.ParseBlock("THEN #1=2"));
+			}
 		};
 		
 		TEST_CLASS(ConditionalOperators)
@@ -1069,4 +1281,2052 @@ namespace UnitTest
 			}
 		};
 	}
+
+	namespace MacroLexer {
+		TEST_CLASS(Tokens)
+		{
+		public:
+			TEST_METHOD(TokenTypes)
+			{
+				FanucMacroLexer lexer;
+				string block("#33=SIN[30] (C)");
+				lexer.Tokenize(block);
+
+				std::vector<MacroTokenType> expected{ TOKEN_OPERATOR, TOKEN_NUMBER, TOKEN_OPERATOR, TOKEN_KEYWORD,
+					TOKEN_PRIORITY_BEGIN, TOKEN_NUMBER, TOKEN_PRIORITY_END, TOKEN_COMMENT };
+				Assert::AreEqual(expected.size(), lexer.Tokens().size());
+				for (size_t i = 0; i != expected.size(); ++i) {
+					Assert::IsTrue(expected[i] == lexer.Tokens()[i].type); }
+				Assert::IsTrue(UNARY_FUNCTION_OPERATOR == lexer.Tokens()[3].keyword);
+			}
+
+			TEST_METHOD(ZeroCopy)
+			{
+				FanucMacroLexer lexer;
+				string block("IF[#1 GE 2.5] GOTO 10");
+				lexer.Tokenize(block);
+
+				//語彙單元內容直接指向原單節字串
+				for (const MacroToken& token : lexer.Tokens()) {
+					Assert::IsTrue(token.text.data() >= block.data() && token.text.data() + token.text.size() <= block.data() + block.size()); }
+				Assert::IsTrue(lexer.Tokens()[4].text == "GE");
+				Assert::IsTrue(RELATIONAL_OPERATOR == lexer.Tokens()[4].keyword);
+				Assert::IsTrue(lexer.Tokens()[5].text == "2.5");
+			}
+
+			TEST_METHOD(KeywordHashTable)
+			{
+				//編譯期查詢
+				static_assert(FindMacroKeyword("ATAN").id == ARC_TANGENT_KEYWORD);
+				static_assert(FindMacroKeyword("ATAN").type == UNARY_BINARY_FUNCTION_OPERATOR);
+				static_assert(FindMacroKeyword("SINE").id == NOT_A_KEYWORD);
+
+				//所有關鍵字皆可查得對應的分類及ID
+				for (const MacroKeyword& keyword : MACRO_KEYWORD_LIST) {
+					MacroKeyword entry(FindMacroKeyword(keyword.text));
+					Assert::IsTrue(entry.id == keyword.id);
+					Assert::IsTrue(entry.type == keyword.type);
+				}
+				//非關鍵字
+				Assert::IsTrue(FindMacroKeyword("").id == NOT_A_KEYWORD);
+				Assert::IsTrue(FindMacroKeyword("X").id == NOT_A_KEYWORD);
+				Assert::IsTrue(FindMacroKeyword("SI").id == NOT_A_KEYWORD);
+				Assert::IsTrue(FindMacroKeyword("GOTOX").id == NOT_A_KEYWORD);
+				Assert::IsTrue(FindMacroKeyword("ABC").type == NOT_AN_OPERATOR);
+			}
+		};
+	}
+	namespace MacroParser {
+		TEST_CLASS(ParseWorkspace)
+		{
+		public:
+			TEST_METHOD(AllocationFree)
+			{
+				SystemParameter system_parameter;
+				MacroVariableInterface macro_variable_interface(system_parameter);
+				FanucMacroParser parser(macro_variable_interface);
+				parser.EnableWorkspace();
+
+				std::vector<string> blocks{
+					"#33=[[[[SIN[#31-#1]+#2]*#3+#4]*#5+#6]*#7+#8]*#9",
+					"#33=POW[#2,#2*4+#6-#14+#2*#8] (65536)",
+					"IF[[#33 EQ 33] AND [#32 EQ 32]] THEN #33=#1*#2+#3-#1*#2+#4*#5",
+					"IF[#33 EQ 33] GOTO #33",
+					"WHILE[[#33 EQ 33] OR [#32 EQ 23]] DO 3",
+					"END 3",
+					"N10 G01 X-[#1+#2] #1=#[#3]" };
+
+				//暖機:建立記憶池區塊及容器容量
+				for (int pass = 0; pass != 2; ++pass) {
+					for (const string& block : blocks) {
+						parser.ParseBlock(block); }
+				}
+
+				//暖機後重複剖析不應配置任何記憶體
+				size_t allocation_before(allocation_count);
+				bool all_parsed(true);
+				for (int pass = 0; pass != 100; ++pass) {
+					for (const string& block : blocks) {
+						all_parsed = parser.ParseBlock(block) != CommandType::INVALID_COMMAND && all_parsed; }
+				}
+				size_t allocation_after(allocation_count);
+
+				Assert::IsTrue(all_parsed);
+				Assert::AreEqual(allocation_before, allocation_after);
+			}
+
+			TEST_METHOD(TreeOutlivesParser)
+			{
+				SystemParameter system_parameter;
+				MacroVariableInterface macro_variable_interface(system_parameter);
+				std::shared_ptr<ArithmeticOperator> expression;
+				{
+					FanucMacroParser parser(macro_variable_interface);
+					parser.EnableWorkspace();
+					Assert::AreEqual(CommandType::MACRO_COMMAND, parser.ParseBlock("[1+2]*3"));
+					expression = parser.macro_generator.GeneralOperators().front().arithmetic;
+				}
+				//運算子持有記憶池,剖析器解構後仍可核算
+				double expected(9.0);
+				Assert::AreEqual(expected, expression->Evaluate());
+			}
+		};
+
+		TEST_CLASS(BlockCache)
+		{
+		public:
+			TEST_METHOD(HitAndMiss)
+			{
+				SystemParameter system_parameter;
+				MacroVariableInterface macro_variable_interface(system_parameter);
+				FanucMacroParser parser(macro_variable_interface);
+				parser.EnableBlockCache(8);
+
+				string block("#33=#1*#2+#3");
+				double expected(0.0);
+				//同一單節重複剖析:第一次未命中,其餘命中並沿用相同運算子
+				Assert::AreEqual(CommandType::MACRO_COMMAND, parser.ParseBlock(block));
+				std::shared_ptr<ArithmeticOperator> expression(parser.macro_generator.GeneralOperators().front().arithmetic);
+				for (int iteration = 1; iteration != 5; ++iteration) {
+					double value(iteration);
+					macro_variable_interface.WriteVariable(1, value);
+					macro_variable_interface.WriteVariable(2, value);
+					macro_variable_interface.WriteVariable(3, value);
+					Assert::AreEqual(CommandType::MACRO_COMMAND, parser.ParseBlock(block));
+					Assert::IsTrue(expression == parser.macro_generator.GeneralOperators().front().arithmetic);
+					//快取的運算子每次核算時讀取目前變數值
+					expected = value * value + value;
+					Assert::AreEqual(expected, parser.macro_generator.GeneralOperators().front().arithmetic->Evaluate());
+				}
+				//不合法單節亦快取
+				Assert::AreEqual(CommandType::INVALID_COMMAND, parser.ParseBlock("#33=SIN 30"));
+				Assert::AreEqual(CommandType::INVALID_COMMAND, parser.ParseBlock("#33=SIN 30"));
+				//條件式單節還原條件運算子
+				Assert::AreEqual(CommandType::MACRO_COMMAND, parser.ParseBlock("WHILE[#1 LT 10] DO 1"));
+				Assert::AreEqual(CommandType::MACRO_COMMAND, parser.ParseBlock("WHILE[#1 LT 10] DO 1"));
+				Assert::IsTrue(parser.macro_generator.GeneralOperators().empty());
+				Assert::IsFalse(parser.macro_generator.conditional_loop_operator.Empty());
+
+				size_t hits(6), misses(3), size(3);
+				Assert::AreEqual(hits, parser.BlockCache().Hits());
+				Assert::AreEqual(misses, parser.BlockCache().Misses());
+				Assert::AreEqual(size, parser.BlockCache().Size());
+			}
+
+			TEST_METHOD(LeastRecentlyUsedEviction)
+			{
+				SystemParameter system_parameter;
+				MacroVariableInterface macro_variable_interface(system_parameter);
+				FanucMacroParser parser(macro_variable_interface);
+				parser.EnableBlockCache(2);
+
+				parser.ParseBlock("#1=1");
+				parser.ParseBlock("#2=2");
+				//使用#1=1使#2=2成為最久未使用
+				parser.ParseBlock("#1=1");
+				//超過容量淘汰#2=2
+				parser.ParseBlock("#3=3");
+				parser.ParseBlock("#1=1");
+				parser.ParseBlock("#2=2");
+
+				size_t hits(2), misses(4), size(2);
+				Assert::AreEqual(hits, parser.BlockCache().Hits());
+				Assert::AreEqual(misses, parser.BlockCache().Misses());
+				Assert::AreEqual(size, parser.BlockCache().Size());
+
+				//停用快取後不再查詢
+				parser.EnableBlockCache(0);
+				parser.ParseBlock("#1=1");
+				size_t empty(0);
+				Assert::AreEqual(empty, parser.BlockCache().Size());
+				Assert::AreEqual(misses, parser.BlockCache().Misses());
+			}
+		};
+
+		TEST_CLASS(ConstantFolding)
+		{
+		public:
+			TEST_METHOD(LiteralSubexpressions)
+			{
+				SystemParameter system_parameter;
+				MacroVariableInterface macro_variable_interface(system_parameter);
+				FanucMacroParser parser(macro_variable_interface);
+				auto constant = [](double value) {
+					return std::make_shared<ConstantOperator>(value); };
+
+				//摺疊結果須與逐一核算運算子完全相同(ADP最小設定單位0.001)
+				std::vector<std::pair<string, std::shared_ptr<ArithmeticOperator>>> folds{
+					{ "SIN[30]", std::make_shared<SineOperator>(constant(30)) },
+					{ "POW[2,16]", std::make_shared<PowerOperator>(constant(2), constant(16)) },
+					{ "[1+2]*3", std::make_shared<MultiplyOperator>(std::make_shared<AddOperator>(constant(1), constant(2)), constant(3)) },
+					{ "-FIX[-2.5]+FUP[-2.5]", std::make_shared<AddOperator>(std::make_shared<MinusOperator>(std::make_shared<RoundDownOperator>(constant(-2.5))), std::make_shared<RoundUpOperator>(constant(-2.5))) },
+					{ "BIN[37]+BCD[25]", std::make_shared<AddOperator>(std::make_shared<BinaryCodeOperator>(constant(37)), std::make_shared<BinaryCodedDecimalOperator>(constant(25))) },
+					{ "ADP[0.01]*ATAN[1,2]", std::make_shared<MultiplyOperator>(std::make_shared<AddDecimalPointOperator>(constant(0.01), 0.001), std::make_shared<ArcTangent2Operator>(constant(1), constant(2))) } };
+
+				for (const auto& fold : folds) {
+					Assert::AreEqual(CommandType::MACRO_COMMAND, parser.ParseBlock(fold.first));
+					std::shared_ptr<ArithmeticOperator> root(parser.macro_generator.GeneralOperators().front().arithmetic);
+					Assert::IsTrue(CONSTANT == root->GetOperatorID());
+					Assert::AreEqual(fold.second->Evaluate(), root->Evaluate());
+				}
+			}
+
+			TEST_METHOD(VariableSubexpressions)
+			{
+				SystemParameter system_parameter;
+				MacroVariableInterface macro_variable_interface(system_parameter);
+				FanucMacroParser parser(macro_variable_interface);
+
+				//含變數的運算子保留,僅摺疊常數索引
+				Assert::AreEqual(CommandType::MACRO_COMMAND, parser.ParseBlock("#[1+2]*[3+4]"));
+				std::shared_ptr<ArithmeticOperator> root(parser.macro_generator.GeneralOperators().front().arithmetic);
+				Assert::IsTrue(MULTIPLY == root->GetOperatorID());
+
+				//核算結果隨變數值變動
+				Assert::AreEqual(CommandType::MACRO_COMMAND, parser.ParseBlock("#3=2"));
+				parser.macro_generator.GeneralOperators().front().arithmetic->Evaluate();
+				double expected(14.0);
+				Assert::AreEqual(expected, root->Evaluate());
+			}
+		};
+
+		TEST_CLASS(CommonSubexpression)
+		{
+		public:
+			TEST_METHOD(SharedSubtree)
+			{
+				SystemParameter system_parameter;
+				MacroVariableInterface macro_variable_interface(system_parameter);
+				FanucMacroParser parser(macro_variable_interface);
+				for (unsigned short variable_ID = 1; variable_ID <= 31; ++variable_ID) {
+					double value(variable_ID);
+					macro_variable_interface.WriteVariable(variable_ID, value);
+				}
+
+				string single("[[[[SIN[#31-#1]+#2]*#3+#4]*#5+#6]*#7+#8]*#9");
+				Assert::AreEqual(CommandType::MACRO_COMMAND, parser.ParseBlock("#33=" + single));
+				double expected(parser.macro_generator.GeneralOperators().front().arithmetic->Evaluate() * 2.0);
+
+				Assert::AreEqual(CommandType::MACRO_COMMAND, parser.ParseBlock("#33=" + single + "+" + single));
+				CompiledMacroBlock compiled(CommandType::MACRO_COMMAND, parser.macro_generator);
+				Assert::AreEqual(expected, compiled.general_operators.front().arithmetic->Evaluate());
+
+				//重複的子樹僅核算一次,其後讀取暫存區
+				MacroBytecode bytecode;
+				Assert::IsTrue(bytecode.Compile(compiled));
+				size_t temporaries(1);
+				Assert::AreEqual(temporaries, bytecode.TemporaryCount());
+				Assert::IsTrue(OP_LOAD_TEMPORARY == bytecode.Code()[bytecode.Code().size() - 4].opcode);
+				MacroVirtualMachine machine(macro_variable_interface);
+				Assert::AreEqual(expected, machine.Run(bytecode).value);
+
+				//索引節點共用同一子樹:子樹20個節點,加法,變數ID常數及賦值
+				MacroNodeArena arena;
+				ArenaMacroBlock statement;
+				Assert::IsTrue(arena.Compile(compiled, statement));
+				Assert::AreEqual(expected, arena.Run(statement, macro_variable_interface).value);
+				size_t node_count(23);
+				Assert::AreEqual(node_count, arena.Size());
+
+				//變數變更後重新核算
+				double value(0.0);
+				macro_variable_interface.WriteVariable(9, value);
+				Assert::AreEqual(value, compiled.general_operators.front().arithmetic->Evaluate());
+			}
+
+			TEST_METHOD(WriteInsideStatement)
+			{
+				SystemParameter system_parameter;
+				MacroVariableInterface macro_variable_interface(system_parameter);
+				FanucMacroParser parser(macro_variable_interface);
+				double value(7.0);
+				macro_variable_interface.WriteVariable(1, value);
+				value = 3.0;
+				macro_variable_interface.WriteVariable(2, value);
+
+				//變數ID於寫入前核算一次,寫入#2後結果讀取#2(不重新核算為#1)
+				Assert::AreEqual(CommandType::MACRO_COMMAND, parser.ParseBlock("#[#2-1]=[#2-1]*1"));
+				double expected(2.0);
+				Assert::AreEqual(expected, parser.macro_generator.GeneralOperators().front().arithmetic->Evaluate());
+				macro_variable_interface.ReadVariable(2, value);
+				Assert::AreEqual(expected, value);
+				macro_variable_interface.ReadVariable(1, value);
+				Assert::AreEqual(7.0, value);
+			}
+		};
+	}
+
+	namespace Program {
+		TEST_CLASS(Compile)
+		{
+		public:
+			TEST_METHOD(IndexedProgram)
+			{
+				SystemParameter system_parameter;
+				MacroVariableInterface macro_variable_interface(system_parameter);
+				FanucMacroParser parser(macro_variable_interface);
+				MacroProgram program;
+
+				string text(
+					"%\r\n"
+					"O801 (LOOP)\r\n"
+					"#1=0\r\n"
+					"N10 WHILE[#1 LT 10] DO 1\r\n"
+					"WHILE[#2 LT 3] DO 2\r\n"
+					"/#2=#2+1\r\n"
+					"END 2\r\n"
+					"N20 IF[#1 EQ 5] GOTO 40\r\n"
+					"#1=#1+1\r\n"
+					"END 1\r\n"
+					"GOTO #3\r\n"
+					"N40 G00 X0\r\n"
+					"M30\r\n"
+					"%\r\n"
+					"#1=99\r\n");
+				Assert::IsTrue(program.Compile(text, parser));
+				Assert::AreEqual(801, program.ProgramNumber());
+
+				const std::vector<MacroProgramBlock>& blocks(program.Blocks());
+				size_t block_count(11);
+				Assert::AreEqual(block_count, blocks.size());
+				//序號索引
+				size_t n10(1), n20(5), n40(9);
+				Assert::AreEqual(n10, program.FindSequence(10));
+				Assert::AreEqual(n20, program.FindSequence(20));
+				Assert::AreEqual(n40, program.FindSequence(40));
+				Assert::AreEqual(NO_PROGRAM_BLOCK, program.FindSequence(30));
+				Assert::AreEqual(string("WHILE[#1 LT 10] DO 1"), blocks[n10].text);
+				//DO/END配對
+				size_t do2(2), end2(4), end1(7);
+				Assert::AreEqual(end1, blocks[n10].loop_pair);
+				Assert::AreEqual(n10, blocks[end1].loop_pair);
+				Assert::AreEqual(end2, blocks[do2].loop_pair);
+				Assert::AreEqual(do2, blocks[end2].loop_pair);
+				//常數分支目標預先解析,變數分支目標留待執行時查詢
+				Assert::AreEqual(n40, blocks[n20].branch_target);
+				Assert::AreEqual(NO_PROGRAM_BLOCK, blocks[8].branch_target);
+				Assert::IsTrue(blocks[3].block_delete);
+				Assert::AreEqual(CommandType::MACRO_COMMAND, blocks[3].command_type);
+				Assert::AreEqual(CommandType::INVALID_COMMAND, blocks[n40].command_type);
+			}
+
+			TEST_METHOD(UnmatchedLoop)
+			{
+				SystemParameter system_parameter;
+				MacroVariableInterface macro_variable_interface(system_parameter);
+				FanucMacroParser parser(macro_variable_interface);
+				MacroProgram program;
+
+				Assert::IsFalse(program.Compile("O1\nWHILE[#1 LT 1] DO 1\nEND 2\n", parser));
+				Assert::IsFalse(program.Compile("O1\nWHILE[#1 LT 1] DO 1\n", parser));
+				Assert::IsFalse(program.Compile("O1\nEND 1\n", parser));
+				Assert::IsFalse(program.Compile("O1\nWHILE[#1 LT 1] DO 4\nEND 4\n", parser));
+				//巢狀超過3層
+				Assert::IsFalse(program.Compile("O1\nDO 1\nDO 2\nDO 3\nDO 1\nEND 1\nEND 3\nEND 2\nEND 1\n", parser));
+				//交錯迴圈
+				Assert::IsFalse(program.Compile("O1\nWHILE[#1 LT 1] DO 1\nWHILE[#2 LT 1] DO 2\nEND 1\nEND 2\n", parser));
+				Assert::IsTrue(program.Compile("O1\nWHILE[#1 LT 1] DO 1\nEND 1\nWHILE[#1 LT 1] DO 1\nEND 1\n", parser));
+			}
+
+			TEST_METHOD(NumberOverflow)
+			{
+				SystemParameter system_parameter;
+				MacroVariableInterface macro_variable_interface(system_parameter);
+				FanucMacroParser parser(macro_variable_interface);
+				MacroProgram program;
+
+				//程式號碼超過位數上限
+				Assert::IsFalse(program.Compile("O99999999999\n#1=1\n", parser));
+				//序號超過位數上限的單節不剖析
+				Assert::IsTrue(program.Compile("O0000000001\nN99999999999 #1=1\nN000000000020 #2=2\nN999999999 #3=3\n", parser));
+				Assert::AreEqual(1, program.ProgramNumber());
+				const std::vector<MacroProgramBlock>& blocks(program.Blocks());
+				Assert::AreEqual(NO_SEQUENCE_NUMBER, blocks[0].sequence_number);
+				Assert::AreEqual(CommandType::INVALID_COMMAND, blocks[0].command_type);
+				Assert::AreEqual(20, blocks[1].sequence_number);
+				Assert::AreEqual(CommandType::MACRO_COMMAND, blocks[1].command_type);
+				size_t n999999999(2);
+				Assert::AreEqual(n999999999, program.FindSequence(999999999));
+			}
+		};
+	}
+
+	namespace Bytecode {
+		//剖析單節並產生位元組碼
+		static void CompileBytecode(FanucMacroParser& parser, const string& block, MacroBytecode& bytecode)
+		{
+			CommandType command_type(parser.ParseBlock(block));
+			Assert::AreEqual(CommandType::MACRO_COMMAND, command_type);
+			Assert::IsTrue(bytecode.Compile(CompiledMacroBlock(command_type, parser.macro_generator)));
+		}
+
+		TEST_CLASS(VirtualMachine)
+		{
+		public:
+			TEST_METHOD(MatchesTreeWalker)
+			{
+				SystemParameter system_parameter;
+				MacroVariableInterface macro_variable_interface(system_parameter);
+				FanucMacroParser parser(macro_variable_interface);
+				MacroVirtualMachine machine(macro_variable_interface);
+				for (unsigned short id = 1; id <= 9; ++id) {
+					double value(id);
+					macro_variable_interface.WriteVariable(id, value);
+				}
+
+				std::vector<string> blocks{
+					"-#[#3-1]+#4-#5*#6/#7",
+					"SIN[#1*30]+COS[60]+TAN[45]",
+					"ASIN[0.5]+ACOS[0.5]+ATAN[1]+ATAN[#1,#2]",
+					"SQRT[#9]+ABS[-#2]+ROUND[2.5]+FIX[-2.5]+FUP[-2.5]+FIX[2.5]+FUP[2.5]",
+					"LN[#2]+EXP[#1]+POW[#2,#8]",
+					"BIN[37]+BCD[25]+ADP[0.01]",
+					"[[[[SIN[#9-#1]+#2]*#3+#4]*#5+#6]*#7+#8]*#9",
+					"#1 EQ #1",
+					"#1 NE #1",
+					"#2 GT #1",
+					"#2 GE #3",
+					"#2 LT #1",
+					"#2 LE #2",
+					"#7 AND #1 OR #2 XOR #3 AND #4 AND #5 XOR #6 OR #7",
+					"[#1 EQ 1] AND [#2 EQ 2]",
+					"#10=[#1 OR #2] AND #3",
+					"#[#1+9]=#9*2" };
+
+				for (const string& block : blocks) {
+					MacroBytecode bytecode;
+					CompileBytecode(parser, block, bytecode);
+					GeneralOperatorHandle handle(parser.macro_generator.GeneralOperators().front());
+					double expected(handle.arithmetic ? handle.arithmetic->Evaluate() :
+						handle.relational ? handle.relational->Evaluate() : handle.logical->Evaluate());
+					MacroBytecodeResult result(machine.Run(bytecode));
+					Assert::IsTrue(result.condition);
+					Assert::AreEqual(expected, result.value);
+				}
+				double assigned(0.0), expected(18.0);
+				macro_variable_interface.ReadVariable(10, assigned);
+				Assert::AreEqual(expected, assigned);
+
+				//間接ID於寫入前核算,結果讀取寫入的變數(#1=5時寫入#1)
+				for (const string& block : { "#[#1-4]=7", "#[#1-4]=#1-4" }) {
+					double five(5.0), tree_written(0.0), written(0.0);
+					macro_variable_interface.WriteVariable(1, five);
+					MacroBytecode bytecode;
+					CompileBytecode(parser, block, bytecode);
+					double tree_value(parser.macro_generator.GeneralOperators().front().arithmetic->Evaluate());
+					macro_variable_interface.ReadVariable(1, tree_written);
+					macro_variable_interface.WriteVariable(1, five);
+					Assert::AreEqual(tree_value, machine.Run(bytecode).value);
+					macro_variable_interface.ReadVariable(1, written);
+					Assert::AreEqual(tree_written, written);
+					Assert::AreEqual(written, tree_value);
+				}
+				Assert::IsFalse(macro_variable_interface.HasAlarm());
+			}
+
+			TEST_METHOD(ControlInstructions)
+			{
+				SystemParameter system_parameter;
+				MacroVariableInterface macro_variable_interface(system_parameter);
+				FanucMacroParser parser(macro_variable_interface);
+				MacroVirtualMachine machine(macro_variable_interface);
+				double one(1.0), zero(0.0);
+				macro_variable_interface.WriteVariable(1, one);
+				macro_variable_interface.WriteVariable(2, zero);
+
+				MacroBytecode bytecode;
+				//條件不成立時不執行賦值
+				CompileBytecode(parser, "IF[#1 EQ 2] THEN #2=5", bytecode);
+				MacroBytecodeResult result(machine.Run(bytecode));
+				double value(0.0), expected(0.0);
+				macro_variable_interface.ReadVariable(2, value);
+				Assert::IsFalse(result.condition);
+				Assert::AreEqual(expected, value);
+				//條件成立時執行賦值
+				CompileBytecode(parser, "IF[[#1 EQ 1] OR [#1 EQ 2]] THEN #2=5", bytecode);
+				result = machine.Run(bytecode);
+				expected = 5.0;
+				macro_variable_interface.ReadVariable(2, value);
+				Assert::IsTrue(result.condition);
+				Assert::AreEqual(expected, value);
+				//條件分支
+				CompileBytecode(parser, "IF[#1 EQ 1] GOTO #2*2", bytecode);
+				result = machine.Run(bytecode);
+				Assert::IsTrue(OP_BRANCH == result.control);
+				Assert::IsTrue(result.condition);
+				Assert::AreEqual(10, result.number);
+				CompileBytecode(parser, "GOTO 99", bytecode);
+				result = machine.Run(bytecode);
+				Assert::IsTrue(result.condition);
+				Assert::AreEqual(99, result.number);
+				//條件不成立的迴圈仍返回迴圈識別號碼
+				CompileBytecode(parser, "WHILE[#1 GT 1] DO 2", bytecode);
+				result = machine.Run(bytecode);
+				Assert::IsTrue(OP_LOOP == result.control);
+				Assert::IsFalse(result.condition);
+				Assert::AreEqual(2, result.number);
+				CompileBytecode(parser, "END 2", bytecode);
+				result = machine.Run(bytecode);
+				Assert::IsTrue(OP_LOOP_END == result.control);
+				Assert::AreEqual(2, result.number);
+			}
+
+			TEST_METHOD(ShortCircuit)
+			{
+				SystemParameter system_parameter;
+				MacroVariableInterface macro_variable_interface(system_parameter);
+				macro_variable_interface.SetAlarmMode(true);
+				FanucMacroParser parser(macro_variable_interface);
+				MacroVirtualMachine machine(macro_variable_interface);
+				MacroNodeArena arena;
+				double zero(0.0), two(2.0), three(3.0);
+				macro_variable_interface.WriteVariable(1, zero);
+				macro_variable_interface.WriteVariable(2, two);
+				macro_variable_interface.WriteVariable(3, three);
+
+				//略過的右運算元內首次保存的共同子運算式,其後須重新核算
+				std::vector<std::pair<string, double>> blocks{
+					{ "[#1 EQ 1] AND [#2000 EQ 0]", 0.0 },
+					{ "[#1 EQ 0] OR [#2000 EQ 0]", 1.0 },
+					{ "[0.5 AND #2000] OR 6", 6.0 },
+					{ "[#1 EQ 1] AND [[#2*#3]+1 GT 0] OR [[#2*#3]+2 GT 5]", 1.0 } };
+				for (const std::pair<string, double>& block : blocks) {
+					CommandType command_type(parser.ParseBlock(block.first));
+					Assert::AreEqual(CommandType::MACRO_COMMAND, command_type);
+					CompiledMacroBlock compiled(command_type, parser.macro_generator);
+					MacroBytecode bytecode;
+					Assert::IsTrue(bytecode.Compile(compiled));
+					Assert::AreEqual(block.second, machine.Run(bytecode).value);
+					ArenaMacroBlock statement;
+					Assert::IsTrue(arena.Compile(compiled, statement));
+					Assert::AreEqual(block.second, arena.Run(statement, macro_variable_interface).value);
+				}
+				Assert::IsFalse(macro_variable_interface.HasAlarm());
+			}
+		};
+	}
+
+	namespace NodeArena {
+		TEST_CLASS(Arena)
+		{
+		public:
+			TEST_METHOD(MatchesTreeWalker)
+			{
+				SystemParameter system_parameter;
+				MacroVariableInterface macro_variable_interface(system_parameter);
+				FanucMacroParser parser(macro_variable_interface);
+				MacroNodeArena arena;
+				for (unsigned short id = 1; id <= 9; ++id) {
+					double value(id);
+					macro_variable_interface.WriteVariable(id, value);
+				}
+
+				std::vector<string> blocks{
+					"-#[#3-1]+#4-#5*#6/#7",
+					"SIN[#1*30]+COS[60]+TAN[45]+ASIN[0.5]+ACOS[0.5]+ATAN[1]+ATAN[#1,#2]",
+					"SQRT[#9]+ABS[-#2]+ROUND[2.5]+FIX[-2.5]+FUP[-2.5]+LN[#2]+EXP[#1]+POW[#2,#8]",
+					"BIN[37]+BCD[25]+ADP[0.01]",
+					"[[[[SIN[#9-#1]+#2]*#3+#4]*#5+#6]*#7+#8]*#9",
+					"#7 AND #1 OR #2 XOR #3 AND #4 AND #5 XOR #6 OR #7",
+					"[#1 EQ 1] AND [#2 NE 2] OR [#3 GT #4]",
+					"#[#1+9]=#9*2" };
+
+				for (const string& block : blocks) {
+					CommandType command_type(parser.ParseBlock(block));
+					Assert::AreEqual(CommandType::MACRO_COMMAND, command_type);
+					ArenaMacroBlock statement;
+					Assert::IsTrue(arena.Compile(CompiledMacroBlock(command_type, parser.macro_generator), statement));
+					GeneralOperatorHandle handle(parser.macro_generator.GeneralOperators().front());
+					double expected(handle.arithmetic ? handle.arithmetic->Evaluate() : handle.logical->Evaluate());
+					Assert::AreEqual(expected, arena.Run(statement, macro_variable_interface).value);
+				}
+
+				//間接ID於寫入前核算,結果讀取寫入的變數(#1=5時寫入#1)
+				for (const string& block : { "#[#1-4]=7", "#[#1-4]=#1-4" }) {
+					double five(5.0), tree_written(0.0), written(0.0);
+					macro_variable_interface.WriteVariable(1, five);
+					CommandType command_type(parser.ParseBlock(block));
+					ArenaMacroBlock statement;
+					Assert::IsTrue(arena.Compile(CompiledMacroBlock(command_type, parser.macro_generator), statement));
+					double tree_value(parser.macro_generator.GeneralOperators().front().arithmetic->Evaluate());
+					macro_variable_interface.ReadVariable(1, tree_written);
+					macro_variable_interface.WriteVariable(1, five);
+					Assert::AreEqual(tree_value, arena.Run(statement, macro_variable_interface).value);
+					macro_variable_interface.ReadVariable(1, written);
+					Assert::AreEqual(tree_written, written);
+					Assert::AreEqual(written, tree_value);
+				}
+				Assert::IsFalse(macro_variable_interface.HasAlarm());
+
+				//條件式單節
+				Assert::AreEqual(CommandType::MACRO_COMMAND, parser.ParseBlock("WHILE[#1 GT 1] DO 2"));
+				ArenaMacroBlock statement;
+				Assert::IsTrue(arena.Compile(CompiledMacroBlock(CommandType::MACRO_COMMAND, parser.macro_generator), statement));
+				MacroBytecodeResult result(arena.Run(statement, macro_variable_interface));
+				Assert::IsTrue(OP_LOOP == result.control);
+				Assert::IsFalse(result.condition);
+				Assert::AreEqual(2, result.number);
+			}
+
+			TEST_METHOD(CompactStorage)
+			{
+				SystemParameter system_parameter;
+				MacroVariableInterface macro_variable_interface(system_parameter);
+				FanucMacroParser parser(macro_variable_interface);
+				MacroNodeArena arena;
+
+				//索引節點至少比共享指標運算子節點小4倍(不含控制區塊)
+				Assert::IsTrue(sizeof(MacroNode) * 4 <= sizeof(ConstantOperator));
+
+				Assert::AreEqual(CommandType::MACRO_COMMAND, parser.ParseBlock("#1=[1+2]*#3"));
+				ArenaMacroBlock statement;
+				Assert::IsTrue(arena.Compile(CompiledMacroBlock(CommandType::MACRO_COMMAND, parser.macro_generator), statement));
+				//摺疊常數3,變數#3,乘法,變數ID常數1,賦值
+				size_t node_count(5);
+				Assert::AreEqual(node_count, arena.Size());
+				Assert::AreEqual(static_cast<MacroNodeIndex>(node_count - 1), statement.expression);
+
+				//無運算子時不保留任何節點
+				parser.macro_generator.Clear();
+				Assert::IsFalse(arena.Compile(CompiledMacroBlock(CommandType::INVALID_COMMAND, parser.macro_generator), statement));
+				Assert::AreEqual(node_count, arena.Size());
+
+				//整批釋放
+				arena.Clear();
+				size_t empty(0);
+				Assert::AreEqual(empty, arena.Size());
+			}
+		};
+	}
+
+	namespace Batch {
+		TEST_CLASS(BatchEvaluation)
+		{
+		public:
+			TEST_METHOD(MatchesVirtualMachine)
+			{
+				SystemParameter system_parameter;
+				MacroVariableInterface macro_variable_interface(system_parameter);
+				FanucMacroParser parser(macro_variable_interface);
+				double value(4.0);
+				macro_variable_interface.WriteVariable(3, value);
+
+				Assert::AreEqual(CommandType::MACRO_COMMAND, parser.ParseBlock("SIN[#1]*#2+COS[#1]*SQRT[#3]-POW[#1,2]/[#2+1]+ABS[-#1]+#[#2-#2+3]"));
+				MacroBytecode bytecode;
+				Assert::IsTrue(bytecode.Compile(CompiledMacroBlock(CommandType::MACRO_COMMAND, parser.macro_generator)));
+
+				//筆數不為向量寬度及批次筆數的倍數
+				size_t count(MACRO_BATCH_LANES * 2 + 7);
+				std::vector<double> angles(count), scales(count), results(count), scalar_results(count);
+				for (size_t row = 0; row != count; ++row) {
+					angles[row] = static_cast<double>(row) * 0.75 - 90.0;
+					scales[row] = static_cast<double>(row % 17);
+				}
+				std::vector<MacroBatchColumn> columns{ MacroBatchColumn(1, angles.data()), MacroBatchColumn(2, scales.data()) };
+
+				MacroBatchEvaluator evaluator(macro_variable_interface);
+				Assert::IsTrue(evaluator.Evaluate(bytecode, columns, count, results.data()));
+				evaluator.EnableSimd(false);
+				Assert::IsFalse(evaluator.SimdEnabled());
+				Assert::IsTrue(evaluator.Evaluate(bytecode, columns, count, scalar_results.data()));
+
+				//逐筆與虛擬機比對(向量POW與純量可能相差最後數位)
+				MacroVirtualMachine machine(macro_variable_interface);
+				for (size_t row = 0; row != count; ++row) {
+					macro_variable_interface.WriteVariable(1, angles[row]);
+					macro_variable_interface.WriteVariable(2, scales[row]);
+					double expected(machine.Run(bytecode).value);
+					Assert::AreEqual(expected, scalar_results[row]);
+					Assert::AreEqual(expected, results[row], 1e-9);
+				}
+			}
+
+			TEST_METHOD(UniformOperands)
+			{
+				SystemParameter system_parameter;
+				MacroVariableInterface macro_variable_interface(system_parameter);
+				FanucMacroParser parser(macro_variable_interface);
+				MacroBatchEvaluator evaluator(macro_variable_interface);
+				MacroVirtualMachine machine(macro_variable_interface);
+				double value(30.0);
+				macro_variable_interface.WriteVariable(3, value);
+
+				//與輸入欄無關的運算只核算一次,結果仍須填滿每一筆
+				size_t count(MACRO_BATCH_LANES + 3);
+				std::vector<double> inputs(count), results(count);
+				for (size_t row = 0; row != count; ++row) {
+					inputs[row] = static_cast<double>(row) - 5.0; }
+				std::vector<MacroBatchColumn> columns{ MacroBatchColumn(1, inputs.data()) };
+				for (const string& block : { string("[SIN[#3]+POW[#3,2]]*#1-ABS[#3-#1]"), string("[#3 GT 2] AND [#1 LT 0]"), string("COS[#3*2]+#3") }) {
+					Assert::AreEqual(CommandType::MACRO_COMMAND, parser.ParseBlock(block));
+					MacroBytecode bytecode;
+					Assert::IsTrue(bytecode.Compile(CompiledMacroBlock(CommandType::MACRO_COMMAND, parser.macro_generator)));
+					Assert::IsTrue(evaluator.Evaluate(bytecode, columns, count, results.data()));
+					for (size_t row = 0; row != count; ++row) {
+						macro_variable_interface.WriteVariable(1, inputs[row]);
+						Assert::AreEqual(machine.Run(bytecode).value, results[row], 1e-9);
+					}
+				}
+			}
+
+			TEST_METHOD(ShortCircuitAlarms)
+			{
+				SystemParameter system_parameter;
+				MacroVariableInterface macro_variable_interface(system_parameter);
+				FanucMacroParser parser(macro_variable_interface);
+				MacroBatchEvaluator evaluator(macro_variable_interface);
+				MacroVirtualMachine machine(macro_variable_interface);
+				size_t count(MACRO_BATCH_LANES + 3);
+				std::vector<double> inputs(count, 5.0), results(count);
+				std::vector<MacroBatchColumn> columns{ MacroBatchColumn(1, inputs.data()) };
+
+				//右運算元於所有資料列皆被跳過時不發出警報(與虛擬機相同,不拋出例外)
+				for (const string& block : { string("[#1 EQ 0] AND [#2000 GT 0]"), string("[#1 GT 0] OR [#[#1*10000] GT 0]"), string("[#1 EQ 5] OR [[#1 EQ 0] AND [#2000 GT 0]]") }) {
+					Assert::AreEqual(CommandType::MACRO_COMMAND, parser.ParseBlock(block));
+					MacroBytecode bytecode;
+					Assert::IsTrue(bytecode.Compile(CompiledMacroBlock(CommandType::MACRO_COMMAND, parser.macro_generator)));
+					Assert::IsTrue(evaluator.Evaluate(bytecode, columns, count, results.data()));
+					Assert::IsFalse(macro_variable_interface.HasAlarm());
+					for (size_t row = 0; row != count; ++row) {
+						macro_variable_interface.WriteVariable(1, inputs[row]);
+						Assert::AreEqual(machine.Run(bytecode).value, results[row]);
+					}
+				}
+
+				//任一資料列核算右運算元時發出警報
+				macro_variable_interface.SetAlarmMode(true);
+				inputs[MACRO_BATCH_LANES + 1] = 0.0;
+				Assert::AreEqual(CommandType::MACRO_COMMAND, parser.ParseBlock("[#1 EQ 0] AND [#2000 GT 0]"));
+				MacroBytecode bytecode;
+				Assert::IsTrue(bytecode.Compile(CompiledMacroBlock(CommandType::MACRO_COMMAND, parser.macro_generator)));
+				Assert::IsTrue(evaluator.Evaluate(bytecode, columns, count, results.data()));
+				Assert::IsTrue(ALARM_VARIABLE_NOT_EXIST == macro_variable_interface.Alarm().code);
+				Assert::AreEqual(2000, static_cast<int>(macro_variable_interface.Alarm().variable_ID));
+				macro_variable_interface.ClearAlarm();
+				inputs[MACRO_BATCH_LANES + 1] = -1.0;
+				Assert::AreEqual(CommandType::MACRO_COMMAND, parser.ParseBlock("[#1 GT 0] OR [#[#1*-10000] GT 0]"));
+				Assert::IsTrue(bytecode.Compile(CompiledMacroBlock(CommandType::MACRO_COMMAND, parser.macro_generator)));
+				Assert::IsTrue(evaluator.Evaluate(bytecode, columns, count, results.data()));
+				Assert::IsTrue(ALARM_VARIABLE_NOT_EXIST == macro_variable_interface.Alarm().code);
+				Assert::AreEqual(10000, static_cast<int>(macro_variable_interface.Alarm().variable_ID));
+			}
+
+			TEST_METHOD(VectorPower)
+			{
+				SystemParameter system_parameter;
+				MacroVariableInterface macro_variable_interface(system_parameter);
+				FanucMacroParser parser(macro_variable_interface);
+				MacroBatchEvaluator evaluator(macro_variable_interface);
+				Assert::AreEqual(CommandType::MACRO_COMMAND, parser.ParseBlock("POW[#1,#2]"));
+				MacroBytecode bytecode;
+				Assert::IsTrue(bytecode.Compile(CompiledMacroBlock(CommandType::MACRO_COMMAND, parser.macro_generator)));
+
+				//正數底數以向量核心核算,負數底數、0及溢位的四筆逐筆以pow核算
+				size_t count(MACRO_BATCH_LANES);
+				std::vector<double> bases(count), exponents(count), results(count);
+				for (size_t row = 0; row != count; ++row) {
+					bases[row] = row < 128 ? static_cast<double>(row) * 0.37 + 0.01 : static_cast<double>(row % 9) - 4.0;
+					exponents[row] = row < 128 ? static_cast<double>(row % 41) * 0.5 - 10.0 : static_cast<double>(row % 5) - 2.0;
+				}
+				bases[200] = 10.0;
+				exponents[200] = 400.0;
+				std::vector<MacroBatchColumn> columns{ MacroBatchColumn(1, bases.data()), MacroBatchColumn(2, exponents.data()) };
+				Assert::IsTrue(evaluator.Evaluate(bytecode, columns, count, results.data()));
+				for (size_t row = 0; row != count; ++row) {
+					double expected(pow(bases[row], exponents[row]));
+					if (std::isfinite(expected)) {
+						Assert::AreEqual(expected, results[row], fabs(expected) * 1e-14); }
+					else {
+						Assert::IsTrue(expected == results[row] || (expected != expected && results[row] != results[row])); }
+				}
+				//2的整數次方與pow相同
+				bases.assign(count, 2.0);
+				for (size_t row = 0; row != count; ++row) {
+					exponents[row] = static_cast<double>(row % 64); }
+				Assert::IsTrue(evaluator.Evaluate(bytecode, columns, count, results.data()));
+				for (size_t row = 0; row != count; ++row) {
+					Assert::AreEqual(pow(2.0, exponents[row]), results[row]); }
+			}
+
+			TEST_METHOD(RejectsWritesAndControl)
+			{
+				SystemParameter system_parameter;
+				MacroVariableInterface macro_variable_interface(system_parameter);
+				FanucMacroParser parser(macro_variable_interface);
+				MacroBatchEvaluator evaluator(macro_variable_interface);
+				std::vector<MacroBatchColumn> columns;
+				double result(0.0);
+
+				for (const string& block : { string("#1=#2+1"), string("IF[#1 GT 0] GOTO 10") }) {
+					Assert::AreEqual(CommandType::MACRO_COMMAND, parser.ParseBlock(block));
+					MacroBytecode bytecode;
+					Assert::IsTrue(bytecode.Compile(CompiledMacroBlock(CommandType::MACRO_COMMAND, parser.macro_generator)));
+					Assert::IsFalse(evaluator.Evaluate(bytecode, columns, 1, &result));
+				}
+			}
+		};
+	}
+
+	namespace Trigonometry {
+		TEST_CLASS(DegreeKernels)
+		{
+		public:
+			TEST_METHOD(ExactAtSpecialAngles)
+			{
+				//30/45/90度倍數(含負角及超過一圈)返回精確值
+				for (double turn : { -720.0, -360.0, 0.0, 360.0, 3600.0 }) {
+					Assert::AreEqual(0.0, DegreeTrigonometry::Sine(turn + 180.0));
+					Assert::AreEqual(1.0, DegreeTrigonometry::Sine(turn + 90.0));
+					Assert::AreEqual(-0.5, DegreeTrigonometry::Sine(turn + 210.0));
+					Assert::AreEqual(sqrt(3.0) / 2.0, DegreeTrigonometry::Sine(turn - 300.0));
+					Assert::AreEqual(-sqrt(0.5), DegreeTrigonometry::Sine(turn - 45.0));
+					Assert::AreEqual(0.0, DegreeTrigonometry::Cosine(turn + 90.0));
+					Assert::AreEqual(-1.0, DegreeTrigonometry::Cosine(turn + 180.0));
+					Assert::AreEqual(-0.5, DegreeTrigonometry::Cosine(turn + 120.0));
+					Assert::AreEqual(-sqrt(0.5), DegreeTrigonometry::Cosine(turn + 225.0));
+					Assert::AreEqual(-1.0, DegreeTrigonometry::Tangent(turn + 135.0));
+					Assert::AreEqual(sqrt(3.0), DegreeTrigonometry::Tangent(turn + 240.0));
+					Assert::AreEqual(-sqrt(3.0) / 3.0, DegreeTrigonometry::Tangent(turn - 30.0));
+				}
+				Assert::AreEqual(-90.0, DegreeTrigonometry::ArcSine(-1.0));
+				Assert::AreEqual(45.0, DegreeTrigonometry::ArcSine(sqrt(0.5)));
+				Assert::AreEqual(150.0, DegreeTrigonometry::ArcCosine(-sqrt(3.0) / 2.0));
+				Assert::AreEqual(90.0, DegreeTrigonometry::ArcCosine(0.0));
+				Assert::AreEqual(-60.0, DegreeTrigonometry::ArcTangent(-sqrt(3.0)));
+				Assert::AreEqual(-135.0, DegreeTrigonometry::ArcTangent2(-2.0, -2.0));
+				Assert::AreEqual(180.0, DegreeTrigonometry::ArcTangent2(0.0, -3.0));
+				Assert::AreEqual(-90.0, DegreeTrigonometry::ArcTangent2(-1.0, 0.0));
+
+				//一般角度與徑度換算僅相差捨入誤差
+				for (double angle = -1000.0; angle < 1000.0; angle += 7.3) {
+					Assert::AreEqual(sin(ConvertAngleToRadians(angle)), DegreeTrigonometry::Sine(angle), 1e-13);
+					Assert::AreEqual(cos(ConvertAngleToRadians(angle)), DegreeTrigonometry::Cosine(angle), 1e-13);
+				}
+			}
+
+			TEST_METHOD(LargeAngles)
+			{
+				//大角度先以一圈化簡,不因degree / 90失去整數精度
+				Assert::AreEqual(sin(ConvertAngleToRadians(280.0)), DegreeTrigonometry::Sine(1e17), 1e-13);
+				Assert::AreEqual(sin(ConvertAngleToRadians(280.0)), DegreeTrigonometry::Sine(1e20), 1e-13);
+				Assert::AreEqual(cos(ConvertAngleToRadians(280.0)), DegreeTrigonometry::Cosine(1e20), 1e-13);
+				Assert::AreEqual(sin(ConvertAngleToRadians(-280.0)), DegreeTrigonometry::Sine(-1e20), 1e-13);
+				Assert::AreEqual(tan(ConvertAngleToRadians(136.0)), DegreeTrigonometry::Tangent(std::ldexp(1.0, 60)), 1e-13);
+				Assert::AreEqual(0.0, DegreeTrigonometry::Sine(1e17 + 80.0));
+				Assert::AreEqual(1.0, DegreeTrigonometry::Cosine(1e17 + 80.0));
+				Assert::IsTrue(std::isnan(DegreeTrigonometry::Sine(std::numeric_limits<double>::infinity())));
+			}
+
+			TEST_METHOD(TangentPoles)
+			{
+				//90+360n度為+無限大,270+360n度(含-90度)為-無限大
+				const double infinity(std::numeric_limits<double>::infinity());
+				for (double turn : { -720.0, -360.0, 0.0, 360.0, 3600.0 }) {
+					Assert::AreEqual(infinity, DegreeTrigonometry::Tangent(turn + 90.0));
+					Assert::AreEqual(-infinity, DegreeTrigonometry::Tangent(turn - 90.0));
+					Assert::AreEqual(-infinity, DegreeTrigonometry::Tangent(turn + 270.0));
+				}
+			}
+
+			TEST_METHOD(VectorMatchesScalar)
+			{
+				//筆數不為向量寬度的倍數,含超過一圈的大角度及正切的極點
+				std::vector<double> angles;
+				for (double angle = -765.0; angle <= 765.0; angle += 2.5) {
+					angles.push_back(angle); }
+				for (double angle : { 1e17, -1e20, 90.0, -90.0, 270.0, 450.0 }) {
+					angles.push_back(angle); }
+				angles.push_back(angles.back() + 0.1);
+
+				std::vector<double> sines(angles), cosines(angles), tangents(angles);
+				DegreeTrigonometry::Sine(sines.data(), sines.size(), true);
+				DegreeTrigonometry::Cosine(cosines.data(), cosines.size(), true);
+				DegreeTrigonometry::Tangent(tangents.data(), tangents.size(), true);
+				//向量核心與純量核心逐位元相同
+				for (size_t index = 0; index != angles.size(); ++index) {
+					Assert::AreEqual(DegreeTrigonometry::Sine(angles[index]), sines[index]);
+					Assert::AreEqual(DegreeTrigonometry::Cosine(angles[index]), cosines[index]);
+					Assert::AreEqual(DegreeTrigonometry::Tangent(angles[index]), tangents[index]);
+				}
+			}
+		};
+	}
+
+	namespace Alarm {
+		TEST_CLASS(AlarmMode)
+		{
+		public:
+			TEST_METHOD(RecordsInsteadOfThrowing)
+			{
+				SystemParameter system_parameter;
+				MacroVariableInterface macro_variable_interface(system_parameter);
+				macro_variable_interface.SetAlarmMode(true);
+				Assert::IsTrue(macro_variable_interface.AlarmMode());
+
+				//讀取不存在的變數:記錄警報、變數ID及發生的運算子,並返回空值
+				GeneralOperatorHandle handle(AssertMacroExpression(macro_variable_interface, "#1=#2000+1"));
+				handle.arithmetic->Evaluate();
+				const MacroAlarm& alarm(macro_variable_interface.Alarm());
+				Assert::IsTrue(ALARM_VARIABLE_NOT_EXIST == alarm.code);
+				Assert::AreEqual(2000, static_cast<int>(alarm.variable_ID));
+				Assert::IsTrue(VARIABLE == static_cast<const ArithmeticOperator*>(alarm.node)->GetOperatorID());
+				//警報後不寫入變數
+				double value(0.0);
+				Assert::IsTrue(macro_variable_interface.ReadVariable(1, value));
+				Assert::AreEqual(NULL_VARIABLE, value);
+
+				//寫入#0
+				macro_variable_interface.ClearAlarm();
+				Assert::IsFalse(macro_variable_interface.HasAlarm());
+				AssertMacroExpression(macro_variable_interface, "#0=1").arithmetic->Evaluate();
+				Assert::IsTrue(ALARM_READ_ONLY_VARIABLE == alarm.code);
+				//變數表及呼叫引數寫入#0時返回false,不拋出例外
+				value = 1.0;
+				Variable variable(0, 9);
+				Assert::IsFalse(variable.WriteVariable(0, value));
+				LocalVariableFrame frame;
+				Assert::IsFalse(frame.WriteVariable(0, value));
+				std::map<unsigned short, double> arguments{ { 0, 1.0 } };
+				Assert::IsFalse(macro_variable_interface.EnterLevel(arguments));
+				Assert::IsFalse(macro_variable_interface.CreateModalLevel(arguments));
+
+				//停用警報模式時維持拋出例外
+				macro_variable_interface.ClearAlarm();
+				macro_variable_interface.SetAlarmMode(false);
+				handle = AssertMacroExpression(macro_variable_interface, "#2000");
+				Assert::ExpectException<std::out_of_range>([&handle]() { handle.arithmetic->Evaluate(); });
+				Assert::IsFalse(macro_variable_interface.HasAlarm());
+			}
+
+			TEST_METHOD(CompiledEvaluators)
+			{
+				SystemParameter system_parameter;
+				MacroVariableInterface macro_variable_interface(system_parameter);
+				macro_variable_interface.SetAlarmMode(true);
+				FanucMacroParser parser(macro_variable_interface);
+				Assert::AreEqual(CommandType::MACRO_COMMAND, parser.ParseBlock("#[#1+5]=#2000"));
+				CompiledMacroBlock compiled(CommandType::MACRO_COMMAND, parser.macro_generator);
+				const MacroAlarm& alarm(macro_variable_interface.Alarm());
+
+				//虛擬機記錄發生警報的指令
+				MacroBytecode bytecode;
+				Assert::IsTrue(bytecode.Compile(compiled));
+				MacroVirtualMachine machine(macro_variable_interface);
+				machine.Run(bytecode);
+				Assert::IsTrue(ALARM_VARIABLE_NOT_EXIST == alarm.code);
+				Assert::AreEqual(2000, static_cast<int>(alarm.variable_ID));
+				const MacroInstruction* instruction(static_cast<const MacroInstruction*>(alarm.node));
+				Assert::IsTrue(instruction >= bytecode.Code().data() && instruction < bytecode.Code().data() + bytecode.Code().size());
+				Assert::IsTrue(OP_LOAD_VARIABLE == instruction->opcode);
+
+				//節點陣列記錄發生警報的節點
+				macro_variable_interface.ClearAlarm();
+				MacroNodeArena arena;
+				ArenaMacroBlock statement;
+				Assert::IsTrue(arena.Compile(compiled, statement));
+				arena.Run(statement, macro_variable_interface);
+				const MacroNode* node(static_cast<const MacroNode*>(alarm.node));
+				Assert::IsTrue(ALARM_VARIABLE_NOT_EXIST == alarm.code);
+				Assert::IsTrue(node >= &arena.Node(0) && node < &arena.Node(0) + arena.Size());
+				Assert::IsTrue(OP_LOAD_VARIABLE == node->opcode);
+
+				//警報後未寫入變數(#1為空值時目標為#5)
+				double value(0.0);
+				Assert::IsTrue(macro_variable_interface.ReadVariable(5, value));
+				Assert::AreEqual(NULL_VARIABLE, value);
+			}
+
+			TEST_METHOD(OutOfRangeVariableID)
+			{
+				SystemParameter system_parameter;
+				MacroVariableInterface macro_variable_interface(system_parameter);
+				macro_variable_interface.SetAlarmMode(true);
+				FanucMacroParser parser(macro_variable_interface);
+				MacroVirtualMachine machine(macro_variable_interface);
+				MacroNodeArena arena;
+				const MacroAlarm& alarm(macro_variable_interface.Alarm());
+				double one(1.0), value(0.0);
+				macro_variable_interface.WriteVariable(1, one);
+
+				//負值、小數或超過65535的變數ID不存在,不可轉型後讀寫其他變數(#65537不為#1)
+				Assert::IsTrue(SLOT_NOT_EXIST == macro_variable_interface.ResolveVariable(VariableID(65537.0)).type);
+				Assert::AreEqual(static_cast<unsigned short>(0), VariableID(NULL_VARIABLE));
+				for (const string& block : { "#2=#65537", "#2=#[65536+1]", "#2=#[-1]", "#2=#[#1-2]", "#2=#[#1+0.5]", "#2=#[#1*100000]", "#[65536+1]=2", "#[#1-65536]=2" }) {
+					Assert::AreEqual(CommandType::MACRO_COMMAND, parser.ParseBlock(block));
+					CompiledMacroBlock compiled(CommandType::MACRO_COMMAND, parser.macro_generator);
+					MacroBytecode bytecode;
+					Assert::IsTrue(bytecode.Compile(compiled));
+					ArenaMacroBlock statement;
+					Assert::IsTrue(arena.Compile(compiled, statement));
+
+					compiled.general_operators.front().arithmetic->Evaluate();
+					Assert::IsTrue(ALARM_VARIABLE_NOT_EXIST == alarm.code);
+					macro_variable_interface.ClearAlarm();
+					machine.Run(bytecode);
+					Assert::IsTrue(ALARM_VARIABLE_NOT_EXIST == alarm.code);
+					macro_variable_interface.ClearAlarm();
+					arena.Run(statement, macro_variable_interface);
+					Assert::IsTrue(ALARM_VARIABLE_NOT_EXIST == alarm.code);
+					macro_variable_interface.ClearAlarm();
+
+					Assert::IsTrue(macro_variable_interface.ReadVariable(1, value));
+					Assert::AreEqual(1.0, value);
+					Assert::IsTrue(macro_variable_interface.ReadVariable(2, value));
+					Assert::AreEqual(NULL_VARIABLE, value);
+				}
+			}
+		};
+	}
+
+	namespace Jit {
+		TEST_CLASS(NativeCode)
+		{
+		public:
+			TEST_METHOD(MatchesTreeWalker)
+			{
+				if (!MacroNativeCode::Supported()) {
+					return; }
+				SystemParameter system_parameter;
+				MacroVariableInterface macro_variable_interface(system_parameter);
+				macro_variable_interface.SetAlarmMode(true);
+				FanucMacroParser parser(macro_variable_interface);
+				for (unsigned short id = 1; id <= 9; ++id) {
+					double value(id);
+					macro_variable_interface.WriteVariable(id, value);
+				}
+				double common(0.25);
+				macro_variable_interface.WriteVariable(100, common);
+
+				std::vector<string> blocks{
+					"-#[#3-1]+#4-#5*#6/#7",
+					"#100*#1+#100/#2-#100",
+					"SIN[#1*30]+COS[60]+TAN[45]",
+					"ASIN[0.5]+ACOS[0.5]+ATAN[1]+ATAN[#1,#2]",
+					"SQRT[#9]+ABS[-#2]+ROUND[2.5]+FIX[-2.5]+FUP[-2.5]+FIX[2.5]+FUP[2.5]",
+					"LN[#2]+EXP[#1]+POW[#2,#8]",
+					"BIN[37]+BCD[25]+ADP[0.01]",
+					"[[[[SIN[#9-#1]+#2]*#3+#4]*#5+#6]*#7+#8]*#9",
+					"#1 EQ #1",
+					"#1 NE #1",
+					"#2 GT #1",
+					"#2 GE #3",
+					"#2 LT #1",
+					"#2 LE #2",
+					"#7 AND #1 OR #2 XOR #3 AND #4 AND #5 XOR #6 OR #7",
+					"[#1 EQ 1] AND [#2 EQ 2]",
+					"[#1 EQ 2] AND [[#2*#3]+1 GT 0] OR [[#2*#3]+2 GT 5]",
+					"#10=[#1 OR #2] AND #3",
+					"#[#1+9]=#9*2" };
+
+				//原生程式碼與運算子樹的結果位元相同
+				MacroNativeCode native_code;
+				std::vector<double> stack, temporaries;
+				for (const string& block : blocks) {
+					MacroBytecode bytecode;
+					Bytecode::CompileBytecode(parser, block, bytecode);
+					GeneralOperatorHandle handle(parser.macro_generator.GeneralOperators().front());
+					double expected(handle.arithmetic ? handle.arithmetic->Evaluate() :
+						handle.relational ? handle.relational->Evaluate() : handle.logical->Evaluate());
+					Assert::IsTrue(native_code.Compile(bytecode, macro_variable_interface));
+					Assert::IsTrue(native_code.CodeSize() > 0);
+					stack.resize(native_code.StackDepth());
+					temporaries.resize(native_code.TemporaryCount());
+					MacroBytecodeResult result(native_code.Run(macro_variable_interface, stack.data(), temporaries.data()));
+					Assert::IsTrue(result.condition);
+					Assert::AreEqual(std::bit_cast<unsigned long long>(expected), std::bit_cast<unsigned long long>(result.value));
+				}
+				Assert::IsFalse(macro_variable_interface.HasAlarm());
+				double assigned(0.0), expected(18.0);
+				macro_variable_interface.ReadVariable(10, assigned);
+				Assert::AreEqual(expected, assigned);
+
+				//間接ID於寫入前核算,結果讀取寫入的變數(#1=5時寫入#1)
+				for (const string& block : { "#[#1-4]=7", "#[#1-4]=#1-4" }) {
+					double five(5.0), tree_written(0.0), written(0.0);
+					macro_variable_interface.WriteVariable(1, five);
+					MacroBytecode bytecode;
+					Bytecode::CompileBytecode(parser, block, bytecode);
+					double tree_value(parser.macro_generator.GeneralOperators().front().arithmetic->Evaluate());
+					macro_variable_interface.ReadVariable(1, tree_written);
+					macro_variable_interface.WriteVariable(1, five);
+					Assert::IsTrue(native_code.Compile(bytecode, macro_variable_interface));
+					stack.resize(native_code.StackDepth());
+					temporaries.resize(native_code.TemporaryCount());
+					Assert::AreEqual(tree_value, native_code.Run(macro_variable_interface, stack.data(), temporaries.data()).value);
+					macro_variable_interface.ReadVariable(1, written);
+					Assert::AreEqual(tree_written, written);
+					Assert::AreEqual(written, tree_value);
+				}
+				Assert::IsFalse(macro_variable_interface.HasAlarm());
+
+				//原生程式碼記錄警報並停止核算
+				MacroBytecode bytecode;
+				Bytecode::CompileBytecode(parser, "#11=#2000+1", bytecode);
+				Assert::IsTrue(native_code.Compile(bytecode, macro_variable_interface));
+				stack.resize(native_code.StackDepth());
+				temporaries.resize(native_code.TemporaryCount());
+				native_code.Run(macro_variable_interface, stack.data(), temporaries.data());
+				Assert::IsTrue(ALARM_VARIABLE_NOT_EXIST == macro_variable_interface.Alarm().code);
+				Assert::AreEqual(2000, static_cast<int>(macro_variable_interface.Alarm().variable_ID));
+				double value(0.0);
+				Assert::IsTrue(macro_variable_interface.ReadVariable(11, value));
+				Assert::AreEqual(NULL_VARIABLE, value);
+			}
+
+			TEST_METHOD(ExecutionThreshold)
+			{
+				SystemParameter system_parameter;
+				MacroVariableInterface macro_variable_interface(system_parameter);
+				macro_variable_interface.SetAlarmMode(true);
+				FanucMacroParser parser(macro_variable_interface);
+				MacroBytecode bytecode;
+				Bytecode::CompileBytecode(parser, "#1=#1+SIN[#1]*0.5", bytecode);
+				MacroVirtualMachine machine(macro_variable_interface);
+				MacroJitEvaluator evaluator(macro_variable_interface, 4);
+				MacroJitBlock block;
+				double zero(0.0);
+
+				//執行次數達門檻前由虛擬機執行,其後執行原生程式碼,結果序列與虛擬機相同
+				std::vector<double> expected;
+				macro_variable_interface.WriteVariable(1, zero);
+				for (int i = 0; i < 10; ++i) {
+					expected.push_back(machine.Run(bytecode).value); }
+				macro_variable_interface.WriteVariable(1, zero);
+				for (int i = 0; i < 10; ++i) {
+					Assert::AreEqual(i >= 4 && MacroNativeCode::Supported(), block.Compiled());
+					MacroBytecodeResult result(evaluator.Run(bytecode, block));
+					Assert::IsTrue(result.condition);
+					Assert::AreEqual(std::bit_cast<unsigned long long>(expected[i]), std::bit_cast<unsigned long long>(result.value));
+				}
+				Assert::AreEqual(10u, block.Executions());
+
+				//重新編譯位元組碼後清除原生程式碼
+				block.Reset();
+				Assert::IsFalse(block.Compiled());
+				Assert::AreEqual(0u, block.Executions());
+
+				//停用警報模式時仍執行原生程式碼,警報轉為對應的例外
+				macro_variable_interface.SetAlarmMode(false);
+				for (int i = 0; i < 10; ++i) {
+					evaluator.Run(bytecode, block); }
+				Assert::AreEqual(MacroNativeCode::Supported(), block.Compiled());
+				Assert::IsFalse(macro_variable_interface.AlarmMode() && MACRO_EXCEPTIONS);
+#if MACRO_EXCEPTIONS
+				MacroBytecode missing;
+				Bytecode::CompileBytecode(parser, "#2=#2000+1", missing);
+				MacroJitBlock missing_block;
+				for (int i = 0; i < 10; ++i) {
+					Assert::ExpectException<std::out_of_range>([&]() { evaluator.Run(missing, missing_block); }); }
+				Assert::AreEqual(MacroNativeCode::Supported(), missing_block.Compiled());
+				Assert::IsFalse(macro_variable_interface.AlarmMode());
+				Assert::IsFalse(macro_variable_interface.HasAlarm());
+#endif
+			}
+		};
+	}
+
+	namespace Transpiler {
+		//轉譯測試程式(TranspiledBoltCircle.h由此程式以MacroTranspiler::Transpile產生)
+		static const char* bolt_circle_program(
+			"O9010 (BOLT CIRCLE)\n"
+			"#100=#1*0.5\n"
+			"#101=360/#2\n"
+			"N10 #102=#100*COS[#101*#3+#4]\n"
+			"#103=#100*SIN[#101*#3+#4]\n"
+			"IF[#3 GE #2] GOTO 20\n"
+			"G01 X#102 Y#103\n"
+			"#104=ATAN[#103,#102]+SQRT[#102*#102+#103*#103]+ABS[-#104]\n"
+			"#105=ROUND[#104]+FIX[-#104]+FUP[#104]+BIN[37]+BCD[25]+ADP[12]\n"
+			"#106=[#3 EQ 1] AND [[#1*#2]+1 GT 0] OR [[#1*#2]+2 GT 5]\n"
+			"IF[#1 GT 0] THEN #107=LN[#1]+EXP[1]+POW[#1,2]-TAN[#4]+ASIN[0.5]+ACOS[0.5]\n"
+			"WHILE[#3 LT #2] DO 1\n"
+			"#3=#3+1\n"
+			"END 1\n"
+			"#[#3+500]=[#3 XOR 3] OR [#2 AND 6]\n"
+			"#108=#2000\n"
+			"N20 M99\n");
+
+		TEST_CLASS(CppSource)
+		{
+		public:
+			TEST_METHOD(GeneratedSource)
+			{
+				SystemParameter system_parameter;
+				MacroVariableInterface macro_variable_interface(system_parameter);
+				FanucMacroParser parser(macro_variable_interface);
+				MacroProgram program;
+				Assert::IsTrue(program.Compile(bolt_circle_program, parser));
+
+				//各巨集單節產生一個函式,NC單節於單節表中為nullptr
+				string source;
+				Assert::IsTrue(MacroTranspiler::Transpile(program, "TranspiledBoltCircle", source));
+				Assert::IsTrue(source.find("namespace TranspiledBoltCircle {") != string::npos);
+				Assert::IsTrue(source.find("inline const int program_number = 9010;") != string::npos);
+				Assert::IsTrue(source.find("inline MacroBytecodeResult Block4(") != string::npos);
+				Assert::IsTrue(source.find("inline MacroBytecodeResult Block5(") == string::npos);
+				Assert::IsTrue(source.find("MacroTranspiledBlock(-1, nullptr)") != string::npos);
+				Assert::IsTrue(source.find("inline const size_t block_count = 16;") != string::npos);
+				//常數以十六進位浮點數保留全部位元
+				Assert::IsTrue(source.find("0x1.5bf0a8b145769p+1") != string::npos);
+				//名稱須為合法識別字
+				Assert::IsFalse(MacroTranspiler::Transpile(program, "9010", source));
+				Assert::IsFalse(MacroTranspiler::Transpile(program, "bolt circle", source));
+			}
+
+			TEST_METHOD(MatchesInterpreter)
+			{
+				SystemParameter system_parameter;
+				MacroVariableInterface interpreted(system_parameter), transpiled(system_parameter);
+				interpreted.SetAlarmMode(true);
+				transpiled.SetAlarmMode(true);
+				FanucMacroParser parser(interpreted);
+				MacroProgram program;
+				Assert::IsTrue(program.Compile(bolt_circle_program, parser));
+				Assert::AreEqual(program.ProgramNumber(), TranspiledBoltCircle::program_number);
+
+				std::vector<unsigned short> variables;
+				for (unsigned short id = 1; id <= 33; ++id) {
+					variables.push_back(id); }
+				for (unsigned short id = 100; id <= 110; ++id) {
+					variables.push_back(id); }
+				for (unsigned short id = 500; id <= 510; ++id) {
+					variables.push_back(id); }
+
+				//以多組相同輸入逐單節比對(最後一個巨集單節發出警報)
+				for (double radius : {10.0, 0.0, -3.5}) {
+					for (double count : {6.0, 1.0}) {
+						std::vector<double> inputs{ radius, count, 0.0, 15.0 };
+						for (unsigned short id = 1; id <= 4; ++id) {
+							interpreted.WriteVariable(id, inputs[id - 1]);
+							transpiled.WriteVariable(id, inputs[id - 1]);
+						}
+						Assert::AreEqual(NO_PROGRAM_BLOCK, MacroTranspiler::Validate(program, TranspiledBoltCircle::blocks, TranspiledBoltCircle::block_count,
+							interpreted, transpiled, variables));
+						Assert::IsTrue(ALARM_VARIABLE_NOT_EXIST == transpiled.Alarm().code);
+						interpreted.ClearAlarm();
+						transpiled.ClearAlarm();
+					}
+				}
+
+				//單節表與程式不一致時返回不符的單節索引
+				std::vector<MacroTranspiledBlock> shifted(TranspiledBoltCircle::blocks, TranspiledBoltCircle::blocks + TranspiledBoltCircle::block_count);
+				shifted[1].function = shifted[0].function;
+				size_t mismatch(1);
+				Assert::AreEqual(mismatch, MacroTranspiler::Validate(program, shifted.data(), shifted.size(), interpreted, transpiled, variables));
+				size_t missing(10);
+				Assert::AreEqual(missing, MacroTranspiler::Validate(program, TranspiledBoltCircle::blocks, missing, interpreted, transpiled, variables));
+			}
+		};
+	}
+
+	namespace Executor {
+		TEST_CLASS(LoopExecution)
+		{
+		public:
+			TEST_METHOD(NestedLoops)
+			{
+				SystemParameter system_parameter;
+				MacroVariableInterface macro_variable_interface(system_parameter);
+				FanucMacroParser parser(macro_variable_interface);
+				MacroProgram program;
+				MacroExecutor executor(macro_variable_interface, system_parameter);
+
+				//100x100格點量測:內層迴圈共執行10000次
+				Assert::IsTrue(program.Compile(
+					"O9100 (GRID)\n"
+					"#100=0\n"
+					"#101=0\n"
+					"#1=0\n"
+					"WHILE[#1 LT 100] DO 1\n"
+					"#2=0\n"
+					"WHILE[#2 LT 100] DO 2\n"
+					"G01 X#1 Y#2\n"
+					"#100=#100+1\n"
+					"#101=#101+#1*#2\n"
+					"#2=#2+1\n"
+					"END 2\n"
+					"#1=#1+1\n"
+					"END 1\n"
+					"M30\n", parser));
+				executor.Load(program);
+				size_t nc_blocks(0);
+				for (size_t index = executor.Step(); index != NO_PROGRAM_BLOCK; index = executor.Step()) {
+					if (program.Blocks()[index].command_type == INVALID_COMMAND) {
+						++nc_blocks; }
+					Assert::IsTrue(executor.LoopDepth() <= 2);
+				}
+				Assert::IsTrue(executor.Finished());
+				Assert::IsFalse(macro_variable_interface.HasAlarm());
+				Assert::AreEqual(static_cast<size_t>(10001), nc_blocks);
+				double count(0.0), sum(0.0);
+				macro_variable_interface.ReadVariable(100, count);
+				macro_variable_interface.ReadVariable(101, sum);
+				Assert::AreEqual(10000.0, count);
+				Assert::AreEqual(4950.0 * 4950.0, sum);
+				Assert::AreEqual(static_cast<size_t>(0), executor.LoopDepth());
+
+				//相同識別號碼的迴圈可依序重複使用,GOTO跳出迴圈時移除迴圈
+				Assert::IsTrue(program.Compile(
+					"O9101\n"
+					"#1=0\n"
+					"WHILE[#1 LT 5] DO 1\n"
+					"#1=#1+1\n"
+					"END 1\n"
+					"WHILE[#1 LT 100] DO 1\n"
+					"WHILE[#1 LT 100] DO 2\n"
+					"IF[#1 EQ 8] GOTO 10\n"
+					"#1=#1+1\n"
+					"END 2\n"
+					"END 1\n"
+					"N10 #2=#1\n"
+					"/#2=0\n", parser));
+				system_parameter.operation_parameter.optional_skip = true;
+				executor.Load(program);
+				Assert::IsTrue(executor.Run());
+				Assert::AreEqual(static_cast<size_t>(0), executor.LoopDepth());
+				double value(0.0);
+				macro_variable_interface.ReadVariable(2, value);
+				Assert::AreEqual(8.0, value);
+			}
+
+			TEST_METHOD(NativeCodeBlocks)
+			{
+				SystemParameter system_parameter;
+				MacroVariableInterface macro_variable_interface(system_parameter);
+				FanucMacroParser parser(macro_variable_interface);
+				MacroProgram program;
+				MacroExecutor executor(macro_variable_interface, system_parameter);
+
+				//迴圈內單節執行次數達門檻後以原生程式碼執行,只執行一次的單節不編譯
+				Assert::IsTrue(program.Compile(
+					"O9110\n"
+					"#100=0\n"
+					"#1=0\n"
+					"WHILE[#1 LT 200] DO 1\n"
+					"#100=#100+#1*0.5\n"
+					"#1=#1+1\n"
+					"END 1\n"
+					"#101=#100\n", parser));
+				executor.Load(program);
+				Assert::IsTrue(executor.Run());
+				const std::vector<MacroProgramBlock>& blocks(program.Blocks());
+				Assert::IsFalse(blocks[0].jit.Compiled());
+				Assert::AreEqual(MacroNativeCode::Supported(), blocks[3].jit.Compiled());
+				Assert::AreEqual(200u, blocks[3].jit.Executions());
+				Assert::IsFalse(blocks[6].jit.Compiled());
+				double sum(0.0);
+				macro_variable_interface.ReadVariable(101, sum);
+				Assert::AreEqual(9950.0, sum);
+
+				//重新編譯程式後重新計數
+				Assert::IsTrue(program.Compile("O9111\n#1=0\nWHILE[#1 LT 200] DO 1\n#1=#1+1\nEND 1\n", parser));
+				Assert::IsFalse(program.Blocks()[2].jit.Compiled());
+				Assert::AreEqual(0u, program.Blocks()[2].jit.Executions());
+
+				//原生程式碼發出的警報與虛擬機相同(#1到達100時讀取#2000)
+				macro_variable_interface.SetAlarmMode(true);
+				Assert::IsTrue(program.Compile("O9112\n#1=0\nWHILE[#1 LT 200] DO 1\n#1=#1+1+#[FIX[#1/100]*1900+100]*0\nEND 1\n", parser));
+				executor.Load(program);
+				Assert::IsFalse(executor.Run());
+				Assert::IsTrue(ALARM_VARIABLE_NOT_EXIST == macro_variable_interface.Alarm().code);
+				Assert::AreEqual(2000, static_cast<int>(macro_variable_interface.Alarm().variable_ID));
+				Assert::AreEqual(MacroNativeCode::Supported(), program.Blocks()[2].jit.Compiled());
+				double counter(0.0);
+				macro_variable_interface.ReadVariable(1, counter);
+				Assert::AreEqual(100.0, counter);
+#if MACRO_EXCEPTIONS
+				//停用警報模式時原生程式碼的警報轉為例外
+				macro_variable_interface.ClearAlarm();
+				macro_variable_interface.SetAlarmMode(false);
+				executor.Load(program);
+				Assert::ExpectException<std::out_of_range>([&executor]() { executor.Run(); });
+				Assert::IsFalse(macro_variable_interface.HasAlarm());
+				macro_variable_interface.ReadVariable(1, counter);
+				Assert::AreEqual(100.0, counter);
+#endif
+			}
+			TEST_METHOD(IterationWatchdog)
+			{
+				SystemParameter system_parameter;
+				MacroVariableInterface macro_variable_interface(system_parameter);
+				macro_variable_interface.SetAlarmMode(true);
+				FanucMacroParser parser(macro_variable_interface);
+				MacroProgram program;
+				MacroExecutor executor(macro_variable_interface, system_parameter);
+				Assert::AreEqual(LOOP_ITERATION_LIMIT, executor.IterationLimit());
+
+				//無條件迴圈於超過監視上限時發出警報
+				Assert::IsTrue(program.Compile("O9102\n#1=0\nDO 1\n#1=#1+1\nEND 1\n", parser));
+				executor.SetIterationLimit(1000);
+				executor.Load(program);
+				Assert::IsFalse(executor.Run());
+				const MacroAlarm& alarm(macro_variable_interface.Alarm());
+				Assert::IsTrue(ALARM_LOOP_WATCHDOG == alarm.code);
+				Assert::IsTrue(&program.Blocks()[3] == alarm.node);
+				double value(0.0);
+				macro_variable_interface.ReadVariable(1, value);
+				Assert::AreEqual(1001.0, value);
+				Assert::AreEqual(1000ull, executor.Loop(0).iterations);
+
+				//跳入迴圈內部執行END
+				macro_variable_interface.ClearAlarm();
+				Assert::IsTrue(program.Compile("O9103\nGOTO 10\nDO 1\nN10 #1=1\nEND 1\n", parser));
+				executor.Load(program);
+				Assert::IsFalse(executor.Run());
+				Assert::IsTrue(ALARM_LOOP_NESTING == alarm.code);
+
+				//分支序號不存在
+				macro_variable_interface.ClearAlarm();
+				Assert::IsTrue(program.Compile("O9104\n#1=30\nGOTO #1\n", parser));
+				executor.Load(program);
+				Assert::IsFalse(executor.Run());
+				Assert::IsTrue(ALARM_SEQUENCE_NOT_EXIST == alarm.code);
+
+				//非1~99999整數的分支序號不搜尋(負值不可跳至無序號單節,超出int範圍不可轉型)
+				for (const char* source : {
+					"O9105\n#1=-1\nGOTO #1\n#2=5\nN10 #3=7\n",
+					"O9106\n#1=10.5\nGOTO #1\n#2=5\nN10 #3=7\n",
+					"O9107\n#1=100000*100000\nGOTO #1\n#2=5\nN10 #3=7\n",
+					"O9108\nGOTO -1\n#2=5\nN10 #3=7\n",
+					"O9109\nGOTO 100000\n#2=5\nN10 #3=7\n" }) {
+					macro_variable_interface.ClearAlarm();
+					Assert::IsTrue(program.Compile(source, parser));
+					executor.Load(program);
+					Assert::IsFalse(executor.Run());
+					Assert::IsTrue(ALARM_SEQUENCE_NOT_EXIST == alarm.code);
+					Assert::IsTrue(&program.Blocks()[program.Blocks().size() - 3] == alarm.node);
+				}
+			}
+		};
+
+		TEST_CLASS(SequenceSearch)
+		{
+		public:
+			TEST_METHOD(CacheParameters)
+			{
+				SystemParameter system_parameter;
+				MacroVariableInterface macro_variable_interface(system_parameter);
+				FanucMacroParser parser(macro_variable_interface);
+				MacroProgram program;
+				//常數及變數序號的向前、向後GOTO
+				Assert::IsTrue(program.Compile(
+					"O9200\n"
+					"#1=0\n"
+					"#2=0\n"
+					"N10 #1=#1+1\n"
+					"IF[#1 GT 50] GOTO 90\n"
+					"#3=20+[#1-FIX[#1/2]*2]*10\n"
+					"GOTO #3\n"
+					"N20 #2=#2+1\n"
+					"GOTO 10\n"
+					"N30 #2=#2+100\n"
+					"GOTO 10\n"
+					"N90 #4=#2\n", parser));
+
+				//停用各快取時結果相同,僅搜尋方式不同
+				for (int flags = 0; flags < 8; ++flags) {
+					system_parameter.sequence_cache_fixed = flags & 1;
+					system_parameter.sequence_cache_variable = flags & 2;
+					system_parameter.sequence_cache_history = flags & 4;
+					MacroExecutor executor(macro_variable_interface, system_parameter);
+					executor.Load(program);
+					Assert::IsTrue(executor.Run());
+					double value(0.0);
+					macro_variable_interface.ReadVariable(4, value);
+					Assert::AreEqual(25.0 + 2500.0, value);
+
+					//常數GOTO共51次,變數GOTO共50次
+					const MacroSequenceStatistics& statistics(executor.SequenceSearch().Statistics());
+					Assert::AreEqual(flags & 1 ? 51ull : 0ull, statistics.fixed_hits);
+					Assert::AreEqual(101ull, statistics.fixed_hits + statistics.history_hits + statistics.variable_hits + statistics.scans);
+					if (flags & 4) {
+						//分支單節重複跳至相同序號時由搜尋記錄命中
+						Assert::IsTrue(statistics.history_hits > 0); }
+					else {
+						Assert::AreEqual(0ull, statistics.history_hits); }
+					if (flags & 2) {
+						//每個序號僅搜尋一次(固定快取停用時含常數序號10及90)
+						Assert::AreEqual(flags & 1 ? 2ull : 4ull, statistics.scans); }
+					else {
+						Assert::AreEqual(0ull, statistics.variable_hits); }
+				}
+			}
+		};
+	}
+
+	namespace Variables {
+		TEST_CLASS(AddressSpace)
+		{
+		public:
+			TEST_METHOD(DispatchTable)
+			{
+				SystemParameter system_parameter;
+				MacroVariableInterface macro_variable_interface(system_parameter);
+				//預設配置:局部#0-#33,共同#100-#199及#500-#999,系統變數
+				Assert::IsTrue(SLOT_LOCAL == macro_variable_interface.ResolveVariable(33).type);
+				Assert::IsTrue(SLOT_NOT_EXIST == macro_variable_interface.ResolveVariable(34).type);
+				Assert::IsTrue(SLOT_COMMON == macro_variable_interface.ResolveVariable(199).type);
+				Assert::IsTrue(SLOT_NOT_EXIST == macro_variable_interface.ResolveVariable(200).type);
+				Assert::IsTrue(SLOT_COMMON == macro_variable_interface.ResolveVariable(999).type);
+				Assert::IsTrue(SLOT_SYSTEM_UNSIGNED_SHORT == macro_variable_interface.ResolveVariable(4201).type);
+				Assert::IsTrue(SLOT_SYSTEM_INT == macro_variable_interface.ResolveVariable(4302).type);
+				Assert::IsTrue(SLOT_SYSTEM_DOUBLE == macro_variable_interface.ResolveVariable(5001).type);
+				Assert::IsTrue(SLOT_NOT_EXIST == macro_variable_interface.ResolveVariable(65535).type);
+				double value(0.0);
+				Assert::IsFalse(macro_variable_interface.ReadVariable(65535, value));
+				Assert::IsFalse(macro_variable_interface.WriteVariable(65535, value));
+
+				//系統變數經分派表讀寫系統參數
+				system_parameter.current_modal_parameter.working_plane = 18;
+				Assert::IsTrue(macro_variable_interface.ReadVariable(4202, value));
+				Assert::AreEqual(18.0, value);
+				value = 19.0;
+				Assert::IsTrue(macro_variable_interface.WriteVariable(4202, value));
+				Assert::AreEqual(static_cast<unsigned short>(19), system_parameter.current_modal_parameter.working_plane);
+
+				//自訂共同變數範圍
+				MacroVariableLayout layout;
+				layout.common_lower = MacroVariableRange(100, 149);
+				layout.common_higher = MacroVariableRange(500, 599);
+				MacroVariableInterface custom(system_parameter, layout);
+				value = 1.5;
+				Assert::IsTrue(custom.WriteVariable(149, value));
+				Assert::IsFalse(custom.WriteVariable(150, value));
+				Assert::IsTrue(custom.WriteVariable(599, value));
+				Assert::IsFalse(custom.WriteVariable(600, value));
+				//未解析的存取位置依變數ID查詢分派表
+				MacroVariableSlot slot;
+				slot.variable_ID = 599;
+				value = 0.0;
+				Assert::IsTrue(custom.ReadVariable(slot, value));
+				Assert::AreEqual(1.5, value);
+				Assert::IsTrue(SLOT_SYSTEM_DOUBLE == custom.ResolveVariable(5001).type);
+			}
+
+			TEST_METHOD(SystemRegistry)
+			{
+				SystemParameter system_parameter;
+				SystemVariable system_variable(system_parameter);
+				//各型別的系統變數皆可查詢
+				Assert::IsTrue(system_variable.InquiryVariableID(4201));
+				Assert::IsTrue(system_variable.InquiryVariableID(4302));
+				Assert::IsTrue(system_variable.InquiryVariableID(5001));
+				Assert::IsFalse(system_variable.InquiryVariableID(5000));
+				Assert::IsFalse(system_variable.InquiryVariableID(999));
+				Assert::IsFalse(system_variable.InquiryVariableID(65535));
+
+				MacroVariableInterface macro_variable_interface(system_parameter);
+				macro_variable_interface.SetAlarmMode(true);
+				//刀具補正#2001起
+				system_parameter.tool_length_offset_table[3] = 123.5;
+				Assert::AreEqual(123.5, AssertMacroExpression(macro_variable_interface, "#2003").arithmetic->Evaluate());
+				AssertMacroExpression(macro_variable_interface, "#2003=99.5").arithmetic->Evaluate();
+				Assert::AreEqual(99.5, system_parameter.tool_length_offset_table[3]);
+				Assert::IsTrue(SLOT_SYSTEM_DOUBLE == macro_variable_interface.ResolveVariable(2000 + TOOL_LENGTH_REGISTER_MAX).type);
+				Assert::IsTrue(SLOT_NOT_EXIST == macro_variable_interface.ResolveVariable(2001 + TOOL_LENGTH_REGISTER_MAX).type);
+				Assert::IsTrue(SLOT_NOT_EXIST == macro_variable_interface.ResolveVariable(2000).type);
+				//補正表為固定容量,最後一個補正號碼的修改經變數可見
+				system_parameter.tool_length_offset_table[TOOL_LENGTH_REGISTER_MAX] = 42.0;
+				Assert::AreEqual(42.0, AssertMacroExpression(macro_variable_interface, "#" + std::to_string(2000 + TOOL_LENGTH_REGISTER_MAX)).arithmetic->Evaluate());
+
+				//G54-G59工作座標系原點#5221起每組間隔20
+				Assert::AreEqual(-700.0, AssertMacroExpression(macro_variable_interface, "#5221").arithmetic->Evaluate());
+				Assert::AreEqual(-500.0, AssertMacroExpression(macro_variable_interface, "#5242").arithmetic->Evaluate());
+				AssertMacroExpression(macro_variable_interface, "#5323=-12.5").arithmetic->Evaluate();
+				Assert::AreEqual(-12.5, system_parameter.working_coordinate_system.SystemPosition(59)->axis_Z);
+
+				//機械座標及工件座標位置為唯讀,讀取成本與共同變數相同
+				system_parameter.machine_coordinate.axis_Y = 42.0;
+				system_parameter.program_coordinate_system.axis_X.SetPosition(7.0);
+				Assert::AreEqual(42.0, AssertMacroExpression(macro_variable_interface, "#5022").arithmetic->Evaluate());
+				Assert::AreEqual(7.0, AssertMacroExpression(macro_variable_interface, "#5041").arithmetic->Evaluate());
+				Assert::IsTrue(SLOT_SYSTEM_READ_ONLY == macro_variable_interface.ResolveVariable(5021).type);
+				Assert::IsFalse(macro_variable_interface.HasAlarm());
+				AssertMacroExpression(macro_variable_interface, "#5021=1").arithmetic->Evaluate();
+				Assert::IsTrue(ALARM_READ_ONLY_VARIABLE == macro_variable_interface.Alarm().code);
+				Assert::AreEqual(5021, static_cast<int>(macro_variable_interface.Alarm().variable_ID));
+				Assert::AreEqual(0.0, system_parameter.machine_coordinate.axis_X);
+			}
+			TEST_METHOD(CallFramePool)
+			{
+				LocalVariable local_variable(5);
+				LocalVariableFramePool& pool(local_variable.FramePool());
+				//框架數為最大總變數層數,level 0已取用一個
+				Assert::AreEqual(static_cast<size_t>(local_variable.TotalLevelMax()), pool.Capacity());
+				Assert::AreEqual(pool.Capacity() - 1, pool.Available());
+
+				//返回後再次呼叫重複使用同一框架,且不保留前次變數值
+				std::map<unsigned short, double> arguments{ { 1, 2.5 } };
+				Assert::IsTrue(local_variable.EnterLevel(arguments));
+				double* frame(local_variable.Address(0));
+				double value(0.0);
+				Assert::IsTrue(local_variable.ReadVariable(1, value));
+				Assert::AreEqual(2.5, value);
+				value = 9.0;
+				Assert::IsTrue(local_variable.WriteVariable(33, value));
+				Assert::IsFalse(local_variable.InquiryVariableID(34));
+				Assert::IsTrue(local_variable.ExitLevel());
+				std::map<unsigned short, double> no_arguments;
+				Assert::IsTrue(local_variable.EnterLevel(no_arguments));
+				Assert::IsTrue(frame == local_variable.Address(0));
+				Assert::IsTrue(local_variable.ReadVariable(33, value));
+				Assert::AreEqual(NULL_VARIABLE, value);
+
+				//框架用盡時無法再進入變數層
+				while (local_variable.EnterLevel(no_arguments)) {}
+				Assert::AreEqual(static_cast<size_t>(local_variable.TotalLevelMax()), local_variable.TotalLevel());
+				Assert::AreEqual(static_cast<size_t>(0), pool.Available());
+				while (local_variable.ExitLevel()) {}
+				Assert::AreEqual(static_cast<size_t>(1), local_variable.CurrentLevel());
+				Assert::AreEqual(pool.Capacity() - 1, pool.Available());
+
+				//模式變數層與局部變數層共用框架池
+				ModalVariableLevel modal_variable_level(pool);
+				std::map<unsigned short, double> modal_arguments{ { 24, 1.25 } };
+				Assert::IsTrue(modal_variable_level.CreateModalLevel(modal_arguments));
+				Assert::AreEqual(pool.Capacity() - 2, pool.Available());
+				Assert::IsTrue(local_variable.EnterModalLevel(modal_variable_level.NextModalVariable()));
+				Assert::IsTrue(modal_variable_level.EnterModalLevel());
+				Assert::IsTrue(local_variable.ReadVariable(24, value));
+				Assert::AreEqual(1.25, value);
+				Assert::IsTrue(modal_variable_level.ExitModalLevel());
+				Assert::IsTrue(local_variable.ExitModalLevel());
+				Assert::IsTrue(local_variable.ReadVariable(24, value));
+				Assert::AreEqual(NULL_VARIABLE, value);
+				Assert::IsTrue(modal_variable_level.DeleteModalLevel());
+				Assert::IsFalse(modal_variable_level.NextModalCall());
+				Assert::AreEqual(pool.Capacity() - 1, pool.Available());
+
+				//引數含#0時不取用框架,重複失敗後仍可進入變數層
+				std::map<unsigned short, double> read_only_arguments{ { 0, 1.0 } };
+				for (size_t count = 0; count != pool.Capacity() + 2; ++count) {
+					Assert::IsFalse(local_variable.EnterLevel(read_only_arguments));
+					Assert::IsFalse(modal_variable_level.CreateModalLevel(read_only_arguments));
+				}
+				Assert::AreEqual(pool.Capacity() - 1, pool.Available());
+				Assert::IsTrue(local_variable.EnterLevel(arguments));
+				Assert::IsTrue(local_variable.ExitLevel());
+			}
+		};
+	}
+	namespace Call {
+		TEST_CLASS(ArgumentSpecification)
+		{
+		public:
+			TEST_METHOD(BindAddressWords)
+			{
+				SystemParameter system_parameter;
+				MacroVariableInterface macro_variable_interface(system_parameter);
+				FanucMacroParser parser(macro_variable_interface);
+				parser.EnableBlockCache(4);
+				double value(10.0);
+				Assert::IsTrue(macro_variable_interface.WriteVariable(1, value));
+
+				//引數指定II的I,J,K依順序分組,與引數指定I混用時以後指定者為準
+				const string block("G65 P9010 L2 A1. B-2. I3. J4. K5. I6. K8. D7.5 X#1 Z[#1*2]");
+				MacroCallArguments arguments;
+				//NC單節不建立巨集運算子,僅保存位址字(快取還原時一併還原)
+				for (int pass = 0; pass != 2; ++pass) {
+					parser.ParseBlock(block);
+					Assert::AreEqual(static_cast<size_t>(13), parser.macro_generator.AddressWords().size());
+					Assert::IsTrue(MacroCallBinder::Bind(parser.macro_generator.AddressWords(), arguments));
+				}
+				Assert::AreEqual(static_cast<size_t>(1), parser.BlockCache().Hits());
+				Assert::AreEqual(9010, arguments.program_number);
+				Assert::AreEqual(2u, arguments.repeat);
+				Assert::AreEqual(1.0, arguments.values[1]);
+				Assert::AreEqual(-2.0, arguments.values[2]);
+				Assert::AreEqual(NULL_VARIABLE, arguments.values[3]);
+				Assert::AreEqual(3.0, arguments.values[4]);
+				Assert::AreEqual(4.0, arguments.values[5]);
+				Assert::AreEqual(5.0, arguments.values[6]);
+				Assert::AreEqual(7.5, arguments.values[7]);
+				Assert::AreEqual(NULL_VARIABLE, arguments.values[8]);
+				Assert::AreEqual(8.0, arguments.values[9]);
+				Assert::AreEqual(10.0, arguments.values[24]);
+				Assert::AreEqual(20.0, arguments.values[26]);
+
+				//引數陣列直接複製至呼叫框架,呼叫及返回不配置記憶體
+				size_t allocations(allocation_count);
+				Assert::IsTrue(macro_variable_interface.EnterLevel(arguments.values));
+				Assert::IsTrue(macro_variable_interface.ReadVariable(1, value));
+				Assert::AreEqual(1.0, value);
+				Assert::IsTrue(macro_variable_interface.ReadVariable(26, value));
+				Assert::AreEqual(20.0, value);
+				Assert::IsTrue(macro_variable_interface.ExitLevel());
+				Assert::AreEqual(allocations, static_cast<size_t>(allocation_count));
+				Assert::IsTrue(macro_variable_interface.CreateModalLevel(arguments.values));
+				Assert::IsTrue(macro_variable_interface.EnterModalLevel());
+				Assert::IsTrue(macro_variable_interface.ReadVariable(9, value));
+				Assert::AreEqual(8.0, value);
+				Assert::IsTrue(macro_variable_interface.ExitModalLevel());
+				Assert::IsTrue(macro_variable_interface.DeleteModalLevel());
+
+				//第10組K為#33,超過10組I,J,K不合法
+				string sets("G65 P1");
+				for (int set = 0; set != ARGUMENT_IJK_SET_MAX; ++set) {
+					sets += " I1. J2. K" + std::to_string(set) + ".";
+				}
+				parser.ParseBlock(sets);
+				Assert::IsTrue(MacroCallBinder::Bind(parser.macro_generator.AddressWords(), arguments));
+				Assert::AreEqual(9.0, arguments.values[33]);
+				parser.ParseBlock(sets + " I1.");
+				Assert::IsFalse(MacroCallBinder::Bind(parser.macro_generator.AddressWords(), arguments));
+				//O不可作為引數,缺少程式號碼
+				parser.ParseBlock("G65 P9010 O1.");
+				Assert::IsFalse(MacroCallBinder::Bind(parser.macro_generator.AddressWords(), arguments));
+				parser.ParseBlock("G65 A1.");
+				Assert::IsFalse(MacroCallBinder::Bind(parser.macro_generator.AddressWords(), arguments));
+			}
+		};
+	}
+	namespace Variables {
+		TEST_CLASS(StateSnapshot)
+		{
+		public:
+			TEST_METHOD(CopyOnWriteFork)
+			{
+				SystemParameter system_parameter;
+				MacroVariableInterface macro_variable_interface(system_parameter);
+				double value(1.0);
+				Assert::IsTrue(macro_variable_interface.WriteVariable(501, value));
+				value = 2.0;
+				Assert::IsTrue(macro_variable_interface.WriteVariable(100, value));
+				value = 3.0;
+				Assert::IsTrue(macro_variable_interface.WriteVariable(1, value));
+				system_parameter.machine_coordinate.axis_Y = 5.0;
+
+				//未寫入的分頁沿用上次快照
+				MacroVariableSnapshot snapshot(macro_variable_interface.Snapshot());
+				Assert::IsTrue(snapshot.Pages()[501 / MACRO_VARIABLE_PAGE_SIZE] == macro_variable_interface.Snapshot().Pages()[501 / MACRO_VARIABLE_PAGE_SIZE]);
+				value = 4.0;
+				Assert::IsTrue(macro_variable_interface.WriteVariable(501, value));
+				MacroVariableSnapshot latest(macro_variable_interface.Snapshot());
+				Assert::IsTrue(snapshot.Pages()[501 / MACRO_VARIABLE_PAGE_SIZE] != latest.Pages()[501 / MACRO_VARIABLE_PAGE_SIZE]);
+				Assert::IsTrue(snapshot.Pages()[100 / MACRO_VARIABLE_PAGE_SIZE] == latest.Pages()[100 / MACRO_VARIABLE_PAGE_SIZE]);
+				Assert::IsTrue(snapshot.ReadVariable(501, value));
+				Assert::AreEqual(1.0, value);
+				Assert::IsFalse(snapshot.ReadVariable(200, value));
+
+				//分岔寫入時僅複製寫入的分頁,不影響快照、其他分岔及實際狀態
+				MacroVariableFork preview(snapshot);
+				MacroVariableFork other(snapshot);
+				MacroVariableInterface& fork(preview.Interface());
+				Assert::IsTrue(fork.Forked());
+				Assert::IsTrue(SLOT_COMMON_PAGE == fork.ResolveVariable(501).type);
+				value = 10.0;
+				Assert::IsTrue(fork.WriteVariable(501, value));
+				Assert::AreEqual(10.0, AssertMacroExpression(fork, "#501").arithmetic->Evaluate());
+				Assert::IsTrue(other.Interface().ReadVariable(501, value));
+				Assert::AreEqual(1.0, value);
+				Assert::IsTrue(macro_variable_interface.ReadVariable(501, value));
+				Assert::AreEqual(4.0, value);
+				Assert::IsTrue(snapshot.ReadVariable(501, value));
+				Assert::AreEqual(1.0, value);
+				MacroVariableSnapshot forked(fork.Snapshot());
+				Assert::IsTrue(forked.Pages()[100 / MACRO_VARIABLE_PAGE_SIZE] == snapshot.Pages()[100 / MACRO_VARIABLE_PAGE_SIZE]);
+				Assert::IsTrue(forked.Pages()[501 / MACRO_VARIABLE_PAGE_SIZE] != snapshot.Pages()[501 / MACRO_VARIABLE_PAGE_SIZE]);
+				//分岔的快照與分岔共享分頁,分岔再次寫入時複製
+				value = 11.0;
+				Assert::IsTrue(fork.WriteVariable(501, value));
+				Assert::IsTrue(forked.ReadVariable(501, value));
+				Assert::AreEqual(10.0, value);
+
+				//局部變數及系統參數為快照時的複本,分岔啟用模擬
+				Assert::IsTrue(fork.ReadVariable(1, value));
+				Assert::AreEqual(3.0, value);
+				Assert::AreEqual(5.0, AssertMacroExpression(fork, "#5022").arithmetic->Evaluate());
+				AssertMacroExpression(fork, "#2003=99.5").arithmetic->Evaluate();
+				Assert::AreEqual(99.5, preview.Parameter().tool_length_offset_table[3]);
+				Assert::AreEqual(200.0, system_parameter.tool_length_offset_table[3]);
+				Assert::IsTrue(preview.Parameter().operation_parameter.simulation_on);
+				Assert::IsFalse(system_parameter.operation_parameter.simulation_on);
+				//程式座標系連結至分岔本身的機械座標系
+				preview.Parameter().program_coordinate_system.axis_X.MovePosition(preview.Parameter().program_coordinate_system.axis_X.GetPosition() + 1.0);
+				Assert::AreEqual(1.0, preview.Parameter().machine_coordinate.axis_X);
+				Assert::AreEqual(0.0, system_parameter.machine_coordinate.axis_X);
+			}
+
+			TEST_METHOD(SharedParameter)
+			{
+				SystemParameter system_parameter;
+				MacroVariableInterface macro_variable_interface(system_parameter);
+				system_parameter.tool_length_offset_table[3] = 150.0;
+				MacroVariableSnapshot snapshot(macro_variable_interface.Snapshot());
+
+				//分岔讀取系統變數時與快照共享系統參數,不複製
+				MacroVariableFork preview(snapshot);
+				MacroVariableInterface& fork(preview.Interface());
+				Assert::IsTrue(SLOT_SYSTEM_FORK == fork.ResolveVariable(2003).type);
+				std::shared_ptr<ArithmeticOperator> offset(AssertMacroExpression(fork, "#2003").arithmetic);
+				Assert::AreEqual(150.0, offset->Evaluate());
+				Assert::IsFalse(fork.ParameterCopied());
+				Assert::IsTrue(&fork.Snapshot().Parameter() == &snapshot.Parameter());
+				//唯讀系統變數發出警報,不複製
+				fork.SetAlarmMode(true);
+				double value(1.0);
+				Assert::IsFalse(fork.WriteVariable(5021, value));
+				Assert::IsTrue(ALARM_READ_ONLY_VARIABLE == fork.Alarm().code);
+				Assert::IsFalse(fork.ParameterCopied());
+				fork.ClearAlarm();
+
+				//首次寫入時複製,先前建立的運算子讀取分岔的複本
+				AssertMacroExpression(fork, "#2003=99.5").arithmetic->Evaluate();
+				Assert::IsTrue(fork.ParameterCopied());
+				Assert::AreEqual(99.5, offset->Evaluate());
+				Assert::AreEqual(150.0, snapshot.Parameter().tool_length_offset_table[3]);
+				Assert::AreEqual(150.0, system_parameter.tool_length_offset_table[3]);
+				Assert::IsTrue(&fork.Snapshot().Parameter() != &snapshot.Parameter());
+				Assert::IsTrue(preview.Parameter().operation_parameter.simulation_on);
+				Assert::IsFalse(snapshot.Parameter().operation_parameter.simulation_on);
+			}
+
+			TEST_METHOD(NestedLevels)
+			{
+				SystemParameter system_parameter;
+				MacroVariableInterface macro_variable_interface(system_parameter);
+				LocalVariableValues arguments;
+				arguments.fill(NULL_VARIABLE);
+				double value(1.0);
+				macro_variable_interface.WriteVariable(1, value);
+				//G66模式層及G65呼叫中建立快照
+				arguments[1] = 2.0;
+				Assert::IsTrue(macro_variable_interface.CreateModalLevel(arguments));
+				Assert::IsTrue(macro_variable_interface.EnterModalLevel());
+				arguments[1] = 3.0;
+				Assert::IsTrue(macro_variable_interface.EnterLevel(arguments));
+				MacroVariableSnapshot snapshot(macro_variable_interface.Snapshot());
+				Assert::IsTrue(snapshot.ReadVariable(1, value));
+				Assert::AreEqual(3.0, value);
+
+				//分岔保留呼叫端的所有變數層,返回後讀取呼叫端的變數
+				MacroVariableFork preview(snapshot);
+				MacroVariableInterface& fork(preview.Interface());
+				Assert::AreEqual(macro_variable_interface.CurrentLevel(), fork.CurrentLevel());
+				Assert::IsTrue(fork.ReadVariable(1, value));
+				Assert::AreEqual(3.0, value);
+				Assert::IsTrue(fork.ExitLevel());
+				Assert::IsTrue(fork.ReadVariable(1, value));
+				Assert::AreEqual(2.0, value);
+				Assert::IsTrue(fork.ExitModalLevel());
+				Assert::IsTrue(fork.ReadVariable(1, value));
+				Assert::AreEqual(1.0, value);
+				//模式層仍存在,可再次進入並刪除
+				Assert::IsTrue(fork.EnterModalLevel());
+				Assert::IsTrue(fork.ReadVariable(1, value));
+				Assert::AreEqual(2.0, value);
+				Assert::IsTrue(fork.ExitModalLevel());
+				Assert::IsTrue(fork.DeleteModalLevel());
+				Assert::IsFalse(fork.ExitLevel());
+
+				//實際狀態不受影響
+				Assert::IsTrue(macro_variable_interface.ReadVariable(1, value));
+				Assert::AreEqual(3.0, value);
+				Assert::IsTrue(macro_variable_interface.ExitLevel());
+				Assert::IsTrue(macro_variable_interface.ExitModalLevel());
+				Assert::IsTrue(macro_variable_interface.DeleteModalLevel());
+			}
+		};
+	}
+	namespace Variables {
+		TEST_CLASS(RetainedVariables)
+		{
+		public:
+			TEST_METHOD(PersistAcrossRestart)
+			{
+				SystemParameter system_parameter;
+				MacroVariableLayout layout;
+				layout.retained_file = (std::filesystem::temp_directory_path() / "macro_retained_variables.bin").string();
+				std::filesystem::remove(layout.retained_file);
+				double value(0.0);
+				{
+					MacroVariableInterface macro_variable_interface(system_parameter, layout);
+					Assert::IsTrue(RETAINED_CREATED == macro_variable_interface.RetainedState());
+					Assert::IsTrue(macro_variable_interface.ReadVariable(500, value));
+					Assert::AreEqual(NULL_VARIABLE, value);
+					//保存變數與一般共同變數相同,以存放位址直接寫入
+					Assert::IsTrue(SLOT_COMMON == macro_variable_interface.ResolveVariable(999).type);
+					AssertMacroExpression(macro_variable_interface, "#500=1.5").arithmetic->Evaluate();
+					AssertMacroExpression(macro_variable_interface, "#999=#500*2").arithmetic->Evaluate();
+					Assert::IsTrue(macro_variable_interface.CheckpointRetained());
+					value = 3.0;
+					Assert::IsTrue(macro_variable_interface.WriteVariable(600, value));
+				}
+				//正常結束時建立檢查點,重新啟動直接使用映射區
+				std::uint64_t sequence(0);
+				{
+					MacroVariableInterface macro_variable_interface(system_parameter, layout);
+					Assert::IsTrue(RETAINED_CONSISTENT == macro_variable_interface.RetainedState());
+					Assert::AreEqual(3.0, AssertMacroExpression(macro_variable_interface, "#999").arithmetic->Evaluate());
+					Assert::IsTrue(macro_variable_interface.ReadVariable(600, value));
+					Assert::AreEqual(3.0, value);
+					Assert::IsTrue(macro_variable_interface.ReadVariable(199, value));
+					Assert::AreEqual(NULL_VARIABLE, value);
+					sequence = macro_variable_interface.RetainedSequence();
+				}
+
+				//目前變數值損毀:還原至最新檢查點
+				{
+					std::fstream file(layout.retained_file, std::ios::in | std::ios::out | std::ios::binary);
+					file.seekp(RETAINED_SECTION_SIZE);
+					file.write("corrupt", 7);
+				}
+				{
+					MacroVariableInterface macro_variable_interface(system_parameter, layout);
+					Assert::IsTrue(RETAINED_RESTORED == macro_variable_interface.RetainedState());
+					Assert::IsTrue(macro_variable_interface.ReadVariable(500, value));
+					Assert::AreEqual(1.5, value);
+					Assert::IsTrue(macro_variable_interface.ReadVariable(600, value));
+					Assert::AreEqual(3.0, value);
+					sequence = macro_variable_interface.RetainedSequence();
+					value = 4.0;
+					Assert::IsTrue(macro_variable_interface.WriteVariable(600, value));
+				}
+				//最新標頭寫入中斷:改用前一份標頭的檢查點
+				{
+					std::fstream file(layout.retained_file, std::ios::in | std::ios::out | std::ios::binary);
+					file.seekp(static_cast<std::streamoff>((sequence + 1) % 2 * RETAINED_HEADER_STRIDE + sizeof(std::uint64_t)));
+					file.write("torn", 4);
+				}
+				{
+					MacroVariableInterface macro_variable_interface(system_parameter, layout);
+					Assert::IsTrue(RETAINED_RESTORED == macro_variable_interface.RetainedState());
+					Assert::IsTrue(macro_variable_interface.ReadVariable(600, value));
+					Assert::AreEqual(3.0, value);
+				}
+				std::filesystem::remove(layout.retained_file);
+			}
+
+			TEST_METHOD(CheckpointInterval)
+			{
+				SystemParameter system_parameter;
+				MacroVariableLayout layout;
+				layout.retained_file = (std::filesystem::temp_directory_path() / "macro_retained_blocks.bin").string();
+				std::string crashed_file((std::filesystem::temp_directory_path() / "macro_retained_crashed.bin").string());
+				std::filesystem::remove(layout.retained_file);
+				//複製執行中的映射檔內容,模擬於此時斷電(不經由解構建立檢查點)
+				auto power_loss = [&]() {
+					std::ifstream source(layout.retained_file, std::ios::binary);
+					std::ofstream target(crashed_file, std::ios::binary | std::ios::trunc);
+					target << source.rdbuf();
+				};
+				MacroVariableLayout crashed_layout(layout);
+				crashed_layout.retained_file = crashed_file;
+				double value(0.0);
+				{
+					MacroVariableInterface macro_variable_interface(system_parameter, layout);
+					FanucMacroParser parser(macro_variable_interface);
+					MacroProgram program;
+					MacroExecutor executor(macro_variable_interface, system_parameter);
+					Assert::IsTrue(program.Compile("O9200\n#100=1\n#500=7\n#1=#500+1\n#501=#1\n", parser));
+					executor.Load(program);
+					//預設間隔:單節間不建立檢查點,程式結束時建立
+					Assert::AreEqual(RETAINED_CHECKPOINT_INTERVAL, executor.CheckpointInterval());
+					std::uint64_t sequence(macro_variable_interface.RetainedSequence());
+					executor.Step();
+					executor.Step();
+					Assert::AreEqual(sequence, macro_variable_interface.RetainedSequence());
+					Assert::IsTrue(macro_variable_interface.RetainedPending());
+					power_loss();
+					{
+						MacroVariableInterface restarted(system_parameter, crashed_layout);
+						Assert::IsTrue(restarted.ReadVariable(500, value));
+						Assert::AreEqual(NULL_VARIABLE, value);
+					}
+					Assert::IsTrue(executor.Run());
+					Assert::AreEqual(++sequence, macro_variable_interface.RetainedSequence());
+					Assert::IsFalse(macro_variable_interface.RetainedPending());
+
+					//間隔1:寫入保存變數的單節結束時建立檢查點,未寫入的單節不建立
+					executor.SetCheckpointInterval(1);
+					executor.Load(program);
+					executor.Step();
+					Assert::AreEqual(sequence, macro_variable_interface.RetainedSequence());
+					executor.Step();
+					Assert::AreEqual(sequence + 1, macro_variable_interface.RetainedSequence());
+					Assert::IsFalse(macro_variable_interface.RetainedPending());
+					executor.Step();
+					Assert::AreEqual(sequence + 1, macro_variable_interface.RetainedSequence());
+					Assert::IsTrue(executor.Run());
+					Assert::AreEqual(sequence + 2, macro_variable_interface.RetainedSequence());
+
+					//間隔2:第二個單節結束時建立檢查點
+					executor.SetCheckpointInterval(2);
+					Assert::IsTrue(program.Compile("O9201\n#500=7\n#1=1\n#1=2\n#1=3\n", parser));
+					executor.Load(program);
+					sequence = macro_variable_interface.RetainedSequence();
+					executor.Step();
+					Assert::AreEqual(sequence, macro_variable_interface.RetainedSequence());
+					executor.Step();
+					Assert::AreEqual(sequence + 1, macro_variable_interface.RetainedSequence());
+					Assert::IsTrue(executor.Run());
+					Assert::AreEqual(sequence + 1, macro_variable_interface.RetainedSequence());
+
+					//執行器以外的寫入於下次提交前斷電時遺失
+					value = 9.0;
+					Assert::IsTrue(macro_variable_interface.WriteVariable(502, value));
+					Assert::IsTrue(macro_variable_interface.RetainedPending());
+					power_loss();
+					{
+						MacroVariableInterface restarted(system_parameter, crashed_layout);
+						Assert::IsTrue(RETAINED_RESTORED == restarted.RetainedState());
+						Assert::IsTrue(restarted.ReadVariable(501, value));
+						Assert::AreEqual(8.0, value);
+						Assert::IsTrue(restarted.ReadVariable(502, value));
+						Assert::AreEqual(NULL_VARIABLE, value);
+					}
+					Assert::IsTrue(macro_variable_interface.CommitRetained());
+					power_loss();
+					{
+						MacroVariableInterface restarted(system_parameter, crashed_layout);
+						Assert::IsTrue(RETAINED_CONSISTENT == restarted.RetainedState());
+						Assert::IsTrue(restarted.ReadVariable(502, value));
+						Assert::AreEqual(9.0, value);
+					}
+
+					//檢查點後映射檔仍開啟,#500照常存取
+					Assert::IsTrue(SLOT_COMMON == macro_variable_interface.ResolveVariable(500).type);
+					Assert::AreEqual(8.0, AssertMacroExpression(macro_variable_interface, "#500+1").arithmetic->Evaluate());
+				}
+				//介面解構時關閉映射檔,重新開啟後存取#500
+				{
+					MacroVariableInterface macro_variable_interface(system_parameter, layout);
+					Assert::IsTrue(RETAINED_CONSISTENT == macro_variable_interface.RetainedState());
+					Assert::IsTrue(macro_variable_interface.ReadVariable(500, value));
+					Assert::AreEqual(7.0, value);
+				}
+				//未開啟映射檔時不記錄保存變數的寫入
+				{
+					MacroVariableInterface macro_variable_interface(system_parameter);
+					Assert::IsTrue(RETAINED_CLOSED == macro_variable_interface.RetainedState());
+					Assert::IsTrue(macro_variable_interface.WriteVariable(500, value));
+					Assert::IsFalse(macro_variable_interface.RetainedPending());
+					Assert::IsTrue(macro_variable_interface.CommitRetained());
+					Assert::IsFalse(macro_variable_interface.CheckpointRetained());
+				}
+				std::filesystem::remove(layout.retained_file);
+				std::filesystem::remove(crashed_file);
+			}
+		};
+	}
 }
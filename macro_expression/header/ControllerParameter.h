@@ -1,6 +1,7 @@
 ﻿#pragma once
 
 #include <float.h>
+#include <array>
 #include "CoordinateSystem.h"
 
 class ModalParameter {
@@ -101,6 +102,8 @@ constexpr unsigned short TOOL_LENGTH_REGISTER_MAX = 81;
 class SystemParameter {
 public:
 	SystemParameter();
+	//複製所有參數(程式座標系重新連結至本身的機械座標系及工作座標系)
+	SystemParameter(const SystemParameter&);
 	~SystemParameter() {}
 	//單節停止無效
 	bool SuppressSingleBlockStop() const {
@@ -137,8 +140,8 @@ public:
 	double peck_drilling_clearance;
 	//啄鑽退刀距離
 	double peck_drilling_retraction;
-	//刀具長度補正表格
-	std::map<unsigned short, double> tool_length_offset_table;
+	//刀具長度補正表格(索引為補正號碼1~TOOL_LENGTH_REGISTER_MAX,索引0不使用;固定容量使#2001起的系統變數位址不失效)
+	std::array<double, TOOL_LENGTH_REGISTER_MAX + 1> tool_length_offset_table;
 	//程式中繼點座標
 	Coordinate intermediate_position;
 	//主要參考原點位置
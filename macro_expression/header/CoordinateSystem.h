@@ -22,9 +22,15 @@ public:
 	//取得軸座標值
 	double GetPosition()const {
 		return position; }
+	//軸座標值存放位址(唯讀)
+	const double* PositionAddress()const {
+		return &position; }
 	//設定軸座標值(直接修改)
 	void SetPosition(double value) {
 		position = value; }
+	//取得同步軸差異值
+	double GetDelta()const {
+		return delta; }
 	//設定同步軸差異值
 	void SetDelta(double d) {
 		delta = d; }
@@ -44,6 +50,8 @@ class WorkingCoordinateSystem {
 	friend class Controller;
 public:
 	WorkingCoordinateSystem();
+	//複製所有座標系原點,並選擇與來源相同的工作座標系
+	WorkingCoordinateSystem(const WorkingCoordinateSystem&);
 	~WorkingCoordinateSystem() {}
 	//取得目前工作座標系原點X軸機械座標值
 	double SystemPositionAxisX()const {
@@ -65,6 +73,10 @@ public:
 	void ShiftByProgramAxisZ(double, double);
 	//以程式座標B軸更新所有工作座標系原點位置
 	void ShiftByProgramAxisB(double, double);
+	//取得工作座標系原點位置(54-59,不合法時返回nullptr)
+	Coordinate* SystemPosition(unsigned short);
+	//目前工作座標系號碼(54-59)
+	unsigned short WorkingSystemID()const;
 
 private:
 	//工作座標系指標
@@ -0,0 +1,28 @@
+﻿#pragma once
+
+#include <cstddef>
+
+//角度制三角函數核心(以角度精確化簡引數,30/45/90度倍數返回精確值)
+class DegreeTrigonometry {
+public:
+	//正弦(角度)
+	static double Sine(double);
+	//餘弦(角度)
+	static double Cosine(double);
+	//正切(角度),90+360n度返回+無限大,270+360n度返回-無限大
+	static double Tangent(double);
+	//反正弦(返回角度)
+	static double ArcSine(double);
+	//反餘弦(返回角度)
+	static double ArcCosine(double);
+	//反正切(返回角度)
+	static double ArcTangent(double);
+	//二引數反正切(y, x,返回角度)
+	static double ArcTangent2(double, double);
+	//就地核算一組角度的正弦,simd為true且支援AVX2時使用向量核心(結果與純量版本逐位元相同)
+	static void Sine(double*, size_t, bool simd);
+	//就地核算一組角度的餘弦
+	static void Cosine(double*, size_t, bool simd);
+	//就地核算一組角度的正切
+	static void Tangent(double*, size_t, bool simd);
+};
@@ -0,0 +1,297 @@
+﻿#pragma once
+
+#include <string_view>
+#include <vector>
+#include <array>
+
+//巨集運算子分類
+enum OperatorType :unsigned char {
+	NOT_AN_OPERATOR,
+	UNARY_OPERATOR,
+	UNARY_BINARY_OPERATOR,
+	BINARY_OPERATOR,
+	PRIORITY_BINARY_OPERATOR,
+	ASSIGNMENT_OPERATOR,
+	UNARY_FUNCTION_OPERATOR,
+	UNARY_BINARY_FUNCTION_OPERATOR,
+	BINARY_FUNCTION_OPERATOR,
+	RELATIONAL_OPERATOR,
+	UNARY_LOGICAL_OPERATOR,
+	BINARY_LOGICAL_OPERATOR,
+	PRIORITY_BINARY_LOGICAL_OPERATOR,
+	IF_CONDITION,
+	WHILE_CONDITION,
+	BRANCH_OPERATOR,
+	CONDITIONAL_ARITHMETIC_OPERATOR,
+	LOOP_OPERATOR,
+	LOOP_END
+};
+
+//巨集運算子關鍵字元
+constexpr unsigned char ADDRESS_MINUS_SUBTRACT_OPERATOR = '-';
+constexpr unsigned char ADDRESS_VARIABLE_OPERATOR = '#';
+constexpr unsigned char ADDRESS_ADD_OPERATOR = '+';
+constexpr unsigned char ADDRESS_MULTIPLY_OPERATOR = '*';
+constexpr unsigned char ADDRESS_DIVIDE_OPERATOR = '/';
+constexpr unsigned char ADDRESS_ASSIGNMENT_OPERATOR = '=';
+//巨集優先運算式關鍵字元
+constexpr unsigned char ADDRESS_PRIORITY_RANGE_BEGIN = '[';
+constexpr unsigned char ADDRESS_PRIORITY_RANGE_END = ']';
+//註解關鍵字元
+constexpr unsigned char ADDRESS_COMMENT_BEGIN = '(';
+constexpr unsigned char ADDRESS_COMMENT_END = ')';
+//巨集函數引數分隔字元
+constexpr unsigned char ADDRESS_ARGUMENT_SEPARATOR = ',';
+
+//巨集三角函數關鍵字
+constexpr auto KEYWORD_SINE_OPERATOR = "SIN";
+constexpr auto KEYWORD_COSINE_OPERATOR = "COS";
+constexpr auto KEYWORD_TANGENT_OPERATOR = "TAN";
+constexpr auto KEYWORD_ARC_SINE_OPERATOR = "ASIN";
+constexpr auto KEYWORD_ARC_COSINE_OPERATOR = "ACOS";
+constexpr auto KEYWORD_ARC_TANGENT_OPERATOR = "ATAN";
+
+//巨集函數關鍵字
+constexpr auto KEYWORD_SQUARE_ROOT_OPERATOR = "SQRT";
+constexpr auto KEYWORD_ABSOLUTE_VALUE_OPERATOR = "ABS";
+constexpr auto KEYWORD_ROUND_OFF_OPERATOR = "ROUND";
+constexpr auto KEYWORD_ROUND_DOWN_OPERATOR = "FIX";
+constexpr auto KEYWORD_ROUND_UP_OPERATOR = "FUP";
+constexpr auto KEYWORD_NATURAL_LOG_OPERATOR = "LN";
+constexpr auto KEYWORD_EXPONENT_OPERATOR = "EXP";
+constexpr auto KEYWORD_POWER_OPERATOR = "POW";
+constexpr auto KEYWORD_BINARY_CODE_OPERATOR = "BIN";
+constexpr auto KEYWORD_BINARY_CODED_DECIMAL_OPERATOR = "BCD";
+constexpr auto KEYWORD_ADD_DECIMAL_POINT_OPERATOR = "ADP";
+
+//巨集關係運算子關鍵字
+constexpr auto KEYWORD_EQUAL_OPERATOR = "EQ";
+constexpr auto KEYWORD_NOT_EQUAL_OPERATOR = "NE";
+constexpr auto KEYWORD_GREATER_OPERATOR = "GT";
+constexpr auto KEYWORD_GREATER_EQUAL_OPERATOR = "GE";
+constexpr auto KEYWORD_LESS_OPERATOR = "LT";
+constexpr auto KEYWORD_LESS_EQUAL_OPERATOR = "LE";
+
+//巨集邏輯運算子關鍵字
+constexpr auto KEYWORD_AND_OPERATOR = "AND";
+constexpr auto KEYWORD_OR_OPERATOR = "OR";
+constexpr auto KEYWORD_XOR_OPERATOR = "XOR";
+
+//巨集條件式運算子關鍵字
+constexpr auto KEYWORD_IF_CONDITION = "IF";
+constexpr auto KEYWORD_CONDITIONAL_ARITHMETIC_OPERATOR = "THEN";
+
+//巨集分支運算子關鍵字
+constexpr auto KEYWORD_BRANCH_OPERATOR = "GOTO";
+
+//巨集迴圈運算子關鍵字
+constexpr auto KEYWORD_WHILE_CONDITION = "WHILE";
+constexpr auto KEYWORD_LOOP_OPERATOR = "DO";
+constexpr auto KEYWORD_LOOP_END = "END";
+
+//巨集關鍵字識別ID
+enum MacroKeywordID :unsigned char {
+	NOT_A_KEYWORD,
+	//函數關鍵字
+	SINE_KEYWORD,
+	COSINE_KEYWORD,
+	TANGENT_KEYWORD,
+	ARC_SINE_KEYWORD,
+	ARC_COSINE_KEYWORD,
+	ARC_TANGENT_KEYWORD,
+	SQUARE_ROOT_KEYWORD,
+	ABSOLUTE_VALUE_KEYWORD,
+	BINARY_CODE_KEYWORD,
+	BINARY_CODED_DECIMAL_KEYWORD,
+	ROUND_OFF_KEYWORD,
+	ROUND_DOWN_KEYWORD,
+	ROUND_UP_KEYWORD,
+	NATURAL_LOG_KEYWORD,
+	EXPONENT_KEYWORD,
+	POWER_KEYWORD,
+	ADD_DECIMAL_POINT_KEYWORD,
+	//關係運算子關鍵字
+	EQUAL_KEYWORD,
+	NOT_EQUAL_KEYWORD,
+	GREATER_KEYWORD,
+	GREATER_EQUAL_KEYWORD,
+	LESS_KEYWORD,
+	LESS_EQUAL_KEYWORD,
+	//邏輯運算子關鍵字
+	AND_KEYWORD,
+	OR_KEYWORD,
+	XOR_KEYWORD,
+	//條件式及敘述關鍵字
+	IF_KEYWORD,
+	THEN_KEYWORD,
+	GOTO_KEYWORD,
+	WHILE_KEYWORD,
+	DO_KEYWORD,
+	END_KEYWORD
+};
+
+//巨集關鍵字表項
+class MacroKeyword {
+public:
+	constexpr MacroKeyword()
+		:text(), type(NOT_AN_OPERATOR), id(NOT_A_KEYWORD) {}
+	constexpr MacroKeyword(std::string_view s, OperatorType t, MacroKeywordID i)
+		:text(s), type(t), id(i) {}
+	//關鍵字字串
+	std::string_view text;
+	//運算子分類
+	OperatorType type;
+	//關鍵字識別ID
+	MacroKeywordID id;
+};
+
+//巨集關鍵字清單
+constexpr MacroKeyword MACRO_KEYWORD_LIST[] = {
+	{ KEYWORD_SINE_OPERATOR, UNARY_FUNCTION_OPERATOR, SINE_KEYWORD },
+	{ KEYWORD_COSINE_OPERATOR, UNARY_FUNCTION_OPERATOR, COSINE_KEYWORD },
+	{ KEYWORD_TANGENT_OPERATOR, UNARY_FUNCTION_OPERATOR, TANGENT_KEYWORD },
+	{ KEYWORD_ARC_SINE_OPERATOR, UNARY_FUNCTION_OPERATOR, ARC_SINE_KEYWORD },
+	{ KEYWORD_ARC_COSINE_OPERATOR, UNARY_FUNCTION_OPERATOR, ARC_COSINE_KEYWORD },
+	{ KEYWORD_ARC_TANGENT_OPERATOR, UNARY_BINARY_FUNCTION_OPERATOR, ARC_TANGENT_KEYWORD },
+	{ KEYWORD_SQUARE_ROOT_OPERATOR, UNARY_FUNCTION_OPERATOR, SQUARE_ROOT_KEYWORD },
+	{ KEYWORD_ABSOLUTE_VALUE_OPERATOR, UNARY_FUNCTION_OPERATOR, ABSOLUTE_VALUE_KEYWORD },
+	{ KEYWORD_BINARY_CODE_OPERATOR, UNARY_FUNCTION_OPERATOR, BINARY_CODE_KEYWORD },
+	{ KEYWORD_BINARY_CODED_DECIMAL_OPERATOR, UNARY_FUNCTION_OPERATOR, BINARY_CODED_DECIMAL_KEYWORD },
+	{ KEYWORD_ROUND_OFF_OPERATOR, UNARY_FUNCTION_OPERATOR, ROUND_OFF_KEYWORD },
+	{ KEYWORD_ROUND_DOWN_OPERATOR, UNARY_FUNCTION_OPERATOR, ROUND_DOWN_KEYWORD },
+	{ KEYWORD_ROUND_UP_OPERATOR, UNARY_FUNCTION_OPERATOR, ROUND_UP_KEYWORD },
+	{ KEYWORD_NATURAL_LOG_OPERATOR, UNARY_FUNCTION_OPERATOR, NATURAL_LOG_KEYWORD },
+	{ KEYWORD_EXPONENT_OPERATOR, UNARY_FUNCTION_OPERATOR, EXPONENT_KEYWORD },
+	{ KEYWORD_POWER_OPERATOR, BINARY_FUNCTION_OPERATOR, POWER_KEYWORD },
+	{ KEYWORD_ADD_DECIMAL_POINT_OPERATOR, UNARY_FUNCTION_OPERATOR, ADD_DECIMAL_POINT_KEYWORD },
+
+	{ KEYWORD_EQUAL_OPERATOR, RELATIONAL_OPERATOR, EQUAL_KEYWORD },
+	{ KEYWORD_NOT_EQUAL_OPERATOR, RELATIONAL_OPERATOR, NOT_EQUAL_KEYWORD },
+	{ KEYWORD_GREATER_OPERATOR, RELATIONAL_OPERATOR, GREATER_KEYWORD },
+	{ KEYWORD_GREATER_EQUAL_OPERATOR, RELATIONAL_OPERATOR, GREATER_EQUAL_KEYWORD },
+	{ KEYWORD_LESS_OPERATOR, RELATIONAL_OPERATOR, LESS_KEYWORD },
+	{ KEYWORD_LESS_EQUAL_OPERATOR, RELATIONAL_OPERATOR, LESS_EQUAL_KEYWORD },
+
+	{ KEYWORD_AND_OPERATOR, PRIORITY_BINARY_LOGICAL_OPERATOR, AND_KEYWORD },
+	{ KEYWORD_OR_OPERATOR, BINARY_LOGICAL_OPERATOR, OR_KEYWORD },
+	{ KEYWORD_XOR_OPERATOR, BINARY_LOGICAL_OPERATOR, XOR_KEYWORD },
+
+	{ KEYWORD_IF_CONDITION, IF_CONDITION, IF_KEYWORD },
+	{ KEYWORD_CONDITIONAL_ARITHMETIC_OPERATOR, CONDITIONAL_ARITHMETIC_OPERATOR, THEN_KEYWORD },
+	{ KEYWORD_BRANCH_OPERATOR, BRANCH_OPERATOR, GOTO_KEYWORD },
+	{ KEYWORD_WHILE_CONDITION, WHILE_CONDITION, WHILE_KEYWORD },
+	{ KEYWORD_LOOP_OPERATOR, LOOP_OPERATOR, DO_KEYWORD },
+	{ KEYWORD_LOOP_END, LOOP_END, END_KEYWORD }
+};
+static_assert(sizeof(MACRO_KEYWORD_LIST) / sizeof(MACRO_KEYWORD_LIST[0]) == END_KEYWORD, "MACRO_KEYWORD_LIST must cover every MacroKeywordID");
+
+//關鍵字完美雜湊表大小(2的次方)
+constexpr size_t KEYWORD_HASH_TABLE_SIZE = 128;
+
+//關鍵字雜湊函數(帶種子的FNV-1a)
+constexpr size_t KeywordHash(std::string_view keyword, unsigned seed) {
+	unsigned hash(seed);
+	for (char ch : keyword) {
+		hash = (hash ^ static_cast<unsigned char>(ch)) * 16777619u; }
+	return (hash ^ (hash >> 15)) & (KEYWORD_HASH_TABLE_SIZE - 1);
+}
+
+//編譯期搜尋使所有關鍵字不碰撞的雜湊種子
+constexpr unsigned FindKeywordHashSeed() {
+	for (unsigned seed = 2166136261u; seed != 2166136261u + 4096u; ++seed) {
+		bool used[KEYWORD_HASH_TABLE_SIZE] = {};
+		bool collision(false);
+		for (const MacroKeyword& keyword : MACRO_KEYWORD_LIST) {
+			size_t slot(KeywordHash(keyword.text, seed));
+			if (used[slot]) {
+				collision = true;
+				break;
+			}
+			used[slot] = true;
+		}
+		if (!collision) {
+			return seed; }
+	}
+	//搜尋範圍內無可用種子
+	return 0;
+}
+
+//關鍵字雜湊種子
+constexpr unsigned KEYWORD_HASH_SEED = FindKeywordHashSeed();
+static_assert(KEYWORD_HASH_SEED != 0, "no collision-free seed for the keyword hash table");
+
+//建立關鍵字完美雜湊表(空位為NOT_A_KEYWORD)
+constexpr std::array<MacroKeyword, KEYWORD_HASH_TABLE_SIZE> BuildKeywordHashTable() {
+	std::array<MacroKeyword, KEYWORD_HASH_TABLE_SIZE> table;
+	for (MacroKeyword& entry : table) {
+		entry = MacroKeyword(); }
+	for (const MacroKeyword& keyword : MACRO_KEYWORD_LIST) {
+		table[KeywordHash(keyword.text, KEYWORD_HASH_SEED)] = keyword; }
+	return table;
+}
+
+//關鍵字完美雜湊表(所有語彙分析器共用的唯讀資料)
+inline constexpr std::array<MacroKeyword, KEYWORD_HASH_TABLE_SIZE> KEYWORD_HASH_TABLE = BuildKeywordHashTable();
+
+//查詢關鍵字(找不到時回傳NOT_A_KEYWORD表項)
+constexpr MacroKeyword FindMacroKeyword(std::string_view keyword) {
+	const MacroKeyword& entry(KEYWORD_HASH_TABLE[KeywordHash(keyword, KEYWORD_HASH_SEED)]);
+	if (entry.text == keyword) {
+		return entry; }
+	else {
+		return MacroKeyword(); }
+}
+
+//語彙單元類型
+enum MacroTokenType :unsigned char {
+	//數字(含小數點)
+	TOKEN_NUMBER,
+	//NC位址字元(單一大寫字母)
+	TOKEN_ADDRESS,
+	//巨集關鍵字(連續大寫字母)
+	TOKEN_KEYWORD,
+	//運算子位址字元
+	TOKEN_OPERATOR,
+	//優先運算範圍開始
+	TOKEN_PRIORITY_BEGIN,
+	//優先運算範圍結束
+	TOKEN_PRIORITY_END,
+	//函數引數分隔字元
+	TOKEN_ARGUMENT_SEPARATOR,
+	//註解
+	TOKEN_COMMENT
+};
+
+//巨集語彙單元
+class MacroToken {
+public:
+	MacroToken(MacroTokenType t, OperatorType k, std::string_view s, MacroKeywordID i = NOT_A_KEYWORD)
+		:type(t), keyword(k), id(i), text(s) {}
+	~MacroToken() {}
+	//語彙單元類型
+	MacroTokenType type;
+	//關鍵字或運算子位址字元分類(其他語彙單元為NOT_AN_OPERATOR)
+	OperatorType keyword;
+	//關鍵字識別ID(非關鍵字為NOT_A_KEYWORD)
+	MacroKeywordID id;
+	//語彙單元字串(直接參照單節字串,不複製)
+	std::string_view text;
+};
+
+//Fanuc巨集語言單節語彙分析器
+class FanucMacroLexer {
+public:
+	FanucMacroLexer() {}
+	~FanucMacroLexer() {}
+	//單次掃描單節字串並切割為語彙單元(單節字串須在語彙單元使用期間保持有效)
+	void Tokenize(std::string_view block);
+	//取得語彙單元串列
+	const std::vector<MacroToken>& Tokens() const {
+		return tokens; }
+	//查詢運算子位址字元分類
+	static OperatorType FindOperator(unsigned char address);
+
+private:
+	//語彙單元串列(重複使用容量)
+	std::vector<MacroToken> tokens;
+};
@@ -1,224 +1,241 @@
 ﻿#pragma once
 
 #include <string>
-#include <queue>
-#include <deque>
-#include <stack>
+#include <string_view>
+#include <vector>
+#include <list>
+#include <unordered_map>
+#include <memory>
+#include <memory_resource>
 #include <cfloat>
+#include <cstdint>
 #include "ControllerParameter.h"
 #include "MacroVariable.h"
 #include "MacroOperator.h"
 #include "NC_NumberDefinition.h"
 #include "StringConverter.h"
+#include "FanucMacroLexer.h"
 
 //不合法整數值
 constexpr int INVALID_NUMBER_VALUE = INT_MAX;
 //不合法浮點數值
 constexpr double INVALID_FLOAT_VALUE = DBL_MAX;
-//巨集暫存容器最大層數
-constexpr size_t PRIORITY_NESTING_LEVEL_MAX = 5;
-
-//巨集運算子分類
-enum OperatorType {
-	NOT_AN_OPERATOR,
-	UNARY_OPERATOR,
-	UNARY_BINARY_OPERATOR,
-	BINARY_OPERATOR,
-	PRIORITY_BINARY_OPERATOR,
-	UNARY_FUNCTION_OPERATOR,
-	UNARY_BINARY_FUNCTION_OPERATOR,
-	BINARY_FUNCTION_OPERATOR,
-	RELATIONAL_OPERATOR,
-	UNARY_LOGICAL_OPERATOR,
-	BINARY_LOGICAL_OPERATOR,
-	PRIORITY_BINARY_LOGICAL_OPERATOR,
-	IF_CONDITION,
-	WHILE_CONDITION,
-	BRANCH_OPERATOR,
-	CONDITIONAL_ARITHMETIC_OPERATOR,
-	LOOP_OPERATOR,
-	LOOP_END
+
+//運算子結合優先順序(數值越大越先結合;邏輯運算子不可與算術或關係運算子於同範圍內混用)
+enum MacroPrecedence :unsigned char {
+	//不參與結合(範圍標記或非二元運算子)
+	PRECEDENCE_NONE,
+	//賦值運算子
+	PRECEDENCE_ASSIGNMENT,
+	//一般邏輯運算子(OR,XOR)
+	PRECEDENCE_LOGICAL,
+	//優先邏輯運算子(AND)
+	PRECEDENCE_PRIORITY_LOGICAL,
+	//關係運算子
+	PRECEDENCE_RELATIONAL,
+	//一般二元算術運算子(+,-)
+	PRECEDENCE_BINARY,
+	//優先二元算術運算子(*,/)
+	PRECEDENCE_PRIORITY_BINARY,
+	//前置一元運算子(#,-,函數)
+	PRECEDENCE_PREFIX
+};
+
+//運算子結合優先順序表(依OperatorType順序排列)
+constexpr MacroPrecedence OPERATOR_PRECEDENCE[] = {
+	//NOT_AN_OPERATOR
+	PRECEDENCE_NONE,
+	//UNARY_OPERATOR
+	PRECEDENCE_PREFIX,
+	//UNARY_BINARY_OPERATOR
+	PRECEDENCE_BINARY,
+	//BINARY_OPERATOR
+	PRECEDENCE_BINARY,
+	//PRIORITY_BINARY_OPERATOR
+	PRECEDENCE_PRIORITY_BINARY,
+	//ASSIGNMENT_OPERATOR
+	PRECEDENCE_ASSIGNMENT,
+	//UNARY_FUNCTION_OPERATOR
+	PRECEDENCE_PREFIX,
+	//UNARY_BINARY_FUNCTION_OPERATOR
+	PRECEDENCE_PREFIX,
+	//BINARY_FUNCTION_OPERATOR
+	PRECEDENCE_PREFIX,
+	//RELATIONAL_OPERATOR
+	PRECEDENCE_RELATIONAL,
+	//UNARY_LOGICAL_OPERATOR
+	PRECEDENCE_PREFIX,
+	//BINARY_LOGICAL_OPERATOR
+	PRECEDENCE_LOGICAL,
+	//PRIORITY_BINARY_LOGICAL_OPERATOR
+	PRECEDENCE_PRIORITY_LOGICAL,
+	//IF_CONDITION
+	PRECEDENCE_NONE,
+	//WHILE_CONDITION
+	PRECEDENCE_NONE,
+	//BRANCH_OPERATOR
+	PRECEDENCE_NONE,
+	//CONDITIONAL_ARITHMETIC_OPERATOR
+	PRECEDENCE_NONE,
+	//LOOP_OPERATOR
+	PRECEDENCE_NONE,
+	//LOOP_END
+	PRECEDENCE_NONE
 };
+static_assert(sizeof(OPERATOR_PRECEDENCE) / sizeof(OPERATOR_PRECEDENCE[0]) == LOOP_END + 1, "OPERATOR_PRECEDENCE must cover every OperatorType");
+
+//查詢運算子結合優先順序
+constexpr MacroPrecedence OperatorPrecedence(OperatorType type) {
+	return OPERATOR_PRECEDENCE[type]; }
 
-//巨集運算子關鍵字元
-constexpr unsigned char ADDRESS_MINUS_SUBTRACT_OPERATOR = '-';
-constexpr unsigned char ADDRESS_VARIABLE_OPERATOR = '#';
-constexpr unsigned char ADDRESS_ADD_OPERATOR = '+';
-constexpr unsigned char ADDRESS_MULTIPLY_OPERATOR = '*';
-constexpr unsigned char ADDRESS_DIVIDE_OPERATOR = '/';
-constexpr unsigned char ADDRESS_ASSIGNMENT_OPERATOR = '=';
-//巨集優先運算式關鍵字元
-constexpr unsigned char ADDRESS_PRIORITY_RANGE_BEGIN = '[';
-constexpr unsigned char ADDRESS_PRIORITY_RANGE_END = ']';
-//註解關鍵字元
-constexpr unsigned char ADDRESS_COMMENT_BEGIN = '(';
-constexpr unsigned char ADDRESS_COMMENT_END = ')';
-//巨集函數引數分隔字元
-constexpr unsigned char ADDRESS_ARGUMENT_SEPARATOR = ',';
-
-//巨集三角函數關鍵字
-constexpr auto KEYWORD_SINE_OPERATOR = "SIN";
-constexpr auto KEYWORD_COSINE_OPERATOR = "COS";
-constexpr auto KEYWORD_TANGENT_OPERATOR = "TAN";
-constexpr auto KEYWORD_ARC_SINE_OPERATOR = "ASIN";
-constexpr auto KEYWORD_ARC_COSINE_OPERATOR = "ACOS";
-constexpr auto KEYWORD_ARC_TANGENT_OPERATOR = "ATAN";
-
-//巨集函數關鍵字
-constexpr auto KEYWORD_SQUARE_ROOT_OPERATOR = "SQRT";
-constexpr auto KEYWORD_ABSOLUTE_VALUE_OPERATOR = "ABS";
-constexpr auto KEYWORD_ROUND_OFF_OPERATOR = "ROUND";
-constexpr auto KEYWORD_ROUND_DOWN_OPERATOR = "FIX";
-constexpr auto KEYWORD_ROUND_UP_OPERATOR = "FUP";
-constexpr auto KEYWORD_NATURAL_LOG_OPERATOR = "LN";
-constexpr auto KEYWORD_EXPONENT_OPERATOR = "EXP";
-constexpr auto KEYWORD_POWER_OPERATOR = "POW";
-constexpr auto KEYWORD_BINARY_CODE_OPERATOR = "BIN";
-constexpr auto KEYWORD_BINARY_CODED_DECIMAL_OPERATOR = "BCD";
-constexpr auto KEYWORD_ADD_DECIMAL_POINT_OPERATOR = "ADP";
-
-//巨集關係運算子關鍵字
-constexpr auto KEYWORD_EQUAL_OPERATOR = "EQ";
-constexpr auto KEYWORD_NOT_EQUAL_OPERATOR = "NE";
-constexpr auto KEYWORD_GREATER_OPERATOR = "GT";
-constexpr auto KEYWORD_GREATER_EQUAL_OPERATOR = "GE";
-constexpr auto KEYWORD_LESS_OPERATOR = "LT";
-constexpr auto KEYWORD_LESS_EQUAL_OPERATOR = "LE";
-
-//巨集邏輯運算子關鍵字
-constexpr auto KEYWORD_AND_OPERATOR = "AND";
-constexpr auto KEYWORD_OR_OPERATOR = "OR";
-constexpr auto KEYWORD_XOR_OPERATOR = "XOR";
-
-//巨集條件式運算子關鍵字
-constexpr auto KEYWORD_IF_CONDITION = "IF";
-constexpr auto KEYWORD_CONDITIONAL_ARITHMETIC_OPERATOR = "THEN";
-
-//巨集分支運算子關鍵字
-constexpr auto KEYWORD_BRANCH_OPERATOR = "GOTO";
-
-//巨集迴圈運算子關鍵字
-constexpr auto KEYWORD_WHILE_CONDITION = "WHILE";
-constexpr auto KEYWORD_LOOP_OPERATOR = "DO";
-constexpr auto KEYWORD_LOOP_END = "END";
-
-//巨集運算式剖析資料
-class MacroParsingContext {
+//是否為邏輯運算子結合優先順序(AND,OR,XOR)
+constexpr bool IsLogicalPrecedence(MacroPrecedence precedence) {
+	return precedence == PRECEDENCE_LOGICAL || precedence == PRECEDENCE_PRIORITY_LOGICAL; }
+
+//運算子堆疊元素(待建立運算子或範圍標記)
+class MacroStackOperator {
 public:
-	MacroParsingContext();
-	~MacroParsingContext() {}
-
-	//優先運算子旗標
-	bool flag_priority;
-	//優先邏輯運算子旗標
-	bool flag_priority_logical;
-	//雙參數旗標
-	bool flag_two_arguments;
-	//一元運算子位址字元暫存器
-	std::stack<unsigned char> unary_operator_address;
-	//二元運算子位址字元暫存器
-	std::deque<unsigned char> binary_operator_address;
-	//優先二元運算子位址字元暫存器
-	std::queue<unsigned char> priority_binary_operator_address;
-	//一元運算子關鍵字暫存器
-	std::stack<std::string> unary_operator_keyword;
-	//一元及二元運算子通用關鍵字暫存器
-	std::stack<std::string> unary_binary_operator_keyword;
-	//二元運算子關鍵字暫存器
-	std::stack<std::string> binary_operator_keyword;
-	//關係運算子關鍵字暫存器
-	std::deque<std::string> relational_keyword;
-	//邏輯運算子關鍵字暫存器
-	std::deque<std::string> logical_keyword;
-	//優先邏輯運算子關鍵字暫存器
-	std::deque<std::string> priority_logical_keyword;
-	//條件式運算子關鍵字暫存器
-	std::deque<std::string> conditional_keyword;
-	//數字字串暫存器
-	std::stack<std::string> digit_string;
-	//大寫字串暫存器
-	std::stack<std::string> upper_string;
-	//通用運算子暫存器
-	std::deque<GeneralOperatorHandle> general_operators;
-	//優先通用運算子暫存器
-	std::deque<GeneralOperatorHandle> priority_general_operators;
-	//清除所有巨集暫存容器
-	void ClearContainers();
-	//清除全部
-	void ClearAll();
+	MacroStackOperator(OperatorType t, std::string_view s, size_t base, MacroKeywordID i = NOT_A_KEYWORD)
+		:type(t), id(i), text(s), operand_base(base), arguments(1) {}
+	~MacroStackOperator() {}
+	//是否為範圍標記(優先運算範圍或NC位址範圍)
+	bool IsFrame() const {
+		return type == NOT_AN_OPERATOR; }
+	//是否為優先運算範圍標記
+	bool IsPriorityRange() const {
+		return IsFrame() && text.front() == ADDRESS_PRIORITY_RANGE_BEGIN; }
 
-private:
-	template<typename T>
-	//清除配接式容器
-	void ClearAdapterContainer(T& c) {
-		while (!c.empty()) c.pop(); }
+	//運算子分類(範圍標記為NOT_AN_OPERATOR,前置#及-為UNARY_OPERATOR)
+	OperatorType type;
+	//關鍵字識別ID(運算子位址字元及範圍標記為NOT_A_KEYWORD)
+	MacroKeywordID id;
+	//運算子位址字元,關鍵字或範圍開始字元(直接參照單節字串)
+	std::string_view text;
+	//範圍開始時的運算元堆疊深度
+	size_t operand_base;
+	//優先運算範圍內的引數數量
+	unsigned char arguments;
+};
+
+//NC位址字(位址字元及其數值運算式,剖析後保留供巨集呼叫引數使用)
+class MacroAddressWord {
+public:
+	MacroAddressWord(char a, const std::shared_ptr<ArithmeticOperator>& v)
+		:address(a), value(v) {}
+	~MacroAddressWord() {}
+
+	//位址字元
+	char address;
+	//數值運算式
+	std::shared_ptr<ArithmeticOperator> value;
+};
+
+//運算子節點配置器(共享剖析工作區的記憶池,運算子存活期間保持記憶池有效)
+template<typename T>
+class MacroNodeAllocator {
+public:
+	using value_type = T;
+	explicit MacroNodeAllocator(const std::shared_ptr<std::pmr::memory_resource>& r)
+		:resource(r) {}
+	template<typename U>
+	MacroNodeAllocator(const MacroNodeAllocator<U>& other)
+		:resource(other.resource) {}
+	~MacroNodeAllocator() {}
+
+	T* allocate(size_t n) {
+		return static_cast<T*>(resource->allocate(n * sizeof(T), alignof(T))); }
+	void deallocate(T* p, size_t n) {
+		resource->deallocate(p, n * sizeof(T), alignof(T)); }
+	template<typename U>
+	bool operator==(const MacroNodeAllocator<U>& other) const {
+		return resource == other.resource; }
+
+	//節點記憶池
+	std::shared_ptr<std::pmr::memory_resource> resource;
 };
 
-//巨集運算式產生器
+class CompiledMacroBlock;
+
+//運算子節點結構鍵值(子節點已共用,故以節點位址比較即為結構比較)
+class MacroNodeKey {
+public:
+	MacroNodeKey(MacroOperatorID i, const ArithmeticOperator* l, const ArithmeticOperator* r, std::uint64_t v)
+		:id(i), left(l), right(r), value(v) {}
+	~MacroNodeKey() {}
+	bool operator==(const MacroNodeKey& other) const {
+		return id == other.id && left == other.left && right == other.right && value == other.value; }
+	//雜湊值
+	size_t Hash() const;
+
+	//運算子ID
+	MacroOperatorID id;
+	//左(或唯一)運算元節點
+	const ArithmeticOperator* left;
+	//右運算元節點
+	const ArithmeticOperator* right;
+	//常數值或最小設定單位(位元表示)
+	std::uint64_t value;
+};
+
+//單節內共用的運算子節點
+class SharedMacroNode {
+public:
+	SharedMacroNode(const MacroNodeKey& k, const std::shared_ptr<ArithmeticOperator>& n)
+		:key(k), node(n), parents(0), visited(false), shares(false) {}
+	~SharedMacroNode() {}
+
+	//結構鍵值
+	MacroNodeKey key;
+	//運算子節點
+	std::shared_ptr<ArithmeticOperator> node;
+	//參照此節點的運算子數量
+	unsigned parents;
+	//共同子運算式運算子(參照數量超過一個時建立)
+	std::shared_ptr<ArithmeticOperator> common;
+	//子節點已改寫
+	bool visited;
+	//子樹含共同子運算式運算子
+	bool shares;
+};
+
+//巨集運算式產生器(單一運算元堆疊及單一運算子堆疊的優先順序爬升法)
 class MacroGenerator {
 public:
 	MacroGenerator(MacroVariableInterface&);
 	~MacroGenerator() {}
+	//啟用剖析工作區模式:運算子節點改由重複使用的記憶池配置(運算子須在同一執行緒釋放)
+	void EnableWorkspace();
+	//清除前一單節的運算子(保留所有容器容量)
 	void Clear();
-	//目前優先運算運算式的嵌套層數
+	//還原已編譯單節的運算子(與快取共享運算子節點)
+	void Restore(const CompiledMacroBlock&);
+	//目前優先運算範圍的嵌套層數
 	size_t CurrentLevel() const {
 		return current_nesting_level; }
-	//進入新的優先運算式嵌套層
-	bool LevelUp();
-	//退出目前的優先運算式嵌套層
-	bool LevelDown();
-	//是否處於雙引數模式
-	bool& TwoArgumentsFlag() {
-		return context[current_nesting_level].flag_two_arguments;
-	}
-	//是否處於巨集運算子模式
-	bool IsMacroMode();
-	//查詢運算子類型
-	OperatorType CheckOperatorType(unsigned char);
 
-	//建立數字字串
-	void CreateDigitString(std::string::const_iterator, std::string::const_iterator);
-	//建立常數運算子
-	bool CreateConstantOperator();
-	//建立一元算術運算子
-	bool CreateUnaryAddressOperator();
-	//建立一元函數運算子
-	bool CreateUnaryFunctionOperator(const std::shared_ptr<ArithmeticOperator>&);
-	//建立二元函數運算子
-	bool CreateBinaryFunctionOperator(const std::shared_ptr<ArithmeticOperator>&, const std::shared_ptr<ArithmeticOperator>&);
-	//建立一般二元算術運算子
-	bool CreateBinaryOperator();
-	//建立優先二元算術運算子
-	bool CreatePriorityBinaryOperator();
-	//建立關係運算子
-	bool CreateRelationalOperator();
-	//建立一般邏輯運算子
-	bool CreateLogicalOperator();
-	//建立優先邏輯運算子
-	bool CreatePriorityLogicalOperator();
-	//建立條件式運算子
-	bool CreateConditionalOperator();
-	//判別並處理關鍵字運算子
-	bool ProcessOperatorKeyword();
-	//判別並處理算術運算子位址字元
-	bool ProcessOperatorAddress(unsigned short, unsigned char);
-	//判別並處理一元與二元通用算術運算子位址字元
-	bool ProcessUnaryBinaryAddress(unsigned char);
-	//檢查並處理算式末端運算子
+	//處理數字
+	bool PushNumber(std::string_view);
+	//處理運算子位址字元
+	bool PushOperatorAddress(const MacroToken&);
+	//處理關鍵字
+	bool PushKeyword(const MacroToken&);
+	//開始NC位址範圍(位址字元與其數值)
+	bool PushNCAddress(std::string_view);
+	//開始優先運算範圍
+	bool OpenPriorityRange(std::string_view);
+	//結束優先運算範圍
+	bool ClosePriorityRange();
+	//處理雙引數分隔符號
+	bool SeparateArgument();
+	//檢查並建立至最後的根部運算子
 	bool ProcessToFinalOperator();
-	//將完成的優先運算子移回前一層
-	bool ReturnPriorityOperatorToPreviousLevel();
-	//取得數字字串容器
-	std::stack<std::string>& DigitString() {
-		return context[current_nesting_level].digit_string;
-	}
-	//取得大寫字母字串容器
-	std::stack<std::string>& UpperString() {
-		return context[current_nesting_level].upper_string;
-	}
-	//取得通用運算子容器
-	std::deque<GeneralOperatorHandle>& GeneralOperators() {
-		return context[current_nesting_level].general_operators; }
+
+	//取得通用運算子容器(運算元堆疊)
+	std::vector<GeneralOperatorHandle>& GeneralOperators() {
+		return operand_stack; }
+	//取得單節內的NC位址字(依出現順序)
+	const std::vector<MacroAddressWord>& AddressWords() const {
+		return address_words; }
 
 	//條件式算術運算子暫存
 	ConditionalArithmeticOperator conditional_arithmetic_operator;
@@ -230,100 +247,100 @@ public:
 	LoopEndOperator loop_end_operator;
 
 private:
-	//初始化巨集關鍵字清單
-	void InitialKeywordList();
-	//初始化巨集禁用位址字元清單
-	void InitialDenyAddress();
-	//取得優先運算子旗標
-	bool& PriorityFlag() {
-		return context[current_nesting_level].flag_priority;
-	}
-	//取得優先邏輯運算子旗標
-	bool& PriorityLogicalFlag() {
-		return context[current_nesting_level].flag_priority_logical;
-	}
-	//取得一元運算子位址字元容器
-	std::stack<unsigned char>& UnaryOperatorAddress() {
-		return context[current_nesting_level].unary_operator_address;
-	}
-	//取得二元運算子位址字元容器
-	std::deque<unsigned char>& BinaryOperatorAddress() {
-		return context[current_nesting_level].binary_operator_address;
-	}
-	//取得優先二元運算子位址字元容器
-	std::queue<unsigned char>& PriorityBinaryOperatorAddress() {
-		return context[current_nesting_level].priority_binary_operator_address;
-	}
-	//取得一元運算子關鍵字容器
-	std::stack<std::string>& UnaryOperatorKeyword() {
-		return context[current_nesting_level].unary_operator_keyword;
-	}
-	//取得通用一元及二元運算子關鍵字容器
-	std::stack<std::string>& UnaryBinaryOperatorKeyword() {
-		return context[current_nesting_level].unary_binary_operator_keyword;
-	}
-	//取得二元運算子關鍵字容器
-	std::stack<std::string>& BinaryOperatorKeyword() {
-		return context[current_nesting_level].binary_operator_keyword;
-	}
-	//取得關係運算子關鍵字容器
-	std::deque<std::string>& RelationalKeyword() {
-		return context[current_nesting_level].relational_keyword;
-	}
-	//取得邏輯運算子關鍵字容器
-	std::deque<std::string>& LogicalKeyword() {
-		return context[current_nesting_level].logical_keyword;
-	}
-	//取得優先邏輯運算子關鍵字容器
-	std::deque<std::string>& PriorityLogicalKeyword() {
-		return context[current_nesting_level].priority_logical_keyword;
-	}
-	//取得條件運算子關鍵字容器
-	std::deque<std::string>& ConditionalKeyword() {
-		return context[current_nesting_level].conditional_keyword;
-	}
-	//取得優先通用運算子容器
-	std::deque<GeneralOperatorHandle>& PriorityGeneralOperators() {
-		return context[current_nesting_level].priority_general_operators;
+	template<typename T, typename... Args>
+	//建立運算子節點(剖析工作區模式使用記憶池)
+	std::shared_ptr<T> CreateNode(Args&&... args) {
+		if (node_resource) {
+			return std::allocate_shared<T>(MacroNodeAllocator<T>(node_resource), std::forward<Args>(args)...); }
+		else {
+			return std::make_shared<T>(std::forward<Args>(args)...); }
 	}
+	template<typename T>
+	//依左右運算元類型建立邏輯運算子
+	std::shared_ptr<LogicalOperator> CreateLogicalOperator(const GeneralOperatorHandle&, const GeneralOperatorHandle&);
+	//是否為函數運算子
+	static bool IsFunction(OperatorType type) {
+		return type == UNARY_FUNCTION_OPERATOR || type == UNARY_BINARY_FUNCTION_OPERATOR || type == BINARY_FUNCTION_OPERATOR; }
+	//準備開始新運算元
+	bool BeginOperand();
+	//存入二元運算子(先建立優先順序較高的待建立運算子)
+	bool PushBinaryOperator(OperatorType, std::string_view, MacroKeywordID = NOT_A_KEYWORD);
+	//建立堆疊頂端的待建立運算子
+	bool ReduceOperator();
+	//建立待建立運算子直到最內層範圍標記
+	bool ReduceToFrame();
+	//最內層範圍標記的位置
+	size_t InnermostFrame() const;
+	//結束NC位址範圍並保存其數值
+	bool CloseNCAddress();
+	//建立運算元完成後的前置一元運算子(#,-)
+	bool ApplyPrefixOperators();
+	//是否為常數運算子
+	static bool IsConstant(const std::shared_ptr<ArithmeticOperator>& handle) {
+		return handle && handle->GetOperatorID() == CONSTANT; }
+	//常數摺疊:以核算結果的常數運算子取代運算元皆為常數的運算子
+	std::shared_ptr<ArithmeticOperator> FoldConstant(const std::shared_ptr<ArithmeticOperator>&);
+	//運算子節點的結構鍵值
+	static MacroNodeKey NodeKey(const ArithmeticOperator*);
+	//尋找鍵值所在(或可插入)的雜湊表位置
+	size_t FindSharedNode(const MacroNodeKey&) const;
+	//清除共用節點(保留容量)
+	void ClearSharedNodes();
+	//雜湊合併:單節內已有結構相同的節點時返回既有節點
+	std::shared_ptr<ArithmeticOperator> ShareNode(const std::shared_ptr<ArithmeticOperator>&);
+	//改寫子節點參照,返回子樹是否含共同子運算式
+	bool ShareChildren(ArithmeticOperator*);
+	//改寫運算元參照,返回運算元是否含共同子運算式
+	bool ShareOperand(std::shared_ptr<ArithmeticOperator>&);
+	//改寫算術運算式根節點
+	void ShareRoot(std::shared_ptr<ArithmeticOperator>&);
+	//改寫關係運算子的算術運算元
+	void ShareRelational(RelationalOperator*);
+	//改寫邏輯運算子的運算元
+	void ShareLogical(LogicalOperator*);
+	//改寫邏輯運算子的單一運算元
+	void ShareCondition(ConditionOperand&);
+	//以共同子運算式運算子取代運算元堆疊內重複參照的節點
+	void ShareSubexpressions();
+	//建立常數運算子
+	bool CreateConstantOperator(std::string_view);
+	//建立函數運算子
+	bool CreateFunctionOperator(const MacroStackOperator&, size_t);
+	//建立二元運算子
+	bool CreateBinaryOperator(const MacroStackOperator&);
+	//建立條件式運算子
+	bool CreateConditionalOperator();
 
-	//目前優先運算運算式的嵌套層數
+	//運算元堆疊
+	std::vector<GeneralOperatorHandle> operand_stack;
+	//運算子堆疊
+	std::vector<MacroStackOperator> operator_stack;
+	//NC位址字
+	std::vector<MacroAddressWord> address_words;
+	//等待運算元旗標
+	bool expect_operand;
+	//目前優先運算範圍的嵌套層數
 	size_t current_nesting_level;
+	//前導條件式關鍵字(IF,WHILE)
+	MacroKeywordID condition_keyword;
+	//敘述關鍵字(THEN,GOTO,DO,END)
+	MacroKeywordID statement_keyword;
+	//敘述關鍵字之前的運算元數量(條件運算子)
+	size_t statement_base;
 	//浮點數字串轉換器
 	FloatStringConverter converter;
 	//浮點數值定義
 	FloatNumberDefinition macro_float_parser;
 	//巨集變數存取介面
 	MacroVariableInterface& macro_variable_interface;
-	//巨集關鍵字清單
-	std::map<std::string, unsigned char> keyword_list;
-	//禁用巨集位址字元清單
-	std::set<char> macro_deny_address;
-	//巨集算式剖析資料暫存器
-	MacroParsingContext context[PRIORITY_NESTING_LEVEL_MAX + 1];
-};
-
-//解析用引數群
-class Argument {
-public:
-	Argument();
-	~Argument() {}
-	
-	//註解旗標
-	bool flag_control_out;
-	//數字字元旗標
-	bool flag_digit;
-	//大寫字母字元旗標
-	bool flag_upper;
-	//NC位址字元暫存器
-	unsigned char NC_address;
-
-	//數字字元起始位置
-	std::string::const_iterator digit_begin;
-	//大寫字元起始位置
-	std::string::const_iterator upper_begin;
-	//字串字元迭代器
-	std::string::const_iterator iter;
+	//剖析工作區的運算子節點記憶池(未啟用時為空)
+	std::shared_ptr<std::pmr::memory_resource> node_resource;
+	//單節內的共用節點
+	std::vector<SharedMacroNode> shared_nodes;
+	//共用節點雜湊表(線性探測,容量為2的次方)
+	std::vector<std::uint32_t> shared_index;
+	//已有重複參照的節點
+	bool subexpression_found;
 };
 
 //指令類型
@@ -338,6 +355,75 @@ enum CommandType {
 	MACRO_COMMAND,
 };
 
+//已編譯單節(剖析結果的不可變快照,運算子節點與產生器共享)
+class CompiledMacroBlock {
+public:
+	CompiledMacroBlock(CommandType, MacroGenerator&);
+	~CompiledMacroBlock() {}
+
+	//剖析結果指令類型
+	const CommandType command_type;
+	//通用運算子
+	const std::vector<GeneralOperatorHandle> general_operators;
+	//條件式算術運算子
+	const ConditionalArithmeticOperator conditional_arithmetic_operator;
+	//條件式分支運算子
+	const ConditionalBranchOperator conditional_branch_operator;
+	//條件式迴圈運算子
+	const ConditionalLoopOperator conditional_loop_operator;
+	//迴圈終點運算子
+	const LoopEndOperator loop_end_operator;
+	//NC位址字
+	const std::vector<MacroAddressWord> address_words;
+};
+
+//已編譯單節快取(以單節字串為鍵,超過容量時淘汰最久未使用的單節)
+class MacroBlockCache {
+public:
+	explicit MacroBlockCache(size_t capacity = 0);
+	~MacroBlockCache() {}
+	//查詢單節(命中時移至最近使用位置,未命中時返回空指標)
+	std::shared_ptr<const CompiledMacroBlock> Find(std::string_view block);
+	//加入單節(超過容量時淘汰最久未使用的單節)
+	void Insert(std::string_view block, const std::shared_ptr<const CompiledMacroBlock>&);
+	//設定容量(0為停用快取,縮小時立即淘汰多餘單節)
+	void SetCapacity(size_t);
+	//清除所有單節及命中統計
+	void Clear();
+	//是否啟用快取
+	bool Enabled() const {
+		return capacity != 0; }
+	//快取單節數量
+	size_t Size() const {
+		return entries.size(); }
+	//最大快取單節數量
+	size_t Capacity() const {
+		return capacity; }
+	//命中次數
+	size_t Hits() const {
+		return hits; }
+	//未命中次數
+	size_t Misses() const {
+		return misses; }
+
+private:
+	//淘汰最久未使用的單節直到不超過容量
+	void Evict();
+
+	//快取單節(單節字串,已編譯單節)
+	using Entry = std::pair<std::string, std::shared_ptr<const CompiledMacroBlock>>;
+	//快取單節串列(最近使用在前)
+	std::list<Entry> entries;
+	//單節字串索引(鍵直接參照串列內的單節字串)
+	std::unordered_map<std::string_view, std::list<Entry>::iterator> index;
+	//最大快取單節數量
+	size_t capacity;
+	//命中次數
+	size_t hits;
+	//未命中次數
+	size_t misses;
+};
+
 //巨集語言抽象解析器
 class MacroParser {
 public:
@@ -354,15 +440,22 @@ public:
 	~FanucMacroParser() = default;
 	//剖析NC碼單節
 	CommandType ParseBlock(const std::string& block);
+	//啟用剖析工作區模式(暖機後剖析單節不再配置記憶體)
+	void EnableWorkspace();
+	//啟用已編譯單節快取(相同單節字串直接還原運算子,0為停用)
+	void EnableBlockCache(size_t capacity);
+	//已編譯單節快取
+	const MacroBlockCache& BlockCache() const {
+		return block_cache; }
 	//巨集運算子產生器
 	MacroGenerator macro_generator;
 
 private:
-	//查詢字元是否為數字相關
-	bool IsDigitOrDot(unsigned char ch) const {
-		return isdigit(ch) || ch == '.'; }
-	//建立位址字元或關鍵字字串
-	bool CreateAddressOrKeyword(Argument& args);
-	//建立一元運算子或常數運算子
-	bool CreateUnaryOrConstantOperator(Argument& args);
+	//剖析單節字串並建立運算子
+	CommandType Parse(const std::string& block);
+
+	//已編譯單節快取
+	MacroBlockCache block_cache;
+	//單節語彙分析器
+	FanucMacroLexer lexer;
 };
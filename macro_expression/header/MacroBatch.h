@@ -0,0 +1,62 @@
+﻿#pragma once
+
+#include <vector>
+#include "MacroBytecode.h"
+
+//批次核算每次處理的資料筆數(向量核心的處理單位)
+constexpr size_t MACRO_BATCH_LANES = 256;
+
+//批次核算的輸入變數欄
+class MacroBatchColumn {
+public:
+	MacroBatchColumn(unsigned short id, const double* v)
+		:variable_ID(id), values(v) {}
+	~MacroBatchColumn() {}
+
+	//變數ID
+	unsigned short variable_ID;
+	//各筆資料的變數值(筆數與核算筆數相同)
+	const double* values;
+};
+
+//巨集運算式批次核算器(同一位元組碼對多組變數值逐欄核算,算術及SIN/COS/TAN/SQRT/POW使用AVX2核心(POW於MSVC使用SVML,其餘編譯器以exp/ln多項式核算,與純量pow可能相差最後數位);與輸入欄無關的運算每段資料只核算一次)
+class MacroBatchEvaluator {
+public:
+	MacroBatchEvaluator(MacroVariableInterface&);
+	~MacroBatchEvaluator() {}
+	//批次核算位元組碼:未列於輸入欄的變數讀取目前變數值,結果寫入results(含控制指令或寫入變數時返回false)
+	bool Evaluate(const MacroBytecode&, const std::vector<MacroBatchColumn>&, size_t count, double* results);
+	//處理器及作業系統是否支援AVX2
+	static bool SimdSupported();
+	//是否使用AVX2核心
+	bool SimdEnabled() const {
+		return simd; }
+	//啟用或停用AVX2核心(不支援時維持停用)
+	void EnableSimd(bool enable) {
+		simd = enable && SimdSupported(); }
+
+private:
+	//檢查位元組碼是否僅含可批次核算的指令
+	static bool Supported(const MacroBytecode&);
+	//核算一段資料(筆數不超過MACRO_BATCH_LANES)
+	void EvaluateLanes(const MacroBytecode&, const std::vector<MacroBatchColumn>&, size_t offset, size_t lanes, double* results);
+	//讀取單筆資料的變數值(變數不存在且alarm為true時發出警報)
+	double ReadVariable(const std::vector<MacroBatchColumn>&, unsigned short, size_t row, const MacroInstruction&, bool alarm);
+
+	//數值欄堆疊(每層MACRO_BATCH_LANES筆,依位元組碼最大深度擴充後重複使用)
+	std::vector<double> stack;
+	//共同子運算式暫存欄
+	std::vector<double> temporaries;
+	//數值欄堆疊各層是否為定值欄(僅第一筆有效,與堆疊相同保留底部一層)
+	std::vector<char> uniform_columns;
+	//共同子運算式暫存欄是否為定值欄
+	std::vector<char> uniform_temporaries;
+	//短路核算跳過右運算元的資料列(每層MACRO_BATCH_LANES筆,含外層跳過的資料列;跳過的資料列不發出警報)
+	std::vector<char> skipped_rows;
+	//各層短路核算的結束指令位置
+	std::vector<size_t> skip_ends;
+	//使用AVX2核心
+	bool simd;
+	//巨集變數存取介面
+	MacroVariableInterface& macro_variable_interface;
+};
@@ -0,0 +1,229 @@
+﻿#pragma once
+
+#include <vector>
+#include "MacroOperator.h"
+#include "FanucMacroParser.h"
+
+//位元組碼運算碼(算術運算碼依MacroOperatorID順序排列)
+enum MacroOpcode :unsigned char {
+	//存入常數(引數為常數表索引)
+	OP_CONSTANT,
+	//負值
+	OP_MINUS,
+	//讀取變數(取出變數ID,存入變數值)
+	OP_VARIABLE,
+	//加法
+	OP_ADD,
+	//減法
+	OP_SUBTRACT,
+	//乘法
+	OP_MULTIPLY,
+	//除法
+	OP_DIVIDE,
+	//賦值(取出數值及變數ID,寫入後存入變數值)
+	OP_ASSIGNMENT,
+	//正弦
+	OP_SINE,
+	//餘弦
+	OP_COSINE,
+	//正切
+	OP_TANGENT,
+	//反正弦
+	OP_ARC_SINE,
+	//反餘弦
+	OP_ARC_COSINE,
+	//反正切
+	OP_ARC_TANGENT,
+	//反正切(雙參數版本)
+	OP_ARC_TANGENT2,
+	//平方根
+	OP_SQUARE_ROOT,
+	//絕對值
+	OP_ABSOLUTE_VALUE,
+	//二進碼
+	OP_BINARY_CODE,
+	//二進位十進制
+	OP_BINARY_CODED_DECIMAL,
+	//四捨五入
+	OP_ROUND_OFF,
+	//無條件捨去
+	OP_ROUND_DOWN,
+	//無條件進位
+	OP_ROUND_UP,
+	//自然對數
+	OP_NATURAL_LOG,
+	//指數
+	OP_EXPONENT,
+	//次方
+	OP_POWER,
+	//轉換浮點數(引數為最小設定單位的常數表索引)
+	OP_ADD_DECIMAL_POINT,
+	//相等(依RelationalOperatorID順序排列)
+	OP_EQUAL,
+	//不相等
+	OP_NOT_EQUAL,
+	//大於
+	OP_GREATER,
+	//大於等於
+	OP_GREATER_EQUAL,
+	//小於
+	OP_LESS,
+	//小於等於
+	OP_LESS_EQUAL,
+	//交集(依LogicalOperatorID順序排列)
+	OP_AND,
+	//聯集
+	OP_OR,
+	//互斥
+	OP_XOR,
+	//條件不成立時跳躍(取出條件值,引數為目標指令索引)
+	OP_JUMP_IF_FALSE,
+	//條件分支(取出分支序號)
+	OP_BRANCH,
+	//迴圈開始(取出迴圈識別號碼)
+	OP_LOOP,
+	//迴圈終點(取出迴圈識別號碼)
+	OP_LOOP_END,
+	//結束核算
+	OP_RETURN,
+	//讀取常數ID變數(引數為變數ID,合併OP_CONSTANT及OP_VARIABLE)
+	OP_LOAD_VARIABLE,
+	//賦值至常數ID變數(取出數值,引數為變數ID,合併OP_CONSTANT及OP_ASSIGNMENT)
+	OP_STORE_VARIABLE,
+	//保存共同子運算式(不取出數值,引數為暫存區索引)
+	OP_STORE_TEMPORARY,
+	//讀取共同子運算式(引數為暫存區索引)
+	OP_LOAD_TEMPORARY,
+	//交集短路(不取出數值,左運算元為0時以0取代並跳至引數位置)
+	OP_AND_SHORT_CIRCUIT,
+	//布林聯集短路(不取出數值,左運算元成立時跳至引數位置);運算節點則為左右運算元皆為布林值的聯集
+	OP_OR_SHORT_CIRCUIT
+};
+static_assert(OP_ADD_DECIMAL_POINT == static_cast<int>(ADD_DECIMAL_POINT), "arithmetic opcodes must follow MacroOperatorID");
+static_assert(OP_LESS_EQUAL - OP_EQUAL == static_cast<int>(LESS_EQUAL), "relational opcodes must follow RelationalOperatorID");
+static_assert(OP_XOR - OP_AND == static_cast<int>(XOR), "logical opcodes must follow LogicalOperatorID");
+
+//位元組碼指令
+class MacroInstruction {
+public:
+	MacroInstruction(MacroOpcode c, unsigned a)
+		:opcode(c), argument(a) {}
+	~MacroInstruction() {}
+
+	//運算碼
+	MacroOpcode opcode;
+	//引數(常數表索引或跳躍目標)
+	unsigned argument;
+};
+
+//分支序號最大值(GOTO 1-99999)
+constexpr int BRANCH_NUMBER_MAX = 99999;
+//不合法的分支序號(與單節的無序號值不同,不會被搜尋到)
+constexpr int INVALID_BRANCH_NUMBER = 0;
+
+//分支序號(非1~BRANCH_NUMBER_MAX的整數時返回INVALID_BRANCH_NUMBER,不以超出int範圍的值轉型)
+inline int BranchNumber(double value)
+{
+	if (!(value >= 1.0 && value <= BRANCH_NUMBER_MAX)) {
+		return INVALID_BRANCH_NUMBER; }
+	int number(static_cast<int>(value));
+	return static_cast<double>(number) == value ? number : INVALID_BRANCH_NUMBER;
+}
+
+//位元組碼執行結果
+class MacroBytecodeResult {
+public:
+	MacroBytecodeResult()
+		:condition(true), control(OP_RETURN), number(0), value(0.0) {}
+	~MacroBytecodeResult() {}
+
+	//條件式是否成立(無條件式為true)
+	bool condition;
+	//控制指令(OP_BRANCH,OP_LOOP,OP_LOOP_END,一般運算式為OP_RETURN)
+	MacroOpcode control;
+	//分支序號(不合法時為INVALID_BRANCH_NUMBER)或迴圈識別號碼
+	int number;
+	//運算式值(條件式不成立或無運算式時為0)
+	double value;
+};
+
+//巨集位元組碼(堆疊式指令序列及常數表)
+class MacroBytecode {
+public:
+	MacroBytecode();
+	~MacroBytecode() {}
+	//由已編譯單節的運算子樹產生位元組碼(無運算子時返回false)
+	bool Compile(const CompiledMacroBlock&);
+	//清除位元組碼
+	void Clear();
+	//是否無位元組碼
+	bool Empty() const {
+		return code.empty(); }
+	//指令序列
+	const std::vector<MacroInstruction>& Code() const {
+		return code; }
+	//常數表
+	const std::vector<double>& Constants() const {
+		return constants; }
+	//核算所需的最大堆疊深度
+	size_t StackDepth() const {
+		return stack_depth; }
+	//共同子運算式暫存區數量
+	size_t TemporaryCount() const {
+		return temporary_count; }
+	//指令對堆疊深度的影響(存入為1,取出為-1)
+	static int StackEffect(MacroOpcode);
+
+private:
+	//加入指令並追蹤堆疊深度
+	void Emit(MacroOpcode, unsigned argument = 0);
+	//加入常數並返回常數表索引
+	unsigned AddConstant(double);
+	//產生算術運算子指令
+	bool EmitArithmetic(const ArithmeticOperator*);
+	//產生關係運算子指令
+	bool EmitRelational(const RelationalOperator*);
+	//產生邏輯運算子指令(AND及布林OR可略過右運算元)
+	bool EmitLogical(const LogicalOperator*);
+	//產生條件運算元指令
+	bool EmitOperand(const ConditionOperand&);
+	//產生條件式指令(關係或邏輯運算子),返回待填入目標的跳躍指令索引
+	bool EmitCondition(const ConditionOperand&, size_t&);
+
+	//指令序列
+	std::vector<MacroInstruction> code;
+	//常數表
+	std::vector<double> constants;
+	//最大堆疊深度
+	size_t stack_depth;
+	//產生指令時的目前堆疊深度
+	size_t current_depth;
+	//共同子運算式暫存區數量
+	size_t temporary_count;
+	//產生指令時已保存的共同子運算式(索引為暫存區索引)
+	std::vector<const ArithmeticOperator*> temporaries;
+};
+
+//巨集位元組碼虛擬機
+class MacroVirtualMachine {
+public:
+	MacroVirtualMachine(MacroVariableInterface&);
+	~MacroVirtualMachine() {}
+	//執行位元組碼
+	MacroBytecodeResult Run(const MacroBytecode&);
+
+private:
+	//讀取變數值(局部、共同及浮點數系統變數直接讀取,變數不存在時發出警報)
+	double ReadVariable(unsigned short, const MacroInstruction&);
+	//寫入變數值(局部變數直接寫入,寫入#0時發出警報)
+	void WriteVariable(unsigned short, double, const MacroInstruction&);
+
+	//執行中的局部變數層變數值(每次執行時取得)
+	double* local_values;
+	//數值堆疊(依位元組碼最大深度擴充後重複使用)
+	std::vector<double> stack;
+	//共同子運算式暫存區
+	std::vector<double> temporaries;
+	//巨集變數存取介面
+	MacroVariableInterface& macro_variable_interface;
+};
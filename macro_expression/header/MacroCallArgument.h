@@ -0,0 +1,67 @@
+﻿#pragma once
+
+#include <vector>
+#include "MacroProgram.h"
+
+//不可作為引數的位址
+constexpr unsigned char NOT_AN_ARGUMENT = 0;
+//引數指定II的I,J,K組數上限(#4-#33)
+constexpr unsigned char ARGUMENT_IJK_SET_MAX = 10;
+//巨集呼叫程式號碼位址字元
+constexpr char ADDRESS_CALL_PROGRAM = 'P';
+//巨集呼叫重複次數位址字元
+constexpr char ADDRESS_CALL_REPEAT = 'L';
+
+//引數指定I的位址對應局部變數編號(A-Z,G,L,N,O,P不可作為引數)
+constexpr unsigned char ARGUMENT_SPECIFICATION_I[] = {
+	//A,B,C,D,E,F,G,H
+	1, 2, 3, 7, 8, 9, NOT_AN_ARGUMENT, 11,
+	//I,J,K,L,M,N,O,P
+	4, 5, 6, NOT_AN_ARGUMENT, 13, NOT_AN_ARGUMENT, NOT_AN_ARGUMENT, NOT_AN_ARGUMENT,
+	//Q,R,S,T,U,V,W,X,Y,Z
+	17, 18, 19, 20, 21, 22, 23, 24, 25, 26
+};
+static_assert(sizeof(ARGUMENT_SPECIFICATION_I) == 'Z' - 'A' + 1, "ARGUMENT_SPECIFICATION_I must cover A-Z");
+
+//查詢引數指定I的局部變數編號
+constexpr unsigned char ArgumentSpecificationI(char address) {
+	return address >= 'A' && address <= 'Z' ? ARGUMENT_SPECIFICATION_I[address - 'A'] : NOT_AN_ARGUMENT; }
+
+//查詢引數指定II的局部變數編號(A,B,C為#1-#3,第set組I,J,K為#4+3*set起)
+constexpr unsigned char ArgumentSpecificationII(char address, unsigned char set) {
+	return address >= 'A' && address <= 'C' ? static_cast<unsigned char>(address - 'A' + 1) :
+		address >= 'I' && address <= 'K' && set < ARGUMENT_IJK_SET_MAX ? static_cast<unsigned char>(4 + 3 * set + (address - 'I')) : NOT_AN_ARGUMENT; }
+
+static_assert(ArgumentSpecificationI('Z') == 26 && ArgumentSpecificationI('P') == NOT_AN_ARGUMENT, "argument specification I");
+static_assert(ArgumentSpecificationII('I', 0) == ArgumentSpecificationI('I') && ArgumentSpecificationII('K', 0) == ArgumentSpecificationI('K'), "first I,J,K set matches argument specification I");
+static_assert(ArgumentSpecificationII('K', ARGUMENT_IJK_SET_MAX - 1) == LOCAL_VARIABLE_COUNT - 1, "argument specification II ends at the last local variable");
+
+//巨集呼叫引數(G65/G66單節的程式號碼、重複次數及局部變數初值)
+class MacroCallArguments {
+public:
+	MacroCallArguments() {
+		Clear(); }
+	~MacroCallArguments() {}
+	//清除所有引數
+	void Clear() {
+		values.fill(NULL_VARIABLE);
+		program_number = NO_SEQUENCE_NUMBER;
+		repeat = 1;
+	}
+
+	//局部變數初值(未指定的引數為空值,直接複製至呼叫框架)
+	LocalVariableValues values;
+	//呼叫程式號碼(未指定為NO_SEQUENCE_NUMBER)
+	int program_number;
+	//重複次數(未指定為1)
+	unsigned repeat;
+};
+
+//巨集呼叫引數繫結(依引數指定I/II將G65/G66單節的位址字寫入固定長度引數陣列)
+class MacroCallBinder {
+public:
+	MacroCallBinder() {}
+	~MacroCallBinder() {}
+	//核算位址字並繫結引數(缺少程式號碼、位址不可作為引數或I,J,K超過10組時返回false)
+	static bool Bind(const std::vector<MacroAddressWord>&, MacroCallArguments&);
+};
@@ -0,0 +1,100 @@
+﻿#pragma once
+
+#include <array>
+#include "MacroProgram.h"
+#include "MacroSequenceSearch.h"
+
+//迴圈執行次數監視上限預設值(0為不監視)
+constexpr unsigned long long LOOP_ITERATION_LIMIT = 100000000;
+//保存變數檢查點間隔預設值(寫入保存變數後經過的單節數)
+constexpr unsigned RETAINED_CHECKPOINT_INTERVAL = 1000;
+
+//執行中的迴圈(DO單節進入時建立,條件不成立或跳出迴圈時移除)
+class MacroLoopFrame {
+public:
+	MacroLoopFrame()
+		:loop_number(0), do_block(NO_PROGRAM_BLOCK), end_block(NO_PROGRAM_BLOCK), iterations(0) {}
+	~MacroLoopFrame() {}
+
+	//迴圈識別號碼
+	unsigned short loop_number;
+	//DO單節索引
+	size_t do_block;
+	//END單節索引
+	size_t end_block;
+	//已完成的重複次數
+	unsigned long long iterations;
+};
+
+//巨集程式執行器(以單節索引跳躍執行分支及迴圈,迴圈起訖於編譯時配對)
+class MacroExecutor {
+public:
+	MacroExecutor(MacroVariableInterface&, SystemParameter&);
+	~MacroExecutor() {}
+	//載入已編譯程式並從第一個單節開始(程式須在執行期間保持有效)
+	void Load(const MacroProgram&);
+	//回到第一個單節並清除迴圈堆疊
+	void Reset();
+	//執行下一個單節,返回執行的單節索引(程式結束或發生警報後建立保存變數檢查點並返回NO_PROGRAM_BLOCK);NC單節不核算,由呼叫端依索引處理
+	size_t Step();
+	//執行至程式結束,無警報時返回true
+	bool Run();
+	//下一個執行的單節索引
+	size_t ProgramCounter() const {
+		return program_counter; }
+	//是否已執行至程式結束
+	bool Finished() const {
+		return !program || program_counter >= program->Blocks().size(); }
+	//迴圈巢狀層數
+	size_t LoopDepth() const {
+		return loop_depth; }
+	//執行中的迴圈(0為最外層)
+	const MacroLoopFrame& Loop(size_t level) const {
+		return loops[level]; }
+	//迴圈執行次數監視上限
+	unsigned long long IterationLimit() const {
+		return iteration_limit; }
+	//設定迴圈執行次數監視上限(0為不監視)
+	void SetIterationLimit(unsigned long long limit) {
+		iteration_limit = limit; }
+	//保存變數檢查點間隔
+	unsigned CheckpointInterval() const {
+		return checkpoint_interval; }
+	//設定保存變數檢查點間隔(0為僅於程式結束或警報時建立,明確提交由MacroVariableInterface::CommitRetained)
+	void SetCheckpointInterval(unsigned interval) {
+		checkpoint_interval = interval; }
+	//GOTO序號搜尋
+	const MacroSequenceSearch& SequenceSearch() const {
+		return sequence_search; }
+
+private:
+	//DO單節:條件成立時進入迴圈,否則跳至END的下一單節
+	void ExecuteLoop(size_t, const MacroBytecodeResult&);
+	//END單節:跳回配對的DO單節重新判斷條件
+	void ExecuteLoopEnd(size_t);
+	//GOTO單節:跳至分支序號所在單節,移除不包含目標的迴圈
+	void ExecuteBranch(size_t, const MacroBytecodeResult&);
+
+	//執行中的程式
+	const MacroProgram* program;
+	//下一個執行的單節索引
+	size_t program_counter;
+	//迴圈堆疊(DO 1-3最多3層)
+	std::array<MacroLoopFrame, LOOP_NESTING_MAX> loops;
+	//迴圈巢狀層數
+	size_t loop_depth;
+	//迴圈執行次數監視上限
+	unsigned long long iteration_limit;
+	//保存變數檢查點間隔
+	unsigned checkpoint_interval;
+	//寫入保存變數後尚未建立檢查點的單節數
+	unsigned pending_blocks;
+	//GOTO序號搜尋
+	MacroSequenceSearch sequence_search;
+	//JIT核算器(單節執行次數達門檻後執行原生程式碼)
+	MacroJitEvaluator evaluator;
+	//巨集變數存取介面
+	MacroVariableInterface& macro_variable_interface;
+	//系統參數(選擇性單節跳躍)
+	SystemParameter& system_parameter;
+};
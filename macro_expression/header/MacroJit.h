@@ -0,0 +1,128 @@
+﻿#pragma once
+
+#include <vector>
+#include "MacroBytecode.h"
+
+//x86-64原生程式碼產生器
+#if defined(_M_X64) || defined(__x86_64__)
+#define MACRO_JIT_X64
+#endif
+
+//單節執行次數達此門檻後編譯為原生程式碼
+constexpr unsigned MACRO_JIT_THRESHOLD = 64;
+
+class MacroJitState;
+
+//原生程式碼進入點(核算狀態,數值堆疊,共同子運算式暫存區,常數表)
+using MacroNativeEntry = void (*)(MacroJitState*, double*, double*, const double*);
+
+//由位元組碼編譯的x86-64原生程式碼(置於可執行記憶頁,不可複製)
+class MacroNativeCode {
+public:
+	MacroNativeCode();
+	MacroNativeCode(MacroNativeCode&&) noexcept;
+	MacroNativeCode& operator=(MacroNativeCode&&) noexcept;
+	MacroNativeCode(const MacroNativeCode&) = delete;
+	MacroNativeCode& operator=(const MacroNativeCode&) = delete;
+	~MacroNativeCode();
+	//處理器及作業系統是否支援原生程式碼
+	static bool Supported();
+	//編譯位元組碼(保留指令及常數表複本,常數ID變數於編譯時解析存取位置,不支援時返回false)
+	bool Compile(const MacroBytecode&, MacroVariableInterface&);
+	//釋放原生程式碼
+	void Clear();
+	//是否無原生程式碼
+	bool Empty() const {
+		return !entry; }
+	//以編譯時的變數存取介面執行原生程式碼(堆疊及暫存區大小不得小於StackDepth及TemporaryCount),結果與位元組碼虛擬機相同
+	MacroBytecodeResult Run(MacroVariableInterface&, double* stack, double* temporaries) const;
+	//核算所需的最大堆疊深度
+	size_t StackDepth() const {
+		return stack_depth; }
+	//共同子運算式暫存區數量
+	size_t TemporaryCount() const {
+		return temporary_count; }
+	//原生程式碼長度(位元組)
+	size_t CodeSize() const {
+		return code_size; }
+
+private:
+	//指令複本(警報記錄的發生位置及輔助函式引數)
+	std::vector<MacroInstruction> instructions;
+	//常數ID變數的存取位置(與指令複本平行)
+	std::vector<MacroVariableSlot> slots;
+	//常數表複本
+	std::vector<double> constants;
+	//最大堆疊深度
+	size_t stack_depth;
+	//共同子運算式暫存區數量
+	size_t temporary_count;
+	//可執行記憶頁
+	void* memory;
+	//可執行記憶頁大小
+	size_t memory_size;
+	//原生程式碼長度
+	size_t code_size;
+	//進入點
+	MacroNativeEntry entry;
+};
+
+//JIT單節狀態(與位元組碼一同保存,位元組碼重新編譯時須Reset)
+class MacroJitBlock {
+	friend class MacroJitEvaluator;
+public:
+	MacroJitBlock()
+		:executions(0), failed(false), owner(nullptr) {}
+	//複製時不保留原生程式碼(重新計數後編譯)
+	MacroJitBlock(const MacroJitBlock&)
+		:executions(0), failed(false), owner(nullptr) {}
+	MacroJitBlock& operator=(const MacroJitBlock&) {
+		Reset();
+		return *this; }
+	~MacroJitBlock() {}
+	//清除執行次數及原生程式碼
+	void Reset();
+	//執行次數
+	unsigned Executions() const {
+		return executions; }
+	//是否已編譯為原生程式碼
+	bool Compiled() const {
+		return !native_code.Empty(); }
+	//原生程式碼
+	const MacroNativeCode& NativeCode() const {
+		return native_code; }
+
+private:
+	//執行次數
+	unsigned executions;
+	//編譯失敗(不再嘗試)
+	bool failed;
+	//編譯原生程式碼的變數存取介面(其他介面由虛擬機執行)
+	const MacroVariableInterface* owner;
+	//原生程式碼
+	MacroNativeCode native_code;
+};
+
+//JIT核算器(單節執行次數達門檻前由位元組碼虛擬機執行,其後執行原生程式碼)
+class MacroJitEvaluator {
+public:
+	MacroJitEvaluator(MacroVariableInterface&, unsigned threshold = MACRO_JIT_THRESHOLD);
+	~MacroJitEvaluator() {}
+	//執行單節(原生程式碼無法傳遞例外,警報模式停用時以警報模式執行原生程式碼後拋出對應的例外)
+	MacroBytecodeResult Run(const MacroBytecode&, MacroJitBlock&);
+	//編譯門檻
+	unsigned Threshold() const {
+		return threshold; }
+
+private:
+	//編譯門檻
+	unsigned threshold;
+	//數值堆疊(依原生程式碼最大深度擴充後重複使用)
+	std::vector<double> stack;
+	//共同子運算式暫存區
+	std::vector<double> temporaries;
+	//位元組碼虛擬機
+	MacroVirtualMachine machine;
+	//巨集變數存取介面
+	MacroVariableInterface& macro_variable_interface;
+};
@@ -0,0 +1,94 @@
+﻿#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <utility>
+#include "MacroBytecode.h"
+
+//運算節點索引
+using MacroNodeIndex = std::uint32_t;
+//無運算節點
+constexpr MacroNodeIndex NO_MACRO_NODE = UINT32_MAX;
+
+//索引連結的運算節點(節點種類沿用位元組碼運算碼)
+class MacroNode {
+public:
+	MacroNode(MacroOpcode c, MacroNodeIndex l, MacroNodeIndex r)
+		:opcode(c), left(l), right(r) {}
+	~MacroNode() {}
+
+	//運算碼
+	MacroOpcode opcode;
+	//左(或唯一)運算元節點,常數節點為常數表索引,常數ID變數節點為變數ID
+	MacroNodeIndex left;
+	//右運算元節點,轉換浮點數節點為最小設定單位的常數表索引
+	MacroNodeIndex right;
+};
+static_assert(sizeof(MacroNode) == 12, "MacroNode must stay a 12-byte index-linked record");
+
+//以節點索引表示的已編譯單節
+class ArenaMacroBlock {
+public:
+	ArenaMacroBlock()
+		:condition(NO_MACRO_NODE), expression(NO_MACRO_NODE), control(OP_RETURN) {}
+	~ArenaMacroBlock() {}
+
+	//條件式節點(無條件式為NO_MACRO_NODE)
+	MacroNodeIndex condition;
+	//運算式節點(分支單節為分支序號,迴圈單節為迴圈識別號碼)
+	MacroNodeIndex expression;
+	//控制指令(OP_BRANCH,OP_LOOP,OP_LOOP_END,一般運算式為OP_RETURN)
+	MacroOpcode control;
+};
+
+//運算節點記憶區(節點連續存放並以32位元索引互相參照,整批一次釋放)
+class MacroNodeArena {
+public:
+	MacroNodeArena() {}
+	~MacroNodeArena() {}
+	//由已編譯單節的運算子樹建立節點(無運算子時返回false且不保留任何節點)
+	bool Compile(const CompiledMacroBlock&, ArenaMacroBlock&);
+	//釋放所有節點
+	void Clear();
+	//核算節點
+	double Evaluate(MacroNodeIndex, MacroVariableInterface&) const;
+	//執行單節(結果與位元組碼虛擬機相同)
+	MacroBytecodeResult Run(const ArenaMacroBlock&, MacroVariableInterface&) const;
+	//取得節點
+	const MacroNode& Node(MacroNodeIndex index) const {
+		return nodes[index]; }
+	//取得常數
+	double Constant(MacroNodeIndex index) const {
+		return constants[index]; }
+	//節點數量
+	size_t Size() const {
+		return nodes.size(); }
+	//節點及常數表佔用的記憶體大小
+	size_t MemoryUsage() const {
+		return nodes.capacity() * sizeof(MacroNode) + constants.capacity() * sizeof(double); }
+
+private:
+	//加入節點
+	MacroNodeIndex Append(MacroOpcode, MacroNodeIndex, MacroNodeIndex = NO_MACRO_NODE);
+	//加入常數並返回常數表索引
+	MacroNodeIndex AppendConstant(double);
+	//建立算術運算子節點
+	MacroNodeIndex AppendArithmetic(const ArithmeticOperator*);
+	//建立關係運算子節點
+	MacroNodeIndex AppendRelational(const RelationalOperator*);
+	//建立邏輯運算子節點(左右運算元皆為布林值的OR建立為OP_OR_SHORT_CIRCUIT節點)
+	MacroNodeIndex AppendLogical(const LogicalOperator*);
+	//建立條件運算元節點(無運算元時返回NO_MACRO_NODE)
+	MacroNodeIndex AppendCondition(const ConditionOperand&);
+	//讀取變數值(變數不存在時發出警報)
+	static double ReadVariable(MacroVariableInterface&, unsigned short, const MacroNode&);
+	//寫入變數值(寫入#0時發出警報)
+	static void WriteVariable(MacroVariableInterface&, unsigned short, double, const MacroNode&);
+
+	//運算節點
+	std::vector<MacroNode> nodes;
+	//常數表
+	std::vector<double> constants;
+	//建立節點時已建立的共同子運算式及其節點
+	std::vector<std::pair<const ArithmeticOperator*, MacroNodeIndex>> shared_nodes;
+};
@@ -1,8 +1,8 @@
 ﻿#pragma once
 
 #include "MacroVariable.h"
+#include "DegreeTrigonometry.h"
 #include <memory>
-#include <numbers>
 
 //空浮點數值
 constexpr double NULL_FLOAT_VALUE = DBL_MIN;
@@ -63,8 +63,52 @@ enum MacroOperatorID {
 	//次方運算子
 	POWER,
 	//轉換浮點數運算子
-	ADD_DECIMAL_POINT
-};
+	ADD_DECIMAL_POINT,
+	//共同子運算式運算子
+	COMMON_SUBEXPRESSION
+};
+
+//關係運算子識別ID
+enum RelationalOperatorID {
+	//相等運算子
+	EQUAL,
+	//不相等運算子
+	NOT_EQUAL,
+	//大於運算子
+	GREATER,
+	//大於等於運算子
+	GREATER_EQUAL,
+	//小於運算子
+	LESS,
+	//小於等於運算子
+	LESS_EQUAL
+};
+
+//邏輯運算子識別ID
+enum LogicalOperatorID {
+	//交集運算子
+	AND,
+	//聯集運算子
+	OR,
+	//互斥運算子
+	XOR
+};
+
+//條件運算元種類
+enum ConditionOperandType {
+	//無運算元
+	NO_CONDITION_OPERAND,
+	//算術運算元
+	ARITHMETIC_CONDITION_OPERAND,
+	//關係運算元
+	RELATIONAL_CONDITION_OPERAND,
+	//邏輯運算元
+	LOGICAL_CONDITION_OPERAND
+};
+
+class MacroBytecode;
+class MacroNodeArena;
+class MacroGenerator;
 
 //算術運算子基礎類別
 class ArithmeticOperator {
@@ -90,6 +134,17 @@ protected:
 
 //一元運算子
 class UnaryOperator:public ArithmeticOperator {
+public:
+	//浮點數運算元
+	double Operand() const {
+		return operand; }
+	//運算子運算元
+	const std::shared_ptr<ArithmeticOperator>& OperandHandle() const {
+		return operand_handle; }
+	//替換為結構相同的運算子運算元(共同子運算式改寫)
+	void SetOperandHandle(const std::shared_ptr<ArithmeticOperator>& handle) {
+		operand_handle = handle; }
+
 protected:
 	UnaryOperator(MacroOperatorID id,double opr);
 	UnaryOperator(MacroOperatorID id,const std::shared_ptr<ArithmeticOperator>& opr);
@@ -105,6 +160,19 @@ protected:
 
 //二元運算子
 class BinaryOperator :public ArithmeticOperator {
+public:
+	//左運算元
+	const std::shared_ptr<ArithmeticOperator>& LeftOperand() const {
+		return left_operand; }
+	//右運算元
+	const std::shared_ptr<ArithmeticOperator>& RightOperand() const {
+		return right_operand; }
+	//替換為結構相同的左右運算元(共同子運算式改寫)
+	void SetOperands(const std::shared_ptr<ArithmeticOperator>& left, const std::shared_ptr<ArithmeticOperator>& right) {
+		left_operand = left;
+		right_operand = right;
+	}
+
 protected:
 	BinaryOperator(MacroOperatorID id, const std::shared_ptr<ArithmeticOperator>& left, const std::shared_ptr<ArithmeticOperator>& right);
 	virtual ~BinaryOperator() {}
@@ -120,49 +188,148 @@ protected:
 //關係運算子
 class RelationalOperator {
 protected:
-	RelationalOperator(const std::shared_ptr<ArithmeticOperator>&, const std::shared_ptr<ArithmeticOperator>&);
+	RelationalOperator(RelationalOperatorID, const std::shared_ptr<ArithmeticOperator>&, const std::shared_ptr<ArithmeticOperator>&);
 	virtual RelationalOperator* clone() const {
 		return new RelationalOperator(*this); }
 	virtual ~RelationalOperator() {}
 
+	//運算子ID
+	const RelationalOperatorID operator_ID;
 	double left_result;
 	double right_result;
 	std::shared_ptr<ArithmeticOperator> left_operand;
 	std::shared_ptr<ArithmeticOperator> right_operand;
 
 public:
+	//查詢運算子ID
+	RelationalOperatorID GetOperatorID() const {
+		return operator_ID; }
+	//左運算元
+	const std::shared_ptr<ArithmeticOperator>& LeftOperand() const {
+		return left_operand; }
+	//右運算元
+	const std::shared_ptr<ArithmeticOperator>& RightOperand() const {
+		return right_operand; }
+	//替換為結構相同的左右運算元(共同子運算式改寫)
+	void SetOperands(const std::shared_ptr<ArithmeticOperator>& left, const std::shared_ptr<ArithmeticOperator>& right) {
+		left_operand = left;
+		right_operand = right;
+	}
 	virtual bool Evaluate();
 };
 
+class LogicalOperator;
+
+//條件運算元(以種類標記單一運算子,用於邏輯運算子的左右運算元及條件式)
+class ConditionOperand {
+public:
+	ConditionOperand()
+		:type(NO_CONDITION_OPERAND) {}
+	ConditionOperand(const std::shared_ptr<ArithmeticOperator>&);
+	ConditionOperand(const std::shared_ptr<RelationalOperator>&);
+	ConditionOperand(const std::shared_ptr<LogicalOperator>&);
+	~ConditionOperand() {}
+
+	//是否無運算元
+	bool Empty() const {
+		return type == NO_CONDITION_OPERAND; }
+	//查詢運算元種類
+	ConditionOperandType Type() const {
+		return type; }
+	//算術運算子(種類須為ARITHMETIC_CONDITION_OPERAND)
+	ArithmeticOperator* Arithmetic() const {
+		return static_cast<ArithmeticOperator*>(handle.get()); }
+	//關係運算子(種類須為RELATIONAL_CONDITION_OPERAND)
+	RelationalOperator* Relational() const {
+		return static_cast<RelationalOperator*>(handle.get()); }
+	//邏輯運算子(種類須為LOGICAL_CONDITION_OPERAND)
+	LogicalOperator* Logical() const {
+		return static_cast<LogicalOperator*>(handle.get()); }
+	//算術運算子Handle(其他種類返回空指標)
+	std::shared_ptr<ArithmeticOperator> ArithmeticHandle() const;
+	//核算結果是否僅為0或1(關係運算元,或左右運算元皆為布林值的邏輯運算元)
+	bool Boolean() const;
+	//核算運算元(算術運算元取無號整數,關係運算元為0或1,無運算元為1)
+	unsigned Evaluate() const;
+	void Clear();
+
+private:
+	//運算元種類
+	ConditionOperandType type;
+	//運算子Handle(依種類轉換)
+	std::shared_ptr<void> handle;
+};
+
 //邏輯運算子
 class LogicalOperator {
 protected:
-	LogicalOperator(const std::shared_ptr<ArithmeticOperator>&, const std::shared_ptr<ArithmeticOperator>&);
-	LogicalOperator(const std::shared_ptr<RelationalOperator>&, const std::shared_ptr<RelationalOperator>&);
-	LogicalOperator(const std::shared_ptr<LogicalOperator>&, const std::shared_ptr<LogicalOperator>&);
+	LogicalOperator(LogicalOperatorID, const std::shared_ptr<ArithmeticOperator>&, const std::shared_ptr<ArithmeticOperator>&);
+	LogicalOperator(LogicalOperatorID, const std::shared_ptr<RelationalOperator>&, const std::shared_ptr<RelationalOperator>&);
+	LogicalOperator(LogicalOperatorID, const std::shared_ptr<LogicalOperator>&, const std::shared_ptr<LogicalOperator>&);
 
-	LogicalOperator(const std::shared_ptr<ArithmeticOperator>&, const std::shared_ptr<LogicalOperator>&);
-	LogicalOperator(const std::shared_ptr<LogicalOperator>&, const std::shared_ptr<ArithmeticOperator>&);
-	LogicalOperator(const std::shared_ptr<RelationalOperator>&, const std::shared_ptr<LogicalOperator>&);
-	LogicalOperator(const std::shared_ptr<LogicalOperator>&, const std::shared_ptr<RelationalOperator>&);
+	LogicalOperator(LogicalOperatorID, const std::shared_ptr<ArithmeticOperator>&, const std::shared_ptr<LogicalOperator>&);
+	LogicalOperator(LogicalOperatorID, const std::shared_ptr<LogicalOperator>&, const std::shared_ptr<ArithmeticOperator>&);
+	LogicalOperator(LogicalOperatorID, const std::shared_ptr<RelationalOperator>&, const std::shared_ptr<LogicalOperator>&);
+	LogicalOperator(LogicalOperatorID, const std::shared_ptr<LogicalOperator>&, const std::shared_ptr<RelationalOperator>&);
 
 	virtual LogicalOperator* clone() const {
 		return new LogicalOperator(*this); }
 	virtual ~LogicalOperator() {}
 
-	unsigned left_result;
-	unsigned right_result;
-	std::shared_ptr<LogicalOperator> left_logical;
-	std::shared_ptr<LogicalOperator> right_logical;
-	std::shared_ptr<ArithmeticOperator> left_arithmetic;
-	std::shared_ptr<ArithmeticOperator> right_arithmetic;
-	std::shared_ptr<RelationalOperator> left_relation;
-	std::shared_ptr<RelationalOperator> right_relation;
+	//運算子ID
+	const LogicalOperatorID operator_ID;
+	ConditionOperand left_operand;
+	ConditionOperand right_operand;
+	//左右運算元皆為布林值
+	const bool boolean;
 
 public:
+	//查詢運算子ID
+	LogicalOperatorID GetOperatorID() const {
+		return operator_ID; }
+	//核算結果是否僅為0或1
+	bool Boolean() const {
+		return boolean; }
+	//左運算元
+	const ConditionOperand& LeftOperand() const {
+		return left_operand; }
+	//右運算元
+	const ConditionOperand& RightOperand() const {
+		return right_operand; }
+	//替換為結構相同的左右運算元(共同子運算式改寫,不改變運算元種類)
+	void SetOperands(const ConditionOperand& left, const ConditionOperand& right) {
+		left_operand = left;
+		right_operand = right;
+	}
 	virtual unsigned Evaluate();
 };
 
+inline bool ConditionOperand::Boolean() const
+{
+	switch (type) {
+	case RELATIONAL_CONDITION_OPERAND:
+		return true;
+	case LOGICAL_CONDITION_OPERAND:
+		return Logical()->Boolean();
+	default:
+		return false;
+	}
+}
+
+inline unsigned ConditionOperand::Evaluate() const
+{
+	switch (type) {
+	case ARITHMETIC_CONDITION_OPERAND:
+		return static_cast<unsigned>(Arithmetic()->Evaluate());
+	case RELATIONAL_CONDITION_OPERAND:
+		return Relational()->Evaluate() ? 1 : 0;
+	case LOGICAL_CONDITION_OPERAND:
+		return Logical()->Evaluate();
+	default:
+		return 1;
+	}
+}
+
 //通用運算子Handle
 class GeneralOperatorHandle {
 public:
@@ -209,6 +376,14 @@ public:
 	~VariableOperator() {}
 	double Evaluate() override;
 	bool WriteVariable(double);
+	//讀取最近一次寫入的變數(不重新核算間接ID)
+	double ReadWrittenVariable();
+	//預先解析的變數存取位置(變數ID非常數時未解析)
+	const MacroVariableSlot& Slot() const {
+		return slot; }
+	//經由變數存取介面發出警報
+	void RaiseAlarm(MacroAlarmCode code, const void* node) {
+		macro_variable_interface.RaiseAlarm(code, node, variable_ID); }
 
 protected:
 	VariableOperator* clone() const override {
@@ -216,6 +391,8 @@ protected:
 
 private:
 	unsigned short variable_ID;
+	//常數ID的變數存取位置
+	MacroVariableSlot slot;
 	MacroVariableInterface& macro_variable_interface;
 };
 
@@ -225,7 +402,7 @@ public:
 	SineOperator(const std::shared_ptr<ArithmeticOperator>& operand);
 	~SineOperator() {}
 	double Evaluate() override {
-		return sin(operand_handle->Evaluate() / 180.0 * std::numbers::pi); }
+		return DegreeTrigonometry::Sine(operand_handle->Evaluate()); }
 
 protected:
 	SineOperator* clone() const override {
@@ -238,7 +415,7 @@ public:
 	CosineOperator(const std::shared_ptr<ArithmeticOperator>& operand);
 	~CosineOperator() {}
 	double Evaluate() override {
-		return cos(operand_handle->Evaluate() / 180.0 * std::numbers::pi); }
+		return DegreeTrigonometry::Cosine(operand_handle->Evaluate()); }
 
 protected:
 	CosineOperator* clone() const override {
@@ -251,7 +428,7 @@ public:
 	TangentOperator(const std::shared_ptr<ArithmeticOperator>& operand);
 	~TangentOperator() {}
 	double Evaluate() override {
-		return tan(operand_handle->Evaluate() / 180.0 * std::numbers::pi); }
+		return DegreeTrigonometry::Tangent(operand_handle->Evaluate()); }
 
 protected:
 	TangentOperator* clone() const override {
@@ -264,7 +441,7 @@ public:
 	ArcSineOperator(const std::shared_ptr<ArithmeticOperator>& operand);
 	~ArcSineOperator() {}
 	double Evaluate() override {
-		return asin(operand_handle->Evaluate()) / std::numbers::pi * 180.0; }
+		return DegreeTrigonometry::ArcSine(operand_handle->Evaluate()); }
 
 protected:
 	ArcSineOperator* clone() const override {
@@ -277,7 +454,7 @@ public:
 	ArcCosineOperator(const std::shared_ptr<ArithmeticOperator>& operand);
 	~ArcCosineOperator() {}
 	double Evaluate() override {
-		return acos(operand_handle->Evaluate()) / std::numbers::pi * 180.0; }
+		return DegreeTrigonometry::ArcCosine(operand_handle->Evaluate()); }
 
 protected:
 	ArcCosineOperator* clone() const override {
@@ -290,7 +467,7 @@ public:
 	ArcTangentOperator(const std::shared_ptr<ArithmeticOperator>& operand);
 	~ArcTangentOperator() {}
 	double Evaluate() override {
-		return atan(operand_handle->Evaluate()) / std::numbers::pi * 180.0; }
+		return DegreeTrigonometry::ArcTangent(operand_handle->Evaluate()); }
 
 protected:
 	ArcTangentOperator* clone() const override {
@@ -386,6 +563,79 @@ protected:
 		return new ExponentOperator(*this); }
 };
 
+//二進碼運算子(BCD碼轉換為二進位值)
+class BinaryCodeOperator :public UnaryOperator {
+public:
+	BinaryCodeOperator(const std::shared_ptr<ArithmeticOperator>& operand);
+	~BinaryCodeOperator() {}
+	double Evaluate() override {
+		return Convert(operand_handle->Evaluate()); }
+	//BCD碼轉換為二進位值
+	static double Convert(double);
+
+protected:
+	BinaryCodeOperator* clone() const override {
+		return new BinaryCodeOperator(*this); }
+};
+
+//二進位十進制運算子(二進位值轉換為BCD碼)
+class BinaryCodedDecimalOperator :public UnaryOperator {
+public:
+	BinaryCodedDecimalOperator(const std::shared_ptr<ArithmeticOperator>& operand);
+	~BinaryCodedDecimalOperator() {}
+	double Evaluate() override {
+		return Convert(operand_handle->Evaluate()); }
+	//二進位值轉換為BCD碼
+	static double Convert(double);
+
+protected:
+	BinaryCodedDecimalOperator* clone() const override {
+		return new BinaryCodedDecimalOperator(*this); }
+};
+
+//轉換浮點數運算子(未指定小數點的引數值以最小設定單位換算為含小數點數值)
+class AddDecimalPointOperator :public UnaryOperator {
+public:
+	AddDecimalPointOperator(const std::shared_ptr<ArithmeticOperator>& operand, double least_increment);
+	~AddDecimalPointOperator() {}
+	double Evaluate() override {
+		return operand_handle->Evaluate() / least_increment; }
+	//最小設定單位
+	double LeastIncrement() const {
+		return least_increment; }
+
+protected:
+	AddDecimalPointOperator* clone() const override {
+		return new AddDecimalPointOperator(*this); }
+
+private:
+	//最小設定單位
+	const double least_increment;
+};
+
+//共同子運算式運算子(單節內結構相同的子樹共用節點,同一核算世代僅核算一次)
+class CommonSubexpressionOperator :public UnaryOperator {
+public:
+	CommonSubexpressionOperator(MacroVariableInterface& interface, const std::shared_ptr<ArithmeticOperator>& operand, bool scope);
+	~CommonSubexpressionOperator() {}
+	double Evaluate() override;
+	//是否為核算範圍(不暫存結果)
+	bool Scope() const {
+		return scope; }
+
+protected:
+	CommonSubexpressionOperator* clone() const override {
+		return new CommonSubexpressionOperator(*this); }
+
+private:
+	//巨集變數存取介面(提供核算世代)
+	MacroVariableInterface& macro_variable_interface;
+	//核算範圍:開始新的核算世代後核算運算元,不暫存結果
+	const bool scope;
+	//暫存結果所屬的核算世代
+	unsigned long long generation;
+};
+
 //次方運算子
 class PowerOperator :public BinaryOperator {
 public:
@@ -405,7 +655,7 @@ public:
 	ArcTangent2Operator(const std::shared_ptr<ArithmeticOperator>& left_operand, const std::shared_ptr<ArithmeticOperator>& right_operand);
 	~ArcTangent2Operator() {}
 	double Evaluate() override {
-		return atan2(left_operand->Evaluate(), right_operand->Evaluate()) / std::numbers::pi * 180.0; }
+		return DegreeTrigonometry::ArcTangent2(left_operand->Evaluate(), right_operand->Evaluate()); }
 
 protected:
 	ArcTangent2Operator* clone() const override {
@@ -471,6 +721,12 @@ public:
 	AssignmentOperator(const std::shared_ptr<ArithmeticOperator>& left_operand, const std::shared_ptr<LogicalOperator>& right_operand);
 	~AssignmentOperator() {}
 	double Evaluate() override;
+	//左變數運算子
+	const VariableOperator* LeftVariable() const {
+		return left_variable; }
+	//邏輯運算子寫入值(右運算元為算術運算子時為空)
+	const std::shared_ptr<LogicalOperator>& RightLogical() const {
+		return right_logical; }
 
 private:
 	VariableOperator* left_variable;
@@ -624,13 +880,19 @@ public:
 	void Clear();
 	bool Evaluate();
 	bool Empty() const {
-		return !relational_operator && !logical_operator || !arithmetic_operator; }
+		return condition.Empty() || !arithmetic_operator; }
 	double ArithmeticValue() {
 		return arithmetic_operator->Evaluate(); }
+	//條件式
+	const ConditionOperand& Condition() const {
+		return condition; }
+	//算術運算子
+	const ArithmeticOperator* Arithmetic() const {
+		return arithmetic_operator.get(); }
 
 protected:
-	std::shared_ptr<RelationalOperator> relational_operator;
-	std::shared_ptr<LogicalOperator> logical_operator;
+	//條件式(關係或邏輯運算子)
+	ConditionOperand condition;
 	std::shared_ptr<ArithmeticOperator> arithmetic_operator;
 };
 
@@ -647,10 +909,16 @@ public:
 	bool Empty() const {
 		return arithmetic_operand ? false : true; }
 	int BranchNumber();
+	//條件式
+	const ConditionOperand& Condition() const {
+		return condition; }
+	//分支順序號碼運算子
+	const ArithmeticOperator* Arithmetic() const {
+		return arithmetic_operand.get(); }
 
 protected:
-	std::shared_ptr<RelationalOperator> relational_operand;
-	std::shared_ptr<LogicalOperator> logical_operand;
+	//條件式(無條件分支為無運算元)
+	ConditionOperand condition;
 	std::shared_ptr<ArithmeticOperator> arithmetic_operand;
 };
 
@@ -667,10 +935,16 @@ public:
 	bool Empty() const {
 		return arithmetic_operator ? false : true; }
 	unsigned short LoopNumber();
+	//條件式
+	const ConditionOperand& Condition() const {
+		return condition; }
+	//迴圈識別號碼運算子
+	const ArithmeticOperator* Arithmetic() const {
+		return arithmetic_operator.get(); }
 
 protected:
-	std::shared_ptr<RelationalOperator> relational_operator;
-	std::shared_ptr<LogicalOperator> logical_operator;
+	//條件式(無條件迴圈為無運算元)
+	ConditionOperand condition;
 	std::shared_ptr<ArithmeticOperator> arithmetic_operator;
 };
 
@@ -685,6 +959,9 @@ public:
 	unsigned short Evaluate();
 	bool Empty() const {
 		return arithmetic_operator ? false : true; }
+	//迴圈識別號碼運算子
+	const ArithmeticOperator* Arithmetic() const {
+		return arithmetic_operator.get(); }
 
 protected:
 	std::shared_ptr<ArithmeticOperator> arithmetic_operator;
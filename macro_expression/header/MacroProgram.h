@@ -0,0 +1,102 @@
+﻿#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unordered_map>
+#include <memory>
+#include <climits>
+#include "FanucMacroParser.h"
+#include "MacroBytecode.h"
+#include "MacroJit.h"
+#include "MacroNodeArena.h"
+
+//無對應單節索引
+constexpr size_t NO_PROGRAM_BLOCK = SIZE_MAX;
+//無序號或程式號碼
+constexpr int NO_SEQUENCE_NUMBER = -1;
+//序號或程式號碼超過位數上限
+constexpr int OVERFLOW_SEQUENCE_NUMBER = -2;
+//序號及程式號碼有效位數上限(不超過int範圍)
+constexpr size_t SEQUENCE_NUMBER_DIGITS_MAX = 9;
+//迴圈識別號碼最大值(DO 1-3)
+constexpr unsigned short LOOP_NUMBER_MAX = 3;
+//迴圈巢狀層數上限
+constexpr unsigned short LOOP_NESTING_MAX = 3;
+
+//程式區段字元
+constexpr char ADDRESS_PROGRAM_TAPE = '%';
+//程式號碼位址字元
+constexpr char ADDRESS_PROGRAM_NUMBER = 'O';
+//序號位址字元
+constexpr char ADDRESS_SEQUENCE_NUMBER = 'N';
+//單節跳躍字元
+constexpr char ADDRESS_BLOCK_DELETE = '/';
+
+//已編譯程式單節
+class MacroProgramBlock {
+public:
+	MacroProgramBlock(std::string_view s, int n, bool d)
+		:text(s), sequence_number(n), block_delete(d), command_type(INVALID_COMMAND), loop_pair(NO_PROGRAM_BLOCK), branch_target(NO_PROGRAM_BLOCK) {}
+	~MacroProgramBlock() {}
+
+	//單節內容(不含單節跳躍字元及序號)
+	std::string text;
+	//序號(無序號為NO_SEQUENCE_NUMBER)
+	int sequence_number;
+	//單節跳躍旗標
+	bool block_delete;
+	//剖析結果指令類型(NC單節及不合法單節為INVALID_COMMAND)
+	CommandType command_type;
+	//程式節點記憶區內的已編譯單節
+	ArenaMacroBlock statement;
+	//位元組碼(NC單節及不合法單節為空)
+	MacroBytecode bytecode;
+	//JIT單節狀態(執行時更新,位元組碼重新編譯時清除)
+	mutable MacroJitBlock jit;
+	//配對迴圈單節索引(DO指向END,END指向DO,其餘為NO_PROGRAM_BLOCK)
+	size_t loop_pair;
+	//預先解析的分支目標單節索引(分支序號非常數或不存在時為NO_PROGRAM_BLOCK)
+	size_t branch_target;
+};
+
+//已編譯巨集程式(單節陣列,序號索引,迴圈配對及分支目標)
+class MacroProgram {
+public:
+	MacroProgram();
+	~MacroProgram() {}
+	//編譯整個O程式(程式號碼超過位數上限,迴圈識別號碼不合法,DO/END未配對或巢狀超過3層時返回false)
+	bool Compile(std::string_view program, FanucMacroParser&);
+	//清除已編譯程式
+	void Clear();
+	//程式號碼(無程式號碼為NO_SEQUENCE_NUMBER)
+	int ProgramNumber() const {
+		return program_number; }
+	//已編譯單節陣列
+	const std::vector<MacroProgramBlock>& Blocks() const {
+		return blocks; }
+	//查詢序號所在單節索引(重複序號取第一個單節,不存在時返回NO_PROGRAM_BLOCK)
+	size_t FindSequence(int sequence_number) const;
+	//程式節點記憶區(所有單節共用,運算子樹於編譯後釋放)
+	const MacroNodeArena& Arena() const {
+		return arena; }
+
+private:
+	//擷取單節開頭的數字(無數字時返回NO_SEQUENCE_NUMBER,有效位數超過上限時返回OVERFLOW_SEQUENCE_NUMBER)
+	static int ExtractNumber(std::string_view&);
+	//配對DO/END單節
+	bool MatchLoops();
+	//預先解析常數分支目標
+	void ResolveBranches();
+	//取得單節的常數運算式值(分支序號或迴圈識別號碼),非常數時返回false
+	bool ConstantExpression(const ArenaMacroBlock&, double&) const;
+
+	//程式號碼
+	int program_number;
+	//已編譯單節陣列
+	std::vector<MacroProgramBlock> blocks;
+	//程式節點記憶區
+	MacroNodeArena arena;
+	//序號索引
+	std::unordered_map<int, size_t> sequence_index;
+};
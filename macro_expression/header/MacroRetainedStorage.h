@@ -0,0 +1,115 @@
+﻿#pragma once
+
+#include <string>
+#include <cstddef>
+#include <cstdint>
+
+//保存變數檔案識別碼
+constexpr std::uint32_t RETAINED_FILE_MAGIC = 0x5652434E;
+//保存變數檔案格式版本
+constexpr std::uint32_t RETAINED_FILE_VERSION = 1;
+//保存變數檔案區段對齊大小(標頭區及各資料區起始位置)
+constexpr size_t RETAINED_SECTION_SIZE = 4096;
+//兩份標頭的間隔(分置於不同磁區,寫入中斷不會同時損毀兩份標頭)
+constexpr size_t RETAINED_HEADER_STRIDE = 2048;
+
+//保存變數映射檔開啟結果
+enum MacroRetainedState :unsigned char {
+	//未開啟(使用記憶體)
+	RETAINED_CLOSED,
+	//建立新檔案(無有效檢查點或變數範圍不符)
+	RETAINED_CREATED,
+	//資料與最新檢查點一致
+	RETAINED_CONSISTENT,
+	//資料與檢查點不一致(檢查點後寫入或中斷),已還原至最新有效檢查點
+	RETAINED_RESTORED };
+
+//保存變數檔案標頭(直接映射至檔案,保持可平凡複製;兩份依檢查點序號交替寫入)
+class MacroRetainedHeader {
+public:
+	//識別碼
+	std::uint32_t magic;
+	//格式版本
+	std::uint32_t version;
+	//起始變數編號
+	std::uint32_t begin_ID;
+	//變數數量
+	std::uint32_t count;
+	//檢查點序號(兩份標頭及檢查點區依序號奇偶交替)
+	std::uint64_t sequence;
+	//檢查點區資料檢查碼
+	std::uint64_t data_checksum;
+	//標頭檢查碼(不含本欄位)
+	std::uint64_t header_checksum;
+};
+
+//保存變數記憶體映射檔(變數值常駐於映射區,寫入為一般記憶體寫入;檢查點以雙份資料區及雙份標頭保存,中斷後還原至最新有效檢查點)
+class MacroRetainedStorage {
+public:
+	MacroRetainedStorage();
+	MacroRetainedStorage(const MacroRetainedStorage&) = delete;
+	MacroRetainedStorage& operator=(const MacroRetainedStorage&) = delete;
+	~MacroRetainedStorage();
+	//開啟或建立映射檔(新檔案以初值填滿,失敗時返回false並維持關閉)
+	bool Open(const std::string& path, unsigned short begin_ID, unsigned short end_ID, double initial_value);
+	//建立檢查點:寫回變數值,複製至非目前檢查點的資料區,再寫入對應標頭
+	bool Checkpoint();
+	//建立檢查點後關閉映射檔
+	void Close();
+	//是否已開啟
+	bool IsOpen() const {
+		return data != nullptr; }
+	//映射的變數值(依變數編號順序,關閉時為nullptr)
+	double* Data() {
+		return data; }
+	//開啟結果
+	MacroRetainedState State() const {
+		return state; }
+	//最新檢查點序號
+	std::uint64_t Sequence() const {
+		return sequence; }
+
+private:
+	//資料檢查碼(FNV-1a)
+	static std::uint64_t Checksum(const void*, size_t);
+	//標頭檢查碼
+	static std::uint64_t HeaderChecksum(const MacroRetainedHeader&);
+	//標頭位置(依序號奇偶)
+	MacroRetainedHeader* Header(std::uint64_t header_sequence) {
+		return reinterpret_cast<MacroRetainedHeader*>(base + header_sequence % 2 * RETAINED_HEADER_STRIDE); }
+	//檢查點資料區(依序號奇偶)
+	double* CheckpointData(std::uint64_t checkpoint_sequence) {
+		return reinterpret_cast<double*>(base + RETAINED_SECTION_SIZE + (1 + checkpoint_sequence % 2) * section_size); }
+	//標頭是否有效(識別碼,版本,變數範圍,標頭及檢查點區檢查碼皆正確)
+	bool ValidHeader(std::uint64_t slot);
+	//寫回映射區範圍至檔案
+	bool Flush(void*, size_t);
+	//解除映射並關閉檔案(不建立檢查點)
+	void Unmap();
+
+	//映射區起始位址
+	unsigned char* base;
+	//映射區大小
+	size_t mapped_size;
+	//每個資料區大小(對齊RETAINED_SECTION_SIZE)
+	size_t section_size;
+	//目前變數值
+	double* data;
+	//變數數量
+	size_t count;
+	//起始變數編號
+	unsigned short begin_ID;
+	//最新檢查點序號
+	std::uint64_t sequence;
+	//開啟結果
+	MacroRetainedState state;
+#ifdef _WIN32
+	//檔案代碼
+	void* file;
+	//映射物件代碼
+	void* mapping;
+#else
+	//檔案描述子
+	int file;
+#endif
+};
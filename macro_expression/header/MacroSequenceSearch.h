@@ -0,0 +1,71 @@
+﻿#pragma once
+
+#include <array>
+#include <unordered_map>
+#include "MacroProgram.h"
+
+//序號搜尋記錄快取容量(依分支單節索引及分支序號直接對應)
+constexpr size_t SEQUENCE_HISTORY_SIZE = 16;
+
+//序號搜尋記錄(分支單節,分支序號及目標單節)
+class MacroSequenceHistory {
+public:
+	MacroSequenceHistory()
+		:branch_block(NO_PROGRAM_BLOCK), sequence_number(NO_SEQUENCE_NUMBER), target(NO_PROGRAM_BLOCK) {}
+	~MacroSequenceHistory() {}
+
+	//分支單節索引
+	size_t branch_block;
+	//分支序號
+	int sequence_number;
+	//目標單節索引
+	size_t target;
+};
+
+//序號搜尋統計(各快取命中次數及逐單節搜尋次數)
+class MacroSequenceStatistics {
+public:
+	MacroSequenceStatistics()
+		:fixed_hits(0), history_hits(0), variable_hits(0), scans(0) {}
+	~MacroSequenceStatistics() {}
+
+	//固定快取命中(常數序號於載入時解析)
+	unsigned long long fixed_hits;
+	//搜尋記錄快取命中
+	unsigned long long history_hits;
+	//變動快取命中(變數序號)
+	unsigned long long variable_hits;
+	//逐單節搜尋
+	unsigned long long scans;
+};
+
+//GOTO序號搜尋(依系統參數的sequence_cache_fixed,sequence_cache_variable,sequence_cache_history啟用各快取,皆未命中時逐單節搜尋)
+class MacroSequenceSearch {
+public:
+	MacroSequenceSearch(SystemParameter&);
+	~MacroSequenceSearch() {}
+	//載入已編譯程式並清除快取
+	void Load(const MacroProgram&);
+	//清除快取及統計
+	void Clear();
+	//查詢分支單節的目標單節索引(重複序號取第一個單節,不存在或序號小於1時返回NO_PROGRAM_BLOCK)
+	size_t Find(size_t branch_block, int sequence_number);
+	//搜尋統計
+	const MacroSequenceStatistics& Statistics() const {
+		return statistics; }
+
+private:
+	//逐單節搜尋序號
+	size_t Scan(int sequence_number) const;
+
+	//搜尋中的程式
+	const MacroProgram* program;
+	//變動快取(分支序號,目標單節索引)
+	std::unordered_map<int, size_t> variable_cache;
+	//搜尋記錄快取
+	std::array<MacroSequenceHistory, SEQUENCE_HISTORY_SIZE> history;
+	//搜尋統計
+	MacroSequenceStatistics statistics;
+	//系統參數(序號快取設定)
+	SystemParameter& system_parameter;
+};
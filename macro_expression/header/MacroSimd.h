@@ -0,0 +1,40 @@
+﻿#pragma once
+
+//x86處理器的AVX2向量核心
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define MACRO_SIMD_X86
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+//MSVC可直接使用AVX2內建函式(含SVML的_mm256_pow_pd等)
+#define MACRO_TARGET_AVX2
+#else
+//GCC/Clang僅對AVX2核心函式啟用AVX2指令
+#define MACRO_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+//處理器及作業系統是否支援AVX2
+inline bool MacroSimdSupported()
+{
+#if defined(MACRO_SIMD_X86) && defined(_MSC_VER)
+	static const bool supported([]() {
+		int info[4];
+		__cpuid(info, 0);
+		if (info[0] < 7) {
+			return false; }
+		//作業系統須保存YMM暫存器(OSXSAVE及AVX)
+		__cpuid(info, 1);
+		if ((info[2] & (1 << 27)) == 0 || (info[2] & (1 << 28)) == 0 || (_xgetbv(0) & 6) != 6) {
+			return false; }
+		__cpuidex(info, 7, 0);
+		return (info[1] & (1 << 5)) != 0;
+	}());
+	return supported;
+#elif defined(MACRO_SIMD_X86)
+	static const bool supported(__builtin_cpu_supports("avx2"));
+	return supported;
+#else
+	return false;
+#endif
+}
@@ -0,0 +1,50 @@
+﻿#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include "MacroBytecode.h"
+#include "MacroProgram.h"
+
+//轉譯函式(以變數存取介面執行單節,結果與位元組碼虛擬機相同)
+using MacroTranspiledFunction = MacroBytecodeResult (*)(MacroVariableInterface&);
+
+//轉譯程式的單節表項目
+class MacroTranspiledBlock {
+public:
+	MacroTranspiledBlock(int n, MacroTranspiledFunction f)
+		:sequence_number(n), function(f) {}
+	~MacroTranspiledBlock() {}
+
+	//序號(無序號為NO_SEQUENCE_NUMBER)
+	int sequence_number;
+	//轉譯函式(NC單節及不合法單節為nullptr)
+	MacroTranspiledFunction function;
+};
+
+//轉譯程式碼的執行期支援(警報行為與位元組碼虛擬機相同,警報不記錄發生節點)
+class MacroTranspiledRuntime {
+public:
+	//讀取變數值(變數不存在時發出警報並返回空值)
+	static double ReadVariable(MacroVariableInterface&, unsigned short);
+	//寫入變數值後讀回(寫入#0時發出警報)
+	static double AssignVariable(MacroVariableInterface&, unsigned short, double);
+};
+
+//巨集程式轉譯器(將已編譯程式的位元組碼轉譯為C++翻譯單元,供模擬器預先編譯)
+class MacroTranspiler {
+public:
+	//轉譯整個程式:於命名空間name內產生各單節函式、單節表及程式號碼(名稱不是合法識別字時返回false)
+	static bool Transpile(const MacroProgram&, std::string_view name, std::string& source);
+	//轉譯單節位元組碼為函式定義(附加至source,位元組碼為空時返回false)
+	static bool TranspileBytecode(const MacroBytecode&, std::string_view function_name, std::string& source);
+	//以相同輸入比對轉譯函式與位元組碼虛擬機:逐單節比對結果、警報及指定變數(位元相同),返回第一個不符的單節索引,全部相符時返回NO_PROGRAM_BLOCK
+	static size_t Validate(const MacroProgram&, const MacroTranspiledBlock* blocks, size_t block_count,
+		MacroVariableInterface& interpreted, MacroVariableInterface& transpiled, const std::vector<unsigned short>& variables);
+
+private:
+	//是否為合法C++識別字
+	static bool Identifier(std::string_view);
+	//以十六進位浮點數表示常數(保留全部位元)
+	static std::string Literal(double);
+};
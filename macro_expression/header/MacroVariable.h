@@ -2,14 +2,163 @@
 
 #include <vector>
 #include <list>
-#include <stack>
+#include <array>
 #include <map>
+#include <memory>
 #include <cfloat>
+#include <climits>
 #include <utility>
+#include <cstdlib>
+#include <string>
 #include "ControllerParameter.h"
+#include "MacroRetainedStorage.h"
+
+//是否啟用C++例外(-fno-exceptions編譯時停用,核算錯誤一律以警報狀態回報)
+#if defined(__cpp_exceptions) || defined(_CPPUNWIND)
+#define MACRO_EXCEPTIONS 1
+#define MACRO_THROW(exception) throw exception
+#else
+#define MACRO_EXCEPTIONS 0
+//停用例外時僅用於建構錯誤等程式錯誤
+#define MACRO_THROW(exception) std::abort()
+#endif
 
 //空變數值
 constexpr double NULL_VARIABLE = DBL_MIN;
+//不合法的變數ID(負值、小數或超過範圍的核算結果,不對應任何變數)
+constexpr unsigned short INVALID_VARIABLE_ID = USHRT_MAX;
+
+//核算結果轉換為變數ID(空值視為#0,非0~65534的整數時返回INVALID_VARIABLE_ID,不以超出範圍的值轉型)
+inline unsigned short VariableID(double value)
+{
+	if (value == NULL_VARIABLE) {
+		return 0; }
+	if (!(value >= 0.0 && value < INVALID_VARIABLE_ID)) {
+		return INVALID_VARIABLE_ID; }
+	unsigned short variable_ID(static_cast<unsigned short>(value));
+	return static_cast<double>(variable_ID) == value ? variable_ID : INVALID_VARIABLE_ID;
+}
+
+//巨集警報碼
+enum MacroAlarmCode :unsigned char {
+	//無警報
+	ALARM_NONE,
+	//變數不存在
+	ALARM_VARIABLE_NOT_EXIST,
+	//寫入唯讀變數(#0)
+	ALARM_READ_ONLY_VARIABLE,
+	//運算元為空
+	ALARM_NULL_OPERAND,
+	//節點不是運算子
+	ALARM_INVALID_NODE,
+	//DO/END不配對或迴圈巢狀超過3層
+	ALARM_LOOP_NESTING,
+	//迴圈執行次數超過監視上限
+	ALARM_LOOP_WATCHDOG,
+	//分支序號不存在
+	ALARM_SEQUENCE_NOT_EXIST };
+
+//巨集警報(發生警報的節點及變數ID)
+class MacroAlarm {
+public:
+	MacroAlarm()
+		:code(ALARM_NONE), variable_ID(0), node(nullptr) {}
+	MacroAlarm(MacroAlarmCode c, const void* n, unsigned short id)
+		:code(c), variable_ID(id), node(n) {}
+	~MacroAlarm() {}
+
+	//警報碼
+	MacroAlarmCode code;
+	//相關變數ID
+	unsigned short variable_ID;
+	//發生警報的運算子、位元組碼指令、運算節點或程式單節
+	const void* node;
+};
+
+//預先解析的變數存取位置類型
+enum MacroVariableSlotType :unsigned char {
+	//未解析(依變數ID動態查詢)
+	SLOT_UNRESOLVED,
+	//變數不存在
+	SLOT_NOT_EXIST,
+	//局部變數(依目前變數層讀寫)
+	SLOT_LOCAL,
+	//共同變數
+	SLOT_COMMON,
+	//短整數系統變數
+	SLOT_SYSTEM_UNSIGNED_SHORT,
+	//整數系統變數
+	SLOT_SYSTEM_INT,
+	//浮點數系統變數
+	SLOT_SYSTEM_DOUBLE,
+	//唯讀浮點數系統變數(機械及工件座標位置)
+	SLOT_SYSTEM_READ_ONLY,
+	//分岔介面的共同變數(與快照共享分頁,寫入時複製)
+	SLOT_COMMON_PAGE,
+	//分岔介面的系統變數(與快照共享系統參數,首次寫入時複製)
+	SLOT_SYSTEM_FORK };
+
+//預先解析的變數存取位置(常數ID於建立運算子時解析)
+class MacroVariableSlot {
+public:
+	MacroVariableSlot()
+		:type(SLOT_UNRESOLVED), variable_ID(0), value(nullptr) {}
+	~MacroVariableSlot() {}
+	//是否已解析
+	bool Resolved() const {
+		return type != SLOT_UNRESOLVED; }
+
+	//存取位置類型
+	MacroVariableSlotType type;
+	//變數ID
+	unsigned short variable_ID;
+	//共同變數及系統變數的存放位址
+	union {
+		double* value;
+		unsigned short* value_unsigned_short;
+		int* value_int;
+	};
+};
+
+//變數編號範圍(含起訖編號)
+class MacroVariableRange {
+public:
+	MacroVariableRange(unsigned short begin, unsigned short end)
+		:begin_ID(begin), end_ID(end) {}
+	~MacroVariableRange() {}
+	//是否包含變數編號
+	bool Contains(unsigned short variable_ID) const {
+		return variable_ID >= begin_ID && variable_ID <= end_ID; }
+
+	//起始變數編號
+	unsigned short begin_ID;
+	//末尾變數編號
+	unsigned short end_ID;
+};
+
+//巨集變數配置(共同變數範圍,預設為#100-#199及#500-#999;可指定高共同變數範圍的保存映射檔)
+class MacroVariableLayout {
+public:
+	MacroVariableLayout()
+		:common_lower(100, 199), common_higher(500, 999) {}
+	~MacroVariableLayout() {}
+
+	//是否為共同變數
+	bool Common(unsigned short variable_ID) const {
+		return common_lower.Contains(variable_ID) || common_higher.Contains(variable_ID); }
+
+	//低共同變數範圍
+	MacroVariableRange common_lower;
+	//高共同變數範圍
+	MacroVariableRange common_higher;
+	//高共同變數保存映射檔路徑(空字串為不保存,斷電後清除;檢查點間的寫入於斷電後還原為前一檢查點)
+	std::string retained_file;
+};
+
+//共同變數快照分頁容量(寫入時複製的單位)
+constexpr unsigned short MACRO_VARIABLE_PAGE_SIZE = 64;
+//共同變數快照分頁(索引為變數編號除以分頁容量的餘數,非共同變數為空值)
+using MacroVariablePage = std::array<double, MACRO_VARIABLE_PAGE_SIZE>;
 
 //變數群
 class Variable {
@@ -22,6 +171,12 @@ public:
 	bool ReadVariable(unsigned short, double&);
 	//寫入變數值
 	bool WriteVariable(unsigned short, double&);
+	//變數值存放位址(變數不存在時返回nullptr)
+	double* Address(unsigned short variable_ID) {
+		return InquiryVariableID(variable_ID) ? &variable_table[static_cast<std::vector<double>::size_type>(variable_ID - begin_ID)] : nullptr; }
+	//末尾變數編號
+	unsigned short LastVariableID() const {
+		return end_ID; }
 
 private:
 	//起始變數編號
@@ -32,13 +187,154 @@ private:
 	std::vector<double> variable_table;
 };
 
+//局部變數數量(#0-#33)
+constexpr unsigned short LOCAL_VARIABLE_COUNT = 34;
+//局部變數層初值(索引為變數編號,未指定的引數為空值)
+using LocalVariableValues = std::array<double, LOCAL_VARIABLE_COUNT>;
+
+//局部變數層框架(#0-#33固定配置)
+class LocalVariableFrame {
+public:
+	LocalVariableFrame() {
+		Clear(); }
+	~LocalVariableFrame() {}
+	//查詢變數是否存在
+	bool InquiryVariableID(unsigned short variable_ID) const {
+		return variable_ID < LOCAL_VARIABLE_COUNT; }
+	//讀取變數值
+	bool ReadVariable(unsigned short, double&) const;
+	//寫入變數值
+	bool WriteVariable(unsigned short, double&);
+	//變數值存放位址(變數不存在時返回nullptr)
+	double* Address(unsigned short variable_ID) {
+		return InquiryVariableID(variable_ID) ? &variable_table[variable_ID] : nullptr; }
+	//所有變數設為空值
+	void Clear() {
+		variable_table.fill(NULL_VARIABLE); }
+	//所有變數值
+	const LocalVariableValues& Values() const {
+		return variable_table; }
+	//以引數陣列設定所有變數初值(#0恆為空值)
+	void Assign(const LocalVariableValues& values) {
+		variable_table = values;
+		variable_table[0] = NULL_VARIABLE;
+	}
+
+private:
+	//變數總表
+	LocalVariableValues variable_table;
+};
+
+//局部變數層框架指標堆疊(容量於建構時固定,推入時不配置記憶體)
+class LocalVariableFrameStack {
+public:
+	LocalVariableFrameStack(size_t capacity)
+		:frames(capacity, nullptr), depth(0) {}
+	~LocalVariableFrameStack() {}
+	//推入框架指標(超出容量時返回false)
+	bool Push(LocalVariableFrame* frame) {
+		if (depth == frames.size()) {
+			return false; }
+		frames[depth++] = frame;
+		return true;
+	}
+	//移除頂端框架指標
+	void Pop() {
+		--depth; }
+	//頂端框架指標
+	LocalVariableFrame* Top() const {
+		return frames[depth - 1]; }
+	//指定位置的框架指標(0為底層)
+	LocalVariableFrame* At(size_t index) const {
+		return frames[index]; }
+	bool Empty() const {
+		return depth == 0; }
+	size_t Size() const {
+		return depth; }
+
+private:
+	//框架指標
+	std::vector<LocalVariableFrame*> frames;
+	//堆疊深度
+	size_t depth;
+};
+
+//局部變數層框架池(依最大總變數層數預先配置,G65/G66呼叫及返回時僅取用及歸還框架)
+class LocalVariableFramePool {
+public:
+	LocalVariableFramePool(size_t capacity);
+	~LocalVariableFramePool() {}
+	//取用框架並以引數設定初值(無可用框架或引數含#0時返回nullptr)
+	LocalVariableFrame* Acquire(std::map<unsigned short, double>&);
+	//取用框架並複製引數陣列(無可用框架時返回nullptr)
+	LocalVariableFrame* Acquire(const LocalVariableValues&);
+	//歸還框架
+	void Release(LocalVariableFrame* frame) {
+		free_frames.Push(frame); }
+	//框架總數
+	size_t Capacity() const {
+		return frames.size(); }
+	//可用框架數
+	size_t Available() const {
+		return free_frames.Size(); }
+
+private:
+	//取出可用框架(無可用框架時返回nullptr)
+	LocalVariableFrame* Take();
+
+	//框架容器(建構後不再增減,框架位址固定)
+	std::vector<LocalVariableFrame> frames;
+	//可用框架
+	LocalVariableFrameStack free_frames;
+};
+
+//變數層框架指標堆疊種類(快照依此保存各堆疊)
+enum LocalVariableStack :unsigned char {
+	//局部變數層容器
+	STACK_LOCAL_LEVEL,
+	//變數層指標清單
+	STACK_LEVEL_LIST,
+	//模式層容器
+	STACK_MODAL_LEVEL,
+	//下一模式層清單
+	STACK_NEXT_MODAL_LEVEL,
+	//上一模式層清單
+	STACK_PREVIOUS_MODAL_LEVEL,
+	//堆疊種類數
+	STACK_COUNT };
+
+//局部及模式變數層快照(G65/G66呼叫中的所有框架,各堆疊以框架索引記錄)
+class LocalVariableLevels {
+public:
+	LocalVariableLevels() {}
+	~LocalVariableLevels() {}
+	//保存堆疊(同一框架於各堆疊共用索引,首次出現時保存變數值)
+	void Capture(LocalVariableStack, const LocalVariableFrameStack&);
+	//目前變數層的變數值
+	const LocalVariableValues& CurrentValues() const {
+		return frames[stacks[STACK_LEVEL_LIST].back()]; }
+
+	//框架變數值
+	std::vector<LocalVariableValues> frames;
+	//各堆疊的框架索引(由底層至頂端)
+	std::array<std::vector<size_t>, STACK_COUNT> stacks;
+
+private:
+	//已保存的框架位址(僅於保存時比對)
+	std::vector<const LocalVariableFrame*> addresses;
+};
+
 //模式變數層
 class ModalVariableLevel {
 public:
-	ModalVariableLevel() {}
+	ModalVariableLevel(LocalVariableFramePool&);
 	~ModalVariableLevel() {}
 	//建立模式層
-	bool CreateModalLevel(std::map<unsigned short, double>&);
+	bool CreateModalLevel(std::map<unsigned short, double>& arguments) {
+		return PushModalLevel(frame_pool.Acquire(arguments)); }
+	//以引數陣列建立模式層
+	bool CreateModalLevel(const LocalVariableValues& arguments) {
+		return PushModalLevel(frame_pool.Acquire(arguments)); }
 	//刪除模式層
 	bool DeleteModalLevel();
 	//進入模式層
@@ -47,21 +343,30 @@ public:
 	bool ExitModalLevel();
 	//是否須進行模式巨集呼叫
 	bool NextModalCall()const { 
-		return !next_modal_level.empty(); }
+		return !next_modal_level.Empty(); }
 	//模式層總數
-	std::stack<Variable>::size_type TotalLevel()const {
-		return modal_level.size(); }
+	size_t TotalLevel()const {
+		return modal_level.Size(); }
 	//取得下一模式層變數群指標
-	Variable* NextModalVariable() { 
-		return next_modal_level.top(); }
+	LocalVariableFrame* NextModalVariable() { 
+		return next_modal_level.Empty() ? nullptr : next_modal_level.Top(); }
+	//保存模式層容器及模式層清單
+	void Capture(LocalVariableLevels&) const;
+	//以快照還原模式層容器及模式層清單(frames為快照框架對應的已取用框架)
+	void Restore(const LocalVariableLevels&, const std::vector<LocalVariableFrame*>& frames);
 
 private:
+	//新增已取用框架的模式層
+	bool PushModalLevel(LocalVariableFrame*);
+
+	//框架池
+	LocalVariableFramePool& frame_pool;
 	//模式層容器
-	std::stack<Variable> modal_level;
+	LocalVariableFrameStack modal_level;
 	//下一模式層清單
-	std::stack<Variable*> next_modal_level;
+	LocalVariableFrameStack next_modal_level;
 	//上一模式層清單
-	std::stack<Variable*> previous_modal_level;
+	LocalVariableFrameStack previous_modal_level;
 };
 
 //局部變數群
@@ -70,50 +375,70 @@ public:
 	LocalVariable(unsigned short level_max);
 	~LocalVariable() {}
 	//查詢變數是否存在
-	bool InquiryVariableID(unsigned short variable_ID) {
-		return variable_list.top()->InquiryVariableID(variable_ID); }
+	bool InquiryVariableID(unsigned short variable_ID) const {
+		return current_frame->InquiryVariableID(variable_ID); }
 	//讀取變數值
-	bool ReadVariable(unsigned short variable_ID, double& value) {
-		return variable_list.top()->ReadVariable(variable_ID, value); }
+	bool ReadVariable(unsigned short variable_ID, double& value) const {
+		return current_frame->ReadVariable(variable_ID, value); }
 	//寫入變數值
 	bool WriteVariable(unsigned short variable_ID, double& value) {
-		return variable_list.top()->WriteVariable(variable_ID, value); }
+		return current_frame->WriteVariable(variable_ID, value); }
+	//目前變數層的變數值存放位址
+	double* Address(unsigned short variable_ID) {
+		return current_frame->Address(variable_ID); }
 	//進入局部變數層
 	bool EnterLevel(std::map<unsigned short, double>& arguments) {
-		return CreateVariable(arguments); }
+		return CreateVariable(frame_pool.Acquire(arguments)); }
+	//以引數陣列進入局部變數層
+	bool EnterLevel(const LocalVariableValues& arguments) {
+		return CreateVariable(frame_pool.Acquire(arguments)); }
 	//退出局部變數層
 	bool ExitLevel();
 	//進入模式變數層
-	bool EnterModalLevel(Variable*);
+	bool EnterModalLevel(LocalVariableFrame*);
 	//退出模式變數層
 	bool ExitModalLevel();
 
 	//查詢總變數層數
-	std::stack<Variable>::size_type TotalLevel() const {
-		return local_variable.size(); }
+	size_t TotalLevel() const {
+		return local_variable.Size(); }
 	//查詢最大總變數層數
 	unsigned short TotalLevelMax()const { 
 		return variable_level_max + 1; }
 
-	std::stack<Variable*>::size_type CurrentLevel() const {
-		return variable_list.size();
+	size_t CurrentLevel() const {
+		return variable_list.Size();
 	}
+	//局部及模式變數層共用的框架池
+	LocalVariableFramePool& FramePool() {
+		return frame_pool; }
+	//目前變數層的所有變數值
+	const LocalVariableValues& CurrentValues() const {
+		return current_frame->Values(); }
+	//保存局部變數層容器及變數層指標清單
+	void Capture(LocalVariableLevels&) const;
+	//以快照還原所有局部及模式變數層(捨棄目前的變數層)
+	void Restore(const LocalVariableLevels&, ModalVariableLevel&);
 
 private:
 	//最大變數層數
 	const unsigned short variable_level_max;
+	//框架池(最大總變數層數個框架)
+	LocalVariableFramePool frame_pool;
 	//局部變數層容器
-	std::stack<Variable> local_variable;
+	LocalVariableFrameStack local_variable;
 	//變數層指標清單
-	std::stack<Variable*> variable_list;
-	//建立新變數層
-	bool CreateVariable(std::map<unsigned short, double>&);
+	LocalVariableFrameStack variable_list;
+	//目前變數層
+	LocalVariableFrame* current_frame;
+	//以已取用框架建立新變數層
+	bool CreateVariable(LocalVariableFrame*);
 };
 
 //共用變數群
 class CommonVariable {
 public:
-	CommonVariable(unsigned short, unsigned short, unsigned short, unsigned short);
+	CommonVariable(unsigned short, unsigned short, unsigned short, unsigned short, const std::string& retained_file = std::string());
 	~CommonVariable() {}
 	//查詢變數存在否
 	bool InquiryVariableID(unsigned short);
@@ -121,60 +446,177 @@ public:
 	bool ReadVariable(unsigned short, double&);
 	//寫入變數值
 	bool WriteVariable(unsigned short, double&);
+	//變數值存放位址(變數不存在時返回nullptr)
+	double* Address(unsigned short);
+	//最大變數編號
+	unsigned short LastVariableID() const {
+		return higher_variable.LastVariableID() > lower_variable.LastVariableID() ? higher_variable.LastVariableID() : lower_variable.LastVariableID(); }
+	//高變數群保存映射檔
+	MacroRetainedStorage& RetainedStorage() {
+		return retained_storage; }
+	const MacroRetainedStorage& RetainedStorage() const {
+		return retained_storage; }
 
 private:
 	//低變數群
 	Variable lower_variable;
-	//高變數群
+	//高變數群(開啟保存映射檔時不使用)
 	Variable higher_variable;
+	//高變數群保存映射檔(開啟時高變數群常駐於映射區)
+	MacroRetainedStorage retained_storage;
+	//高變數群起始編號
+	unsigned short higher_begin_ID;
 };
 
 //系統變數群
+//系統變數起始編號
+constexpr unsigned short SYSTEM_VARIABLE_BEGIN = 1000;
+//刀具補正系統變數基準編號(#2001起依補正號碼對應)
+constexpr unsigned short SYSTEM_VARIABLE_TOOL_OFFSET = 2000;
+//機械座標位置系統變數起始編號(#5021-#5024)
+constexpr unsigned short SYSTEM_VARIABLE_MACHINE_POSITION = 5021;
+//工件座標位置系統變數起始編號(#5041-#5044)
+constexpr unsigned short SYSTEM_VARIABLE_PROGRAM_POSITION = 5041;
+//G54工作座標系原點系統變數起始編號(#5221-#5224,G55-G59每組遞增20)
+constexpr unsigned short SYSTEM_VARIABLE_WORK_OFFSET = 5221;
+//工作座標系原點系統變數每組間隔
+constexpr unsigned short SYSTEM_VARIABLE_WORK_OFFSET_STEP = 20;
+
 class SystemVariable {
 public:
 	SystemVariable(SystemParameter&);
 	~SystemVariable() {}
+	//連結系統參數(重新建立登錄表,先前解析的存取位置失效)
+	void Bind(SystemParameter&);
 	//查詢變數是否存在
-	bool InquiryVariableID(unsigned short);
+	bool InquiryVariableID(unsigned short variable_ID) const {
+		return Entry(variable_ID).type != SLOT_NOT_EXIST; }
 	//讀取變數值
 	bool ReadVariable(unsigned short, double&);
-	//寫入變數值
+	//寫入變數值(唯讀變數返回false)
 	bool WriteVariable(unsigned short, double&);
+	//解析系統參數存放位址
+	bool ResolveVariable(unsigned short, MacroVariableSlot&);
+	//最大變數編號
+	unsigned short LastVariableID() const {
+		return static_cast<unsigned short>(SYSTEM_VARIABLE_BEGIN + registry.size() - 1); }
+	//系統參數群
+	const SystemParameter& Parameter() const {
+		return *system_parameter; }
+	SystemParameter& Parameter() {
+		return *system_parameter; }
 
 private:
-	//系統參數群
-	SystemParameter& system_parameter;
-	//短整數表格
-	std::map<unsigned short, unsigned short*> table_unsigned_short;
-	//整數表格
-	std::map<unsigned short, int*> table_int;
-	//浮點數表格
-	std::map<unsigned short, double*> table_double;
+	//查詢登錄表(未登錄的編號類型為SLOT_NOT_EXIST)
+	const MacroVariableSlot& Entry(unsigned short variable_ID) const {
+		return variable_ID >= SYSTEM_VARIABLE_BEGIN && static_cast<size_t>(variable_ID - SYSTEM_VARIABLE_BEGIN) < registry.size() ? registry[variable_ID - SYSTEM_VARIABLE_BEGIN] : not_exist_slot; }
+	//登錄變數存取位置
+	void Register(unsigned short, MacroVariableSlotType, void*);
 	//建立系統參數對應變數編號
 	void SetVariableID(unsigned short variable_ID, unsigned short* variable) {
-		table_unsigned_short.insert(std::make_pair(variable_ID, variable)); }
+		Register(variable_ID, SLOT_SYSTEM_UNSIGNED_SHORT, variable); }
 	void SetVariableID(unsigned short variable_ID, int* variable) {
-		table_int.insert(std::make_pair(variable_ID, variable)); }
+		Register(variable_ID, SLOT_SYSTEM_INT, variable); }
 	void SetVariableID(unsigned short variable_ID, double* variable) {
-		table_double.insert(std::make_pair(variable_ID, variable)); }
+		Register(variable_ID, SLOT_SYSTEM_DOUBLE, variable); }
+	void SetVariableID(unsigned short variable_ID, const double* variable) {
+		Register(variable_ID, SLOT_SYSTEM_READ_ONLY, const_cast<double*>(variable)); }
+	//建立座標四軸(X,Y,Z,B)對應的連續變數編號
+	void SetCoordinateID(unsigned short, Coordinate&);
+
+	//系統參數群
+	SystemParameter* system_parameter;
+	//變數登錄表(索引為變數編號減SYSTEM_VARIABLE_BEGIN,每個編號一個型別化存取位置)
+	std::vector<MacroVariableSlot> registry;
+	//不存在的變數
+	MacroVariableSlot not_exist_slot;
+};
+
+//巨集變數狀態快照(共同變數分頁以共享指標保存,分岔介面寫入時才複製分頁;系統參數整體保存並與分岔共享;保存G65/G66呼叫中的所有變數層)
+class MacroVariableSnapshot {
+	friend class MacroVariableInterface;
+public:
+	~MacroVariableSnapshot() {}
+	//讀取快照的局部或共同變數值
+	bool ReadVariable(unsigned short, double&) const;
+	//快照的系統參數
+	const SystemParameter& Parameter() const {
+		return *system_parameter; }
+	//共同變數分頁(索引為變數編號除以分頁容量,不含共同變數的分頁為空)
+	const std::vector<std::shared_ptr<MacroVariablePage>>& Pages() const {
+		return pages; }
+
+private:
+	MacroVariableSnapshot(const MacroVariableLayout& l)
+		:layout(l) {}
+
+	//變數配置
+	MacroVariableLayout layout;
+	//局部及模式變數層
+	LocalVariableLevels levels;
+	//共同變數分頁(快照建立後不再修改)
+	std::vector<std::shared_ptr<MacroVariablePage>> pages;
+	//系統參數複本(快照的複本及未寫入系統變數的分岔間共享)
+	std::shared_ptr<const SystemParameter> system_parameter;
 };
 
 //巨集變數存取介面
 class MacroVariableInterface {
 public:
-	MacroVariableInterface(SystemParameter&);
+	MacroVariableInterface(SystemParameter&, const MacroVariableLayout& layout = MacroVariableLayout());
+	//自快照建立分岔介面(共同變數與快照共享分頁,系統參數與快照共享,皆於寫入時複製)
+	explicit MacroVariableInterface(const MacroVariableSnapshot&);
 	~MacroVariableInterface() {}
+	//建立目前變數狀態的快照(僅重新複製上次快照後寫入過的共同變數分頁)
+	MacroVariableSnapshot Snapshot();
+	//是否為分岔介面
+	bool Forked() const {
+		return !common_pages.empty(); }
+	//可寫入的系統參數(分岔介面首次取用時複製快照的系統參數並啟用模擬)
+	SystemParameter& WritableParameter();
+	//分岔介面是否已複製系統參數
+	bool ParameterCopied() const {
+		return forked_parameter != nullptr; }
+	//建立高共同變數保存檢查點(未開啟保存映射檔時返回false;映射檔於介面解構時才關閉,變數存放位址不失效)
+	bool CheckpointRetained();
+	//有保存變數寫入時建立檢查點(執行器依檢查點間隔及於程式結束時呼叫,斷電遺失上次檢查點後的寫入)
+	bool CommitRetained() {
+		return !retained_pending || CheckpointRetained(); }
+	//上次檢查點後是否寫入過保存變數
+	bool RetainedPending() const {
+		return retained_pending; }
+	//保存映射檔開啟結果
+	MacroRetainedState RetainedState() const {
+		return common_variable.RetainedStorage().State(); }
+	//最新保存檢查點序號
+	std::uint64_t RetainedSequence() const {
+		return common_variable.RetainedStorage().Sequence(); }
 	//讀取變數值
-	bool ReadVariable(unsigned short, double&);
+	bool ReadVariable(unsigned short variable_ID, double& value) {
+		return Load(Slot(variable_ID), value); }
 	//寫入變數值
 	bool WriteVariable(unsigned short, double&);
+	//解析變數存取位置(變數不存在時類型為SLOT_NOT_EXIST)
+	MacroVariableSlot ResolveVariable(unsigned short variable_ID) {
+		return Slot(variable_ID); }
+	//讀取預先解析位置的變數值
+	bool ReadVariable(const MacroVariableSlot&, double&);
+	//目前局部變數層的變數值存放位址(索引為變數編號,切換變數層後失效)
+	double* LocalValues() {
+		return local_variable.Address(0); }
+	//寫入預先解析位置的變數值
+	bool WriteVariable(const MacroVariableSlot&, double&);
 	//進入變數層
 	bool EnterLevel(std::map<unsigned short, double>&);
+	//以引數陣列進入變數層
+	bool EnterLevel(const LocalVariableValues&);
 	//退出變數層
 	bool ExitLevel() { 
 		return local_variable.ExitLevel(); }
 	//建立模式變數層
 	bool CreateModalLevel(std::map<unsigned short, double>&);
+	//以引數陣列建立模式變數層
+	bool CreateModalLevel(const LocalVariableValues&);
 	//刪除模式變數層
 	bool DeleteModalLevel() {
 		//嘗試刪除模式變數層並回傳結果
@@ -184,10 +626,50 @@ public:
 	//退出模式層
 	bool ExitModalLevel();
 	//查詢總變數層數
-	std::stack<Variable*>::size_type CurrentLevel() const {
+	size_t CurrentLevel() const {
 		return local_variable.CurrentLevel(); }
+	//查詢核算世代(寫入變數或開始新的核算時遞增)
+	unsigned long long Generation() const {
+		return generation; }
+	//開始新的核算世代(捨棄共同子運算式的暫存結果)
+	void NextGeneration() {
+		++generation; }
+	//是否為警報模式(核算錯誤記錄為警報而不拋出例外)
+	bool AlarmMode() const {
+		return alarm_mode; }
+	//啟用或停用警報模式(停用例外的編譯恆為警報模式)
+	void SetAlarmMode(bool enable) {
+		alarm_mode = enable || !MACRO_EXCEPTIONS; }
+	//目前警報(僅保留第一個警報)
+	const MacroAlarm& Alarm() const {
+		return alarm; }
+	//是否有未解除的警報(有警報時不再寫入變數)
+	bool HasAlarm() const {
+		return alarm.code != ALARM_NONE; }
+	//解除警報
+	void ClearAlarm() {
+		alarm = MacroAlarm(); }
+	//發出警報:警報模式下記錄警報,否則拋出對應的例外
+	void RaiseAlarm(MacroAlarmCode, const void* node, unsigned short variable_ID = 0);
 
 private:
+	//新增變數層是否不超出最大層數限制
+	bool LevelAvailable() const {
+		return local_variable.TotalLevel() + modal_variable_level.TotalLevel() != local_variable.TotalLevelMax(); }
+	//建立變數分派表
+	void BuildDispatchTable();
+	//依局部、共同、系統變數順序解析存取位置(建立變數分派表時使用)
+	MacroVariableSlot ResolveStorage(unsigned short);
+	//取得可寫入的分岔共同變數分頁(與快照共享時先複製)
+	MacroVariablePage& WritablePage(unsigned short variable_ID);
+	//查詢變數分派表(超出分派表的編號不存在)
+	const MacroVariableSlot& Slot(unsigned short variable_ID) const {
+		return variable_ID < dispatch_table.size() ? dispatch_table[variable_ID] : not_exist_slot; }
+	//讀取存取位置的變數值
+	bool Load(const MacroVariableSlot&, double&);
+	//寫入存取位置的變數值(不檢查警報及#0,唯讀系統變數發出警報)
+	bool Store(const MacroVariableSlot&, double&);
+
 	//局部變數
 	LocalVariable local_variable;
 	//共同變數
@@ -196,4 +678,46 @@ private:
 	SystemVariable system_variable;
 	//模式變數層
 	ModalVariableLevel modal_variable_level;
+	//變數分派表(索引為變數編號,以一次索引決定局部、共同或系統變數的存取位置)
+	std::vector<MacroVariableSlot> dispatch_table;
+	//不存在的變數
+	MacroVariableSlot not_exist_slot;
+	//核算世代
+	unsigned long long generation;
+	//警報模式
+	bool alarm_mode;
+	//目前警報
+	MacroAlarm alarm;
+	//變數配置
+	MacroVariableLayout layout;
+	//分岔介面的共同變數分頁(非分岔介面為空)
+	std::vector<std::shared_ptr<MacroVariablePage>> common_pages;
+	//上次快照的共同變數分頁(非分岔介面重複使用未寫入的分頁)
+	std::vector<std::shared_ptr<MacroVariablePage>> snapshot_pages;
+	//上次快照後寫入過的共同變數分頁
+	std::vector<bool> dirty_pages;
+	//上次檢查點後寫入過保存變數
+	bool retained_pending;
+	//分岔介面與快照共享的系統參數(非分岔介面為空)
+	std::shared_ptr<const SystemParameter> shared_parameter;
+	//分岔介面寫入系統變數時複製的系統參數
+	std::unique_ptr<SystemParameter> forked_parameter;
+};
+
+//巨集變數分岔(自快照建立分岔介面,模擬執行不影響實際狀態)
+class MacroVariableFork {
+public:
+	explicit MacroVariableFork(const MacroVariableSnapshot& snapshot)
+		:macro_variable_interface(snapshot) {}
+	~MacroVariableFork() {}
+	//分岔的系統參數(首次取用時複製快照的系統參數並啟用模擬)
+	SystemParameter& Parameter() {
+		return macro_variable_interface.WritableParameter(); }
+	//分岔的巨集變數存取介面
+	MacroVariableInterface& Interface() {
+		return macro_variable_interface; }
+
+private:
+	//分岔介面
+	MacroVariableInterface macro_variable_interface;
 };
@@ -1,6 +1,7 @@
 ﻿#pragma once
 
 #include <string>
+#include <string_view>
 #include "StringConverter.h"
 
 //整數字串剖析器
@@ -34,7 +35,7 @@ public:
 	FloatNumberDefinition(const FloatStringConverter&, double, double, double, int, std::string::size_type, bool, bool);
 	~FloatNumberDefinition() {}
 	//剖析字串並轉換為浮點數值
-	bool StringToFloat(const std::string&, double&) const;
+	bool StringToFloat(std::string_view, double&) const;
 	//浮點數轉換為字串
 	bool FloatToString(double, std::string&) const;
 	//檢查浮點數值是否合法
@@ -58,5 +59,5 @@ public:
 
 private:
 	//檢查字串是否合法
-	bool VerifyString(const std::string&, std::string::size_type&)const;
+	bool VerifyString(std::string_view, std::string::size_type&)const;
 };
@@ -1,5 +1,6 @@
 ﻿#pragma once
 #include <string>
+#include <string_view>
 
 class IntegerStringConverter {
 public:
@@ -14,5 +15,5 @@ public:
 	FloatStringConverter() {}
 	~FloatStringConverter() {}
 	void FloatToString(double, std::string&, int)const;
-	bool StringToFloat(const std::string&, double&)const;
+	bool StringToFloat(std::string_view, double&)const;
 };
@@ -2,13 +2,202 @@
 //
 
 #include <iostream>
+#include <fstream>
+#include <chrono>
+#include <vector>
+#include <cmath>
 #include "MacroParserFactory.h"
+#include "MacroBytecode.h"
+#include "MacroBatch.h"
 #include <numbers>
 #include <memory>
 
 using namespace std;
 
-int main()
+//運算子樹核算副本(已編譯單節的運算子為唯讀)
+class TreeBlock {
+public:
+    explicit TreeBlock(const CompiledMacroBlock& compiled)
+        :general_operators(compiled.general_operators),
+        conditional_arithmetic_operator(compiled.conditional_arithmetic_operator),
+        conditional_branch_operator(compiled.conditional_branch_operator),
+        conditional_loop_operator(compiled.conditional_loop_operator),
+        loop_end_operator(compiled.loop_end_operator) {}
+
+    //以運算子樹核算單節,返回運算式值或分支/迴圈識別號碼
+    double Evaluate() {
+        if (!general_operators.empty()) {
+            const GeneralOperatorHandle& handle(general_operators.front());
+            if (handle.arithmetic) return handle.arithmetic->Evaluate();
+            if (handle.relational) return handle.relational->Evaluate();
+            return handle.logical->Evaluate();
+        }
+        if (!conditional_arithmetic_operator.Empty()) return conditional_arithmetic_operator.Evaluate();
+        if (!conditional_branch_operator.Empty()) return conditional_branch_operator.Evaluate() ? conditional_branch_operator.BranchNumber() : 0;
+        if (!conditional_loop_operator.Empty()) return conditional_loop_operator.LoopNumber() + conditional_loop_operator.Evaluate();
+        return loop_end_operator.Evaluate();
+    }
+    //是否為條件式賦值單節(IF[...] THEN)
+    bool ConditionalAssignment() const {
+        return general_operators.empty() && !conditional_arithmetic_operator.Empty(); }
+
+private:
+    vector<GeneralOperatorHandle> general_operators;
+    ConditionalArithmeticOperator conditional_arithmetic_operator;
+    ConditionalBranchOperator conditional_branch_operator;
+    ConditionalLoopOperator conditional_loop_operator;
+    LoopEndOperator loop_end_operator;
+};
+
+//以位元組碼虛擬機核算單節,返回值與TreeBlock::Evaluate相同
+static double EvaluateBytecode(MacroVirtualMachine& machine, const MacroBytecode& bytecode, bool conditional_assignment)
+{
+    MacroBytecodeResult result(machine.Run(bytecode));
+    switch (result.control) {
+    case OP_BRANCH:
+        return result.condition ? result.number : 0;
+    case OP_LOOP:
+        return result.number + result.condition;
+    case OP_LOOP_END:
+        return result.number;
+    default:
+        return conditional_assignment ? result.condition : result.value;
+    }
+}
+
+//評估大量模擬的核算吞吐量目標:運算子樹的10倍
+constexpr double TARGET_SPEEDUP = 10.0;
+
+//比較運算子樹與位元組碼虛擬機核算01_Macro_test.NC內所有巨集單節的速度
+//逐筆核算的虛擬機約為運算子樹的1.3~1.8倍(每單節的派送及數學函式成本無法以指令集消除),尚未達到TARGET_SPEEDUP
+static void Benchmark(const string& path, MacroVariableInterface& mvi)
+{
+    ifstream file(path);
+    if (!file) {
+        cout << "benchmark skipped: cannot open " << path << endl;
+        return;
+    }
+    //測試變數#1-#33設為其變數編號
+    for (unsigned short id = 1; id <= 33; ++id) {
+        double value(id);
+        mvi.WriteVariable(id, value);
+    }
+
+    FanucMacroParser parser(mvi);
+    vector<TreeBlock> trees;
+    vector<MacroBytecode> bytecodes;
+    string line;
+    while (getline(file, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        CommandType command_type(parser.ParseBlock(line));
+        if (command_type != MACRO_COMMAND) continue;
+        CompiledMacroBlock compiled(command_type, parser.macro_generator);
+        MacroBytecode bytecode;
+        if (!bytecode.Compile(compiled)) continue;
+        trees.emplace_back(compiled);
+        bytecodes.push_back(bytecode);
+    }
+
+    MacroVirtualMachine machine(mvi);
+    //驗證兩種核算方式結果一致
+    size_t mismatch(0);
+    for (size_t index = 0; index != trees.size(); ++index) {
+        double tree_value(trees[index].Evaluate());
+        double bytecode_value(EvaluateBytecode(machine, bytecodes[index], trees[index].ConditionalAssignment()));
+        if (tree_value != bytecode_value && !(tree_value != tree_value && bytecode_value != bytecode_value)) ++mismatch;
+    }
+
+    constexpr int passes(20000);
+    double checksum(0.0);
+    chrono::steady_clock::time_point begin(chrono::steady_clock::now());
+    for (int pass = 0; pass != passes; ++pass) {
+        for (TreeBlock& tree : trees) {
+            checksum += tree.Evaluate(); }
+    }
+    chrono::steady_clock::time_point middle(chrono::steady_clock::now());
+    for (int pass = 0; pass != passes; ++pass) {
+        for (const MacroBytecode& bytecode : bytecodes) {
+            checksum += machine.Run(bytecode).value; }
+    }
+    chrono::steady_clock::time_point end(chrono::steady_clock::now());
+
+    double evaluations(static_cast<double>(passes) * trees.size());
+    double tree_ns(chrono::duration<double, nano>(middle - begin).count() / evaluations);
+    double bytecode_ns(chrono::duration<double, nano>(end - middle).count() / evaluations);
+    cout << "benchmark blocks: " << trees.size() << ", mismatches: " << mismatch << endl;
+    cout << "tree walker: " << tree_ns << " ns/block, bytecode VM: " << bytecode_ns << " ns/block, speedup: " << tree_ns / bytecode_ns << "x (target "
+        << TARGET_SPEEDUP << "x, checksum " << checksum << ")" << endl;
+}
+
+//批次核算:#1,#2逐筆變動時,比較運算子樹,位元組碼虛擬機逐筆核算與批次核算的每筆資料速度(賦值單節取右方運算式,逐筆核算含寫入變數)
+static void BatchBenchmark(const string& path, MacroVariableInterface& mvi)
+{
+    ifstream file(path);
+    if (!file) return;
+
+    FanucMacroParser parser(mvi);
+    vector<TreeBlock> trees;
+    vector<MacroBytecode> bytecodes;
+    string line;
+    while (getline(file, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        //賦值單節改為剖析右方運算式(批次核算不寫入變數)
+        string::size_type assignment(line.find('='));
+        if (!line.empty() && line.front() == '#' && assignment != string::npos) line = line.substr(assignment + 1);
+        CommandType command_type(parser.ParseBlock(line));
+        if (command_type != MACRO_COMMAND) continue;
+        CompiledMacroBlock compiled(command_type, parser.macro_generator);
+        if (compiled.general_operators.empty()) continue;
+        MacroBytecode bytecode;
+        if (!bytecode.Compile(compiled)) continue;
+        trees.emplace_back(compiled);
+        bytecodes.push_back(bytecode);
+    }
+
+    constexpr size_t rows(100000);
+    vector<double> first(rows), second(rows), expected(rows), results(rows);
+    for (size_t row = 0; row != rows; ++row) {
+        first[row] = static_cast<double>(1 + row % 7);
+        second[row] = static_cast<double>(2 + row % 5);
+    }
+    vector<MacroBatchColumn> columns{ MacroBatchColumn(1, first.data()), MacroBatchColumn(2, second.data()) };
+    MacroBatchEvaluator evaluator(mvi);
+    MacroVirtualMachine machine(mvi);
+
+    double tree_ns(0.0), bytecode_ns(0.0), batch_ns(0.0), checksum(0.0);
+    size_t mismatch(0);
+    for (size_t index = 0; index != trees.size(); ++index) {
+        chrono::steady_clock::time_point begin(chrono::steady_clock::now());
+        for (size_t row = 0; row != rows; ++row) {
+            mvi.WriteVariable(1, first[row]);
+            mvi.WriteVariable(2, second[row]);
+            expected[row] = trees[index].Evaluate();
+        }
+        chrono::steady_clock::time_point tree_end(chrono::steady_clock::now());
+        for (size_t row = 0; row != rows; ++row) {
+            mvi.WriteVariable(1, first[row]);
+            mvi.WriteVariable(2, second[row]);
+            checksum += machine.Run(bytecodes[index]).value;
+        }
+        chrono::steady_clock::time_point bytecode_end(chrono::steady_clock::now());
+        evaluator.Evaluate(bytecodes[index], columns, rows, results.data());
+        chrono::steady_clock::time_point batch_end(chrono::steady_clock::now());
+
+        tree_ns += chrono::duration<double, nano>(tree_end - begin).count();
+        bytecode_ns += chrono::duration<double, nano>(bytecode_end - tree_end).count();
+        batch_ns += chrono::duration<double, nano>(batch_end - bytecode_end).count();
+        //向量POW與純量pow可能相差最後數位
+        for (size_t row = 0; row != rows; ++row) {
+            if (results[row] != expected[row] && !(fabs(results[row] - expected[row]) <= fabs(expected[row]) * 1e-14) &&
+                !(results[row] != results[row] && expected[row] != expected[row])) ++mismatch; }
+    }
+    double evaluations(static_cast<double>(rows) * trees.size());
+    cout << "batch expressions: " << trees.size() << ", rows: " << rows << ", mismatches: " << mismatch << endl;
+    cout << "tree walker: " << tree_ns / evaluations << " ns/row, bytecode VM: " << bytecode_ns / evaluations << " ns/row, batch VM: " << batch_ns / evaluations
+        << " ns/row, speedup: " << tree_ns / batch_ns << "x (target " << TARGET_SPEEDUP << "x, checksum " << checksum << ")" << endl;
+}
+
+int main(int argc, char* argv[])
 {
     SystemParameter system_parameter;
     MacroVariableInterface  mvi(system_parameter);
@@ -17,6 +206,10 @@ int main()
     auto parser=factory.CreateParser();
     string block("#1=SIN[30]");
     cout << "command type: " << parser->ParseBlock(block) << endl;
+
+    //巨集測試程式路徑(預設為方案目錄)
+    Benchmark(argc > 1 ? argv[1] : "../01_Macro_test.NC", mvi);
+    BatchBenchmark(argc > 1 ? argv[1] : "../01_Macro_test.NC", mvi);
 }
 
 // Run program: Ctrl + F5 or Debug > Start Without Debugging menu
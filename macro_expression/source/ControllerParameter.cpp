@@ -72,6 +72,46 @@ SystemParameter::SystemParameter()
 	program_coordinate_system(machine_coordinate, working_coordinate_system)
 {
 	//初始化所有刀長補正值為200.0mm
+	tool_length_offset_table[0] = 0.0;
 	for (unsigned short iter = 1; iter <= TOOL_LENGTH_REGISTER_MAX; ++iter) {
-		tool_length_offset_table.insert(make_pair(iter, 200.0)); }
+		tool_length_offset_table[iter] = 200.0; }
+}
+
+SystemParameter::SystemParameter(const SystemParameter& other)
+	:last_command_motion(other.last_command_motion),
+	sequence_cache_fixed(other.sequence_cache_fixed),
+	sequence_cache_variable(other.sequence_cache_variable),
+	sequence_cache_history(other.sequence_cache_history),
+	sub_program_begin_sequence(other.sub_program_begin_sequence),
+	sub_program_number_P8(other.sub_program_number_P8),
+	last_reference_position(other.last_reference_position),
+	suppress_single_block_stop_wait_auxiliary_function(other.suppress_single_block_stop_wait_auxiliary_function),
+	boring_shift_direction(other.boring_shift_direction),
+	program_radius(other.program_radius),
+	rapid_feed_rate_X(other.rapid_feed_rate_X),
+	rapid_feed_rate_Y(other.rapid_feed_rate_Y),
+	rapid_feed_rate_Z(other.rapid_feed_rate_Z),
+	peck_drilling_clearance(other.peck_drilling_clearance),
+	peck_drilling_retraction(other.peck_drilling_retraction),
+	tool_length_offset_table(other.tool_length_offset_table),
+	intermediate_position(other.intermediate_position),
+	reference_position_1st(other.reference_position_1st),
+	reference_position_2nd(other.reference_position_2nd),
+	reference_position_3rd(other.reference_position_3rd),
+	reference_position_4th(other.reference_position_4th),
+	preview_program_position(other.preview_program_position),
+	current_modal_parameter(other.current_modal_parameter),
+	preview_modal_parameter(other.preview_modal_parameter),
+	operation_parameter(other.operation_parameter),
+	machine_coordinate(other.machine_coordinate),
+	working_coordinate_system(other.working_coordinate_system),
+	program_coordinate_system(machine_coordinate, working_coordinate_system)
+{
+	//程式座標值及同步軸差異值與來源相同
+	const CoordinateAxis* source[] = { &other.program_coordinate_system.axis_X, &other.program_coordinate_system.axis_Y, &other.program_coordinate_system.axis_Z, &other.program_coordinate_system.axis_B };
+	CoordinateAxis* target[] = { &program_coordinate_system.axis_X, &program_coordinate_system.axis_Y, &program_coordinate_system.axis_Z, &program_coordinate_system.axis_B };
+	for (size_t axis = 0; axis != 4; ++axis) {
+		target[axis]->SetPosition(source[axis]->GetPosition());
+		target[axis]->SetDelta(source[axis]->GetDelta());
+	}
 }
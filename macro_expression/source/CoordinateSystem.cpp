@@ -40,40 +40,64 @@ WorkingCoordinateSystem::WorkingCoordinateSystem()
 	SelectWorkingCoordinateSystem(54);
 }
 
-bool WorkingCoordinateSystem::SelectWorkingCoordinateSystem(unsigned short working_system_ID)
+WorkingCoordinateSystem::WorkingCoordinateSystem(const WorkingCoordinateSystem& other)
+	:working_system(NULL),
+	G54_system_position(other.G54_system_position),
+	G55_system_position(other.G55_system_position),
+	G56_system_position(other.G56_system_position),
+	G57_system_position(other.G57_system_position),
+	G58_system_position(other.G58_system_position),
+	G59_system_position(other.G59_system_position)
+{
+	//工作座標系指標指向本身的座標系
+	SelectWorkingCoordinateSystem(other.WorkingSystemID());
+}
+
+unsigned short WorkingCoordinateSystem::WorkingSystemID()const
 {
-	//判斷選擇的工作座標系
+	if (working_system == &G55_system_position) {
+		return 55; }
+	else if (working_system == &G56_system_position) {
+		return 56; }
+	else if (working_system == &G57_system_position) {
+		return 57; }
+	else if (working_system == &G58_system_position) {
+		return 58; }
+	else if (working_system == &G59_system_position) {
+		return 59; }
+	else {
+		return 54; }
+}
+
+Coordinate* WorkingCoordinateSystem::SystemPosition(unsigned short working_system_ID)
+{
+	//判斷工作座標系
 	switch (working_system_ID) {
-		//選擇G54工作座標系
 	case 54:
-		//將工作座標系指標指向G54座標系
-		working_system = &G54_system_position;
-		break;
-
+		return &G54_system_position;
 	case 55:
-		working_system = &G55_system_position;
-		break;
-
+		return &G55_system_position;
 	case 56:
-		working_system = &G56_system_position;
-		break;
-
+		return &G56_system_position;
 	case 57:
-		working_system = &G57_system_position;
-		break;
-
+		return &G57_system_position;
 	case 58:
-		working_system = &G58_system_position;
-		break;
-
+		return &G58_system_position;
 	case 59:
-		working_system = &G59_system_position;
-		break;
-
+		return &G59_system_position;
 		//不合法或未定義的工作座標系
-	default: return false;
+	default:
+		return nullptr;
 	}
+}
 
+bool WorkingCoordinateSystem::SelectWorkingCoordinateSystem(unsigned short working_system_ID)
+{
+	Coordinate* system_position(SystemPosition(working_system_ID));
+	if (system_position == nullptr) {
+		return false; }
+	//將工作座標系指標指向選擇的座標系
+	working_system = system_position;
 	return true;
 }
 
@@ -0,0 +1,332 @@
+﻿#include "DegreeTrigonometry.h"
+#include "MacroSimd.h"
+#include <cmath>
+#include <limits>
+#include <numbers>
+
+using namespace std;
+
+//角度轉弳度
+constexpr double DEGREE_TO_RADIAN = numbers::pi / 180.0;
+//弳度轉角度
+constexpr double RADIAN_TO_DEGREE = 180.0 / numbers::pi;
+//一圈的角度
+constexpr double FULL_TURN = 360.0;
+//正無限大
+constexpr double INFINITE_VALUE = numeric_limits<double>::infinity();
+//sin(30)及cos(60)
+constexpr double SINE_30 = 0.5;
+//cos(30)及sin(60)
+constexpr double COSINE_30 = 0.86602540378443864676;
+//sin(45)及cos(45)
+constexpr double SINE_45 = 0.70710678118654752440;
+//tan(30)
+constexpr double TANGENT_30 = 0.57735026918962576451;
+//tan(60)
+constexpr double TANGENT_60 = 1.73205080756887729353;
+//多項式係數個數
+constexpr size_t COEFFICIENT_COUNT = 6;
+//正弦多項式係數(|x| <= pi/4)
+constexpr double SINE_COEFFICIENT[COEFFICIENT_COUNT] = {
+	1.58962301576546568060E-10, -2.50507477628578072866E-8, 2.75573136213857245213E-6,
+	-1.98412698295895385996E-4, 8.33333333332211858878E-3, -1.66666666666666307295E-1 };
+//餘弦多項式係數(|x| <= pi/4)
+constexpr double COSINE_COEFFICIENT[COEFFICIENT_COUNT] = {
+	-1.13585365213876817300E-11, 2.08757008419747316778E-9, -2.75573141792967388112E-7,
+	2.48015872888517045348E-5, -1.38888888888730564116E-3, 4.16666666666665929218E-2 };
+
+//化簡後的角度:degree = 象限 * 90 + 餘角, |餘角| <= 45
+class DegreeReduction {
+public:
+	//象限(0~3)
+	double quadrant;
+	//餘角的正弦
+	double sine;
+	//餘角的餘弦
+	double cosine;
+	//餘角為+-30度
+	bool thirty;
+};
+
+//超過一圈的角度先以fmod精確化簡(大角度時degree / 90.0已失去整數精度),0度倍數返回+0.0
+static double ReduceFullTurn(double degree)
+{
+	return fabs(degree) >= FULL_TURN ? fmod(degree, FULL_TURN) + 0.0 : degree;
+}
+
+//以角度精確化簡引數(與90度倍數的差無捨入誤差),再以多項式核算餘角的正弦及餘弦
+//向量核心須依相同的運算順序且不使用FMA,以維持逐位元相同的結果
+static DegreeReduction Reduce(double degree)
+{
+	degree = ReduceFullTurn(degree);
+	double multiple(nearbyint(degree / 90.0));
+	//0度倍數時保留-0.0的符號
+	double remainder(multiple == 0.0 ? degree : degree - multiple * 90.0);
+	DegreeReduction reduction;
+	reduction.quadrant = multiple - 4.0 * floor(multiple * 0.25);
+	reduction.thirty = fabs(remainder) == 30.0;
+	//90度倍數保留0.0的符號
+	if (remainder == 0.0) {
+		reduction.sine = remainder;
+		reduction.cosine = 1.0;
+	}
+	else if (reduction.thirty) {
+		reduction.sine = copysign(SINE_30, remainder);
+		reduction.cosine = COSINE_30;
+	}
+	else if (fabs(remainder) == 45.0) {
+		reduction.sine = copysign(SINE_45, remainder);
+		reduction.cosine = SINE_45;
+	}
+	else {
+		double x(remainder * DEGREE_TO_RADIAN), z(x * x);
+		double p(SINE_COEFFICIENT[0]), q(COSINE_COEFFICIENT[0]);
+		for (size_t index = 1; index != COEFFICIENT_COUNT; ++index) {
+			p = p * z + SINE_COEFFICIENT[index];
+			q = q * z + COSINE_COEFFICIENT[index];
+		}
+		reduction.sine = x + x * z * p;
+		reduction.cosine = 1.0 - 0.5 * z + z * z * q;
+	}
+	return reduction;
+}
+
+//是否為奇數象限
+static bool OddQuadrant(const DegreeReduction& reduction)
+{
+	return reduction.quadrant == 1.0 || reduction.quadrant == 3.0;
+}
+
+double DegreeTrigonometry::Sine(double degree)
+{
+	DegreeReduction reduction(Reduce(degree));
+	double value(OddQuadrant(reduction) ? reduction.cosine : reduction.sine);
+	return reduction.quadrant >= 2.0 ? -value : value;
+}
+
+double DegreeTrigonometry::Cosine(double degree)
+{
+	DegreeReduction reduction(Reduce(degree));
+	double value(OddQuadrant(reduction) ? reduction.sine : reduction.cosine);
+	return reduction.quadrant == 1.0 || reduction.quadrant == 2.0 ? -value : value;
+}
+
+double DegreeTrigonometry::Tangent(double degree)
+{
+	DegreeReduction reduction(Reduce(degree));
+	//奇數象限tan = -cos/sin,90度奇數倍時90+360n為+無限大、270+360n為-無限大
+	if (OddQuadrant(reduction)) {
+		if (reduction.sine == 0.0) {
+			return reduction.quadrant == 1.0 ? INFINITE_VALUE : -INFINITE_VALUE; }
+		return reduction.thirty ? copysign(TANGENT_60, -reduction.sine) : -reduction.cosine / reduction.sine; }
+	else {
+		return reduction.thirty ? copysign(TANGENT_30, reduction.sine) : reduction.sine / reduction.cosine; }
+}
+
+double DegreeTrigonometry::ArcSine(double value)
+{
+	double magnitude(fabs(value));
+	if (magnitude == 1.0) {
+		return copysign(90.0, value); }
+	else if (magnitude == SINE_30) {
+		return copysign(30.0, value); }
+	else if (magnitude == SINE_45) {
+		return copysign(45.0, value); }
+	else if (magnitude == COSINE_30) {
+		return copysign(60.0, value); }
+	else {
+		return asin(value) * RADIAN_TO_DEGREE; }
+}
+
+double DegreeTrigonometry::ArcCosine(double value)
+{
+	//特殊值以acos = 90 - asin核算(皆為精確角度)
+	double magnitude(fabs(value));
+	if (value == 0.0 || magnitude == 1.0 || magnitude == SINE_30 || magnitude == SINE_45 || magnitude == COSINE_30) {
+		return 90.0 - ArcSine(value); }
+	else {
+		return acos(value) * RADIAN_TO_DEGREE; }
+}
+
+double DegreeTrigonometry::ArcTangent(double value)
+{
+	double magnitude(fabs(value));
+	if (magnitude == 1.0) {
+		return copysign(45.0, value); }
+	else if (magnitude == TANGENT_30) {
+		return copysign(30.0, value); }
+	else if (magnitude == TANGENT_60) {
+		return copysign(60.0, value); }
+	else if (isinf(value)) {
+		return copysign(90.0, value); }
+	else {
+		return atan(value) * RADIAN_TO_DEGREE; }
+}
+
+double DegreeTrigonometry::ArcTangent2(double y, double x)
+{
+	if (isnan(y) || isnan(x)) {
+		return y + x; }
+	//座標軸上
+	else if (y == 0.0) {
+		return signbit(x) ? copysign(180.0, y) : y; }
+	else if (x == 0.0) {
+		return copysign(90.0, y); }
+	//對角線上
+	else if (fabs(y) == fabs(x)) {
+		return copysign(signbit(x) ? 135.0 : 45.0, y); }
+	else {
+		return atan2(y, x) * RADIAN_TO_DEGREE; }
+}
+
+#if defined(MACRO_SIMD_X86)
+//AVX2一次處理的筆數
+constexpr size_t AVX2_LANES = 4;
+
+//四筆化簡後的角度(各欄位意義同DegreeReduction,比較結果為全1遮罩)
+class DegreeReductionAvx2 {
+public:
+	__m256d quadrant;
+	__m256d sine;
+	__m256d cosine;
+	__m256d thirty;
+	//奇數象限遮罩
+	__m256d odd;
+};
+
+//ReduceFullTurn的向量版本(超過一圈的筆數逐筆以fmod化簡)
+MACRO_TARGET_AVX2 static __m256d ReduceFullTurnAvx2(__m256d degree)
+{
+	__m256d magnitude(_mm256_andnot_pd(_mm256_set1_pd(-0.0), degree));
+	if (_mm256_movemask_pd(_mm256_cmp_pd(magnitude, _mm256_set1_pd(FULL_TURN), _CMP_GE_OQ)) == 0) {
+		return degree; }
+	alignas(32) double lanes[AVX2_LANES];
+	_mm256_store_pd(lanes, degree);
+	for (double& lane : lanes) {
+		lane = ReduceFullTurn(lane); }
+	return _mm256_load_pd(lanes);
+}
+
+//Reduce的向量版本
+MACRO_TARGET_AVX2 static DegreeReductionAvx2 ReduceAvx2(__m256d degree)
+{
+	const __m256d zero(_mm256_setzero_pd()), sign(_mm256_set1_pd(-0.0)), ninety(_mm256_set1_pd(90.0));
+	degree = ReduceFullTurnAvx2(degree);
+	__m256d multiple(_mm256_round_pd(_mm256_div_pd(degree, ninety), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC));
+	__m256d remainder(_mm256_blendv_pd(_mm256_sub_pd(degree, _mm256_mul_pd(multiple, ninety)), degree,
+		_mm256_cmp_pd(multiple, zero, _CMP_EQ_OQ)));
+	DegreeReductionAvx2 reduction;
+	reduction.quadrant = _mm256_sub_pd(multiple, _mm256_mul_pd(_mm256_set1_pd(4.0), _mm256_floor_pd(_mm256_mul_pd(multiple, _mm256_set1_pd(0.25)))));
+	reduction.odd = _mm256_or_pd(_mm256_cmp_pd(reduction.quadrant, _mm256_set1_pd(1.0), _CMP_EQ_OQ),
+		_mm256_cmp_pd(reduction.quadrant, _mm256_set1_pd(3.0), _CMP_EQ_OQ));
+
+	__m256d x(_mm256_mul_pd(remainder, _mm256_set1_pd(DEGREE_TO_RADIAN))), z(_mm256_mul_pd(x, x));
+	__m256d p(_mm256_set1_pd(SINE_COEFFICIENT[0])), q(_mm256_set1_pd(COSINE_COEFFICIENT[0]));
+	for (size_t index = 1; index != COEFFICIENT_COUNT; ++index) {
+		p = _mm256_add_pd(_mm256_mul_pd(p, z), _mm256_set1_pd(SINE_COEFFICIENT[index]));
+		q = _mm256_add_pd(_mm256_mul_pd(q, z), _mm256_set1_pd(COSINE_COEFFICIENT[index]));
+	}
+	reduction.sine = _mm256_add_pd(x, _mm256_mul_pd(_mm256_mul_pd(x, z), p));
+	reduction.cosine = _mm256_add_pd(_mm256_sub_pd(_mm256_set1_pd(1.0), _mm256_mul_pd(_mm256_set1_pd(0.5), z)),
+		_mm256_mul_pd(_mm256_mul_pd(z, z), q));
+
+	//0、+-30及+-45度使用精確值
+	__m256d magnitude(_mm256_andnot_pd(sign, remainder)), remainder_sign(_mm256_and_pd(sign, remainder));
+	reduction.thirty = _mm256_cmp_pd(magnitude, _mm256_set1_pd(30.0), _CMP_EQ_OQ);
+	__m256d forty_five(_mm256_cmp_pd(magnitude, _mm256_set1_pd(45.0), _CMP_EQ_OQ));
+	reduction.sine = _mm256_blendv_pd(reduction.sine, _mm256_or_pd(_mm256_set1_pd(SINE_30), remainder_sign), reduction.thirty);
+	reduction.cosine = _mm256_blendv_pd(reduction.cosine, _mm256_set1_pd(COSINE_30), reduction.thirty);
+	reduction.sine = _mm256_blendv_pd(reduction.sine, _mm256_or_pd(_mm256_set1_pd(SINE_45), remainder_sign), forty_five);
+	reduction.cosine = _mm256_blendv_pd(reduction.cosine, _mm256_set1_pd(SINE_45), forty_five);
+	__m256d right_angle(_mm256_cmp_pd(remainder, zero, _CMP_EQ_OQ));
+	reduction.sine = _mm256_blendv_pd(reduction.sine, remainder, right_angle);
+	reduction.cosine = _mm256_blendv_pd(reduction.cosine, _mm256_set1_pd(1.0), right_angle);
+	return reduction;
+}
+
+MACRO_TARGET_AVX2 static void SineAvx2(double* values, size_t count)
+{
+	const __m256d sign(_mm256_set1_pd(-0.0)), two(_mm256_set1_pd(2.0));
+	size_t index(0);
+	for (; index + AVX2_LANES <= count; index += AVX2_LANES) {
+		DegreeReductionAvx2 reduction(ReduceAvx2(_mm256_loadu_pd(values + index)));
+		__m256d value(_mm256_blendv_pd(reduction.sine, reduction.cosine, reduction.odd));
+		value = _mm256_xor_pd(value, _mm256_and_pd(sign, _mm256_cmp_pd(reduction.quadrant, two, _CMP_GE_OQ)));
+		_mm256_storeu_pd(values + index, value);
+	}
+	for (; index != count; ++index) {
+		values[index] = DegreeTrigonometry::Sine(values[index]); }
+}
+
+MACRO_TARGET_AVX2 static void CosineAvx2(double* values, size_t count)
+{
+	const __m256d sign(_mm256_set1_pd(-0.0));
+	size_t index(0);
+	for (; index + AVX2_LANES <= count; index += AVX2_LANES) {
+		DegreeReductionAvx2 reduction(ReduceAvx2(_mm256_loadu_pd(values + index)));
+		__m256d value(_mm256_blendv_pd(reduction.cosine, reduction.sine, reduction.odd));
+		__m256d negative(_mm256_or_pd(_mm256_cmp_pd(reduction.quadrant, _mm256_set1_pd(1.0), _CMP_EQ_OQ),
+			_mm256_cmp_pd(reduction.quadrant, _mm256_set1_pd(2.0), _CMP_EQ_OQ)));
+		_mm256_storeu_pd(values + index, _mm256_xor_pd(value, _mm256_and_pd(sign, negative)));
+	}
+	for (; index != count; ++index) {
+		values[index] = DegreeTrigonometry::Cosine(values[index]); }
+}
+
+MACRO_TARGET_AVX2 static void TangentAvx2(double* values, size_t count)
+{
+	const __m256d sign(_mm256_set1_pd(-0.0));
+	size_t index(0);
+	for (; index + AVX2_LANES <= count; index += AVX2_LANES) {
+		DegreeReductionAvx2 reduction(ReduceAvx2(_mm256_loadu_pd(values + index)));
+		__m256d sine_sign(_mm256_and_pd(sign, reduction.sine));
+		__m256d even(_mm256_blendv_pd(_mm256_div_pd(reduction.sine, reduction.cosine),
+			_mm256_or_pd(_mm256_set1_pd(TANGENT_30), sine_sign), reduction.thirty));
+		__m256d odd(_mm256_blendv_pd(_mm256_div_pd(_mm256_xor_pd(reduction.cosine, sign), reduction.sine),
+			_mm256_or_pd(_mm256_set1_pd(TANGENT_60), _mm256_xor_pd(sine_sign, sign)), reduction.thirty));
+		//90度奇數倍:第1象限為+無限大,第3象限為-無限大
+		__m256d pole(_mm256_xor_pd(_mm256_set1_pd(INFINITE_VALUE),
+			_mm256_and_pd(sign, _mm256_cmp_pd(reduction.quadrant, _mm256_set1_pd(3.0), _CMP_EQ_OQ))));
+		odd = _mm256_blendv_pd(odd, pole, _mm256_cmp_pd(reduction.sine, _mm256_setzero_pd(), _CMP_EQ_OQ));
+		_mm256_storeu_pd(values + index, _mm256_blendv_pd(even, odd, reduction.odd));
+	}
+	for (; index != count; ++index) {
+		values[index] = DegreeTrigonometry::Tangent(values[index]); }
+}
+#endif
+
+void DegreeTrigonometry::Sine(double* values, size_t count, bool simd)
+{
+#if defined(MACRO_SIMD_X86)
+	if (simd && MacroSimdSupported()) {
+		SineAvx2(values, count);
+		return;
+	}
+#endif
+	for (size_t index = 0; index != count; ++index) {
+		values[index] = Sine(values[index]); }
+}
+
+void DegreeTrigonometry::Cosine(double* values, size_t count, bool simd)
+{
+#if defined(MACRO_SIMD_X86)
+	if (simd && MacroSimdSupported()) {
+		CosineAvx2(values, count);
+		return;
+	}
+#endif
+	for (size_t index = 0; index != count; ++index) {
+		values[index] = Cosine(values[index]); }
+}
+
+void DegreeTrigonometry::Tangent(double* values, size_t count, bool simd)
+{
+#if defined(MACRO_SIMD_X86)
+	if (simd && MacroSimdSupported()) {
+		TangentAvx2(values, count);
+		return;
+	}
+#endif
+	for (size_t index = 0; index != count; ++index) {
+		values[index] = Tangent(values[index]); }
+}
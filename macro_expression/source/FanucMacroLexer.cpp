@@ -0,0 +1,107 @@
+﻿#include "FanucMacroLexer.h"
+#include <cctype>
+
+using namespace std;
+
+OperatorType FanucMacroLexer::FindOperator(unsigned char address)
+{
+	switch (address) {
+		//變數運算子
+	case ADDRESS_VARIABLE_OPERATOR:
+		return UNARY_OPERATOR;
+		//賦值運算子
+	case ADDRESS_ASSIGNMENT_OPERATOR:
+		return ASSIGNMENT_OPERATOR;
+		//加法運算子
+	case ADDRESS_ADD_OPERATOR:
+		return BINARY_OPERATOR;
+		//乘法及除法運算子
+	case ADDRESS_MULTIPLY_OPERATOR:
+	case ADDRESS_DIVIDE_OPERATOR:
+		return PRIORITY_BINARY_OPERATOR;
+		//負值或減法運算子
+	case ADDRESS_MINUS_SUBTRACT_OPERATOR:
+		return UNARY_BINARY_OPERATOR;
+		//非運算子字元
+	default:
+		return NOT_AN_OPERATOR;
+	}
+}
+
+void FanucMacroLexer::Tokenize(string_view block)
+{
+	//清除前一單節的語彙單元(保留容量)
+	tokens.clear();
+
+	string_view::size_type index(0);
+	//逐一處理單節內每一個字元
+	while (index != block.size()) {
+		//取得字元
+		unsigned char ch(block[index]);
+		//字元為數字或小數點:擷取連續數字範圍
+		if (isdigit(ch) || ch == '.') {
+			string_view::size_type begin(index);
+			while (index != block.size() && (isdigit(static_cast<unsigned char>(block[index])) || block[index] == '.')) {
+				++index; }
+			tokens.emplace_back(TOKEN_NUMBER, NOT_AN_OPERATOR, block.substr(begin, index - begin));
+			continue;
+		}
+		//字元為大寫字母:擷取連續大寫字母範圍
+		if (isupper(ch)) {
+			string_view::size_type begin(index);
+			while (index != block.size() && isupper(static_cast<unsigned char>(block[index]))) {
+				++index; }
+			string_view upper(block.substr(begin, index - begin));
+			//僅有一個大寫字母為NC位址字元
+			if (upper.size() == 1) {
+				tokens.emplace_back(TOKEN_ADDRESS, NOT_AN_OPERATOR, upper); }
+			//超過一個大寫字母為關鍵字
+			else {
+				MacroKeyword keyword(FindMacroKeyword(upper));
+				tokens.emplace_back(TOKEN_KEYWORD, keyword.type, upper, keyword.id);
+			}
+			continue;
+		}
+
+		switch (ch) {
+			//運算子位址字元
+		case ADDRESS_VARIABLE_OPERATOR:
+		case ADDRESS_ASSIGNMENT_OPERATOR:
+		case ADDRESS_ADD_OPERATOR:
+		case ADDRESS_MULTIPLY_OPERATOR:
+		case ADDRESS_DIVIDE_OPERATOR:
+		case ADDRESS_MINUS_SUBTRACT_OPERATOR:
+			tokens.emplace_back(TOKEN_OPERATOR, FindOperator(ch), block.substr(index, 1));
+			break;
+
+			//優先運算範圍開始
+		case ADDRESS_PRIORITY_RANGE_BEGIN:
+			tokens.emplace_back(TOKEN_PRIORITY_BEGIN, NOT_AN_OPERATOR, block.substr(index, 1));
+			break;
+
+			//優先運算範圍結束
+		case ADDRESS_PRIORITY_RANGE_END:
+			tokens.emplace_back(TOKEN_PRIORITY_END, NOT_AN_OPERATOR, block.substr(index, 1));
+			break;
+
+			//雙引數分隔符號
+		case ADDRESS_ARGUMENT_SEPARATOR:
+			tokens.emplace_back(TOKEN_ARGUMENT_SEPARATOR, NOT_AN_OPERATOR, block.substr(index, 1));
+			break;
+
+			//註解開始:擷取至註解結束字元(含)或單節末尾
+		case ADDRESS_COMMENT_BEGIN: {
+			string_view::size_type end(block.find(ADDRESS_COMMENT_END, index + 1));
+			end = (end == string_view::npos) ? block.size() : end + 1;
+			tokens.emplace_back(TOKEN_COMMENT, NOT_AN_OPERATOR, block.substr(index, end - index));
+			index = end;
+			continue;
+		}
+
+			//直接忽略非巨集相關字元
+		default:
+			break;
+		}
+		++index;
+	}
+}
@@ -1,48 +1,57 @@
 ﻿#include "FanucMacroParser.h"
 #include <cstdlib>
+#include <algorithm>
+#include <bit>
 
 using namespace std;
 
-MacroParsingContext::MacroParsingContext()
-	:flag_priority(false),
-	flag_priority_logical(false),
-	flag_two_arguments(false)
-{
-}
-
-void MacroParsingContext::ClearContainers()
-{
-	ClearAdapterContainer(unary_operator_address);
-	binary_operator_address.clear();
-	ClearAdapterContainer(priority_binary_operator_address);
-	ClearAdapterContainer(unary_operator_keyword);
-	ClearAdapterContainer(unary_binary_operator_keyword);
-	ClearAdapterContainer(binary_operator_keyword);
-	relational_keyword.clear();
-	logical_keyword.clear();
-	priority_logical_keyword.clear();
-	conditional_keyword.clear();
-	ClearAdapterContainer(digit_string);
-	ClearAdapterContainer(upper_string);
-	general_operators.clear();
-	priority_general_operators.clear();
-}
+//無範圍標記
+constexpr size_t NO_FRAME = SIZE_MAX;
+//共用節點雜湊表空位
+constexpr uint32_t NO_SHARED_NODE = UINT32_MAX;
+//共用節點雜湊表最小容量(2的次方)
+constexpr size_t SHARED_INDEX_MIN = 64;
 
-void MacroParsingContext::ClearAll()
+//依左右運算元類型建立邏輯運算子
+template<typename T>
+shared_ptr<LogicalOperator> MacroGenerator::CreateLogicalOperator(const GeneralOperatorHandle& left, const GeneralOperatorHandle& right)
 {
-	flag_priority = false;
-	flag_priority_logical = false;
-	flag_two_arguments = false;
-	ClearContainers();
+	if (left.arithmetic && right.arithmetic) {
+		return CreateNode<T>(left.arithmetic, right.arithmetic); }
+	else if (left.relational && right.relational) {
+		return CreateNode<T>(left.relational, right.relational); }
+	else if (left.logical && right.logical) {
+		return CreateNode<T>(left.logical, right.logical); }
+	else if (left.arithmetic && right.logical) {
+		return CreateNode<T>(left.arithmetic, right.logical); }
+	else if (left.logical && right.arithmetic) {
+		return CreateNode<T>(left.logical, right.arithmetic); }
+	else if (left.relational && right.logical) {
+		return CreateNode<T>(left.relational, right.logical); }
+	else if (left.logical && right.relational) {
+		return CreateNode<T>(left.logical, right.relational); }
+	//算術運算子與關係運算子不可直接組合
+	else return shared_ptr<LogicalOperator>();
 }
 
 MacroGenerator::MacroGenerator(MacroVariableInterface &interface)
-	:current_nesting_level(0),
+	:expect_operand(true),
+	current_nesting_level(0),
+	condition_keyword(NOT_A_KEYWORD),
+	statement_keyword(NOT_A_KEYWORD),
+	statement_base(0),
 	//value max,value min,increment,digits max,digits min,lead zero,calculator type decimal
 	macro_float_parser(converter, DBL_MAX, DBL_MIN, 0.001, 15, 1, true, true),
-	macro_variable_interface(interface)
+	macro_variable_interface(interface),
+	subexpression_found(false)
 {
-	InitialKeywordList();
+}
+
+void MacroGenerator::EnableWorkspace()
+{
+	//建立運算子節點記憶池(已建立時沿用)
+	if (!node_resource) {
+		node_resource = make_shared<pmr::unsynchronized_pool_resource>(); }
 }
 
 void MacroGenerator::Clear()
@@ -52,2333 +61,1023 @@ void MacroGenerator::Clear()
 	conditional_loop_operator.Clear();
 	loop_end_operator.Clear();
 
+	//清除堆疊(保留容量)
+	operand_stack.clear();
+	operator_stack.clear();
+	address_words.clear();
+	expect_operand = true;
 	current_nesting_level = 0;
-	for (size_t i = 0; i != PRIORITY_NESTING_LEVEL_MAX + 1; ++i) {
-		context[i].ClearAll(); }
+	condition_keyword = NOT_A_KEYWORD;
+	statement_keyword = NOT_A_KEYWORD;
+	statement_base = 0;
+	ClearSharedNodes();
 }
 
-bool MacroGenerator::LevelUp()
+void MacroGenerator::Restore(const CompiledMacroBlock& compiled)
 {
-	if (current_nesting_level == PRIORITY_NESTING_LEVEL_MAX) {
-		return false; }
-	else {
-		++current_nesting_level;
-		return true;
-	}
+	Clear();
+	operand_stack.assign(compiled.general_operators.begin(), compiled.general_operators.end());
+	conditional_arithmetic_operator = compiled.conditional_arithmetic_operator;
+	conditional_branch_operator = compiled.conditional_branch_operator;
+	conditional_loop_operator = compiled.conditional_loop_operator;
+	loop_end_operator = compiled.loop_end_operator;
+	address_words.assign(compiled.address_words.begin(), compiled.address_words.end());
 }
 
-bool MacroGenerator::LevelDown()
+bool MacroGenerator::PushNumber(string_view digits)
 {
-	if (current_nesting_level == 0) return false;
-	else {
-		--current_nesting_level;
-		return true;
-	}
-}
-
-bool MacroGenerator::IsMacroMode()
-{
-	//目前有優先運算層
-	if (current_nesting_level != 0 ||
-		//有一元運算子且並非minus運算子
-		!context[0].unary_operator_address.empty() && context[0].unary_operator_address.top() != '-' ||
-		//有二元運算子
-		!context[0].binary_operator_address.empty() ||
-		//有條件運算子關鍵字
-		!context[0].conditional_keyword.empty()
-		) return true;
-	else return false;
+	//準備開始新運算元
+	if (!BeginOperand()) return false;
+	//建立常數運算子
+	if (!CreateConstantOperator(digits)) return false;
+	//建立作用於常數的前置一元運算子
+	return ApplyPrefixOperators();
 }
 
-OperatorType MacroGenerator::CheckOperatorType(unsigned char ch)
+bool MacroGenerator::PushOperatorAddress(const MacroToken& token)
 {
-	switch (ch) {
+	switch (token.keyword) {
 		//變數運算子
-	case ADDRESS_VARIABLE_OPERATOR:
-		return OperatorType::UNARY_OPERATOR;
+	case UNARY_OPERATOR:
+		//準備開始新運算元
+		if (!BeginOperand()) return false;
+		//存入前置一元運算子
+		operator_stack.emplace_back(UNARY_OPERATOR, token.text, operand_stack.size());
+		return true;
 
-		//賦值運算子
-	case ADDRESS_ASSIGNMENT_OPERATOR:
-		//加法運算子
-	case ADDRESS_ADD_OPERATOR:
-		return OperatorType::BINARY_OPERATOR;
-
-		//乘法運算子
-	case ADDRESS_MULTIPLY_OPERATOR:
-		return OperatorType::PRIORITY_BINARY_OPERATOR;
-
-		//除法運算子
-	case ADDRESS_DIVIDE_OPERATOR:
-		if (PriorityFlag()) {
-			if (!PriorityGeneralOperators().empty()) {
-				return OperatorType::PRIORITY_BINARY_OPERATOR; }
-		}
-		else {
-			if (!GeneralOperators().empty()) {
-				return OperatorType::PRIORITY_BINARY_OPERATOR; }
+		//負值或減法運算子
+	case UNARY_BINARY_OPERATOR:
+		//等待運算元:判斷為一元minus運算子
+		if (expect_operand) {
+			if (!BeginOperand()) return false;
+			operator_stack.emplace_back(UNARY_OPERATOR, token.text, operand_stack.size());
+			return true;
 		}
-		return OperatorType::NOT_AN_OPERATOR;
+		//已有左運算元:判斷為二元subtract運算子
+		return PushBinaryOperator(BINARY_OPERATOR, token.text);
 
-		//負值或減法運算子
-	case ADDRESS_MINUS_SUBTRACT_OPERATOR:
-		return OperatorType::UNARY_BINARY_OPERATOR;
+		//乘法及除法運算子
+	case PRIORITY_BINARY_OPERATOR:
+		//單節開頭的除號為選擇性單節跳躍,直接忽略
+		if (expect_operand && token.text.front() == ADDRESS_DIVIDE_OPERATOR && operand_stack.empty() && operator_stack.empty()) {
+			return true; }
+		return PushBinaryOperator(PRIORITY_BINARY_OPERATOR, token.text);
+
+		//加法及賦值運算子
+	case BINARY_OPERATOR:
+	case ASSIGNMENT_OPERATOR:
+		return PushBinaryOperator(token.keyword, token.text);
 
 		//非運算子字元
-	default: return OperatorType::NOT_AN_OPERATOR;
+	default: return false;
 	}
 }
 
-void MacroGenerator::CreateDigitString(string::const_iterator begin, string::const_iterator end)
+bool MacroGenerator::PushKeyword(const MacroToken& token)
 {
-	if (!UnaryOperatorAddress().empty() && UnaryOperatorAddress().top() == '-') {
-		string digit_string;
-		digit_string.push_back('-');
-		digit_string += string(begin, end);
-		DigitString().push(digit_string);
-		UnaryOperatorAddress().pop();
-	}
-	else {
-		DigitString().push(string(begin, end));
+	switch (token.keyword) {
+		//函數運算子:等待後續的優先運算範圍
+	case UNARY_FUNCTION_OPERATOR:
+	case UNARY_BINARY_FUNCTION_OPERATOR:
+	case BINARY_FUNCTION_OPERATOR:
+		if (!BeginOperand()) return false;
+		operator_stack.emplace_back(token.keyword, token.text, operand_stack.size(), token.id);
+		return true;
+
+		//關係及邏輯運算子
+	case RELATIONAL_OPERATOR:
+	case BINARY_LOGICAL_OPERATOR:
+	case PRIORITY_BINARY_LOGICAL_OPERATOR:
+		return PushBinaryOperator(token.keyword, token.text, token.id);
+
+		//條件式關鍵字
+	case IF_CONDITION:
+	case WHILE_CONDITION:
+		//結束前導的NC位址範圍
+		if (!expect_operand) {
+			if (!CloseNCAddress()) return false;
+			expect_operand = true;
+		}
+		//條件式關鍵字必須位於敘述開頭
+		if (!operand_stack.empty() || !operator_stack.empty() || condition_keyword != NOT_A_KEYWORD || statement_keyword != NOT_A_KEYWORD) return false;
+		condition_keyword = token.id;
+		return true;
+
+		//敘述關鍵字
+	case CONDITIONAL_ARITHMETIC_OPERATOR:
+	case BRANCH_OPERATOR:
+	case LOOP_OPERATOR:
+	case LOOP_END:
+		//每個單節僅允許一個敘述關鍵字
+		if (statement_keyword != NOT_A_KEYWORD) return false;
+		//有前導條件式關鍵字
+		if (condition_keyword != NOT_A_KEYWORD) {
+			//條件式運算元不完整
+			if (expect_operand) return false;
+			//結束條件式之後的NC位址範圍
+			if (InnermostFrame() != NO_FRAME && !CloseNCAddress()) return false;
+			//建立條件式運算子
+			if (!ReduceToFrame() || !operator_stack.empty()) return false;
+			//條件式須為單一關係或邏輯運算子
+			if (operand_stack.size() != 1 || (!operand_stack.front().relational && !operand_stack.front().logical)) return false;
+			//IF僅能搭配THEN或GOTO,WHILE僅能搭配DO
+			if (condition_keyword == IF_KEYWORD) {
+				if (token.id != THEN_KEYWORD && token.id != GOTO_KEYWORD) return false; }
+			else if (token.id != DO_KEYWORD) return false;
+		}
+		//無前導條件式關鍵字
+		else {
+			//THEN必須搭配IF
+			if (token.id == THEN_KEYWORD) return false;
+			//結束前導的NC位址範圍
+			if (!expect_operand && !CloseNCAddress()) return false;
+			//敘述關鍵字必須位於敘述開頭
+			if (!operand_stack.empty() || !operator_stack.empty()) return false;
+		}
+		statement_keyword = token.id;
+		statement_base = operand_stack.size();
+		expect_operand = true;
+		return true;
+
+		//不合法關鍵字
+	default: return false;
 	}
 }
 
-bool MacroGenerator::CreateConstantOperator()
+bool MacroGenerator::PushNCAddress(string_view address)
 {
-	//浮點數值暫存器
-	double value(0.0);
-	//將數字字串轉換為浮點數值
-	if (macro_float_parser.StringToFloat(DigitString().top(), value) == true) {
-
-		shared_ptr<ArithmeticOperator> handle(new ConstantOperator(value));
-		//建立通用運算子Handle
-		GeneralOperatorHandle constant(handle);
-		//優先算術運算子模式或優先邏輯運算子模式:存入優先運算子容器
-		if (PriorityFlag() || PriorityLogicalFlag()) PriorityGeneralOperators().push_back(constant);
-		//一般運算子模式:存入一般運算子容器
-		else GeneralOperators().push_back(constant);
-		//刪除數字字串
-		DigitString().pop();
-		return true;
-	}
-	//返回錯誤:轉換發生錯誤
-	else return false;
+	//等待運算元:NC位址字元只能出現在敘述之間
+	if (expect_operand) {
+		if (!operator_stack.empty()) return false; }
+	//已有完整運算元:先結束前一NC位址範圍(優先運算範圍內不可出現NC位址字元)
+	else if (InnermostFrame() != NO_FRAME) {
+		if (!CloseNCAddress()) return false; }
+	//存入NC位址範圍標記
+	operator_stack.emplace_back(NOT_AN_OPERATOR, address, operand_stack.size());
+	expect_operand = true;
+	return true;
 }
 
-bool MacroGenerator::CreateUnaryAddressOperator()
+bool MacroGenerator::OpenPriorityRange(string_view range)
 {
-	//運算子成功建立旗標
-	bool result(false);
-
-	//持續處理存在的一元運算子位址字元
-	while (!UnaryOperatorAddress().empty()) {
-		//判斷一元運算子位址字元
-		switch (UnaryOperatorAddress().top()) {
-			//位址字元為變數運算子
-		case ADDRESS_VARIABLE_OPERATOR:
-			//優先運算子模式
-			if (PriorityFlag() || PriorityLogicalFlag()) {
-				//返回錯誤:容器內無運算元或非算術運算子
-				if (PriorityGeneralOperators().empty() || !PriorityGeneralOperators().back().arithmetic) return false;
-				//有運算元且確認為算術運算子
-				else {
-					shared_ptr<ArithmeticOperator> handle(new VariableOperator(macro_variable_interface, PriorityGeneralOperators().back().arithmetic));
-					//建立通用(變數)運算子Handle
-					GeneralOperatorHandle variable(handle);
-					//刪除一元運算子位址字元
-					UnaryOperatorAddress().pop();
-					//刪除運算元(前優先運算子)
-					PriorityGeneralOperators().pop_back();
-					//存放新優先運算子
-					PriorityGeneralOperators().push_back(variable);
-					//設立運算子建立旗標
-					result = true;
-					break;
-				}
-			}
-			//一般運算子模式
-			else {
-				//返回錯誤:容器內無運算元或非算術運算子
-				if (GeneralOperators().empty() || !GeneralOperators().back().arithmetic) return false;
-				//有運算元且確認為算術運算子
-				else {
-					shared_ptr<ArithmeticOperator> handle(new VariableOperator(macro_variable_interface, GeneralOperators().back().arithmetic));
-					//建立變數運算子Handle
-					GeneralOperatorHandle variable(handle);
-					//刪除一元運算子位址字元
-					UnaryOperatorAddress().pop();
-					//刪除運算元(前運算子)
-					GeneralOperators().pop_back();
-					//存放新運算子
-					GeneralOperators().push_back(variable);
-					//設立運算子建立旗標
-					result = true;
-					break;
-				}
-			}
-			//位址字元為補數或減法運算子
-		case ADDRESS_MINUS_SUBTRACT_OPERATOR:
-			//優先運算子模式
-			if (PriorityFlag() || PriorityLogicalFlag()) {
-				//返回錯誤:容器內無運算元或非算術運算子
-				if (PriorityGeneralOperators().empty() || !PriorityGeneralOperators().back().arithmetic) return false;
-				//有運算元且確認為算術運算子
-				else {
-					shared_ptr<ArithmeticOperator> handle(new MinusOperator(PriorityGeneralOperators().back().arithmetic));
-					//建立通用(補數)運算子Handle
-					GeneralOperatorHandle minus(handle);
-					//刪除一元運算子位址字元
-					UnaryOperatorAddress().pop();
-					//刪除運算元(前優先運算子)
-					PriorityGeneralOperators().pop_back();
-					//存放新優先運算子
-					PriorityGeneralOperators().push_back(minus);
-					//設立運算子建立旗標
-					result = true;
-					break;
-				}
-			}
-			//一般運算子模式
-			else {
-				//返回錯誤:容器內無運算元或非算術運算子
-				if (GeneralOperators().empty() || !GeneralOperators().back().arithmetic) return false;
-				//有運算元且確認為算術運算子
-				else {
-					shared_ptr<ArithmeticOperator> handle(new MinusOperator(GeneralOperators().back().arithmetic));
-					//建立通用(補數)運算子Handle
-					GeneralOperatorHandle minus(handle);
-					//刪除一元運算子位址字元
-					UnaryOperatorAddress().pop();
-					//刪除運算元(前運算子)
-					GeneralOperators().pop_back();
-					//存放新運算子
-					GeneralOperators().push_back(minus);
-					//設立運算子建立旗標
-					result = true;
-					break;
-				}
-			}
-		//不合法位址字元
-		default: return false;
-		}
+	//前一運算元已完成:僅能在結束NC位址範圍後開始新運算元
+	if (!expect_operand) {
+		if (!CloseNCAddress()) return false;
+		expect_operand = true;
 	}
-	return result;
+	//存入優先運算範圍標記(無嵌套層數限制)
+	operator_stack.emplace_back(NOT_AN_OPERATOR, range, operand_stack.size());
+	++current_nesting_level;
+	return true;
 }
 
-bool MacroGenerator::CreateUnaryFunctionOperator(const shared_ptr<ArithmeticOperator>& operand)
+bool MacroGenerator::ClosePriorityRange()
 {
-	//檢查一元函數關鍵字容器
-	if (!UnaryOperatorKeyword().empty()) {
-		//取出關鍵字字串
-		string keyword(UnaryOperatorKeyword().top());
-		//關鍵字串為Sine函數運算子
-		if (keyword == KEYWORD_SINE_OPERATOR) {
-			shared_ptr<ArithmeticOperator> handle(new SineOperator(operand));
-			//建立Sine函數運算子Handle
-			GeneralOperatorHandle sine(handle);
-			//優先運算子模式
-			if (PriorityFlag() || PriorityLogicalFlag()) {
-				//存放新建運算子於優先運算子容器
-				PriorityGeneralOperators().push_back(sine);
-			}
-			//一般運算子模式
-			else {
-				//存放新建運算子於一般運算子容器
-				GeneralOperators().push_back(sine);
-			}
-			//刪除容器內關鍵字字串
-			UnaryOperatorKeyword().pop();
-			return true;
-		}
-		//關鍵字串為Cosine函數運算子
-		else if (keyword == KEYWORD_COSINE_OPERATOR) {
-			shared_ptr<ArithmeticOperator> handle(new CosineOperator(operand));
-			//建立Cosine函數運算子Handle
-			GeneralOperatorHandle cosine(handle);
-			//優先運算子模式
-			if (PriorityFlag() || PriorityLogicalFlag()) {
-				//存放新建運算子於優先運算子容器
-				PriorityGeneralOperators().push_back(cosine);
-			}
-			//一般運算子模式
-			else {
-				//存放新建運算子於一般運算子容器
-				GeneralOperators().push_back(cosine);
-			}
-			//刪除容器內關鍵字字串
-			UnaryOperatorKeyword().pop();
-			return true;
-		}
-		//關鍵字串為Tangent函數運算子
-		else if (keyword == KEYWORD_TANGENT_OPERATOR) {
-			shared_ptr<ArithmeticOperator> handle(new TangentOperator(operand));
-			//建立Tangent函數運算子Handle
-			GeneralOperatorHandle tangent(handle);
-			//優先運算子模式
-			if (PriorityFlag() || PriorityLogicalFlag()) {
-				//存放新建運算子於優先運算子容器
-				PriorityGeneralOperators().push_back(tangent);
-			}
-			//一般運算子模式
-			else {
-				//存放新建運算子於一般運算子容器
-				GeneralOperators().push_back(tangent);
-			}
-			//刪除容器內關鍵字字串
-			UnaryOperatorKeyword().pop();
-			return true;
-		}
-		//關鍵字串為Arc Sine函數運算子
-		else if (keyword == KEYWORD_ARC_SINE_OPERATOR) {
-			shared_ptr<ArithmeticOperator> handle(new ArcSineOperator(operand));
-			//建立Arc Sine函數運算子Handle
-			GeneralOperatorHandle arc_sine(handle);
-			//優先運算子模式
-			if (PriorityFlag() || PriorityLogicalFlag()) {
-				//存放新建運算子於優先運算子容器
-				PriorityGeneralOperators().push_back(arc_sine);
-			}
-			//一般運算子模式
-			else {
-				//存放新建運算子於一般運算子容器
-				GeneralOperators().push_back(arc_sine);
-			}
-			//刪除容器內關鍵字字串
-			UnaryOperatorKeyword().pop();
-			return true;
-		}
-		//關鍵字串為Arc Cosine函數運算子
-		else if (keyword == KEYWORD_ARC_COSINE_OPERATOR) {
-			shared_ptr<ArithmeticOperator> handle(new ArcCosineOperator(operand));
-			//建立Arc Cosine函數運算子Handle
-			GeneralOperatorHandle arc_cosine(handle);
-			//優先運算子模式
-			if (PriorityFlag() || PriorityLogicalFlag()) {
-				//存放新建運算子於優先運算子容器
-				PriorityGeneralOperators().push_back(arc_cosine);
-			}
-			//一般運算子模式
-			else {
-				//存放新建運算子於一般運算子容器
-				GeneralOperators().push_back(arc_cosine);
-			}
-			//刪除容器內關鍵字字串
-			UnaryOperatorKeyword().pop();
-			return true;
-		}
-		//關鍵字串為Square Root函數運算子
-		else if (keyword == KEYWORD_SQUARE_ROOT_OPERATOR) {
-			shared_ptr<ArithmeticOperator> handle(new SquareRootOperator(operand));
-			//建立Square Root函數運算子Handle
-			GeneralOperatorHandle square_root(handle);
-			//優先運算子模式
-			if (PriorityFlag() || PriorityLogicalFlag()) {
-				//存放新建運算子於優先運算子容器
-				PriorityGeneralOperators().push_back(square_root);
-			}
-			//一般運算子模式
-			else {
-				//存放新建運算子於一般運算子容器
-				GeneralOperators().push_back(square_root);
-			}
-			//刪除容器內關鍵字字串
-			UnaryOperatorKeyword().pop();
-			return true;
-		}
-		//關鍵字串為Absolute Value函數運算子
-		else if (keyword == KEYWORD_ABSOLUTE_VALUE_OPERATOR) {
-			shared_ptr<ArithmeticOperator> handle(new AbsoluteValueOperator(operand));
-			//建立Absolute Value函數運算子Handle
-			GeneralOperatorHandle absolute_value(handle);
-			//優先運算子模式
-			if (PriorityFlag() || PriorityLogicalFlag()) {
-				//存放新建運算子於優先運算子容器
-				PriorityGeneralOperators().push_back(absolute_value);
-			}
-			//一般運算子模式
-			else {
-				//存放新建運算子於一般運算子容器
-				GeneralOperators().push_back(absolute_value);
-			}
-			//刪除容器內關鍵字字串
-			UnaryOperatorKeyword().pop();
-			return true;
-		}
-		else if (keyword == KEYWORD_BINARY_CODE_OPERATOR) {
-			return false;
-		}
-		else if (keyword == KEYWORD_BINARY_CODED_DECIMAL_OPERATOR) {
-			return false;
-		}
-		//關鍵字串為四捨五入函數運算子
-		else if (keyword == KEYWORD_ROUND_OFF_OPERATOR) {
-			shared_ptr<ArithmeticOperator> handle(new RoundOffOperator(operand));
-			//建立四捨五入函數運算子Handle
-			GeneralOperatorHandle round_off(handle);
-			//優先運算子模式
-			if (PriorityFlag() || PriorityLogicalFlag()) {
-				//存放新建運算子於優先運算子容器
-				PriorityGeneralOperators().push_back(round_off);
-			}
-			//一般運算子模式
-			else {
-				//存放新建運算子於一般運算子容器
-				GeneralOperators().push_back(round_off);
-			}
-			//刪除容器內關鍵字字串
-			UnaryOperatorKeyword().pop();
-			return true;
-		}
-		//關鍵字串為Round Down函數運算子
-		else if (keyword == KEYWORD_ROUND_DOWN_OPERATOR) {
-			shared_ptr<ArithmeticOperator> handle(new RoundDownOperator(operand));
-			//建立Round Down函數運算子Handle
-			GeneralOperatorHandle round_down(handle);
-			//優先運算子模式
-			if (PriorityFlag() || PriorityLogicalFlag()) {
-				//存放新建運算子於優先運算子容器
-				PriorityGeneralOperators().push_back(round_down);
-			}
-			//一般運算子模式
-			else {
-				//存放新建運算子於一般運算子容器
-				GeneralOperators().push_back(round_down);
-			}
-			//刪除容器內關鍵字字串
-			UnaryOperatorKeyword().pop();
-			return true;
-		}
-		//關鍵字串為Round Up函數運算子
-		else if (keyword == KEYWORD_ROUND_UP_OPERATOR) {
-			shared_ptr<ArithmeticOperator> handle(new RoundUpOperator(operand));
-			//建立Round Up函數運算子Handle
-			GeneralOperatorHandle round_up(handle);
-			//優先運算子模式
-			if (PriorityFlag() || PriorityLogicalFlag()) {
-				//存放新建運算子於優先運算子容器
-				PriorityGeneralOperators().push_back(round_up);
-			}
-			//一般運算子模式
-			else {
-				//存放新建運算子於一般運算子容器
-				GeneralOperators().push_back(round_up);
-			}
-			//刪除容器內關鍵字字串
-			UnaryOperatorKeyword().pop();
-			return true;
-		}
-		//關鍵字串為Natural Log函數運算子
-		else if (keyword == KEYWORD_NATURAL_LOG_OPERATOR) {
-			shared_ptr<ArithmeticOperator> handle(new NaturalLogOperator(operand));
-			//建立Natural Log函數運算子Handle
-			GeneralOperatorHandle natural_log(handle);
-			//優先運算子模式
-			if (PriorityFlag() || PriorityLogicalFlag()) {
-				//存放新建運算子於優先運算子容器
-				PriorityGeneralOperators().push_back(natural_log);
-			}
-			//一般運算子模式
-			else {
-				//存放新建運算子於一般運算子容器
-				GeneralOperators().push_back(natural_log);
-			}
-			//刪除容器內關鍵字字串
-			UnaryOperatorKeyword().pop();
-			return true;
-		}
-		//關鍵字串為Exponent函數運算子
-		else if (keyword == KEYWORD_EXPONENT_OPERATOR) {
-			shared_ptr<ArithmeticOperator> handle(new ExponentOperator(operand));
-			//建立Exponent函數運算子Handle
-			GeneralOperatorHandle exponent(handle);
-			//優先運算子模式
-			if (PriorityFlag() || PriorityLogicalFlag()) {
-				//存放新建運算子於優先運算子容器
-				PriorityGeneralOperators().push_back(exponent);
-			}
-			//一般運算子模式
-			else {
-				//存放新建運算子於一般運算子容器
-				GeneralOperators().push_back(exponent);
-			}
-			//刪除容器內關鍵字字串
-			UnaryOperatorKeyword().pop();
-			return true;
-		}
-		else if (keyword == KEYWORD_ADD_DECIMAL_POINT_OPERATOR) {
-			return false;
-		}
-		//不合法關鍵字
-		else return false;
+	//優先運算範圍內缺少運算元
+	if (expect_operand) return false;
+	//建立範圍內所有待建立運算子
+	if (!ReduceToFrame()) return false;
+	//最內層範圍必須為優先運算範圍
+	if (operator_stack.empty() || !operator_stack.back().IsPriorityRange()) return false;
+
+	//取出優先運算範圍標記
+	MacroStackOperator range(operator_stack.back());
+	operator_stack.pop_back();
+	--current_nesting_level;
+	//範圍內運算元數量須與引數數量相同
+	if (operand_stack.size() != range.operand_base + range.arguments) return false;
+
+	//優先運算範圍屬於函數運算子
+	if (!operator_stack.empty() && IsFunction(operator_stack.back().type)) {
+		MacroStackOperator function(operator_stack.back());
+		operator_stack.pop_back();
+		if (!CreateFunctionOperator(function, range.arguments)) return false;
 	}
-	//檢查一元二元通用函數關鍵字容器
-	else if (!UnaryBinaryOperatorKeyword().empty()) {
-		//取出關鍵字字串
-		string keyword(UnaryBinaryOperatorKeyword().top());
-		//關鍵字串為Arc Tangent函數運算子
-		if (keyword == KEYWORD_ARC_TANGENT_OPERATOR) {
-			shared_ptr<ArithmeticOperator> handle(new ArcTangentOperator(operand));
-			//建立Arc Tangent函數運算子Handle
-			GeneralOperatorHandle arc_tangent(handle);
-			//優先運算子模式
-			if (PriorityFlag() || PriorityLogicalFlag()) {
-				//存放新建運算子於優先運算子容器
-				PriorityGeneralOperators().push_back(arc_tangent);
-			}
-			//一般運算子模式
-			else {
-				//存放新建運算子於一般運算子容器
-				GeneralOperators().push_back(arc_tangent);
-			}
-			//刪除容器內關鍵字字串
-			UnaryBinaryOperatorKeyword().pop();
-			return true;
-		}
-		//關鍵字不合法
-		else return false;
+	//雙引數僅能用於函數運算子
+	else if (range.arguments != 1) return false;
+
+	//建立作用於優先運算範圍的前置一元運算子
+	return ApplyPrefixOperators();
+}
+
+bool MacroGenerator::SeparateArgument()
+{
+	//第一引數缺少運算元
+	if (expect_operand) return false;
+	//建立第一引數內所有待建立運算子
+	if (!ReduceToFrame()) return false;
+	//最內層範圍必須為尚未分隔的優先運算範圍
+	if (operator_stack.size() < 2 || !operator_stack.back().IsPriorityRange() || operator_stack.back().arguments != 1) return false;
+	//優先運算範圍必須屬於雙引數函數運算子
+	OperatorType function(operator_stack[operator_stack.size() - 2].type);
+	if (function != UNARY_BINARY_FUNCTION_OPERATOR && function != BINARY_FUNCTION_OPERATOR) return false;
+
+	++operator_stack.back().arguments;
+	expect_operand = true;
+	return true;
+}
+
+bool MacroGenerator::ProcessToFinalOperator()
+{
+	//運算式不完整(含空單節)
+	if (expect_operand) return false;
+	//結束最後的NC位址範圍
+	if (InnermostFrame() != NO_FRAME && !CloseNCAddress()) return false;
+	//建立所有待建立運算子
+	if (!ReduceToFrame()) return false;
+	//優先運算範圍未結束
+	if (!operator_stack.empty()) return false;
+	//以共同子運算式運算子取代重複參照的節點
+	ShareSubexpressions();
+
+	//有敘述關鍵字:建立條件式運算子
+	if (statement_keyword != NOT_A_KEYWORD) {
+		return CreateConditionalOperator(); }
+	//條件式缺少敘述關鍵字
+	if (condition_keyword != NOT_A_KEYWORD) return false;
+	//單節內僅允許單一巨集運算式
+	return operand_stack.size() <= 1;
+}
+
+bool MacroGenerator::BeginOperand()
+{
+	//前一運算元已完成:僅能在結束NC位址範圍後開始新運算元
+	if (!expect_operand) {
+		if (!CloseNCAddress()) return false;
+		expect_operand = true;
+		return true;
 	}
-	//容器內無關鍵字
-	else return false;
+	//函數關鍵字之後必須為優先運算範圍
+	return operator_stack.empty() || !IsFunction(operator_stack.back().type);
 }
 
-bool MacroGenerator::CreateBinaryFunctionOperator(const shared_ptr<ArithmeticOperator>& left_operand, const shared_ptr<ArithmeticOperator>& right_operand)
+bool MacroGenerator::PushBinaryOperator(OperatorType type, string_view address, MacroKeywordID id)
 {
-	//檢查二元函數關鍵字容器
-	if (!BinaryOperatorKeyword().empty()) {
-		//取出關鍵字字串
-		string keyword(BinaryOperatorKeyword().top());
-		//關鍵字串為Power函數運算子
-		if (keyword == KEYWORD_POWER_OPERATOR) {
-			//建立Power函數運算子Handle
-			shared_ptr<ArithmeticOperator> power(new PowerOperator(left_operand, right_operand));
-			//優先運算子模式
-			if (PriorityFlag() || PriorityLogicalFlag()) {
-				//存放新建函數運算子於優先運算子容器
-				PriorityGeneralOperators().push_back(GeneralOperatorHandle(power));
-			}
-			//一般運算子模式
-			else {
-				//存放新建函數運算子於一般運算子容器
-				GeneralOperators().push_back(GeneralOperatorHandle(power));
-			}
-			//刪除容器內關鍵字串
-			BinaryOperatorKeyword().pop();
-			return true;
-		}
-		//不合法關鍵字
-		else return false;
+	//缺少左運算元
+	if (expect_operand) return false;
+
+	MacroPrecedence precedence(OperatorPrecedence(type));
+	//FANUC的AND與* /,OR XOR與+ -同級且關係運算子最後結合,與一般優先順序不同:同範圍內邏輯運算子與算術或關係運算子須以[]區分
+	if (!operator_stack.empty() && !operator_stack.back().IsFrame()) {
+		MacroPrecedence previous(OperatorPrecedence(operator_stack.back().type));
+		if (previous != PRECEDENCE_ASSIGNMENT && IsLogicalPrecedence(previous) != IsLogicalPrecedence(precedence)) return false;
 	}
-	//檢查一元與二元通用函數關鍵字容器
-	else if (!UnaryBinaryOperatorKeyword().empty()) {
-		//取出關鍵字字串
-		string keyword(UnaryBinaryOperatorKeyword().top());
-		//關鍵字為Arc Tangent函數運算子
-		if (keyword == KEYWORD_ARC_TANGENT_OPERATOR) {
-			//建立Arc Tangent2函數運算子Handle
-			shared_ptr<ArithmeticOperator> arc_tangent2(new ArcTangent2Operator(left_operand, right_operand));
-			//優先運算子模式
-			if (PriorityFlag() || PriorityLogicalFlag()) {
-				//存放新建函數運算子於優先運算子容器
-				PriorityGeneralOperators().push_back(GeneralOperatorHandle(arc_tangent2));
-			}
-			//一般運算子模式
-			else {
-				//存放新建函數運算子於一般運算子容器
-				GeneralOperators().push_back(GeneralOperatorHandle(arc_tangent2));
-			}
-			//刪除容器內關鍵字串
-			UnaryBinaryOperatorKeyword().pop();
-			return true;
-		}
-		//不合法關鍵字
-		else return false;
+	//先建立同範圍內優先順序較高(左結合時包含相同)的待建立運算子
+	while (!operator_stack.empty() && !operator_stack.back().IsFrame()) {
+		MacroPrecedence previous(OperatorPrecedence(operator_stack.back().type));
+		//賦值運算子為右結合
+		if (previous < precedence || (previous == precedence && type == ASSIGNMENT_OPERATOR)) break;
+		if (!ReduceOperator()) return false;
 	}
-	//關鍵字容器均為空
-	else return false;
+	//存入二元運算子,等待右運算元
+	operator_stack.emplace_back(type, address, operand_stack.size(), id);
+	expect_operand = true;
+	return true;
 }
 
-bool MacroGenerator::CreateBinaryOperator()
+bool MacroGenerator::ReduceOperator()
 {
-	//新運算子Handle
-	shared_ptr<ArithmeticOperator> next_operator;
-	//前運算子Handle
-	shared_ptr<ArithmeticOperator> last_operator;
-	//賦值運算子之左運算元暫存
-	shared_ptr<ArithmeticOperator> assignment_left_operand;
-	//函數雙引數之第一引數暫存
-	shared_ptr<ArithmeticOperator> function_first_argument;
-
-	//檢查函數雙引數旗標並確認容器內有算術運算元存在
-	if (TwoArgumentsFlag() && !GeneralOperators().empty() && GeneralOperators().front().arithmetic) {
-		//複製並暫存第一引數
-		function_first_argument = GeneralOperators().front().arithmetic;
-		//移除容器內第一引數
-		GeneralOperators().pop_front();
-	}
+	//取出待建立運算子
+	MacroStackOperator pending(operator_stack.back());
+	operator_stack.pop_back();
+	//前置運算子已在運算元完成時建立,不應殘留
+	if (OperatorPrecedence(pending.type) == PRECEDENCE_PREFIX) return false;
+	return CreateBinaryOperator(pending);
+}
 
-	//容器內仍有二元運算子位址字元則持續處理
-	while (!BinaryOperatorAddress().empty()) {
-		//取得下一個二元運算子位址字元
-		unsigned char address(BinaryOperatorAddress().front());
-		//前運算子為空Handle且容器內至少有二個運算子
-		if (!last_operator && GeneralOperators().size() > 1) {
-			//複製左運算元
-			GeneralOperatorHandle left_operand(GeneralOperators().front());
-			//清除容器內左運算元
-			GeneralOperators().pop_front();
-			//複製右運算元
-			GeneralOperatorHandle right_operand(GeneralOperators().front());
-			//清除容器內右運算元
-			GeneralOperators().pop_front();
-			//左右運算元均為算術運算子
-			if (left_operand.arithmetic && right_operand.arithmetic) {
-				//建立前運算子(加法):使用左右運算元
-				if (address == ADDRESS_ADD_OPERATOR) last_operator = shared_ptr<ArithmeticOperator>(new AddOperator(left_operand.arithmetic, right_operand.arithmetic));
-				//建立前運算子(減法):使用左右運算元
-				else if (address == ADDRESS_MINUS_SUBTRACT_OPERATOR) last_operator = shared_ptr<ArithmeticOperator>(new SubtractOperator(left_operand.arithmetic, right_operand.arithmetic));
-				//建立前運算子(賦值):使用左右運算元
-				else if (address == ADDRESS_ASSIGNMENT_OPERATOR) {
-					//運算元剛好只有二個,直接建立賦值運算子
-					if (GeneralOperators().empty()) last_operator = shared_ptr<ArithmeticOperator>(new AssignmentOperator(left_operand.arithmetic, right_operand.arithmetic));
-					//運算元超過兩個
-					else {
-						//暫存賦值左運算元
-						assignment_left_operand = left_operand.arithmetic;
-						//回存右運算元
-						GeneralOperators().push_front(right_operand);
-					}
-				}
-				//返回錯誤:不合法運算子位址字元
-				else {
-					//回存右運算元
-					GeneralOperators().push_front(right_operand);
-					//回存左運算元
-					GeneralOperators().push_front(left_operand);
-					//有暫存賦值左運算元
-					if (assignment_left_operand) {
-						//回存賦值運算子位址字元
-						BinaryOperatorAddress().push_front(ADDRESS_ASSIGNMENT_OPERATOR);
-						//回存賦值左運算元
-						GeneralOperators().push_front(GeneralOperatorHandle(assignment_left_operand));
-					}
-					//檢查函數第一引數暫存
-					if (function_first_argument) {
-						//回存函數第一引數
-						GeneralOperators().push_front(GeneralOperatorHandle(function_first_argument));
-					}
-					return false;
-				}
-				//刪除一個運算子位址字元
-				BinaryOperatorAddress().pop_front();
-			}
-			else if (left_operand.arithmetic && right_operand.logical && GeneralOperators().empty() && address == ADDRESS_ASSIGNMENT_OPERATOR) {
-				last_operator = shared_ptr<ArithmeticOperator>(new AssignmentOperator(left_operand.arithmetic, right_operand.logical));
-				//刪除一個運算子位址字元
-				BinaryOperatorAddress().pop_front();
-			}
-			//左右運算元不合法
-			else {
-				//回存右運算元
-				GeneralOperators().push_front(right_operand);
-				//回存左運算元
-				GeneralOperators().push_front(left_operand);
-				//有暫存賦值左運算元
-				if (assignment_left_operand) {
-					//回存賦值運算子位址字元
-					BinaryOperatorAddress().push_front(ADDRESS_ASSIGNMENT_OPERATOR);
-					//回存賦值左運算元
-					GeneralOperators().push_front(GeneralOperatorHandle(assignment_left_operand));
-				}
-				//檢查函數第一引數暫存
-				if (function_first_argument) {
-					//回存函數第一引數
-					GeneralOperators().push_front(GeneralOperatorHandle(function_first_argument));
-				}
-				return false;
-			}
-		}
-		//前運算子存在且容器內至少有一個運算子
-		else if (last_operator && !GeneralOperators().empty()) {
-			//複製右運算元
-			GeneralOperatorHandle right_operand(GeneralOperators().front());
-			//清除容器內右運算元
-			GeneralOperators().pop_front();
-			//右運算元為算術運算子
-			if (right_operand.arithmetic) {
-				//建立新運算子(加法):使用前(算術)運算子為左運算元,一個右運算元
-				if (address == ADDRESS_ADD_OPERATOR) next_operator = shared_ptr<ArithmeticOperator>(new AddOperator(last_operator, right_operand.arithmetic));
-				//建立新運算子(減法):使用前(算術)運算子為左運算元,一個右運算元
-				else if (address == ADDRESS_MINUS_SUBTRACT_OPERATOR) next_operator = shared_ptr<ArithmeticOperator>(new SubtractOperator(last_operator, right_operand.arithmetic));
-				//返回錯誤:不合法運算子位址字元
-				else {
-					//回存右運算元
-					GeneralOperators().push_front(right_operand);
-					//有暫存賦值左運算元
-					if (assignment_left_operand) {
-						//回存賦值運算子位址字元
-						BinaryOperatorAddress().push_front(ADDRESS_ASSIGNMENT_OPERATOR);
-						//回存賦值左運算元
-						GeneralOperators().push_front(GeneralOperatorHandle(assignment_left_operand));
-					}
-					//檢查函數第一引數暫存
-					if (function_first_argument) {
-						//回存函數第一引數
-						GeneralOperators().push_front(GeneralOperatorHandle(function_first_argument));
-					}
-					return false;
-				}
-				//刪除一個運算子位址字元
-				BinaryOperatorAddress().pop_front();
-				//新運算子成為前運算子(前運算子Handle自動清空)
-				last_operator = next_operator;
-			}
-			//右運算元不合法
-			else {
-				//回存右運算元
-				GeneralOperators().push_front(right_operand);
-				//有暫存賦值左運算元
-				if (assignment_left_operand) {
-					//回存賦值運算子位址字元
-					BinaryOperatorAddress().push_front(ADDRESS_ASSIGNMENT_OPERATOR);
-					//回存賦值左運算元
-					GeneralOperators().push_front(GeneralOperatorHandle(assignment_left_operand));
-				}
-				//檢查函數第一引數暫存
-				if (function_first_argument) {
-					//回存函數第一引數
-					GeneralOperators().push_front(GeneralOperatorHandle(function_first_argument));
-				}
-				return false;
-			}
-		}
-		//返回錯誤:未滿足建立新運算元的初始條件
-		else {
-			//有暫存賦值左運算元
-			if (assignment_left_operand) {
-				//回存賦值運算子位址字元
-				BinaryOperatorAddress().push_front(ADDRESS_ASSIGNMENT_OPERATOR);
-				//回存賦值左運算元
-				GeneralOperators().push_front(GeneralOperatorHandle(assignment_left_operand));
-			}
-			//檢查函數第一引數暫存
-			if (function_first_argument) {
-				//回存函數第一引數
-				GeneralOperators().push_front(GeneralOperatorHandle(function_first_argument));
-			}
-			return false;
-		}
+bool MacroGenerator::ReduceToFrame()
+{
+	while (!operator_stack.empty() && !operator_stack.back().IsFrame()) {
+		if (!ReduceOperator()) return false; }
+	return true;
+}
+
+size_t MacroGenerator::InnermostFrame() const
+{
+	for (size_t index = operator_stack.size(); index != 0; --index) {
+		if (operator_stack[index - 1].IsFrame()) {
+			return index - 1; }
 	}
+	return NO_FRAME;
+}
 
-	//運算元容器已清空且前運算子存在
-	if (GeneralOperators().empty() && last_operator) {
-		//無暫存賦值左運算元
-		if (!assignment_left_operand) {
-			//將最終的前運算子放入一般運算元容器
-			GeneralOperators().push_back(GeneralOperatorHandle(last_operator));
-		}
-		//有暫存賦值左運算元
+bool MacroGenerator::CloseNCAddress()
+{
+	//最內層範圍必須為NC位址範圍
+	size_t frame(InnermostFrame());
+	if (frame == NO_FRAME || operator_stack[frame].IsPriorityRange()) return false;
+	//NC位址字元缺少數值
+	if (expect_operand) return false;
+	//建立NC位址數值
+	if (!ReduceToFrame()) return false;
+	//NC位址範圍內應只有單一數值
+	if (operand_stack.size() != operator_stack.back().operand_base + 1) return false;
+	//保存算術數值的NC位址字,並移除NC位址數值及範圍標記
+	if (operand_stack.back().arithmetic) {
+		address_words.emplace_back(operator_stack.back().text.front(), operand_stack.back().arithmetic); }
+	operand_stack.pop_back();
+	operator_stack.pop_back();
+	return true;
+}
+
+bool MacroGenerator::ApplyPrefixOperators()
+{
+	//運算元已完成
+	expect_operand = false;
+	//由內而外建立前置一元運算子(#,minus)
+	while (!operator_stack.empty() && operator_stack.back().type == UNARY_OPERATOR) {
+		//運算元必須為算術運算子
+		if (!operand_stack.back().arithmetic) return false;
+
+		shared_ptr<ArithmeticOperator> handle;
+		if (operator_stack.back().text.front() == ADDRESS_VARIABLE_OPERATOR) {
+			handle = CreateNode<VariableOperator>(macro_variable_interface, operand_stack.back().arithmetic); }
 		else {
-			next_operator = shared_ptr<ArithmeticOperator>(new AssignmentOperator(assignment_left_operand, last_operator));
-			//建立最終的賦值運算子並放入一般運算元容器
-			GeneralOperators().push_back(GeneralOperatorHandle(next_operator));
-		}
-		//檢查函數第一引數暫存
-		if (function_first_argument) {
-			//回存函數第一引數
-			GeneralOperators().push_front(GeneralOperatorHandle(function_first_argument));
+			handle = CreateNode<MinusOperator>(operand_stack.back().arithmetic);
+			if (IsConstant(operand_stack.back().arithmetic)) {
+				handle = FoldConstant(handle); }
 		}
-		return true;
-	}
-	//未成功建立前運算子或運算子數量異常
-	else {
-		//有暫存賦值左運算元
-		if (assignment_left_operand) {
-			//回存賦值運算子位址字元
-			BinaryOperatorAddress().push_front(ADDRESS_ASSIGNMENT_OPERATOR);
-			//回存賦值左運算元
-			GeneralOperators().push_front(GeneralOperatorHandle(assignment_left_operand));
-		}
-		//檢查函數第一引數暫存
-		if (function_first_argument) {
-			//回存函數第一引數
-			GeneralOperators().push_front(GeneralOperatorHandle(function_first_argument));
-		}
-		return false;
+		//以新運算子取代運算元
+		operand_stack.back() = GeneralOperatorHandle(ShareNode(handle));
+		operator_stack.pop_back();
 	}
+	return true;
 }
 
-bool MacroGenerator::CreatePriorityBinaryOperator()
+shared_ptr<ArithmeticOperator> MacroGenerator::FoldConstant(const shared_ptr<ArithmeticOperator>& handle)
 {
-	//新運算子Handle
-	shared_ptr<ArithmeticOperator> next_operator;
-	//前運算子Handle
-	shared_ptr<ArithmeticOperator> last_operator;
-
-	//容器內仍有優先二元運算子位址字元則持續處理
-	while (!PriorityBinaryOperatorAddress().empty()) {
-		//取得下一個優先二元運算子位址字元
-		unsigned char address(PriorityBinaryOperatorAddress().front());
-		//前運算子為空Handle且容器內至少有二個運算子
-		if (!last_operator && PriorityGeneralOperators().size() > 1) {
-			//複製左運算元
-			GeneralOperatorHandle left_operand(PriorityGeneralOperators().front());
-			//清除容器內左運算元
-			PriorityGeneralOperators().pop_front();
-			//複製右運算元
-			GeneralOperatorHandle right_operand(PriorityGeneralOperators().front());
-			//清除容器內右運算元
-			PriorityGeneralOperators().pop_front();
-			//左右運算元均為算術運算子
-			if (left_operand.arithmetic && right_operand.arithmetic) {
-				//建立前運算子(乘法):使用一個左運算元
-				if (address == '*') last_operator = shared_ptr<ArithmeticOperator>(new MultiplyOperator(left_operand.arithmetic, right_operand.arithmetic));
-				//建立前運算子(除法):使用一個左運算元
-				else if (address == '/') last_operator = shared_ptr<ArithmeticOperator>(new DivideOperator(left_operand.arithmetic, right_operand.arithmetic));
-				//返回錯誤:不合法運算子位址字元
-				else {
-					//回存右運算元
-					PriorityGeneralOperators().push_front(right_operand);
-					//回存左運算元
-					PriorityGeneralOperators().push_front(left_operand);
-					return false;
-				}
-				//刪除一個運算子位址字元
-				PriorityBinaryOperatorAddress().pop();
-			}
-			//左右運算元不合法
-			else {
-				//回存右運算元
-				PriorityGeneralOperators().push_front(right_operand);
-				//回存左運算元
-				PriorityGeneralOperators().push_front(left_operand);
-				return false;
-			}
-		}
-		//前運算子存在且容器內至少有一個運算子
-		else if (last_operator && !PriorityGeneralOperators().empty()) {
-			//複製右運算元
-			GeneralOperatorHandle right_operand(PriorityGeneralOperators().front());
-			//清除容器內右運算元
-			PriorityGeneralOperators().pop_front();
-			//右運算元為算術運算子
-			if (right_operand.arithmetic) {
-				//建立新運算子(乘法):使用前(算術)運算子為左運算元,一個右運算元
-				if (address == '*') next_operator = shared_ptr<ArithmeticOperator>(new MultiplyOperator(last_operator, right_operand.arithmetic));
-				//建立新運算子(除法):使用前運算子為左運算元,一個右運算元
-				else if (address == '/') next_operator = shared_ptr<ArithmeticOperator>(new DivideOperator(last_operator, right_operand.arithmetic));
-				//返回錯誤:不合法運算子位址字元
-				else {
-					//回存右運算元
-					PriorityGeneralOperators().push_front(right_operand);
-					return false;
-				}
-				//刪除一個運算子位址字元
-				PriorityBinaryOperatorAddress().pop();
-				//新運算子成為前運算子(前運算子Handle自動清空)
-				last_operator = next_operator;
-			}
-			//右運算元不合法
-			else {
-				//回存右運算元
-				PriorityGeneralOperators().push_front(right_operand);
-				return false;
-			}
-		}
-		//返回錯誤:未滿足建立新運算元的初始條件
-		else return false;
-	}
+	//以運算子本身核算,保持與執行時完全相同的結果
+	return CreateNode<ConstantOperator>(handle->Evaluate());
+}
 
-	//運算元容器已清空且前運算子存在
-	if (PriorityGeneralOperators().empty() && last_operator) {
-		//將最終的前運算子放入一般運算元容器
-		GeneralOperators().push_back(GeneralOperatorHandle(last_operator));
-		return true;
+size_t MacroNodeKey::Hash() const
+{
+	size_t hash(static_cast<size_t>(id) * 0x9E3779B97F4A7C15ull);
+	hash ^= reinterpret_cast<uintptr_t>(left) + 0x9E3779B9 + (hash << 6) + (hash >> 2);
+	hash ^= reinterpret_cast<uintptr_t>(right) + 0x9E3779B9 + (hash << 6) + (hash >> 2);
+	hash ^= static_cast<size_t>(value) + 0x9E3779B9 + (hash << 6) + (hash >> 2);
+	return hash;
+}
+
+MacroNodeKey MacroGenerator::NodeKey(const ArithmeticOperator* node)
+{
+	MacroOperatorID id(node->GetOperatorID());
+	switch (id) {
+		//常數值以位元比較(區分0與-0)
+	case CONSTANT:
+		return MacroNodeKey(id, nullptr, nullptr, bit_cast<uint64_t>(static_cast<const UnaryOperator*>(node)->Operand()));
+	case ADD_DECIMAL_POINT: {
+		const AddDecimalPointOperator* add_decimal_point(static_cast<const AddDecimalPointOperator*>(node));
+		return MacroNodeKey(id, add_decimal_point->OperandHandle().get(), nullptr, bit_cast<uint64_t>(add_decimal_point->LeastIncrement()));
 	}
-	//未成功建立前運算子或運算子數量異常
-	else {
-		return false;
+	case ADD:
+	case SUBSTRACT:
+	case MULTIPLY:
+	case DIVIDE:
+	case ARC_TANGENT2:
+	case POWER: {
+		const BinaryOperator* binary(static_cast<const BinaryOperator*>(node));
+		return MacroNodeKey(id, binary->LeftOperand().get(), binary->RightOperand().get(), 0);
+	}
+	default:
+		return MacroNodeKey(id, static_cast<const UnaryOperator*>(node)->OperandHandle().get(), nullptr, 0);
 	}
 }
 
-bool MacroGenerator::CreateRelationalOperator()
+size_t MacroGenerator::FindSharedNode(const MacroNodeKey& key) const
 {
-	//容器內有關係運算子關鍵字且有兩個運算元
-	if (!RelationalKeyword().empty() && GeneralOperators().size() == 2) {
-		//取得關鍵字字串
-		string keyword(RelationalKeyword().back());
-		//關鍵字為"等於"運算子
-		if (keyword == KEYWORD_EQUAL_OPERATOR) {
-			//返回錯誤:左或右運算元非算術運算子
-			if (!GeneralOperators().front().arithmetic || !GeneralOperators().back().arithmetic) return false;
-			//確認左右運算元均為算術運算子
-			else {
-				//建立關係運算子Handle
-				shared_ptr<RelationalOperator> relation(new EqualOperator(GeneralOperators().front().arithmetic, GeneralOperators().back().arithmetic));
-				//刪除關鍵字串
-				RelationalKeyword().pop_back();
-				//刪除左右運算元
-				GeneralOperators().clear();
-				//存入通用運算子容器
-				GeneralOperators().push_back(GeneralOperatorHandle(relation));
-				return true;
-			}
-		}
-		//關鍵字為"不等於"運算子
-		else if (keyword == KEYWORD_NOT_EQUAL_OPERATOR) {
-			//返回錯誤:左或右運算元非算術運算子
-			if (!GeneralOperators().front().arithmetic || !GeneralOperators().back().arithmetic) return false;
-			//確認左右運算元均為算術運算子
-			else {
-				//建立關係運算子Handle
-				shared_ptr<RelationalOperator> relation(new NotEqualOperator(GeneralOperators().front().arithmetic, GeneralOperators().back().arithmetic));
-				//刪除關鍵字串
-				RelationalKeyword().pop_back();
-				//刪除左右運算元
-				GeneralOperators().clear();
-				//存入通用運算子容器
-				GeneralOperators().push_back(GeneralOperatorHandle(relation));
-				return true;
-			}
-		}
-		//關鍵字為"大於"運算子
-		else if (keyword == KEYWORD_GREATER_OPERATOR) {
-			//返回錯誤:左或右運算元非算術運算子
-			if (!GeneralOperators().front().arithmetic || !GeneralOperators().back().arithmetic) return false;
-			//確認左右運算元均為算術運算子
-			else {
-				//建立關係運算子Handle
-				shared_ptr<RelationalOperator> relation(new GreaterOperator(GeneralOperators().front().arithmetic, GeneralOperators().back().arithmetic));
-				//刪除關鍵字串
-				RelationalKeyword().pop_back();
-				//刪除左右運算元
-				GeneralOperators().clear();
-				//存入通用運算子容器
-				GeneralOperators().push_back(GeneralOperatorHandle(relation));
-				return true;
-			}
-		}
-		//關鍵字為"大於等於"運算子
-		else if (keyword == KEYWORD_GREATER_EQUAL_OPERATOR) {
-			//返回錯誤:左或右運算元非算術運算子
-			if (!GeneralOperators().front().arithmetic || !GeneralOperators().back().arithmetic) return false;
-			//確認左右運算元均為算術運算子
-			else {
-
-				//建立關係運算子Handle
-				shared_ptr<RelationalOperator> relation(new GreaterEqualOperator(GeneralOperators().front().arithmetic, GeneralOperators().back().arithmetic));
-				//刪除關鍵字串
-				RelationalKeyword().pop_back();
-				//刪除左右運算元
-				GeneralOperators().clear();
-				//存入通用運算子容器
-				GeneralOperators().push_back(GeneralOperatorHandle(relation));
-				return true;
-			}
-		}
-		//關鍵字為"小於"運算子
-		else if (keyword == KEYWORD_LESS_OPERATOR) {
-			//返回錯誤:左或右運算元非算術運算子
-			if (!GeneralOperators().front().arithmetic || !GeneralOperators().back().arithmetic) return false;
-			//確認左右運算元均為算術運算子
-			else {
-				//建立關係運算子Handle
-				shared_ptr<RelationalOperator> relation(new LessOperator(GeneralOperators().front().arithmetic, GeneralOperators().back().arithmetic));
-				//刪除關鍵字串
-				RelationalKeyword().pop_back();
-				//刪除左右運算元
-				GeneralOperators().clear();
-				//存入通用運算子容器
-				GeneralOperators().push_back(GeneralOperatorHandle(relation));
-				return true;
-			}
-		}
-		//關鍵字為"小於等於"運算子
-		else if (keyword == KEYWORD_LESS_EQUAL_OPERATOR) {
-			//返回錯誤:左或右運算元非算術運算子
-			if (!GeneralOperators().front().arithmetic || !GeneralOperators().back().arithmetic) return false;
-			//確認左右運算元均為算術運算子
-			else {
-				//建立關係運算子Handle
-				shared_ptr<RelationalOperator> relation(new LessEqualOperator(GeneralOperators().front().arithmetic, GeneralOperators().back().arithmetic));
-				//刪除關鍵字串
-				RelationalKeyword().pop_back();
-				//刪除左右運算元
-				GeneralOperators().clear();
-				//存入通用運算子容器
-				GeneralOperators().push_back(GeneralOperatorHandle(relation));
-				return true;
-			}
-		}
-		//關鍵字不合法
-		else return false;
-	}
-	//返回錯誤:未滿足建立關係運算子的初始條件
-	return false;
+	//線性探測至相同鍵值或空位
+	size_t mask(shared_index.size() - 1);
+	size_t position(key.Hash() & mask);
+	while (shared_index[position] != NO_SHARED_NODE && !(shared_nodes[shared_index[position]].key == key)) {
+		position = (position + 1) & mask; }
+	return position;
 }
 
-bool MacroGenerator::CreateLogicalOperator()
+void MacroGenerator::ClearSharedNodes()
 {
-	//新運算子Handle
-	shared_ptr<LogicalOperator> next_operator;
-	//前運算子Handle
-	shared_ptr<LogicalOperator> last_operator;
-	//賦值左運算元Handle
-	shared_ptr<ArithmeticOperator> assignment_left_operand;
-
-	//有賦值運算子位址字元
-	if (!BinaryOperatorAddress().empty() && BinaryOperatorAddress().front() == ADDRESS_ASSIGNMENT_OPERATOR) {
-		//有至少一個運算元且為算術運算子
-		if (!GeneralOperators().empty() && GeneralOperators().front().arithmetic) {
-			//刪除位址字元
-			BinaryOperatorAddress().pop_front();
-			//複製暫存賦值左運算元
-			assignment_left_operand = GeneralOperators().front().arithmetic;
-			//刪除左運算元
-			GeneralOperators().pop_front();
-		}
-	}
+	if (shared_nodes.empty()) {
+		return; }
+	//保留容量以免重複配置
+	shared_nodes.clear();
+	fill(shared_index.begin(), shared_index.end(), NO_SHARED_NODE);
+	subexpression_found = false;
+}
 
-	//容器內仍有邏輯運算子關鍵字則持續處理
-	while (!LogicalKeyword().empty()) {
-		//取得下一個邏輯運算子關鍵字
-		string keyword(LogicalKeyword().front());
-		//前運算子為空Handle且容器內至少有二個運算元
-		if (!last_operator && GeneralOperators().size() > 1) {
-			//複製左運算元
-			GeneralOperatorHandle left_operand(GeneralOperators().front());
-			//清除容器內左運算元
-			GeneralOperators().pop_front();
-			//複製右運算元
-			GeneralOperatorHandle right_operand(GeneralOperators().front());
-			//清除容器內右運算元
-			GeneralOperators().pop_front();
-			//左右運算元均為算術運算子
-			if (left_operand.arithmetic && right_operand.arithmetic) {
-				//建立前運算子(OR):使用左右運算元
-				if (keyword == KEYWORD_OR_OPERATOR) last_operator = shared_ptr<LogicalOperator>(new OR_Operator(left_operand.arithmetic, right_operand.arithmetic));
-				//建立前運算子(XOR):使用左右運算元
-				else if (keyword == KEYWORD_XOR_OPERATOR) last_operator = shared_ptr<LogicalOperator>(new XOR_Operator(left_operand.arithmetic, right_operand.arithmetic));
-				//返回錯誤:不合法運算子關鍵字
-				else {
-					//回存右運算元
-					GeneralOperators().push_front(right_operand);
-					//回存左運算元
-					GeneralOperators().push_front(left_operand);
-					//有暫存賦值左運算元
-					if (assignment_left_operand) {
-						//回存賦值位址字元
-						BinaryOperatorAddress().push_front(ADDRESS_ASSIGNMENT_OPERATOR);
-						//回存賦值左運算元
-						GeneralOperators().push_front(GeneralOperatorHandle(assignment_left_operand));
-					}
-					return false;
-				}
-				//刪除一個運算子關鍵字
-				LogicalKeyword().pop_front();
-			}
-			//左右運算元均為邏輯運算子
-			else if (left_operand.logical && right_operand.logical) {
-				//建立前運算子(OR):使用左右運算元
-				if (keyword == KEYWORD_OR_OPERATOR) last_operator = shared_ptr<LogicalOperator>(new OR_Operator(left_operand.logical, right_operand.logical));
-				//建立前運算子(XOR):使用左右運算元
-				else if (keyword == KEYWORD_XOR_OPERATOR) last_operator = shared_ptr<LogicalOperator>(new XOR_Operator(left_operand.logical, right_operand.logical));
-				//返回錯誤:不合法運算子關鍵字
-				else {
-					//回存右運算元
-					GeneralOperators().push_front(right_operand);
-					//回存左運算元
-					GeneralOperators().push_front(left_operand);
-					//有暫存賦值左運算元
-					if (assignment_left_operand) {
-						//回存賦值位址字元
-						BinaryOperatorAddress().push_front(ADDRESS_ASSIGNMENT_OPERATOR);
-						//回存賦值左運算元
-						GeneralOperators().push_front(GeneralOperatorHandle(assignment_left_operand));
-					}
-					return false;
-				}
-				//刪除一個運算子關鍵字
-				LogicalKeyword().pop_front();
-			}
-			//左運算元為算術運算子,右運算元為邏輯運算子
-			else if (left_operand.arithmetic && right_operand.logical) {
-				//建立前運算子(OR):使用左右運算元
-				if (keyword == KEYWORD_OR_OPERATOR) last_operator = shared_ptr<LogicalOperator>(new OR_Operator(left_operand.arithmetic, right_operand.logical));
-				//建立前運算子(XOR):使用左右運算元
-				else if (keyword == KEYWORD_XOR_OPERATOR) last_operator = shared_ptr<LogicalOperator>(new XOR_Operator(left_operand.arithmetic, right_operand.logical));
-				//返回錯誤:不合法運算子關鍵字
-				else {
-					//回存右運算元
-					GeneralOperators().push_front(right_operand);
-					//回存左運算元
-					GeneralOperators().push_front(left_operand);
-					//有暫存賦值左運算元
-					if (assignment_left_operand) {
-						//回存賦值位址字元
-						BinaryOperatorAddress().push_front(ADDRESS_ASSIGNMENT_OPERATOR);
-						//回存賦值左運算元
-						GeneralOperators().push_front(GeneralOperatorHandle(assignment_left_operand));
-					}
-					return false;
-				}
-				//刪除一個運算子關鍵字
-				LogicalKeyword().pop_front();
-			}
-			//左運算元為邏輯運算子,右運算元為算術運算子
-			else if (left_operand.logical && right_operand.arithmetic) {
-				//建立前運算子(OR):使用左右運算元
-				if (keyword == KEYWORD_OR_OPERATOR) last_operator = shared_ptr<LogicalOperator>(new OR_Operator(left_operand.logical, right_operand.arithmetic));
-				//建立前運算子(XOR):使用左右運算元
-				else if (keyword == KEYWORD_XOR_OPERATOR) last_operator = shared_ptr<LogicalOperator>(new XOR_Operator(left_operand.logical, right_operand.arithmetic));
-				//返回錯誤:不合法運算子關鍵字
-				else {
-					//回存右運算元
-					GeneralOperators().push_front(right_operand);
-					//回存左運算元
-					GeneralOperators().push_front(left_operand);
-					//有暫存賦值左運算元
-					if (assignment_left_operand) {
-						//回存賦值位址字元
-						BinaryOperatorAddress().push_front(ADDRESS_ASSIGNMENT_OPERATOR);
-						//回存賦值左運算元
-						GeneralOperators().push_front(GeneralOperatorHandle(assignment_left_operand));
-					}
-					return false;
-				}
-				//刪除一個運算子關鍵字
-				LogicalKeyword().pop_front();
-			}
-			//左右運算元均為關係運算子
-			else if (left_operand.relational && right_operand.relational) {
-				//建立前運算子(OR):使用左右運算元
-				if (keyword == KEYWORD_OR_OPERATOR) last_operator = shared_ptr<LogicalOperator>(new OR_Operator(left_operand.relational, right_operand.relational));
-				//建立前運算子(XOR):使用左右運算元
-				else if (keyword == KEYWORD_XOR_OPERATOR) last_operator = shared_ptr<LogicalOperator>(new XOR_Operator(left_operand.relational, right_operand.relational));
-				//返回錯誤:不合法運算子關鍵字
-				else {
-					//回存右運算元
-					GeneralOperators().push_front(right_operand);
-					//回存左運算元
-					GeneralOperators().push_front(left_operand);
-					//有暫存賦值左運算元
-					if (assignment_left_operand) {
-						//回存賦值位址字元
-						BinaryOperatorAddress().push_front(ADDRESS_ASSIGNMENT_OPERATOR);
-						//回存賦值左運算元
-						GeneralOperators().push_front(GeneralOperatorHandle(assignment_left_operand));
-					}
-					return false;
-				}
-				//刪除一個運算子關鍵字
-				LogicalKeyword().pop_front();
-			}
-			//左運算元為關係運算子,右運算元為邏輯運算子
-			else if (left_operand.relational && right_operand.logical) {
-				//建立前運算子(OR):使用左右運算元
-				if (keyword == KEYWORD_OR_OPERATOR) last_operator = shared_ptr<LogicalOperator>(new OR_Operator(left_operand.relational, right_operand.logical));
-				//建立前運算子(XOR):使用左右運算元
-				else if (keyword == KEYWORD_XOR_OPERATOR) last_operator = shared_ptr<LogicalOperator>(new XOR_Operator(left_operand.relational, right_operand.logical));
-				//返回錯誤:不合法運算子關鍵字
-				else {
-					//回存右運算元
-					GeneralOperators().push_front(right_operand);
-					//回存左運算元
-					GeneralOperators().push_front(left_operand);
-					//有暫存賦值左運算元
-					if (assignment_left_operand) {
-						//回存賦值位址字元
-						BinaryOperatorAddress().push_front(ADDRESS_ASSIGNMENT_OPERATOR);
-						//回存賦值左運算元
-						GeneralOperators().push_front(GeneralOperatorHandle(assignment_left_operand));
-					}
-					return false;
-				}
-				//刪除一個運算子關鍵字
-				LogicalKeyword().pop_front();
-			}
-			//左運算元為邏輯運算子,右運算元為關係運算子
-			else if (left_operand.logical && right_operand.relational) {
-				//建立前運算子(OR):使用左右運算元
-				if (keyword == KEYWORD_OR_OPERATOR) last_operator = shared_ptr<LogicalOperator>(new OR_Operator(left_operand.logical, right_operand.relational));
-				//建立前運算子(XOR):使用左右運算元
-				else if (keyword == KEYWORD_XOR_OPERATOR) last_operator = shared_ptr<LogicalOperator>(new XOR_Operator(left_operand.logical, right_operand.relational));
-				//返回錯誤:不合法運算子關鍵字
-				else {
-					//回存右運算元
-					GeneralOperators().push_front(right_operand);
-					//回存左運算元
-					GeneralOperators().push_front(left_operand);
-					//有暫存賦值左運算元
-					if (assignment_left_operand) {
-						//回存賦值位址字元
-						BinaryOperatorAddress().push_front(ADDRESS_ASSIGNMENT_OPERATOR);
-						//回存賦值左運算元
-						GeneralOperators().push_front(GeneralOperatorHandle(assignment_left_operand));
-					}
-					return false;
-				}
-				//刪除一個運算子關鍵字
-				LogicalKeyword().pop_front();
-			}
-			//左右運算元不合法
-			else {
-				//回存右運算元
-				GeneralOperators().push_front(right_operand);
-				//回存左運算元
-				GeneralOperators().push_front(left_operand);
-				//有暫存賦值左運算元
-				if (assignment_left_operand) {
-					//回存賦值位址字元
-					BinaryOperatorAddress().push_front(ADDRESS_ASSIGNMENT_OPERATOR);
-					//回存賦值左運算元
-					GeneralOperators().push_front(GeneralOperatorHandle(assignment_left_operand));
-				}
-				return false;
-			}
-		}
-		//前運算子存在且容器內至少有一個運算元
-		else if (last_operator && !GeneralOperators().empty()) {
-			//複製右運算元
-			GeneralOperatorHandle right_operand(GeneralOperators().front());
-			//清除容器內右運算元
-			GeneralOperators().pop_front();
-			//右運算元為算術運算子
-			if (right_operand.arithmetic) {
-				//建立新運算子(OR):使用前運算子為左運算元,一個右運算元
-				if (keyword == KEYWORD_OR_OPERATOR) next_operator = shared_ptr<LogicalOperator>(new OR_Operator(last_operator, right_operand.arithmetic));
-				//建立新運算子(XOR):使用前運算子為左運算元,一個右運算元
-				else if (keyword == KEYWORD_XOR_OPERATOR) next_operator = shared_ptr<LogicalOperator>(new XOR_Operator(last_operator, right_operand.arithmetic));
-				//返回錯誤:不合法運算子關鍵字
-				else {
-					//回存右運算元
-					GeneralOperators().push_front(right_operand);
-					//有暫存賦值左運算元
-					if (assignment_left_operand) {
-						//回存賦值位址字元
-						BinaryOperatorAddress().push_front(ADDRESS_ASSIGNMENT_OPERATOR);
-						//回存賦值左運算元
-						GeneralOperators().push_front(GeneralOperatorHandle(assignment_left_operand));
-					}
-					return false;
-				}
-				//刪除一個運算子關鍵字
-				LogicalKeyword().pop_front();
-				//新運算子成為前運算子(前運算子Handle自動清空)
-				last_operator = next_operator;
-			}
-			//右運算元為邏輯運算子
-			else if (right_operand.logical) {
-				//建立新運算子(OR):使用前運算子為左運算元,一個右運算元
-				if (keyword == KEYWORD_OR_OPERATOR) next_operator = shared_ptr<LogicalOperator>(new OR_Operator(last_operator, right_operand.logical));
-				//建立新運算子(XOR):使用前運算子為左運算元,一個右運算元
-				else if (keyword == KEYWORD_XOR_OPERATOR) next_operator = shared_ptr<LogicalOperator>(new XOR_Operator(last_operator, right_operand.logical));
-				//返回錯誤:不合法運算子關鍵字
-				else {
-					//回存右運算元
-					GeneralOperators().push_front(right_operand);
-					//有暫存賦值左運算元
-					if (assignment_left_operand) {
-						//回存賦值位址字元
-						BinaryOperatorAddress().push_front(ADDRESS_ASSIGNMENT_OPERATOR);
-						//回存賦值左運算元
-						GeneralOperators().push_front(GeneralOperatorHandle(assignment_left_operand));
-					}
-					return false;
-				}
-				//刪除一個運算子關鍵字
-				LogicalKeyword().pop_front();
-				//新運算子成為前運算子(前運算子Handle自動清空)
-				last_operator = next_operator;
-			}
-			//右運算元為關係運算子
-			else if (right_operand.relational) {
-				//建立新運算子(OR):使用前運算子為左運算元,一個右運算元
-				if (keyword == KEYWORD_OR_OPERATOR) next_operator = shared_ptr<LogicalOperator>(new OR_Operator(last_operator, right_operand.relational));
-				//建立新運算子(XOR):使用前運算算算子為左運算元,一個右運算元
-				else if (keyword == KEYWORD_XOR_OPERATOR) next_operator = shared_ptr<LogicalOperator>(new XOR_Operator(last_operator, right_operand.relational));
-				//返回錯誤:不合法運算子關鍵字
-				else {
-					//回存右運算元
-					GeneralOperators().push_front(right_operand);
-					//有暫存賦值左運算元
-					if (assignment_left_operand) {
-						//回存賦值位址字元
-						BinaryOperatorAddress().push_front(ADDRESS_ASSIGNMENT_OPERATOR);
-						//回存賦值左運算元
-						GeneralOperators().push_front(GeneralOperatorHandle(assignment_left_operand));
-					}
-					return false;
-				}
-				//刪除一個運算子關鍵字
-				LogicalKeyword().pop_front();
-				//新運算子成為前運算子(前運算子Handle自動清空)
-				last_operator = next_operator;
-			}
-			//右運算元不合法
-			else {
-				//回存右運算元
-				GeneralOperators().push_front(right_operand);
-				//有暫存賦值左運算元
-				if (assignment_left_operand) {
-					//回存賦值位址字元
-					BinaryOperatorAddress().push_front(ADDRESS_ASSIGNMENT_OPERATOR);
-					//回存賦值左運算元
-					GeneralOperators().push_front(GeneralOperatorHandle(assignment_left_operand));
-				}
-				return false;
-			}
-		}
-		//返回錯誤:未滿足建立新運算子的初始條件
-		else {
-			//有暫存賦值左運算元
-			if (assignment_left_operand) {
-				//回存賦值位址字元
-				BinaryOperatorAddress().push_front(ADDRESS_ASSIGNMENT_OPERATOR);
-				//回存賦值左運算元
-				GeneralOperators().push_front(GeneralOperatorHandle(assignment_left_operand));
-			}
-			return false;
-		}
+shared_ptr<ArithmeticOperator> MacroGenerator::ShareNode(const shared_ptr<ArithmeticOperator>& handle)
+{
+	//雜湊表負載超過一半時加倍容量並重建索引
+	if ((shared_nodes.size() + 1) * 2 > shared_index.size()) {
+		shared_index.assign(max(SHARED_INDEX_MIN, shared_index.size() * 2), NO_SHARED_NODE);
+		for (size_t index = 0; index != shared_nodes.size(); ++index) {
+			shared_index[FindSharedNode(shared_nodes[index].key)] = static_cast<uint32_t>(index); }
 	}
 
-	//運算元容器已清空且前運算子存在
-	if (GeneralOperators().empty() && last_operator) {
-		//無暫存賦值左運算元
-		if (!assignment_left_operand) {
-			//將最終的前運算子放入一般運算子容器
-			GeneralOperators().push_back(GeneralOperatorHandle(last_operator));
-		}
-		//有暫存賦值左運算元
-		else {
-			//建立賦值運算子:使用暫存賦值左運算元,前運算子為右運算元
-			shared_ptr<ArithmeticOperator> assignment(new AssignmentOperator(assignment_left_operand, last_operator));
-			//將最終賦值運算子存入一般運算子容器
-			GeneralOperators().push_back(GeneralOperatorHandle(assignment));
-		}
-		return true;
+	//已有結構相同的節點:沿用既有節點
+	MacroNodeKey key(NodeKey(handle.get()));
+	size_t position(FindSharedNode(key));
+	if (shared_index[position] != NO_SHARED_NODE) {
+		return shared_nodes[shared_index[position]].node; }
+
+	//新節點:累計子節點的參照數量
+	for (const ArithmeticOperator* child : { key.left, key.right }) {
+		if (!child) continue;
+		uint32_t index(shared_index[FindSharedNode(NodeKey(child))]);
+		if (index != NO_SHARED_NODE && ++shared_nodes[index].parents > 1 && child->GetOperatorID() != CONSTANT) {
+			subexpression_found = true; }
 	}
-	//未成功建立前運算子或運算子數量異常
-	else {
-		//有暫存賦值左運算元
-		if (assignment_left_operand) {
-			//回存賦值位址字元
-			BinaryOperatorAddress().push_front(ADDRESS_ASSIGNMENT_OPERATOR);
-			//回存賦值左運算元
-			GeneralOperators().push_front(GeneralOperatorHandle(assignment_left_operand));
-		}
+	shared_index[position] = static_cast<uint32_t>(shared_nodes.size());
+	shared_nodes.emplace_back(key, handle);
+	return handle;
+}
+
+bool MacroGenerator::ShareChildren(ArithmeticOperator* node)
+{
+	switch (node->GetOperatorID()) {
+	case CONSTANT:
 		return false;
+	case ADD:
+	case SUBSTRACT:
+	case MULTIPLY:
+	case DIVIDE:
+	case ARC_TANGENT2:
+	case POWER: {
+		BinaryOperator* binary(static_cast<BinaryOperator*>(node));
+		shared_ptr<ArithmeticOperator> left(binary->LeftOperand()), right(binary->RightOperand());
+		bool left_shared(ShareOperand(left));
+		bool right_shared(ShareOperand(right));
+		binary->SetOperands(left, right);
+		return left_shared || right_shared;
+	}
+	default: {
+		UnaryOperator* unary(static_cast<UnaryOperator*>(node));
+		shared_ptr<ArithmeticOperator> operand(unary->OperandHandle());
+		bool shared(ShareOperand(operand));
+		unary->SetOperandHandle(operand);
+		return shared;
+	}
 	}
 }
 
-bool MacroGenerator::CreatePriorityLogicalOperator()
+bool MacroGenerator::ShareOperand(shared_ptr<ArithmeticOperator>& operand)
 {
-	//新運算子Handle
-	shared_ptr<LogicalOperator> next_operator;
-	//前運算子Handle
-	shared_ptr<LogicalOperator> last_operator;
-
-	//容器內仍有邏輯運算子關鍵字則持續處理
-	while (!PriorityLogicalKeyword().empty()) {
-		//取得下一個邏輯運算子關鍵字
-		string keyword(PriorityLogicalKeyword().front());
-		//前運算子為空Handle且容器內至少有二個優先運算元
-		if (!last_operator && PriorityGeneralOperators().size() > 1) {
-			//複製左運算元
-			GeneralOperatorHandle left_operand(PriorityGeneralOperators().front());
-			//清除容器內左運算元
-			PriorityGeneralOperators().pop_front();
-			//複製右運算元
-			GeneralOperatorHandle right_operand(PriorityGeneralOperators().front());
-			//清除容器內右運算元
-			PriorityGeneralOperators().pop_front();
-			//左右運算元均為算術運算子
-			if (left_operand.arithmetic && right_operand.arithmetic) {
-				//建立前運算子(AND):使用左右運算元
-				if (keyword == KEYWORD_AND_OPERATOR) {
-					last_operator = shared_ptr<LogicalOperator>(new AND_Operator(left_operand.arithmetic, right_operand.arithmetic));
-					//刪除一個運算子關鍵字
-					PriorityLogicalKeyword().pop_front();
-				}
-				//返回錯誤:不合法運算子關鍵字
-				else {
-					//回存右運算元
-					PriorityGeneralOperators().push_front(right_operand);
-					//回存左運算元
-					PriorityGeneralOperators().push_front(left_operand);
-					return false;
-				}
-			}
-			//左右運算元均為邏輯運算子
-			else if (left_operand.logical && right_operand.logical) {
-				//建立前運算子(AND):使用左右運算元
-				if (keyword == KEYWORD_AND_OPERATOR) {
-					last_operator = shared_ptr<LogicalOperator>(new AND_Operator(left_operand.logical, right_operand.logical));
-					//刪除一個運算子關鍵字
-					PriorityLogicalKeyword().pop_front();
-				}
-				//返回錯誤:不合法運算子關鍵字
-				else {
-					//回存右運算元
-					PriorityGeneralOperators().push_front(right_operand);
-					//回存左運算元
-					PriorityGeneralOperators().push_front(left_operand);
-					return false;
-				}
-			}
-			//左右運算元均為關係運算子
-			else if (left_operand.relational && right_operand.relational) {
-				//建立前運算子(AND):使用左右運算元
-				if (keyword == KEYWORD_AND_OPERATOR) {
-					last_operator = shared_ptr<LogicalOperator>(new AND_Operator(left_operand.relational, right_operand.relational));
-					//刪除一個運算子關鍵字
-					PriorityLogicalKeyword().pop_front();
-				}
-				//返回錯誤:不合法運算子關鍵字
-				else {
-					//回存右運算元
-					PriorityGeneralOperators().push_front(right_operand);
-					//回存左運算元
-					PriorityGeneralOperators().push_front(left_operand);
-					return false;
-				}
-			}
-			//左運算元為算術運算子,右運算元為邏輯運算子
-			else if (left_operand.arithmetic && right_operand.logical) {
-				//建立前運算子(AND):使用左右運算元
-				if (keyword == KEYWORD_AND_OPERATOR) {
-					last_operator = shared_ptr<LogicalOperator>(new AND_Operator(left_operand.arithmetic, right_operand.logical));
-					//刪除一個運算子關鍵字
-					PriorityLogicalKeyword().pop_front();
-				}
-				//返回錯誤:不合法運算子關鍵字
-				else {
-					//回存右運算元
-					PriorityGeneralOperators().push_front(right_operand);
-					//回存左運算元
-					PriorityGeneralOperators().push_front(left_operand);
-					return false;
-				}
-			}
-			//左運算元為邏輯運算子,右運算元為算術運算子
-			else if (left_operand.logical && right_operand.arithmetic) {
-				//建立前運算子(AND):使用左右運算元
-				if (keyword == KEYWORD_AND_OPERATOR) {
-					last_operator = shared_ptr<LogicalOperator>(new AND_Operator(left_operand.logical, right_operand.arithmetic));
-					//刪除一個運算子關鍵字
-					PriorityLogicalKeyword().pop_front();
-				}
-				//返回錯誤:不合法運算子關鍵字
-				else {
-					//回存右運算元
-					PriorityGeneralOperators().push_front(right_operand);
-					//回存左運算元
-					PriorityGeneralOperators().push_front(left_operand);
-					return false;
-				}
-			}
-			//左運算元為關係運算子,右運算元為邏輯運算子
-			else if (left_operand.relational && right_operand.logical) {
-				//建立前運算子(AND):使用左右運算元
-				if (keyword == KEYWORD_AND_OPERATOR) {
-					last_operator = shared_ptr<LogicalOperator>(new AND_Operator(left_operand.relational, right_operand.logical));
-					//刪除一個運算子關鍵字
-					PriorityLogicalKeyword().pop_front();
-				}
-				//返回錯誤:不合法運算子關鍵字
-				else {
-					//回存右運算元
-					PriorityGeneralOperators().push_front(right_operand);
-					//回存左運算元
-					PriorityGeneralOperators().push_front(left_operand);
-					return false;
-				}
-			}
-			//左運算元為邏輯運算子,右運算元為關係運算子
-			else if (left_operand.logical && right_operand.relational) {
-				//建立前運算子(AND):使用左右運算元
-				if (keyword == KEYWORD_AND_OPERATOR) {
-					last_operator = shared_ptr<LogicalOperator>(new AND_Operator(left_operand.logical, right_operand.relational));
-					//刪除一個運算子關鍵字
-					PriorityLogicalKeyword().pop_front();
-				}
-				//返回錯誤:不合法運算子關鍵字
-				else {
-					//回存右運算元
-					PriorityGeneralOperators().push_front(right_operand);
-					//回存左運算元
-					PriorityGeneralOperators().push_front(left_operand);
-					return false;
-				}
-			}
-			//左右運算元不合法
-			else {
-				//回存右運算元
-				PriorityGeneralOperators().push_front(right_operand);
-				//回存左運算元
-				PriorityGeneralOperators().push_front(left_operand);
-				return false;
-			}
-		}
-		//前運算子存在且容器內至少有一個優先運算元
-		else if (last_operator && !PriorityGeneralOperators().empty()) {
-			//複製右運算元
-			GeneralOperatorHandle right_operand(PriorityGeneralOperators().front());
-			//清除容器內右運算元
-			PriorityGeneralOperators().pop_front();
-			//右運算元為算術運算子
-			if (right_operand.arithmetic) {
-				//建立新運算子(AND):使用前運算子為左運算元,一個右運算元
-				if (keyword == KEYWORD_AND_OPERATOR) {
-					next_operator = shared_ptr<LogicalOperator>(new AND_Operator(last_operator, right_operand.arithmetic));
-					//刪除一個運算子關鍵字
-					PriorityLogicalKeyword().pop_front();
-					//新運算子成為前運算子(前運算子Handle自動清空)
-					last_operator = next_operator;
-				}
-				//返回錯誤:不合法運算子關鍵字
-				else {
-					//回存右運算元
-					PriorityGeneralOperators().push_front(right_operand);
-					return false;
-				}
-			}
-			//右運算元為邏輯運算子
-			else if (right_operand.logical) {
-				//建立新運算子(AND):使用前運算子為左運算元,一個右運算元
-				if (keyword == KEYWORD_AND_OPERATOR) {
-					next_operator = shared_ptr<LogicalOperator>(new AND_Operator(last_operator, right_operand.logical));
-					//刪除一個運算子關鍵字
-					PriorityLogicalKeyword().pop_front();
-					//新運算子成為前運算子(前運算子Handle自動清空)
-					last_operator = next_operator;
-				}
-				//返回錯誤:不合法運算子關鍵字
-				else {
-					//回存右運算元
-					PriorityGeneralOperators().push_front(right_operand);
-					return false;
-				}
-			}
-			//右運算元為關係運算子
-			else if (right_operand.relational) {
-				//建立新運算子(AND):使用前運算子為左運算元,一個右運算元
-				if (keyword == KEYWORD_AND_OPERATOR) {
-					next_operator = shared_ptr<LogicalOperator>(new AND_Operator(last_operator, right_operand.relational));
-					//刪除一個運算子關鍵字
-					PriorityLogicalKeyword().pop_front();
-					//新運算子成為前運算子(前運算子Handle自動清空)
-					last_operator = next_operator;
-				}
-				//返回錯誤:不合法運算子關鍵字
-				else {
-					//回存右運算元
-					PriorityGeneralOperators().push_front(right_operand);
-					return false;
-				}
-			}
-			//右運算元不合法
-			else {
-				//回存右運算元
-				PriorityGeneralOperators().push_front(right_operand);
-				return false;
-			}
-		}
-		//返回錯誤:未滿足建立新運算子的初始條件
-		else return false;
+	//已改寫的共同子運算式
+	if (operand->GetOperatorID() == COMMON_SUBEXPRESSION) {
+		return true; }
+	uint32_t index(shared_index[FindSharedNode(NodeKey(operand.get()))]);
+	if (index == NO_SHARED_NODE) {
+		return ShareChildren(operand.get()); }
+
+	//每個節點的子節點僅改寫一次
+	if (!shared_nodes[index].visited) {
+		shared_nodes[index].visited = true;
+		shared_nodes[index].shares = ShareChildren(operand.get());
 	}
-
-	//優先運算元容器已清空且前運算子存在
-	if (PriorityGeneralOperators().empty() && last_operator) {
-		//將最終的前運算子放入一般運算元容器
-		GeneralOperators().push_back(GeneralOperatorHandle(last_operator));
+	SharedMacroNode& shared(shared_nodes[index]);
+	//多個運算子參照的非常數節點:改由共同子運算式運算子參照
+	if (shared.parents > 1 && operand->GetOperatorID() != CONSTANT) {
+		if (!shared.common) {
+			shared.common = CreateNode<CommonSubexpressionOperator>(macro_variable_interface, shared.node, false); }
+		operand = shared.common;
 		return true;
 	}
-	//未成功建立前運算子或運算子數量異常
-	else {
-		return false;
-	}
+	return shared.shares;
 }
 
-bool MacroGenerator::CreateConditionalOperator()
+void MacroGenerator::ShareRoot(shared_ptr<ArithmeticOperator>& root)
 {
-	//檢查目前容器層數是否在最底層,確認有運算元(算術運算子)
-	if (CurrentLevel() == 0 && !ConditionalKeyword().empty() && !GeneralOperators().empty() && GeneralOperators().back().arithmetic) {
-		//取得條件式運算子關鍵字
-		string keyword(ConditionalKeyword().back());
-		//關鍵字為分支運算子
-		if (keyword == KEYWORD_BRANCH_OPERATOR) {
-			//檢查前導的條件式關鍵字存在,並確認關係運算子已建立
-			if (ConditionalKeyword().front() == KEYWORD_IF_CONDITION && GeneralOperators().size() == 2) {
-				if (GeneralOperators().front().relational) {
-					//建立條件式分支運算子:左運算元使用關係運算子,右運算元使用算術運算子
-					ConditionalBranchOperator conditional_branch(GeneralOperators().front().relational, GeneralOperators().back().arithmetic);
-					//複製分支運算子
-					conditional_branch_operator = conditional_branch;
-				}
-				else if (GeneralOperators().front().logical) {
-					//建立條件式分支運算子:左運算元使用關係運算子,右運算元使用算術運算子
-					ConditionalBranchOperator conditional_branch(GeneralOperators().front().logical, GeneralOperators().back().arithmetic);
-					//複製分支運算子
-					conditional_branch_operator = conditional_branch;
-				}
-				else return false;
-				//清除(前導)條件式關鍵字及算術運算關鍵字
-				ConditionalKeyword().clear();
-				//清除關係運算子及算術運算元
-				GeneralOperators().clear();
-				return true;
-			}
-			//僅有分支運算子關鍵字且無關係運算子
-			else if (ConditionalKeyword().size() == 1 && GeneralOperators().size() == 1) {
-				//建立分支運算子:單一右運算元使用算術運算子
-				ConditionalBranchOperator conditional_branch(GeneralOperators().front().arithmetic);
-				//清除分支運算子關鍵字
-				ConditionalKeyword().pop_back();
-				//清除算術運算元
-				GeneralOperators().pop_front();
-				//複製分支運算子
-				conditional_branch_operator = conditional_branch;
-				return true;
-			}
-			else return false;
-		}
-		//關鍵字為條件式算術運算子
-		else if (keyword == KEYWORD_CONDITIONAL_ARITHMETIC_OPERATOR) {
-			//檢查前導的條件式關鍵字存在,並確認關係運算子已建立
-			if (ConditionalKeyword().front() == KEYWORD_IF_CONDITION && GeneralOperators().size() == 2) {
-				if (GeneralOperators().front().relational) {
-					//建立條件式運算子:左運算元使用關係運算子,右運算元使用算術運算子
-					ConditionalArithmeticOperator conditional_arithmetic(GeneralOperators().front().relational, GeneralOperators().back().arithmetic);
-					//複製條件式運算子
-					conditional_arithmetic_operator = conditional_arithmetic;
-				}
-				else if (GeneralOperators().front().logical) {
-					//建立條件式運算子:左運算元使用關係運算子,右運算元使用算術運算子
-					ConditionalArithmeticOperator conditional_arithmetic(GeneralOperators().front().logical, GeneralOperators().back().arithmetic);
-					//複製條件件式運算子
-					conditional_arithmetic_operator = conditional_arithmetic;
-				}
-				else return false;
-				//清除(前導)條件式關鍵字及算術運算關鍵字
-				ConditionalKeyword().clear();
-				//清除關係運算子及算術運算元
-				GeneralOperators().clear();
-				return true;
-			}
-			else return false;
-		}
-		//關鍵字為迴圈運算子
-		else if (keyword == KEYWORD_LOOP_OPERATOR) {
-			//檢查前導的條件式關鍵字存在,並確認關係運算子已建立
-			if (ConditionalKeyword().front() == KEYWORD_WHILE_CONDITION && GeneralOperators().size() == 2) {
-				if (GeneralOperators().front().relational) {
-					//建立條件式分支運算子:左運算元使用關係運算子,右運算元使用算術運算子
-					ConditionalLoopOperator conditional_loop(GeneralOperators().front().relational, GeneralOperators().back().arithmetic);
-					//複製分支運算子
-					conditional_loop_operator = conditional_loop;
-				}
-				else if (GeneralOperators().front().logical) {
-					//建立條件式分支運算子:左運算元使用關係運算子,右運算元使用算術運算子
-					ConditionalLoopOperator conditional_loop(GeneralOperators().front().logical, GeneralOperators().back().arithmetic);
-					//複製分支運算子
-					conditional_loop_operator = conditional_loop;
-				}
-				else return false;
-				//清除(前導)條件式關鍵字及算術運算關鍵字
-				ConditionalKeyword().clear();
-				//清除關係運算子及算術運算元
-				GeneralOperators().clear();
-				return true;
-			}
-			//僅有迴圈運算子關鍵字且無關係運算子
-			else if (ConditionalKeyword().size() == 1 && GeneralOperators().size() == 1) {
-				//建立迴圈運算子:單一右運算元元使用算術運算子
-				ConditionalLoopOperator conditional_loop(GeneralOperators().front().arithmetic);
-				//清除迴圈運算子關鍵字
-				ConditionalKeyword().pop_back();
-				//清除算術運算元
-				GeneralOperators().pop_front();
-				//複製迴圈運算子
-				conditional_loop_operator = conditional_loop;
-				return true;
-			}
-			else return false;
-		}
-		//關鍵字為迴圈結束
-		else if (keyword == KEYWORD_LOOP_END) {
-			if (ConditionalKeyword().size() == 1 && GeneralOperators().size() == 1) {
-				//建立迴圈結束運算子:單一右運算元使用算術運算子
-				LoopEndOperator loop_end(GeneralOperators().front().arithmetic);
-				//清除迴圈結束運算子關鍵字
-				ConditionalKeyword().pop_back();
-				//清除算術運算元
-				GeneralOperators().pop_front();
-				//複製迴圈結束運算子
-				loop_end_operator = loop_end;
-				return true;
-			}
-			else return false;
-		}
-		else return false;
+	if (!root) {
+		return; }
+	//賦值運算子:分別改寫寫入值及變數ID(變數ID於寫入值之後核算)
+	if (root->GetOperatorID() == ASSIGNMENT) {
+		AssignmentOperator* assignment(static_cast<AssignmentOperator*>(root.get()));
+		shared_ptr<ArithmeticOperator> value(assignment->RightOperand());
+		if (assignment->RightLogical()) {
+			ShareLogical(assignment->RightLogical().get()); }
+		else {
+			ShareRoot(value); }
+		assignment->SetOperands(assignment->LeftOperand(), value);
+		UnaryOperator* variable(static_cast<UnaryOperator*>(assignment->LeftOperand().get()));
+		shared_ptr<ArithmeticOperator> variable_ID(variable->OperandHandle());
+		ShareRoot(variable_ID);
+		variable->SetOperandHandle(variable_ID);
+		return;
 	}
-	else return false;
+	//含共同子運算式的根節點:每次核算前開始新的核算世代
+	if (ShareOperand(root)) {
+		root = CreateNode<CommonSubexpressionOperator>(macro_variable_interface, root, true); }
 }
 
-bool MacroGenerator::ProcessOperatorKeyword()
+void MacroGenerator::ShareRelational(RelationalOperator* relational)
 {
-	map<string, unsigned char>::const_iterator iter(keyword_list.find(UpperString().top()));
-	if (iter == keyword_list.end())	return false;
-	else {
-		switch (iter->second) {
-		//關鍵字為一元函數運算子
-		case UNARY_FUNCTION_OPERATOR:
-			//關鍵字存入對應容器
-			UnaryOperatorKeyword().push(iter->first);
-			//刪除大寫字串
-			UpperString().pop();
-			return true;
-
-		//關鍵字為一元與二元通用函數運算子
-		case UNARY_BINARY_FUNCTION_OPERATOR:
-			//關鍵字存入對應容器
-			UnaryBinaryOperatorKeyword().push(iter->first);
-			//刪除大寫字串
-			UpperString().pop();
-			return true;
-
-		//關鍵字為二元函數運算子
-		case BINARY_FUNCTION_OPERATOR:
-			//關鍵字存入對應容器
-			BinaryOperatorKeyword().push(iter->first);
-			//刪除大寫字串
-			UpperString().pop();
-			return true;
-
-		//關鍵字為關係運算子
-		case RELATIONAL_OPERATOR:
-			//關鍵字存入對應容器
-			RelationalKeyword().push_back(iter->first);
-			//刪除大寫字串
-			UpperString().pop();
-			return true;
-
-		//關鍵字為一般二元邏輯運算子
-		case BINARY_LOGICAL_OPERATOR:
-			//目前為優先運算子模式
-			if (PriorityLogicalFlag()) {
-				//建立優先邏輯運算子失敗:返回錯誤
-				if (!CreatePriorityLogicalOperator()) return false;
-				//成功:取消優先運算子模式
-				else PriorityLogicalFlag() = false;
-			}
-			//邏輯運算子關鍵字存入對應容器
-			LogicalKeyword().push_back(iter->first);
-			//刪除大寫字串
-			UpperString().pop();
-			return true;
-
-		//關鍵字為優先二元邏輯運算子
-		case PRIORITY_BINARY_LOGICAL_OPERATOR:
-			//目前為一般運算子模式
-			if (!PriorityLogicalFlag()) {
-				//設定優先運算子模式
-				PriorityLogicalFlag() = true;
-				if (!GeneralOperators().empty()) {
-					//將左運算元由一般運算子容器搬移到優先運算子容器
-					PriorityGeneralOperators().push_back(GeneralOperators().back());
-					//刪除左運算元
-					GeneralOperators().pop_back();
-				}
-				else return false;
-			}
-			//優先邏輯運算子關鍵字存入對應容器
-			PriorityLogicalKeyword().push_back(iter->first);
-			//刪除大寫字串
-			UpperString().pop();
-			return true;
-
-		//關鍵字為條件式
-		case IF_CONDITION:
-		//關鍵字為迴圈條件式
-		case WHILE_CONDITION:
-		//關鍵字為分支運算子
-		case BRANCH_OPERATOR:
-		//關鍵字為條件式算術運算
-		case CONDITIONAL_ARITHMETIC_OPERATOR:
-		//關鍵字為迴圈運算子
-		case LOOP_OPERATOR:
-		//關鍵字為迴圈結束
-		case LOOP_END:
-			//關鍵字存入對應容器
-			ConditionalKeyword().push_back(iter->first);
-			//刪除大寫字串
-			UpperString().pop();
-			return true;
+	shared_ptr<ArithmeticOperator> left(relational->LeftOperand()), right(relational->RightOperand());
+	ShareRoot(left);
+	ShareRoot(right);
+	relational->SetOperands(left, right);
+}
 
-			//不合法關鍵字
-		default: return false;
-		}
-	}
+void MacroGenerator::ShareLogical(LogicalOperator* logical)
+{
+	ConditionOperand left(logical->LeftOperand()), right(logical->RightOperand());
+	ShareCondition(left);
+	ShareCondition(right);
+	logical->SetOperands(left, right);
 }
 
-bool MacroGenerator::ProcessOperatorAddress(unsigned short address_type, unsigned char address)
+void MacroGenerator::ShareCondition(ConditionOperand& operand)
 {
-	//字元屬於一元運算子
-	if (address_type == UNARY_OPERATOR) {
-		//將字元放入一元運算子位址字元容器
-		UnaryOperatorAddress().push(address);
-		return true;
+	switch (operand.Type()) {
+		//算術運算元:根節點可能改由共同子運算式運算子參照
+	case ARITHMETIC_CONDITION_OPERAND: {
+		shared_ptr<ArithmeticOperator> root(operand.ArithmeticHandle());
+		ShareRoot(root);
+		operand = ConditionOperand(root);
+		break;
 	}
-	//字元屬於一般二元運算子
-	else if (address_type == BINARY_OPERATOR) {
-		//目前處於優先運算子模式
-		if (PriorityFlag()) {
-			//處理並建立優先運算子
-			if (!CreatePriorityBinaryOperator()) {
-				return false;
-			}
-			//解除優先運算子模式
-			PriorityFlag() = false;
-		}
-		//將字元放入一般二元運算子位址字元容器
-		BinaryOperatorAddress().push_back(address);
-		return true;
+	case RELATIONAL_CONDITION_OPERAND:
+		ShareRelational(operand.Relational());
+		break;
+	case LOGICAL_CONDITION_OPERAND:
+		ShareLogical(operand.Logical());
+		break;
+	default:
+		break;
 	}
-	//字元屬於優先二元運算子
-	else if (address_type == PRIORITY_BINARY_OPERATOR) {
-		//目前處於優先運算子模式
-		if (PriorityFlag()) {
-			//將字元放入優先二元運算子位址字元容器
-			PriorityBinaryOperatorAddress().push(address);
-			return true;
-		}
-		//目前非優先運算子模式
-		else {
-			//設立優先運算子旗標
-			PriorityFlag() = true;
-			//將字元放入優先二元運算子位址字元容器
-			PriorityBinaryOperatorAddress().push(address);
-			//返回錯誤:左運算元不存在
-			if (GeneralOperators().empty()) return false;
-			//將左運算元由一般運算子容器複製到優先運算子容器
-			PriorityGeneralOperators().push_back(GeneralOperators().back());
-			//清除左運算元
-			GeneralOperators().pop_back();
-			return true;
+}
+
+void MacroGenerator::ShareSubexpressions()
+{
+	//無重複參照的節點:維持原運算子樹
+	if (subexpression_found) {
+		for (GeneralOperatorHandle& handle : operand_stack) {
+			if (handle.arithmetic) {
+				ShareRoot(handle.arithmetic); }
+			else if (handle.relational) {
+				ShareRelational(handle.relational.get()); }
+			else if (handle.logical) {
+				ShareLogical(handle.logical.get()); }
 		}
 	}
-	//字元為一元與二元通用運算子
-	else if (address_type == UNARY_BINARY_OPERATOR) {
-		//判別為一元或二元運算子並處理
-		return ProcessUnaryBinaryAddress(address);
-	}
-	else return false;
+	//釋放雜湊表持有的節點
+	ClearSharedNodes();
 }
 
-bool MacroGenerator::ProcessUnaryBinaryAddress(unsigned char address)
+bool MacroGenerator::CreateConstantOperator(string_view digits)
 {
-	//有關係運算子關鍵字存在
-	if (!RelationalKeyword().empty()) {
-		//判斷為一元minus運算子位址字元
-		UnaryOperatorAddress().push(address);
-		return true;
+	//浮點數值暫存器
+	double value(0.0);
+	//返回錯誤:轉換發生錯誤
+	if (!macro_float_parser.StringToFloat(digits, value)) return false;
+	//前導一元minus運算子:直接建立負值常數
+	if (!operator_stack.empty() && operator_stack.back().type == UNARY_OPERATOR && operator_stack.back().text.front() == ADDRESS_MINUS_SUBTRACT_OPERATOR) {
+		value = -value;
+		operator_stack.pop_back();
 	}
 
-	//目前處於優先運算子模式
-	if (PriorityFlag() == true) {
-		//檢查二元優先運算子位址字元與優先運算元的配對數量
-		if (PriorityGeneralOperators().size() == PriorityBinaryOperatorAddress().size()) {
-			//判斷為一元minus運算子位址字元
-			UnaryOperatorAddress().push(address);
-			return true;
-		}
-		else {
-			//判斷為二元subtract運算子位址字元
-			//先處理並建立優先運算子
-			if (!CreatePriorityBinaryOperator()) {
-				return false;
-			}
-			//解除優先運算子模式
-			PriorityFlag() = false;
-			//存入一般二元運算子位址容器
-			BinaryOperatorAddress().push_back(address);
-			return true;
+	shared_ptr<ArithmeticOperator> handle(CreateNode<ConstantOperator>(value));
+	operand_stack.push_back(GeneralOperatorHandle(ShareNode(handle)));
+	return true;
+}
+
+bool MacroGenerator::CreateFunctionOperator(const MacroStackOperator& function, size_t arguments)
+{
+	//函數引數必須為算術運算子
+	for (size_t index = operand_stack.size() - arguments; index != operand_stack.size(); ++index) {
+		if (!operand_stack[index].arithmetic) return false; }
+
+	shared_ptr<ArithmeticOperator> handle;
+	//雙引數函數
+	if (arguments == 2) {
+		shared_ptr<ArithmeticOperator> right_operand(operand_stack.back().arithmetic);
+		operand_stack.pop_back();
+		shared_ptr<ArithmeticOperator> left_operand(operand_stack.back().arithmetic);
+		operand_stack.pop_back();
+
+		switch (function.id) {
+		case POWER_KEYWORD:
+			handle = CreateNode<PowerOperator>(left_operand, right_operand);
+			break;
+		case ARC_TANGENT_KEYWORD:
+			handle = CreateNode<ArcTangent2Operator>(left_operand, right_operand);
+			break;
+			//不合法關鍵字
+		default: return false;
 		}
+		if (IsConstant(left_operand) && IsConstant(right_operand)) {
+			handle = FoldConstant(handle); }
 	}
-	//目前非優先運算子模式
+	//單引數函數
 	else {
-		//運算元計數器
-		deque<GeneralOperatorHandle>::size_type count_operand(GeneralOperators().size());
-		//記數須扣除第一引數或根運算式可能存在的條件(關係或邏輯)運算子
-		if (TwoArgumentsFlag() || CurrentLevel() == 0 && !GeneralOperators().empty() && !GeneralOperators().front().arithmetic) {
-			//扣除運算元數量
-			--count_operand;
-		}
-		//一般二元運算子位址字元與運算元的配對數量相同
-		if (count_operand == BinaryOperatorAddress().size()) {
-			//判斷為一元minus運算子位址字元
-			UnaryOperatorAddress().push(address);
-			return true;
-		}
-		//配對數量不相同
-		else {
-			//判斷為二元subtract運算子位址字元
-			//存入一般二元運算子位址容器
-			BinaryOperatorAddress().push_back(address);
-			return true;
+		shared_ptr<ArithmeticOperator> operand(operand_stack.back().arithmetic);
+		operand_stack.pop_back();
+
+		switch (function.id) {
+		case SINE_KEYWORD:
+			handle = CreateNode<SineOperator>(operand);
+			break;
+		case COSINE_KEYWORD:
+			handle = CreateNode<CosineOperator>(operand);
+			break;
+		case TANGENT_KEYWORD:
+			handle = CreateNode<TangentOperator>(operand);
+			break;
+		case ARC_SINE_KEYWORD:
+			handle = CreateNode<ArcSineOperator>(operand);
+			break;
+		case ARC_COSINE_KEYWORD:
+			handle = CreateNode<ArcCosineOperator>(operand);
+			break;
+		case ARC_TANGENT_KEYWORD:
+			handle = CreateNode<ArcTangentOperator>(operand);
+			break;
+		case SQUARE_ROOT_KEYWORD:
+			handle = CreateNode<SquareRootOperator>(operand);
+			break;
+		case ABSOLUTE_VALUE_KEYWORD:
+			handle = CreateNode<AbsoluteValueOperator>(operand);
+			break;
+		case ROUND_OFF_KEYWORD:
+			handle = CreateNode<RoundOffOperator>(operand);
+			break;
+		case ROUND_DOWN_KEYWORD:
+			handle = CreateNode<RoundDownOperator>(operand);
+			break;
+		case ROUND_UP_KEYWORD:
+			handle = CreateNode<RoundUpOperator>(operand);
+			break;
+		case NATURAL_LOG_KEYWORD:
+			handle = CreateNode<NaturalLogOperator>(operand);
+			break;
+		case EXPONENT_KEYWORD:
+			handle = CreateNode<ExponentOperator>(operand);
+			break;
+		case BINARY_CODE_KEYWORD:
+			handle = CreateNode<BinaryCodeOperator>(operand);
+			break;
+		case BINARY_CODED_DECIMAL_KEYWORD:
+			handle = CreateNode<BinaryCodedDecimalOperator>(operand);
+			break;
+		case ADD_DECIMAL_POINT_KEYWORD:
+			handle = CreateNode<AddDecimalPointOperator>(operand, macro_float_parser.least_increment);
+			break;
+			//不合法關鍵字(雙引數POW)
+		default: return false;
 		}
+		if (IsConstant(operand)) {
+			handle = FoldConstant(handle); }
 	}
+
+	operand_stack.push_back(GeneralOperatorHandle(ShareNode(handle)));
+	return true;
 }
 
-bool MacroGenerator::ProcessToFinalOperator()
+bool MacroGenerator::CreateBinaryOperator(const MacroStackOperator& binary)
 {
-	//有優先邏輯運算子關鍵字
-	if (!PriorityLogicalKeyword().empty()) {
-		//嘗試建立優先邏輯運算子
-		if (!CreatePriorityLogicalOperator()) return false;
-		//有一般邏輯運算子關鍵字
-		if (!LogicalKeyword().empty()) {
-			//嘗試建立一般邏輯運算子
-			if (!CreateLogicalOperator()) return false;
-		}
-		//有二元算術運算子(賦值)位址字元
-		if (!BinaryOperatorAddress().empty()) {
-			//嘗試建立二元算術(賦值)運算子
-			if (!CreateBinaryOperator()) return false;
+	//運算子右方須有單一運算元
+	if (operand_stack.size() != binary.operand_base + 1 || binary.operand_base == 0) return false;
+
+	//取出左右運算元
+	GeneralOperatorHandle right(operand_stack.back());
+	operand_stack.pop_back();
+	GeneralOperatorHandle left(operand_stack.back());
+	operand_stack.pop_back();
+
+	switch (binary.type) {
+		//算術運算子
+	case BINARY_OPERATOR:
+	case PRIORITY_BINARY_OPERATOR: {
+		//左右運算元必須為算術運算子
+		if (!left.arithmetic || !right.arithmetic) return false;
+
+		shared_ptr<ArithmeticOperator> handle;
+		switch (binary.text.front()) {
+		case ADDRESS_ADD_OPERATOR:
+			handle = CreateNode<AddOperator>(left.arithmetic, right.arithmetic);
+			break;
+		case ADDRESS_MINUS_SUBTRACT_OPERATOR:
+			handle = CreateNode<SubtractOperator>(left.arithmetic, right.arithmetic);
+			break;
+		case ADDRESS_MULTIPLY_OPERATOR:
+			handle = CreateNode<MultiplyOperator>(left.arithmetic, right.arithmetic);
+			break;
+		case ADDRESS_DIVIDE_OPERATOR:
+			handle = CreateNode<DivideOperator>(left.arithmetic, right.arithmetic);
+			break;
+		default: return false;
 		}
+		if (IsConstant(left.arithmetic) && IsConstant(right.arithmetic)) {
+			handle = FoldConstant(handle); }
+		operand_stack.push_back(GeneralOperatorHandle(ShareNode(handle)));
 		return true;
 	}
-	//有一般邏輯運算子關鍵字
-	else if (!LogicalKeyword().empty()) {
-		//嘗試建立一般邏輯運算子
-		if (!CreateLogicalOperator()) return false;
+
+		//賦值運算子
+	case ASSIGNMENT_OPERATOR: {
+		//左運算元必須為變數運算子
+		if (!left.arithmetic || left.arithmetic->GetOperatorID() != MacroOperatorID::VARIABLE) return false;
+
+		shared_ptr<ArithmeticOperator> handle;
+		//右運算元為算術運算子
+		if (right.arithmetic) {
+			handle = CreateNode<AssignmentOperator>(left.arithmetic, right.arithmetic); }
+		//右運算元為邏輯運算子
+		else if (right.logical) {
+			handle = CreateNode<AssignmentOperator>(left.arithmetic, right.logical); }
+		//關係運算子不可賦值
+		else return false;
+		operand_stack.push_back(GeneralOperatorHandle(handle));
 		return true;
 	}
 
-	//有優先二元運算子位址字元
-	if (!PriorityBinaryOperatorAddress().empty()) {
-		//返回錯誤:建立優先二元運算子失敗
-		if (!CreatePriorityBinaryOperator()) return false;
-		//取消優先運算子模式:成功建立優先二元運算子
-		else PriorityFlag() = false;
-	}
-	//有一般二元運算子位址字元
-	if (!BinaryOperatorAddress().empty()) {
-		//第一個運算元為關係或邏輯運算子
-		if (GeneralOperators().front().relational || GeneralOperators().front().logical) {
-			//暫存運算元
-			GeneralOperatorHandle condition(GeneralOperators().front());
-			//容器內刪除運算元
-			GeneralOperators().pop_front();
-			//嘗試建立一般二元算術運算子
-			if (!CreateBinaryOperator()) {
-				//返回失敗:先回存運算元
-				GeneralOperators().push_front(condition);
-				return false;
-			}
-			//回存運算元
-			else GeneralOperators().push_front(condition);
+		//關係運算子
+	case RELATIONAL_OPERATOR: {
+		//左右運算元必須為算術運算子
+		if (!left.arithmetic || !right.arithmetic) return false;
+
+		shared_ptr<RelationalOperator> handle;
+		switch (binary.id) {
+		case EQUAL_KEYWORD:
+			handle = CreateNode<EqualOperator>(left.arithmetic, right.arithmetic);
+			break;
+		case NOT_EQUAL_KEYWORD:
+			handle = CreateNode<NotEqualOperator>(left.arithmetic, right.arithmetic);
+			break;
+		case GREATER_KEYWORD:
+			handle = CreateNode<GreaterOperator>(left.arithmetic, right.arithmetic);
+			break;
+		case GREATER_EQUAL_KEYWORD:
+			handle = CreateNode<GreaterEqualOperator>(left.arithmetic, right.arithmetic);
+			break;
+		case LESS_KEYWORD:
+			handle = CreateNode<LessOperator>(left.arithmetic, right.arithmetic);
+			break;
+		case LESS_EQUAL_KEYWORD:
+			handle = CreateNode<LessEqualOperator>(left.arithmetic, right.arithmetic);
+			break;
+		default: return false;
 		}
-		//第一個運算元為算術運算子
-		else {
-			//嘗試建立二元算術運算子
-			return CreateBinaryOperator();
+		operand_stack.push_back(GeneralOperatorHandle(handle));
+		return true;
+	}
+
+		//邏輯運算子
+	case BINARY_LOGICAL_OPERATOR:
+	case PRIORITY_BINARY_LOGICAL_OPERATOR: {
+		shared_ptr<LogicalOperator> handle;
+		switch (binary.id) {
+		case AND_KEYWORD:
+			handle = CreateLogicalOperator<AND_Operator>(left, right);
+			break;
+		case OR_KEYWORD:
+			handle = CreateLogicalOperator<OR_Operator>(left, right);
+			break;
+		case XOR_KEYWORD:
+			handle = CreateLogicalOperator<XOR_Operator>(left, right);
+			break;
+		default: return false;
 		}
+		//返回錯誤:關鍵字或運算元組合不合法
+		if (!handle) return false;
+		operand_stack.push_back(GeneralOperatorHandle(handle));
+		return true;
 	}
-	//有條件式運算子關鍵字
-	if (!ConditionalKeyword().empty()) {
-		//嘗試建立條件式運算子
-		return CreateConditionalOperator();
+
+		//非二元運算子
+	default: return false;
 	}
-	//不需建立任何運算子
-	return true;
 }
 
-bool MacroGenerator::ReturnPriorityOperatorToPreviousLevel()
+bool MacroGenerator::CreateConditionalOperator()
 {
-	//有優先二元算術運算子位址字元
-	if (!PriorityBinaryOperatorAddress().empty()) {
-		//返回錯誤:建立優先二元運算子失敗
-		if (!CreatePriorityBinaryOperator()) return false;
-		//取消優先運算子模式:成功建立優先二元運算子
-		else PriorityFlag() = false;
-		//嘗試建立一般二元算術運算子
-		CreateBinaryOperator();
-	}
-	//有一般二元算術運算子位址字元
-	else if (!BinaryOperatorAddress().empty()) {
-		//嘗試建立一般二元算術運算子
-		if (!CreateBinaryOperator()) return false;
-	}
-	//有關係運算子關鍵字
-	else if (!RelationalKeyword().empty()) {
-		//嘗試建立關係運算子
-		if (!CreateRelationalOperator()) return false;
-	}
-	//有優先邏輯運算子關鍵字
-	else if (!PriorityLogicalKeyword().empty()) {
-		//嘗試建立優先邏輯運算子
-		if (!CreatePriorityLogicalOperator()) return false;
-		//有一般邏輯運算子關鍵字
-		if (!LogicalKeyword().empty()) {
-			//嘗試建立一般邏輯運算子
-			if (!CreateLogicalOperator()) return false;
-		}
+	//敘述關鍵字之後須有單一算術運算元
+	if (operand_stack.size() != statement_base + 1 || !operand_stack.back().arithmetic) return false;
+	//敘述數值(賦值運算子,分支序號,迴圈編號)
+	const shared_ptr<ArithmeticOperator>& value(operand_stack.back().arithmetic);
+
+	//關鍵字為分支運算子
+	if (statement_keyword == GOTO_KEYWORD) {
+		//無條件分支
+		if (statement_base == 0) {
+			conditional_branch_operator = ConditionalBranchOperator(value); }
+		else if (operand_stack.front().relational) {
+			conditional_branch_operator = ConditionalBranchOperator(operand_stack.front().relational, value); }
+		else {
+			conditional_branch_operator = ConditionalBranchOperator(operand_stack.front().logical, value); }
 	}
-	//有一般邏輯運算子關鍵字
-	else if (!LogicalKeyword().empty()) {
-		//嘗試建立一般邏輯運算子
-		if (!CreateLogicalOperator()) return false;
+	//關鍵字為條件式算術運算子
+	else if (statement_keyword == THEN_KEYWORD) {
+		if (operand_stack.front().relational) {
+			conditional_arithmetic_operator = ConditionalArithmeticOperator(operand_stack.front().relational, value); }
+		else {
+			conditional_arithmetic_operator = ConditionalArithmeticOperator(operand_stack.front().logical, value); }
 	}
-
-	//有通用運算子
-	if (!GeneralOperators().empty()) {
-		//只有一個運算子
-		if (GeneralOperators().size() == 1) {
-			//複製上層最終運算子
-			GeneralOperatorHandle final_operator(GeneralOperators().front());
-			//清除上層最終運算子
-			GeneralOperators().pop_front();
-			//運算子暫存容器切換回下層
-			if (!LevelDown()) return false;
-			//最終運算子非算術運算子
-			if (!final_operator.arithmetic) {
-				//檢查目前是否為優先運算子模式
-				if (PriorityFlag() || PriorityLogicalFlag()) {
-					//複製上層最終運算子到優先運算子容器
-					PriorityGeneralOperators().push_back(final_operator);
-				}
-				else {
-					//複製上層最終運算子到下層一般運算子容器
-					GeneralOperators().push_back(final_operator);
-				}
-			}
-			//最終運算子為算術運算子
-			else {
-				//嘗試建立一元函數運算子
-				if (!CreateUnaryFunctionOperator(final_operator.arithmetic)) {
-					//檢查目前是否為優先運算子模式
-					if (PriorityFlag() || PriorityLogicalFlag()) {
-						//複製上層最終運算子到優先運算子容器
-						PriorityGeneralOperators().push_back(final_operator);
-					}
-					else {
-						//複製上層最終運算子到下層一般運算子容器
-						GeneralOperators().push_back(final_operator);
-					}
-				}
-			}
-		}
-		//有兩個運算子且雙引數旗標被設立
-		else if (GeneralOperators().size() == 2 && TwoArgumentsFlag()) {
-			//確認雙引數均為算術運算子
-			if (!GeneralOperators().front().arithmetic || !GeneralOperators().back().arithmetic) return false;
-			//複製上層第一引數運算子
-			shared_ptr<ArithmeticOperator> first_argument(GeneralOperators().front().arithmetic);
-			//複製上層第二引數運算子
-			shared_ptr<ArithmeticOperator> second_argument(GeneralOperators().back().arithmetic);
-			//清除上層所有運算子
-			GeneralOperators().clear();
-			//清除雙引數旗標
-			TwoArgumentsFlag() = false;
-			//運算子暫存容器切換回下層
-			if (!LevelDown()) return false;
-			//嘗試建立二元函數運算子
-			if (!CreateBinaryFunctionOperator(first_argument, second_argument)) return false;
-		}
-		//運算子數量或條件異常
+	//關鍵字為迴圈運算子
+	else if (statement_keyword == DO_KEYWORD) {
+		//無條件迴圈
+		if (statement_base == 0) {
+			conditional_loop_operator = ConditionalLoopOperator(value); }
+		else if (operand_stack.front().relational) {
+			conditional_loop_operator = ConditionalLoopOperator(operand_stack.front().relational, value); }
 		else {
-			return false;
-		}
-		//嘗試建立一元運算子(#,minus)
-		CreateUnaryAddressOperator();
-		return true;
+			conditional_loop_operator = ConditionalLoopOperator(operand_stack.front().logical, value); }
 	}
-	//返回錯誤:無任何運算子
+	//關鍵字為迴圈結束
+	else if (statement_keyword == END_KEYWORD) {
+		loop_end_operator = LoopEndOperator(value); }
 	else return false;
+
+	//清除條件運算元及算術運算元
+	operand_stack.clear();
+	return true;
 }
 
-void MacroGenerator::InitialKeywordList()
+FanucMacroParser::FanucMacroParser(MacroVariableInterface& variable_interface)
+	:macro_generator(variable_interface)
 {
-	keyword_list.insert(pair<string, unsigned char>(KEYWORD_SINE_OPERATOR, OperatorType::UNARY_FUNCTION_OPERATOR));
-	keyword_list.insert(pair<string, unsigned char>(KEYWORD_COSINE_OPERATOR, OperatorType::UNARY_FUNCTION_OPERATOR));
-	keyword_list.insert(pair<string, unsigned char>(KEYWORD_TANGENT_OPERATOR, OperatorType::UNARY_FUNCTION_OPERATOR));
-	keyword_list.insert(pair<string, unsigned char>(KEYWORD_ARC_SINE_OPERATOR, OperatorType::UNARY_FUNCTION_OPERATOR));
-	keyword_list.insert(pair<string, unsigned char>(KEYWORD_ARC_COSINE_OPERATOR, OperatorType::UNARY_FUNCTION_OPERATOR));
-	keyword_list.insert(pair<string, unsigned char>(KEYWORD_ARC_TANGENT_OPERATOR, OperatorType::UNARY_BINARY_FUNCTION_OPERATOR));
-	keyword_list.insert(pair<string, unsigned char>(KEYWORD_SQUARE_ROOT_OPERATOR, OperatorType::UNARY_FUNCTION_OPERATOR));
-	keyword_list.insert(pair<string, unsigned char>(KEYWORD_ABSOLUTE_VALUE_OPERATOR, OperatorType::UNARY_FUNCTION_OPERATOR));
-	keyword_list.insert(pair<string, unsigned char>(KEYWORD_BINARY_CODE_OPERATOR, OperatorType::UNARY_FUNCTION_OPERATOR));
-	keyword_list.insert(pair<string, unsigned char>(KEYWORD_BINARY_CODED_DECIMAL_OPERATOR, OperatorType::UNARY_FUNCTION_OPERATOR));
-	keyword_list.insert(pair<string, unsigned char>(KEYWORD_ROUND_OFF_OPERATOR, OperatorType::UNARY_FUNCTION_OPERATOR));
-	keyword_list.insert(pair<string, unsigned char>(KEYWORD_ROUND_DOWN_OPERATOR, OperatorType::UNARY_FUNCTION_OPERATOR));
-	keyword_list.insert(pair<string, unsigned char>(KEYWORD_ROUND_UP_OPERATOR, OperatorType::UNARY_FUNCTION_OPERATOR));
-	keyword_list.insert(pair<string, unsigned char>(KEYWORD_NATURAL_LOG_OPERATOR, OperatorType::UNARY_FUNCTION_OPERATOR));
-	keyword_list.insert(pair<string, unsigned char>(KEYWORD_EXPONENT_OPERATOR, OperatorType::UNARY_FUNCTION_OPERATOR));
-	keyword_list.insert(pair<string, unsigned char>(KEYWORD_POWER_OPERATOR, OperatorType::BINARY_FUNCTION_OPERATOR));
-	keyword_list.insert(pair<string, unsigned char>(KEYWORD_ADD_DECIMAL_POINT_OPERATOR, OperatorType::UNARY_FUNCTION_OPERATOR));
-
-	keyword_list.insert(pair<string, unsigned char>(KEYWORD_EQUAL_OPERATOR, OperatorType::RELATIONAL_OPERATOR));
-	keyword_list.insert(pair<string, unsigned char>(KEYWORD_NOT_EQUAL_OPERATOR, OperatorType::RELATIONAL_OPERATOR));
-	keyword_list.insert(pair<string, unsigned char>(KEYWORD_GREATER_OPERATOR, OperatorType::RELATIONAL_OPERATOR));
-	keyword_list.insert(pair<string, unsigned char>(KEYWORD_GREATER_EQUAL_OPERATOR, OperatorType::RELATIONAL_OPERATOR));
-	keyword_list.insert(pair<string, unsigned char>(KEYWORD_LESS_OPERATOR, OperatorType::RELATIONAL_OPERATOR));
-	keyword_list.insert(pair<string, unsigned char>(KEYWORD_LESS_EQUAL_OPERATOR, OperatorType::RELATIONAL_OPERATOR));
-
-	keyword_list.insert(pair<string, unsigned char>(KEYWORD_AND_OPERATOR, OperatorType::PRIORITY_BINARY_LOGICAL_OPERATOR));
-	keyword_list.insert(pair<string, unsigned char>(KEYWORD_OR_OPERATOR, OperatorType::BINARY_LOGICAL_OPERATOR));
-	keyword_list.insert(pair<string, unsigned char>(KEYWORD_XOR_OPERATOR, OperatorType::BINARY_LOGICAL_OPERATOR));
-
-	keyword_list.insert(pair<string, unsigned char>(KEYWORD_IF_CONDITION, OperatorType::IF_CONDITION));
-	keyword_list.insert(pair<string, unsigned char>(KEYWORD_WHILE_CONDITION, OperatorType::WHILE_CONDITION));
-	keyword_list.insert(pair<string, unsigned char>(KEYWORD_BRANCH_OPERATOR, OperatorType::BRANCH_OPERATOR));
-	keyword_list.insert(pair<string, unsigned char>(KEYWORD_CONDITIONAL_ARITHMETIC_OPERATOR, OperatorType::CONDITIONAL_ARITHMETIC_OPERATOR));
-	keyword_list.insert(pair<string, unsigned char>(KEYWORD_LOOP_OPERATOR, OperatorType::LOOP_OPERATOR));
-	keyword_list.insert(pair<string, unsigned char>(KEYWORD_LOOP_END, OperatorType::LOOP_END));
 }
 
-void MacroGenerator::InitialDenyAddress()
+void FanucMacroParser::EnableWorkspace()
 {
-	//不允許搭配巨集算式之NC位址字元
-	macro_deny_address.insert('O');
-	macro_deny_address.insert(':');
-	macro_deny_address.insert('N');
-	macro_deny_address.insert('/');
+	macro_generator.EnableWorkspace();
 }
 
-Argument::Argument()
-	:flag_control_out(false),
-	flag_digit(false),
-	flag_upper(false),
-	NC_address(NULL),
-	digit_begin(string::const_iterator()),
-	upper_begin(string::const_iterator()),
-	iter(string::const_iterator())
+void FanucMacroParser::EnableBlockCache(size_t capacity)
 {
+	block_cache.SetCapacity(capacity);
 }
 
-FanucMacroParser::FanucMacroParser(MacroVariableInterface& variable_interface)
-	:macro_generator(variable_interface)
+CommandType FanucMacroParser::ParseBlock(const string& block)
 {
+	//未啟用快取:直接剖析
+	if (!block_cache.Enabled()) {
+		return Parse(block); }
+
+	//快取命中:還原已編譯單節的運算子
+	shared_ptr<const CompiledMacroBlock> compiled(block_cache.Find(block));
+	if (compiled) {
+		macro_generator.Restore(*compiled);
+		return compiled->command_type;
+	}
+	//快取未命中:剖析後加入快取(不合法單節一併快取)
+	CommandType command_type(Parse(block));
+	block_cache.Insert(block, make_shared<const CompiledMacroBlock>(command_type, macro_generator));
+	return command_type;
 }
 
-CommandType FanucMacroParser::ParseBlock(const string& block)
+CommandType FanucMacroParser::Parse(const string& block)
 {
-	//剖析巨集用引數
-	Argument args;
 	//清除巨集算式產生器
 	macro_generator.Clear();
-
-	//逐一處理輸入字串內每一個字元
-	for (args.iter = block.begin(); args.iter != block.end(); ++args.iter) {
-		//取得字元
-		unsigned char ch(*args.iter);
-		//註解旗標開啟
-		if (args.flag_control_out) {
-			//字元為註解結束
-			if (ch == ADDRESS_COMMENT_END) {
-				//關閉註解旗標
-				args.flag_control_out = false;
-			}
-			//標記註解文字起始位置
-			if (args.upper_begin == block.end()) args.upper_begin = args.iter;
-			continue;
-		}
-		//字元為數字
-		if (IsDigitOrDot(ch)) {
-			//字元為第一個數字
-			if (args.flag_digit == false) {
-				//記錄數字字元起始位置
-				args.digit_begin = args.iter;
-				//設立數字字元旗標:目前字元位置已進入數字範圍
-				args.flag_digit = true;
-			}
-			//字元位置離開大寫字母範圍
-			if (args.flag_upper) {
-				//建立位址字元或關鍵字字串
-				if (!CreateAddressOrKeyword(args)) {
-					return CommandType::INVALID_COMMAND;
-				}
-			}
-			continue;
-		}
-		//字元位置離開數字範圍
-		if (args.flag_digit) {
-			//建立一元或常數運算子
-			if (!CreateUnaryOrConstantOperator(args)) {
-				return CommandType::INVALID_COMMAND; }
-		}
-		//字元為大寫字母
-		if (isupper(ch)) {
-			//字元為第一個大寫字母
-			if (!args.flag_upper) {
-				//記錄大寫字母起始位置
-				args.upper_begin = args.iter;
-				//設立大寫字母旗標:目前字元位置已進入大寫字母範圍
-				args.flag_upper = true;
-				//存在NC位址字元
-				if (args.NC_address != NULL) {
-					//NC位址字元為大寫字母
-					if (isupper(args.NC_address)) {
-						//目前非巨集運算模式,已建立巨集運算子,運算子類型為算術運算子
-						if (!macro_generator.IsMacroMode() && !macro_generator.GeneralOperators().empty() && macro_generator.GeneralOperators().front().arithmetic) {
-							//清除NC位址字元
-							args.NC_address = NULL;
-							//刪除巨集運算子
-							macro_generator.GeneralOperators().pop_front();
-						}
-					}
-					//返回錯誤:NC位址字元不合法
-					else return INVALID_COMMAND;
-				}
-			}
-			continue;
-		}
-		//字元位置離開大寫字母範圍
-		if (args.flag_upper) {
-			//建立位址字元或關鍵字字串
-			if (!CreateAddressOrKeyword(args)) {
-				return CommandType::INVALID_COMMAND;
-			}
-		}
-
-		//其他非數字且非大寫字母的字元
-		//測試字元是否為運算子
-		unsigned short operator_type(macro_generator.CheckOperatorType(ch));
-		//字元屬於某種運算子
-		if (operator_type != NOT_AN_OPERATOR) {
-			if (!macro_generator.ProcessOperatorAddress(operator_type, ch)) return INVALID_COMMAND;
-		}
-		//字元為優先運算範圍開始
-		else if (ch == ADDRESS_PRIORITY_RANGE_BEGIN) {
-			if (!macro_generator.LevelUp())	return INVALID_COMMAND;
-		}
-		//字元為優先運算範圍結束
-		else if (ch == ADDRESS_PRIORITY_RANGE_END) {
-			if (!macro_generator.ReturnPriorityOperatorToPreviousLevel()) return INVALID_COMMAND;
-		}
-		//字元為雙引數分隔符號
-		else if (ch == ADDRESS_ARGUMENT_SEPARATOR) {
-			if (macro_generator.TwoArgumentsFlag()) {
-				return INVALID_COMMAND; }
-			else {
-				macro_generator.TwoArgumentsFlag() = true; }
-		}
-		//字元為註解開始
-		else if (ch == ADDRESS_COMMENT_BEGIN) {
-			//設定忽略註解文字旗標
-			args.flag_control_out = true;
-		}
-		//直接忽略非巨集相關字元
-		else {
-			continue;
-		}
-	}
-
-	//字元位置離開數字範圍(單節最後一個字元為數字)
-	if (args.flag_digit) {
-		//建立一元或常數運算子
-		if (!CreateUnaryOrConstantOperator(args)) {
-			return CommandType::INVALID_COMMAND;
-		}
+	//單次掃描單節字串,切割為語彙單元
+	lexer.Tokenize(block);
+	//語彙單元串列
+	const vector<MacroToken>& tokens(lexer.Tokens());
+
+	//逐一處理每一個語彙單元
+	for (vector<MacroToken>::size_type index = 0; index != tokens.size(); ++index) {
+		//取得語彙單元
+		const MacroToken& token(tokens[index]);
+		//語彙單元處理結果
+		bool result(true);
+		switch (token.type) {
+			//數字
+		case TOKEN_NUMBER:
+			result = macro_generator.PushNumber(token.text);
+			break;
+
+			//NC位址字元
+		case TOKEN_ADDRESS:
+			//單節末尾的大寫字母不建立位址字元
+			if (index + 1 != tokens.size()) {
+				result = macro_generator.PushNCAddress(token.text); }
+			break;
+
+			//關鍵字
+		case TOKEN_KEYWORD:
+			//單節末尾的大寫字母不建立關鍵字
+			if (index + 1 != tokens.size()) {
+				result = macro_generator.PushKeyword(token); }
+			break;
+
+			//運算子位址字元
+		case TOKEN_OPERATOR:
+			result = macro_generator.PushOperatorAddress(token);
+			break;
+
+			//優先運算範圍開始
+		case TOKEN_PRIORITY_BEGIN:
+			result = macro_generator.OpenPriorityRange(token.text);
+			break;
+
+			//優先運算範圍結束
+		case TOKEN_PRIORITY_END:
+			result = macro_generator.ClosePriorityRange();
+			break;
+
+			//雙引數分隔符號
+		case TOKEN_ARGUMENT_SEPARATOR:
+			result = macro_generator.SeparateArgument();
+			break;
+
+			//直接忽略註解
+		default:
+			break;
+		}
+		//返回錯誤:語彙單元不合法
+		if (!result) return INVALID_COMMAND;
 	}
 
 	//檢查並處理至最後的根部運算子
 	if (!macro_generator.ProcessToFinalOperator()) return INVALID_COMMAND;
-	else {
-		//有NC位址字元及巨集算術運算子
-		if (args.NC_address != NULL && macro_generator.GeneralOperators().front().arithmetic) {
-			//清除NC位址字元
-			args.NC_address = NULL;
-			//刪除巨集運算子
-			macro_generator.GeneralOperators().pop_front();
-		}
-	}
 
-	//巨集運算層數在最底層
-	if (macro_generator.CurrentLevel() == 0) {
-		//成功建立算術運算子
-		if (!macro_generator.GeneralOperators().empty()) {
-			return MACRO_COMMAND;
-		}
-		//成功建立條件式算術運算子
-		else if (!macro_generator.conditional_arithmetic_operator.Empty()) {
-			return MACRO_COMMAND;
-		}
-		//成功建立條件式分支運算子
-		else if (!macro_generator.conditional_branch_operator.Empty()) {
-			return MACRO_COMMAND;
-		}
-		//成功建立條件式迴圈運算子
-		else if (!macro_generator.conditional_loop_operator.Empty()) {
-			return MACRO_COMMAND;
-		}
-		//成功建立迴圈結束運算子
-		else if (!macro_generator.loop_end_operator.Empty()) {
-			return MACRO_COMMAND;
-		}
-		//返回錯誤:未成功建立任何巨集運算子
-		else return INVALID_COMMAND;
+	//成功建立算術運算子
+	if (!macro_generator.GeneralOperators().empty()) {
+		return MACRO_COMMAND;
 	}
-	//返回錯誤:巨集運算層數未返回最底層
-	else {
-		return INVALID_COMMAND;
+	//成功建立條件式算術運算子
+	else if (!macro_generator.conditional_arithmetic_operator.Empty()) {
+		return MACRO_COMMAND;
+	}
+	//成功建立條件式分支運算子
+	else if (!macro_generator.conditional_branch_operator.Empty()) {
+		return MACRO_COMMAND;
+	}
+	//成功建立條件式迴圈運算子
+	else if (!macro_generator.conditional_loop_operator.Empty()) {
+		return MACRO_COMMAND;
 	}
+	//成功建立迴圈結束運算子
+	else if (!macro_generator.loop_end_operator.Empty()) {
+		return MACRO_COMMAND;
+	}
+	//返回錯誤:未成功建立任何巨集運算子
+	else return INVALID_COMMAND;
 }
 
-bool FanucMacroParser::CreateAddressOrKeyword(Argument& args)
+CompiledMacroBlock::CompiledMacroBlock(CommandType type, MacroGenerator& generator)
+	:command_type(type),
+	general_operators(generator.GeneralOperators()),
+	conditional_arithmetic_operator(generator.conditional_arithmetic_operator),
+	conditional_branch_operator(generator.conditional_branch_operator),
+	conditional_loop_operator(generator.conditional_loop_operator),
+	loop_end_operator(generator.loop_end_operator),
+	address_words(generator.AddressWords())
 {
-	//僅有一個大寫字母
-	if (args.iter - args.upper_begin == 1) {
-		//設立NC位址字元
-		args.NC_address = *args.upper_begin;
-	}
-	//超過一個大寫字母
-	else {
-		//建立關鍵字字串
-		macro_generator.UpperString().push(string(args.upper_begin, args.iter));
-		//處理關鍵字字串
-		if (!macro_generator.ProcessOperatorKeyword()) {
-			return false; }
-	}
-	//關閉大寫字母字元旗標
-	args.flag_upper = false;
-	//清空大寫字母起始位置
-	args.upper_begin = string::const_iterator();
-	
-	return true;
 }
 
-bool FanucMacroParser::CreateUnaryOrConstantOperator(Argument& args)
+MacroBlockCache::MacroBlockCache(size_t c)
+	:capacity(c),
+	hits(0),
+	misses(0)
 {
-	//建立數字字串
-	macro_generator.CreateDigitString(args.digit_begin, args.iter);
-	//目前為巨集運算模式
-	if (macro_generator.IsMacroMode()) {
-		//建立常數運算子
-		if (!macro_generator.CreateConstantOperator()) return false;
-		else {
-			//嘗試建立一元運算子(minus,#)
-			macro_generator.CreateUnaryAddressOperator();
-		}
+}
+
+shared_ptr<const CompiledMacroBlock> MacroBlockCache::Find(string_view block)
+{
+	unordered_map<string_view, list<Entry>::iterator>::iterator found(index.find(block));
+	if (found == index.end()) {
+		++misses;
+		return nullptr;
 	}
-	//非巨集運算模式
-	else {
-		//返回錯誤:無NC位址字元可配對
-		if (args.NC_address == NULL) {
-			if (!macro_generator.CreateConstantOperator()) return false;
-		}
-		//有NC位址字元
-		else {
-			//清除數字字串
-			macro_generator.DigitString().pop();
-			//清除NC位址字元
-			args.NC_address = NULL;
-		}
+	++hits;
+	//移至最近使用位置(不移動串列節點,索引鍵保持有效)
+	entries.splice(entries.begin(), entries, found->second);
+	return found->second->second;
+}
+
+void MacroBlockCache::Insert(string_view block, const shared_ptr<const CompiledMacroBlock>& compiled)
+{
+	if (!Enabled()) return;
+	//已存在:更新已編譯單節並移至最近使用位置
+	unordered_map<string_view, list<Entry>::iterator>::iterator found(index.find(block));
+	if (found != index.end()) {
+		found->second->second = compiled;
+		entries.splice(entries.begin(), entries, found->second);
+		return;
 	}
-	//關閉數字字元旗標
-	args.flag_digit = false;
-	//清空數字字元起始位置
-	args.digit_begin = string::const_iterator();
+	entries.emplace_front(string(block), compiled);
+	index.emplace(entries.front().first, entries.begin());
+	Evict();
+}
 
-	return true;
+void MacroBlockCache::SetCapacity(size_t c)
+{
+	capacity = c;
+	Evict();
+}
+
+void MacroBlockCache::Clear()
+{
+	index.clear();
+	entries.clear();
+	hits = 0;
+	misses = 0;
+}
+
+void MacroBlockCache::Evict()
+{
+	while (entries.size() > capacity) {
+		index.erase(entries.back().first);
+		entries.pop_back();
+	}
 }
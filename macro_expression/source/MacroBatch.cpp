@@ -0,0 +1,615 @@
+﻿#include "MacroBatch.h"
+#include "MacroSimd.h"
+#include "DegreeTrigonometry.h"
+#include <algorithm>
+#include <functional>
+#include <cmath>
+#include <cfloat>
+
+using namespace std;
+
+//一元核心:就地核算一欄
+using MacroUnaryKernel = void (*)(double*, size_t);
+//二元核心:左欄就地與右欄核算
+using MacroBinaryKernel = void (*)(double*, const double*, size_t);
+
+//批次核算核心函式表
+class MacroBatchKernels {
+public:
+	MacroBinaryKernel add;
+	MacroBinaryKernel subtract;
+	MacroBinaryKernel multiply;
+	MacroBinaryKernel divide;
+	MacroBinaryKernel power;
+	MacroUnaryKernel minus;
+	MacroUnaryKernel absolute_value;
+	MacroUnaryKernel square_root;
+	MacroUnaryKernel sine;
+	MacroUnaryKernel cosine;
+	MacroUnaryKernel tangent;
+};
+
+//逐筆核算一元運算
+template<typename Operation>
+static void UnaryLanes(double* value, size_t lanes, Operation operation)
+{
+	for (size_t lane = 0; lane != lanes; ++lane) {
+		value[lane] = operation(value[lane]); }
+}
+
+//逐筆核算二元運算
+template<typename Operation>
+static void BinaryLanes(double* left, const double* right, size_t lanes, Operation operation)
+{
+	for (size_t lane = 0; lane != lanes; ++lane) {
+		left[lane] = operation(left[lane], right[lane]); }
+}
+
+static void AddScalar(double* left, const double* right, size_t lanes)
+{
+	BinaryLanes(left, right, lanes, plus<double>());
+}
+
+static void SubtractScalar(double* left, const double* right, size_t lanes)
+{
+	BinaryLanes(left, right, lanes, minus<double>());
+}
+
+static void MultiplyScalar(double* left, const double* right, size_t lanes)
+{
+	BinaryLanes(left, right, lanes, multiplies<double>());
+}
+
+static void DivideScalar(double* left, const double* right, size_t lanes)
+{
+	BinaryLanes(left, right, lanes, divides<double>());
+}
+
+static void PowerScalar(double* left, const double* right, size_t lanes)
+{
+	BinaryLanes(left, right, lanes, [](double base, double exponent) { return pow(base, exponent); });
+}
+
+static void MinusScalar(double* value, size_t lanes)
+{
+	UnaryLanes(value, lanes, negate<double>());
+}
+
+static void AbsoluteValueScalar(double* value, size_t lanes)
+{
+	UnaryLanes(value, lanes, [](double operand) { return fabs(operand); });
+}
+
+static void SquareRootScalar(double* value, size_t lanes)
+{
+	UnaryLanes(value, lanes, [](double operand) { return sqrt(operand); });
+}
+
+static void SineScalar(double* value, size_t lanes)
+{
+	DegreeTrigonometry::Sine(value, lanes, false);
+}
+
+static void CosineScalar(double* value, size_t lanes)
+{
+	DegreeTrigonometry::Cosine(value, lanes, false);
+}
+
+static void TangentScalar(double* value, size_t lanes)
+{
+	DegreeTrigonometry::Tangent(value, lanes, false);
+}
+
+//純量核心
+static const MacroBatchKernels scalar_kernels{
+	AddScalar, SubtractScalar, MultiplyScalar, DivideScalar, PowerScalar,
+	MinusScalar, AbsoluteValueScalar, SquareRootScalar, SineScalar, CosineScalar, TangentScalar };
+
+#if defined(MACRO_SIMD_X86)
+//AVX2一次處理的筆數
+constexpr size_t AVX2_LANES = 4;
+
+MACRO_TARGET_AVX2 static void AddAvx2(double* left, const double* right, size_t lanes)
+{
+	size_t lane(0);
+	for (; lane + AVX2_LANES <= lanes; lane += AVX2_LANES) {
+		_mm256_storeu_pd(left + lane, _mm256_add_pd(_mm256_loadu_pd(left + lane), _mm256_loadu_pd(right + lane))); }
+	AddScalar(left + lane, right + lane, lanes - lane);
+}
+
+MACRO_TARGET_AVX2 static void SubtractAvx2(double* left, const double* right, size_t lanes)
+{
+	size_t lane(0);
+	for (; lane + AVX2_LANES <= lanes; lane += AVX2_LANES) {
+		_mm256_storeu_pd(left + lane, _mm256_sub_pd(_mm256_loadu_pd(left + lane), _mm256_loadu_pd(right + lane))); }
+	SubtractScalar(left + lane, right + lane, lanes - lane);
+}
+
+MACRO_TARGET_AVX2 static void MultiplyAvx2(double* left, const double* right, size_t lanes)
+{
+	size_t lane(0);
+	for (; lane + AVX2_LANES <= lanes; lane += AVX2_LANES) {
+		_mm256_storeu_pd(left + lane, _mm256_mul_pd(_mm256_loadu_pd(left + lane), _mm256_loadu_pd(right + lane))); }
+	MultiplyScalar(left + lane, right + lane, lanes - lane);
+}
+
+MACRO_TARGET_AVX2 static void DivideAvx2(double* left, const double* right, size_t lanes)
+{
+	size_t lane(0);
+	for (; lane + AVX2_LANES <= lanes; lane += AVX2_LANES) {
+		_mm256_storeu_pd(left + lane, _mm256_div_pd(_mm256_loadu_pd(left + lane), _mm256_loadu_pd(right + lane))); }
+	DivideScalar(left + lane, right + lane, lanes - lane);
+}
+
+#if !defined(_MSC_VER)
+//ln2分為高位(低位元為0,乘以整數無捨入誤差)及低位
+constexpr double LN2_HIGH = 6.93147180369123816490e-01;
+constexpr double LN2_LOW = 1.90821492927058770002e-10;
+//1/ln2
+constexpr double INVERSE_LN2 = 1.44269504088896338700e+00;
+//sqrt(2)(尾數化簡至[sqrt(2)/2, sqrt(2)))
+constexpr double SQUARE_ROOT_2 = 1.41421356237309504880;
+//Dekker乘法拆分常數(2^27+1)
+constexpr double SPLIT_FACTOR = 134217729.0;
+//2^52(整數與浮點數位元互轉)
+constexpr double TWO_POWER_52 = 4503599627370496.0;
+//向量核心可處理的指數絕對值上限(拆分時不溢位)
+constexpr double POWER_EXPONENT_LIMIT = 0x1p500;
+//向量核心可處理的y*ln(x)絕對值上限(結果為正規數)
+constexpr double POWER_LOG_LIMIT = 708.0;
+//對數多項式係數個數
+constexpr size_t LOG_COEFFICIENT_COUNT = 7;
+//對數多項式係數(log(1+f) = f - f^2/2 + s*(f^2/2+R(s^2)), s = f/(2+f))
+constexpr double LOG_COEFFICIENT[LOG_COEFFICIENT_COUNT] = {
+	6.666666666666735130e-01, 3.999999999940941908e-01, 2.857142874366239149e-01, 2.222219843214978396e-01,
+	1.818357216161805012e-01, 1.531383769920937332e-01, 1.479819860511658591e-01 };
+//指數多項式係數個數
+constexpr size_t EXPONENT_COEFFICIENT_COUNT = 12;
+//指數多項式係數(|r| <= ln2/2的泰勒展開,1/13!~1/2!)
+constexpr double EXPONENT_COEFFICIENT[EXPONENT_COEFFICIENT_COUNT] = {
+	1.6059043836821614599e-10, 2.0876756987868098979e-09, 2.5052108385441718775e-08, 2.7557319223985890653e-07,
+	2.7557319223985890653e-06, 2.4801587301587301587e-05, 1.9841269841269841270e-04, 1.3888888888888888889e-03,
+	8.3333333333333333333e-03, 4.1666666666666666667e-02, 1.6666666666666666667e-01, 0.5 };
+
+//POW的向量版本:pow(x,y) = exp(y*ln(x)),ln(x)保留高低位且y*ln(x)以Dekker乘法保留捨入誤差
+//x不為正規正數、y過大或結果不為正規數時valid為false,由呼叫端逐筆以pow核算
+MACRO_TARGET_AVX2 static __m256d PowerLanesAvx2(__m256d base, __m256d exponent, bool& valid)
+{
+	const __m256d one(_mm256_set1_pd(1.0)), half(_mm256_set1_pd(0.5)), two_power_52(_mm256_set1_pd(TWO_POWER_52));
+	__m256d domain(_mm256_and_pd(_mm256_cmp_pd(base, _mm256_set1_pd(DBL_MIN), _CMP_GE_OQ),
+		_mm256_cmp_pd(base, _mm256_set1_pd(DBL_MAX), _CMP_LE_OQ)));
+	domain = _mm256_and_pd(domain, _mm256_cmp_pd(_mm256_andnot_pd(_mm256_set1_pd(-0.0), exponent), _mm256_set1_pd(POWER_EXPONENT_LIMIT), _CMP_LE_OQ));
+	if (_mm256_movemask_pd(domain) != 0xF) {
+		valid = false;
+		return base;
+	}
+
+	//x = 2^k * m, m介於[sqrt(2)/2, sqrt(2))
+	__m256i bits(_mm256_castpd_si256(base));
+	__m256d k(_mm256_sub_pd(_mm256_castsi256_pd(_mm256_or_si256(_mm256_srli_epi64(bits, 52), _mm256_castpd_si256(two_power_52))), two_power_52));
+	k = _mm256_sub_pd(k, _mm256_set1_pd(1023.0));
+	__m256d m(_mm256_castsi256_pd(_mm256_or_si256(_mm256_and_si256(bits, _mm256_set1_epi64x(0x000FFFFFFFFFFFFFLL)), _mm256_castpd_si256(one))));
+	__m256d large(_mm256_cmp_pd(m, _mm256_set1_pd(SQUARE_ROOT_2), _CMP_GT_OQ));
+	m = _mm256_blendv_pd(m, _mm256_mul_pd(m, half), large);
+	k = _mm256_add_pd(k, _mm256_and_pd(large, one));
+
+	//ln(m) = f - (f^2/2 - s*(f^2/2+R)),與k*ln2高位相加後保留捨入誤差
+	__m256d f(_mm256_sub_pd(m, one));
+	__m256d s(_mm256_div_pd(f, _mm256_add_pd(_mm256_set1_pd(2.0), f)));
+	__m256d z(_mm256_mul_pd(s, s)), w(_mm256_mul_pd(z, z));
+	//奇數項及偶數項係數分別以w = s^4核算
+	__m256d odd(_mm256_set1_pd(LOG_COEFFICIENT[6])), even(_mm256_set1_pd(LOG_COEFFICIENT[5]));
+	for (size_t index = 4; index != 0; index -= 2) {
+		odd = _mm256_add_pd(_mm256_mul_pd(odd, w), _mm256_set1_pd(LOG_COEFFICIENT[index])); }
+	odd = _mm256_add_pd(_mm256_mul_pd(odd, w), _mm256_set1_pd(LOG_COEFFICIENT[0]));
+	for (size_t index = 3; index != 1; index -= 2) {
+		even = _mm256_add_pd(_mm256_mul_pd(even, w), _mm256_set1_pd(LOG_COEFFICIENT[index])); }
+	even = _mm256_add_pd(_mm256_mul_pd(even, w), _mm256_set1_pd(LOG_COEFFICIENT[1]));
+	__m256d r(_mm256_add_pd(_mm256_mul_pd(z, odd), _mm256_mul_pd(w, even)));
+	__m256d half_square(_mm256_mul_pd(_mm256_mul_pd(half, f), f));
+	__m256d correction(_mm256_sub_pd(_mm256_mul_pd(s, _mm256_add_pd(half_square, r)), half_square));
+	//k*ln2高位+f+修正項依序以Fast2Sum累加(各項絕對值遞減)
+	__m256d k_high(_mm256_mul_pd(k, _mm256_set1_pd(LN2_HIGH)));
+	__m256d sum(_mm256_add_pd(k_high, f));
+	__m256d log_low(_mm256_add_pd(_mm256_sub_pd(k_high, sum), f));
+	__m256d log_high(_mm256_add_pd(sum, correction));
+	log_low = _mm256_add_pd(log_low, _mm256_add_pd(_mm256_sub_pd(sum, log_high), correction));
+	log_low = _mm256_add_pd(log_low, _mm256_mul_pd(k, _mm256_set1_pd(LN2_LOW)));
+
+	//t = y*ln(x) = product + error(Dekker乘法,不使用FMA)
+	__m256d split(_mm256_set1_pd(SPLIT_FACTOR));
+	__m256d c(_mm256_mul_pd(split, exponent)), y_high(_mm256_sub_pd(c, _mm256_sub_pd(c, exponent))), y_low(_mm256_sub_pd(exponent, y_high));
+	c = _mm256_mul_pd(split, log_high);
+	__m256d l_high(_mm256_sub_pd(c, _mm256_sub_pd(c, log_high))), l_low(_mm256_sub_pd(log_high, l_high));
+	__m256d product(_mm256_mul_pd(exponent, log_high));
+	__m256d error(_mm256_add_pd(_mm256_add_pd(_mm256_add_pd(_mm256_sub_pd(_mm256_mul_pd(y_high, l_high), product),
+		_mm256_mul_pd(y_high, l_low)), _mm256_mul_pd(y_low, l_high)), _mm256_mul_pd(y_low, l_low)));
+	error = _mm256_add_pd(error, _mm256_mul_pd(exponent, log_low));
+	if (_mm256_movemask_pd(_mm256_cmp_pd(_mm256_andnot_pd(_mm256_set1_pd(-0.0), product), _mm256_set1_pd(POWER_LOG_LIMIT), _CMP_LE_OQ)) != 0xF) {
+		valid = false;
+		return base;
+	}
+
+	//exp(t) = 2^n * exp(r), |r| <= ln2/2
+	__m256d n(_mm256_round_pd(_mm256_mul_pd(product, _mm256_set1_pd(INVERSE_LN2)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC));
+	r = _mm256_sub_pd(_mm256_add_pd(_mm256_sub_pd(product, _mm256_mul_pd(n, _mm256_set1_pd(LN2_HIGH))), error), _mm256_mul_pd(n, _mm256_set1_pd(LN2_LOW)));
+	__m256d series(_mm256_set1_pd(EXPONENT_COEFFICIENT[0]));
+	for (size_t index = 1; index != EXPONENT_COEFFICIENT_COUNT; ++index) {
+		series = _mm256_add_pd(_mm256_mul_pd(series, r), _mm256_set1_pd(EXPONENT_COEFFICIENT[index])); }
+	//1/1!及1/0!
+	series = _mm256_add_pd(_mm256_mul_pd(series, r), one);
+	series = _mm256_add_pd(_mm256_mul_pd(series, r), one);
+	//2^n:n加上指數偏移後移至指數位元
+	const __m256d magic(_mm256_set1_pd(TWO_POWER_52 * 1.5));
+	__m256i scale(_mm256_sub_epi64(_mm256_castpd_si256(_mm256_add_pd(n, magic)), _mm256_castpd_si256(magic)));
+	scale = _mm256_slli_epi64(_mm256_add_epi64(scale, _mm256_set1_epi64x(1023)), 52);
+	valid = true;
+	return _mm256_mul_pd(series, _mm256_castsi256_pd(scale));
+}
+#endif
+
+MACRO_TARGET_AVX2 static void PowerAvx2(double* left, const double* right, size_t lanes)
+{
+	size_t lane(0);
+	for (; lane + AVX2_LANES <= lanes; lane += AVX2_LANES) {
+#if defined(_MSC_VER)
+		_mm256_storeu_pd(left + lane, _mm256_pow_pd(_mm256_loadu_pd(left + lane), _mm256_loadu_pd(right + lane)));
+#else
+		//負數底數、0、非數值及溢位的四筆逐筆核算
+		bool valid(false);
+		__m256d value(PowerLanesAvx2(_mm256_loadu_pd(left + lane), _mm256_loadu_pd(right + lane), valid));
+		if (valid) {
+			_mm256_storeu_pd(left + lane, value); }
+		else {
+			PowerScalar(left + lane, right + lane, AVX2_LANES); }
+#endif
+	}
+	PowerScalar(left + lane, right + lane, lanes - lane);
+}
+
+MACRO_TARGET_AVX2 static void MinusAvx2(double* value, size_t lanes)
+{
+	//反轉符號位元
+	const __m256d sign(_mm256_set1_pd(-0.0));
+	size_t lane(0);
+	for (; lane + AVX2_LANES <= lanes; lane += AVX2_LANES) {
+		_mm256_storeu_pd(value + lane, _mm256_xor_pd(_mm256_loadu_pd(value + lane), sign)); }
+	MinusScalar(value + lane, lanes - lane);
+}
+
+MACRO_TARGET_AVX2 static void AbsoluteValueAvx2(double* value, size_t lanes)
+{
+	//清除符號位元
+	const __m256d sign(_mm256_set1_pd(-0.0));
+	size_t lane(0);
+	for (; lane + AVX2_LANES <= lanes; lane += AVX2_LANES) {
+		_mm256_storeu_pd(value + lane, _mm256_andnot_pd(sign, _mm256_loadu_pd(value + lane))); }
+	AbsoluteValueScalar(value + lane, lanes - lane);
+}
+
+MACRO_TARGET_AVX2 static void SquareRootAvx2(double* value, size_t lanes)
+{
+	size_t lane(0);
+	for (; lane + AVX2_LANES <= lanes; lane += AVX2_LANES) {
+		_mm256_storeu_pd(value + lane, _mm256_sqrt_pd(_mm256_loadu_pd(value + lane))); }
+	SquareRootScalar(value + lane, lanes - lane);
+}
+
+static void SineAvx2(double* value, size_t lanes)
+{
+	DegreeTrigonometry::Sine(value, lanes, true);
+}
+
+static void CosineAvx2(double* value, size_t lanes)
+{
+	DegreeTrigonometry::Cosine(value, lanes, true);
+}
+
+static void TangentAvx2(double* value, size_t lanes)
+{
+	DegreeTrigonometry::Tangent(value, lanes, true);
+}
+
+//AVX2核心
+static const MacroBatchKernels avx2_kernels{
+	AddAvx2, SubtractAvx2, MultiplyAvx2, DivideAvx2, PowerAvx2,
+	MinusAvx2, AbsoluteValueAvx2, SquareRootAvx2, SineAvx2, CosineAvx2, TangentAvx2 };
+#endif
+
+MacroBatchEvaluator::MacroBatchEvaluator(MacroVariableInterface& interface)
+	:simd(SimdSupported()),
+	macro_variable_interface(interface)
+{
+}
+
+//展開定值欄(僅第一筆有效)至所有筆數
+static void Expand(double* column, char& uniform, size_t lanes)
+{
+	if (uniform) {
+		fill(column + 1, column + lanes, column[0]);
+		uniform = 0;
+	}
+}
+
+//二元運算的核算筆數:左右欄皆為定值時只核算第一筆,否則展開定值欄後逐筆核算
+static size_t BinaryCount(double* left, char& left_uniform, double* right, char& right_uniform, size_t lanes)
+{
+	if (left_uniform && right_uniform) {
+		return 1; }
+	Expand(left, left_uniform, lanes);
+	Expand(right, right_uniform, lanes);
+	return lanes;
+}
+
+bool MacroBatchEvaluator::SimdSupported()
+{
+	return MacroSimdSupported();
+}
+
+bool MacroBatchEvaluator::Supported(const MacroBytecode& bytecode)
+{
+	if (bytecode.Empty()) {
+		return false; }
+	for (const MacroInstruction& instruction : bytecode.Code()) {
+		switch (instruction.opcode) {
+			//寫入變數及控制指令無法批次核算
+		case OP_ASSIGNMENT:
+		case OP_STORE_VARIABLE:
+		case OP_JUMP_IF_FALSE:
+		case OP_BRANCH:
+		case OP_LOOP:
+		case OP_LOOP_END:
+			return false;
+		default:
+			break;
+		}
+	}
+	return true;
+}
+
+double MacroBatchEvaluator::ReadVariable(const vector<MacroBatchColumn>& columns, unsigned short variable_ID, size_t row, const MacroInstruction& instruction, bool alarm)
+{
+	for (const MacroBatchColumn& column : columns) {
+		if (column.variable_ID == variable_ID) {
+			return column.values[row]; }
+	}
+	double value(0.0);
+	if (macro_variable_interface.ReadVariable(variable_ID, value)) {
+		return value; }
+	if (alarm) {
+		macro_variable_interface.RaiseAlarm(ALARM_VARIABLE_NOT_EXIST, &instruction, variable_ID); }
+	return NULL_VARIABLE;
+}
+
+bool MacroBatchEvaluator::Evaluate(const MacroBytecode& bytecode, const vector<MacroBatchColumn>& columns, size_t count, double* results)
+{
+	if (!Supported(bytecode)) {
+		return false; }
+	//擴充數值欄(僅在所需深度超過目前容量時配置),底部保留一欄使堆疊頂端欄恆為有效位址
+	if (stack.size() < (bytecode.StackDepth() + 1) * MACRO_BATCH_LANES) {
+		stack.resize((bytecode.StackDepth() + 1) * MACRO_BATCH_LANES); }
+	if (temporaries.size() < bytecode.TemporaryCount() * MACRO_BATCH_LANES) {
+		temporaries.resize(bytecode.TemporaryCount() * MACRO_BATCH_LANES); }
+	if (uniform_columns.size() < bytecode.StackDepth() + 1) {
+		uniform_columns.resize(bytecode.StackDepth() + 1); }
+	if (uniform_temporaries.size() < bytecode.TemporaryCount()) {
+		uniform_temporaries.resize(bytecode.TemporaryCount()); }
+
+	for (size_t offset = 0; offset < count; offset += MACRO_BATCH_LANES) {
+		EvaluateLanes(bytecode, columns, offset, min(MACRO_BATCH_LANES, count - offset), results); }
+	return true;
+}
+
+void MacroBatchEvaluator::EvaluateLanes(const MacroBytecode& bytecode, const vector<MacroBatchColumn>& columns, size_t offset, size_t lanes, double* results)
+{
+#if defined(MACRO_SIMD_X86)
+	const MacroBatchKernels& kernels(simd ? avx2_kernels : scalar_kernels);
+#else
+	const MacroBatchKernels& kernels(scalar_kernels);
+#endif
+	const vector<double>& constants(bytecode.Constants());
+	//堆疊底部欄
+	double* const base(stack.data() + MACRO_BATCH_LANES);
+	//下一個可用欄
+	double* top(base);
+	//各層是否為定值欄(與堆疊相同保留底部一層)
+	char* const uniform(uniform_columns.data() + 1);
+	//目前跳過右運算元的資料列(不在短路核算的右運算元內時為nullptr)
+	const char* skipped(nullptr);
+	skip_ends.clear();
+
+	const vector<MacroInstruction>& code(bytecode.Code());
+	for (size_t pc = 0; pc != code.size(); ++pc) {
+		const MacroInstruction& instruction(code[pc]);
+		//離開短路核算的右運算元
+		while (!skip_ends.empty() && skip_ends.back() == pc) {
+			skip_ends.pop_back();
+			skipped = skip_ends.empty() ? nullptr : skipped_rows.data() + (skip_ends.size() - 1) * MACRO_BATCH_LANES;
+		}
+		//二元運算先取出右運算元欄
+		int effect(MacroBytecode::StackEffect(instruction.opcode));
+		if (effect < 0) {
+			top -= MACRO_BATCH_LANES; }
+		//堆疊頂端欄(二元運算為左運算元欄,右運算元欄為top)
+		double* const column(top - MACRO_BATCH_LANES);
+		ptrdiff_t level((top - base) / static_cast<ptrdiff_t>(MACRO_BATCH_LANES));
+		char& constant(uniform[level - 1]);
+		//核算筆數:定值欄只核算第一筆
+		size_t count(constant ? 1 : lanes);
+		if (effect < 0) {
+			count = BinaryCount(column, constant, top, uniform[level], lanes); }
+
+		switch (instruction.opcode) {
+		case OP_CONSTANT:
+			top[0] = constants[instruction.argument];
+			uniform[level] = 1;
+			top += MACRO_BATCH_LANES;
+			break;
+		case OP_LOAD_VARIABLE: {
+			unsigned short variable_ID(static_cast<unsigned short>(instruction.argument));
+			vector<MacroBatchColumn>::const_iterator input(find_if(columns.begin(), columns.end(),
+				[variable_ID](const MacroBatchColumn& bound) { return bound.variable_ID == variable_ID; }));
+			//輸入欄變數逐筆複製,其餘變數於整段資料中為定值
+			if (input != columns.end()) {
+				copy(input->values + offset, input->values + offset + lanes, top);
+				uniform[level] = 0;
+			}
+			else {
+				//所有資料列皆跳過時不發出警報
+				bool alarm(!skipped || find(skipped, skipped + lanes, 0) != skipped + lanes);
+				top[0] = ReadVariable(columns, variable_ID, offset, instruction, alarm);
+				uniform[level] = 1;
+			}
+			top += MACRO_BATCH_LANES;
+			break;
+		}
+		case OP_VARIABLE:
+			//變數ID可能指向輸入欄,逐筆讀取
+			Expand(column, constant, lanes);
+			for (size_t lane = 0; lane != lanes; ++lane) {
+				column[lane] = ReadVariable(columns, VariableID(column[lane]), offset + lane, instruction, !skipped || !skipped[lane]); }
+			break;
+		case OP_MINUS:
+			kernels.minus(column, count);
+			break;
+		case OP_ADD:
+			kernels.add(column, top, count);
+			break;
+		case OP_SUBTRACT:
+			kernels.subtract(column, top, count);
+			break;
+		case OP_MULTIPLY:
+			kernels.multiply(column, top, count);
+			break;
+		case OP_DIVIDE:
+			kernels.divide(column, top, count);
+			break;
+		case OP_SINE:
+			kernels.sine(column, count);
+			break;
+		case OP_COSINE:
+			kernels.cosine(column, count);
+			break;
+		case OP_TANGENT:
+			kernels.tangent(column, count);
+			break;
+		case OP_ARC_SINE:
+			UnaryLanes(column, count, [](double value) { return DegreeTrigonometry::ArcSine(value); });
+			break;
+		case OP_ARC_COSINE:
+			UnaryLanes(column, count, [](double value) { return DegreeTrigonometry::ArcCosine(value); });
+			break;
+		case OP_ARC_TANGENT:
+			UnaryLanes(column, count, [](double value) { return DegreeTrigonometry::ArcTangent(value); });
+			break;
+		case OP_ARC_TANGENT2:
+			BinaryLanes(column, top, count, [](double y, double x) { return DegreeTrigonometry::ArcTangent2(y, x); });
+			break;
+		case OP_SQUARE_ROOT:
+			kernels.square_root(column, count);
+			break;
+		case OP_ABSOLUTE_VALUE:
+			kernels.absolute_value(column, count);
+			break;
+		case OP_BINARY_CODE:
+			UnaryLanes(column, count, BinaryCodeOperator::Convert);
+			break;
+		case OP_BINARY_CODED_DECIMAL:
+			UnaryLanes(column, count, BinaryCodedDecimalOperator::Convert);
+			break;
+		case OP_ROUND_OFF:
+			UnaryLanes(column, count, [](double value) { return round(value); });
+			break;
+		case OP_ROUND_DOWN:
+			UnaryLanes(column, count, [](double value) { return value < 0.0 ? ceil(value) : floor(value); });
+			break;
+		case OP_ROUND_UP:
+			UnaryLanes(column, count, [](double value) { return value < 0.0 ? floor(value) : ceil(value); });
+			break;
+		case OP_NATURAL_LOG:
+			UnaryLanes(column, count, [](double value) { return log(value); });
+			break;
+		case OP_EXPONENT:
+			UnaryLanes(column, count, [](double value) { return exp(value); });
+			break;
+		case OP_POWER:
+			kernels.power(column, top, count);
+			break;
+		case OP_ADD_DECIMAL_POINT: {
+			double least_increment(constants[instruction.argument]);
+			UnaryLanes(column, count, [least_increment](double value) { return value / least_increment; });
+			break;
+		}
+		case OP_EQUAL:
+			BinaryLanes(column, top, count, [](double left, double right) { return left == right ? 1.0 : 0.0; });
+			break;
+		case OP_NOT_EQUAL:
+			BinaryLanes(column, top, count, [](double left, double right) { return left != right ? 1.0 : 0.0; });
+			break;
+		case OP_GREATER:
+			BinaryLanes(column, top, count, [](double left, double right) { return left > right ? 1.0 : 0.0; });
+			break;
+		case OP_GREATER_EQUAL:
+			BinaryLanes(column, top, count, [](double left, double right) { return left >= right ? 1.0 : 0.0; });
+			break;
+		case OP_LESS:
+			BinaryLanes(column, top, count, [](double left, double right) { return left < right ? 1.0 : 0.0; });
+			break;
+		case OP_LESS_EQUAL:
+			BinaryLanes(column, top, count, [](double left, double right) { return left <= right ? 1.0 : 0.0; });
+			break;
+		case OP_AND:
+			BinaryLanes(column, top, count, [](double left, double right) {
+				return static_cast<double>(static_cast<unsigned>(left) & static_cast<unsigned>(right)); });
+			break;
+		case OP_OR:
+			BinaryLanes(column, top, count, [](double left, double right) {
+				return static_cast<double>(static_cast<unsigned>(left) | static_cast<unsigned>(right)); });
+			break;
+		case OP_XOR:
+			BinaryLanes(column, top, count, [](double left, double right) {
+				return static_cast<double>(static_cast<unsigned>(left) ^ static_cast<unsigned>(right)); });
+			break;
+		case OP_STORE_TEMPORARY:
+			copy(column, column + count, temporaries.data() + instruction.argument * MACRO_BATCH_LANES);
+			uniform_temporaries[instruction.argument] = constant;
+			break;
+		case OP_LOAD_TEMPORARY: {
+			const double* temporary(temporaries.data() + instruction.argument * MACRO_BATCH_LANES);
+			uniform[level] = uniform_temporaries[instruction.argument];
+			copy(temporary, temporary + (uniform[level] ? 1 : lanes), top);
+			top += MACRO_BATCH_LANES;
+			break;
+		}
+			//各筆資料的左運算元不同,一律核算右運算元(結果與短路核算相同),僅記錄跳過的資料列以遮蔽其警報
+		case OP_AND_SHORT_CIRCUIT:
+		case OP_OR_SHORT_CIRCUIT: {
+			//擴充後重新取得外層跳過的資料列
+			if (skipped_rows.size() < (skip_ends.size() + 1) * MACRO_BATCH_LANES) {
+				skipped_rows.resize((skip_ends.size() + 1) * MACRO_BATCH_LANES);
+				skipped = skip_ends.empty() ? nullptr : skipped_rows.data() + (skip_ends.size() - 1) * MACRO_BATCH_LANES;
+			}
+			char* rows(skipped_rows.data() + skip_ends.size() * MACRO_BATCH_LANES);
+			bool and_operator(instruction.opcode == OP_AND_SHORT_CIRCUIT);
+			for (size_t lane = 0; lane != lanes; ++lane) {
+				double left(column[constant ? 0 : lane]);
+				rows[lane] = (skipped && skipped[lane]) || (and_operator ? static_cast<unsigned>(left) == 0 : left != 0.0);
+			}
+			skip_ends.push_back(instruction.argument);
+			skipped = rows;
+			break;
+		}
+		case OP_RETURN:
+			if (top != base) {
+				Expand(column, constant, lanes);
+				copy(column, column + lanes, results + offset);
+			}
+			else {
+				fill(results + offset, results + offset + lanes, 0.0); }
+			return;
+			//Supported已排除寫入變數及控制指令
+		default:
+			return;
+		}
+	}
+}
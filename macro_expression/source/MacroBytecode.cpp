@@ -0,0 +1,532 @@
+﻿#include "MacroBytecode.h"
+#include <cmath>
+#include <climits>
+#include <algorithm>
+
+using namespace std;
+
+//無跳躍指令
+constexpr size_t NO_JUMP = SIZE_MAX;
+
+MacroBytecode::MacroBytecode()
+	:stack_depth(0),
+	current_depth(0),
+	temporary_count(0)
+{
+}
+
+void MacroBytecode::Clear()
+{
+	code.clear();
+	constants.clear();
+	stack_depth = 0;
+	current_depth = 0;
+	temporary_count = 0;
+	temporaries.clear();
+}
+
+int MacroBytecode::StackEffect(MacroOpcode opcode)
+{
+	switch (opcode) {
+		//存入一個數值
+	case OP_CONSTANT:
+	case OP_LOAD_VARIABLE:
+	case OP_LOAD_TEMPORARY:
+		return 1;
+		//取出兩個數值並存入一個數值
+	case OP_ADD:
+	case OP_SUBTRACT:
+	case OP_MULTIPLY:
+	case OP_DIVIDE:
+	case OP_ASSIGNMENT:
+	case OP_ARC_TANGENT2:
+	case OP_POWER:
+	case OP_EQUAL:
+	case OP_NOT_EQUAL:
+	case OP_GREATER:
+	case OP_GREATER_EQUAL:
+	case OP_LESS:
+	case OP_LESS_EQUAL:
+	case OP_AND:
+	case OP_OR:
+	case OP_XOR:
+		//取出一個數值
+	case OP_JUMP_IF_FALSE:
+	case OP_BRANCH:
+	case OP_LOOP:
+	case OP_LOOP_END:
+		return -1;
+		//一元運算,賦值至常數ID變數,短路及結束核算不改變堆疊深度
+	default:
+		return 0;
+	}
+}
+
+void MacroBytecode::Emit(MacroOpcode opcode, unsigned argument)
+{
+	code.emplace_back(opcode, argument);
+	current_depth += StackEffect(opcode);
+	stack_depth = max(stack_depth, current_depth);
+}
+
+unsigned MacroBytecode::AddConstant(double value)
+{
+	constants.push_back(value);
+	return static_cast<unsigned>(constants.size() - 1);
+}
+
+bool MacroBytecode::EmitArithmetic(const ArithmeticOperator* arithmetic)
+{
+	if (!arithmetic) return false;
+
+	MacroOperatorID id(arithmetic->GetOperatorID());
+	switch (id) {
+		//常數運算子
+	case CONSTANT:
+		Emit(OP_CONSTANT, AddConstant(static_cast<const UnaryOperator*>(arithmetic)->Operand()));
+		return true;
+
+		//賦值運算子:先核算右運算元,再核算左變數運算子的變數ID
+	case ASSIGNMENT: {
+		const AssignmentOperator* assignment(static_cast<const AssignmentOperator*>(arithmetic));
+		if (assignment->RightLogical()) {
+			if (!EmitLogical(assignment->RightLogical().get())) return false; }
+		else if (!EmitArithmetic(assignment->RightOperand().get())) return false;
+		if (!assignment->LeftVariable()) return false;
+		const ArithmeticOperator* variable_ID(assignment->LeftVariable()->OperandHandle().get());
+		//常數變數ID直接寫入指令引數
+		if (variable_ID && variable_ID->GetOperatorID() == CONSTANT) {
+			Emit(OP_STORE_VARIABLE, VariableID(static_cast<const UnaryOperator*>(variable_ID)->Operand()));
+			return true;
+		}
+		if (!EmitArithmetic(variable_ID)) return false;
+		Emit(OP_ASSIGNMENT);
+		return true;
+	}
+
+		//變數運算子:常數變數ID直接寫入指令引數
+	case VARIABLE: {
+		const ArithmeticOperator* variable_ID(static_cast<const UnaryOperator*>(arithmetic)->OperandHandle().get());
+		if (variable_ID && variable_ID->GetOperatorID() == CONSTANT) {
+			Emit(OP_LOAD_VARIABLE, VariableID(static_cast<const UnaryOperator*>(variable_ID)->Operand()));
+			return true;
+		}
+		if (!EmitArithmetic(variable_ID)) return false;
+		Emit(OP_VARIABLE);
+		return true;
+	}
+
+		//轉換浮點數運算子:最小設定單位存入常數表
+	case ADD_DECIMAL_POINT: {
+		const AddDecimalPointOperator* add_decimal_point(static_cast<const AddDecimalPointOperator*>(arithmetic));
+		if (!EmitArithmetic(add_decimal_point->OperandHandle().get())) return false;
+		Emit(OP_ADD_DECIMAL_POINT, AddConstant(add_decimal_point->LeastIncrement()));
+		return true;
+	}
+
+		//共同子運算式運算子:首次核算後保存於暫存區,其後直接讀取
+	case COMMON_SUBEXPRESSION: {
+		const CommonSubexpressionOperator* common(static_cast<const CommonSubexpressionOperator*>(arithmetic));
+		const ArithmeticOperator* operand(common->OperandHandle().get());
+		//核算範圍不需暫存(單次執行即為一個核算世代)
+		if (common->Scope()) {
+			return EmitArithmetic(operand); }
+		vector<const ArithmeticOperator*>::iterator found(find(temporaries.begin(), temporaries.end(), arithmetic));
+		if (found != temporaries.end()) {
+			Emit(OP_LOAD_TEMPORARY, static_cast<unsigned>(found - temporaries.begin()));
+			return true;
+		}
+		if (!EmitArithmetic(operand)) return false;
+		temporaries.push_back(arithmetic);
+		temporary_count = max(temporary_count, temporaries.size());
+		Emit(OP_STORE_TEMPORARY, static_cast<unsigned>(temporaries.size() - 1));
+		return true;
+	}
+
+		//二元運算子
+	case ADD:
+	case SUBSTRACT:
+	case MULTIPLY:
+	case DIVIDE:
+	case ARC_TANGENT2:
+	case POWER: {
+		const BinaryOperator* binary(static_cast<const BinaryOperator*>(arithmetic));
+		if (!EmitArithmetic(binary->LeftOperand().get()) || !EmitArithmetic(binary->RightOperand().get())) return false;
+		Emit(static_cast<MacroOpcode>(id));
+		return true;
+	}
+
+		//一元運算子
+	default:
+		if (!EmitArithmetic(static_cast<const UnaryOperator*>(arithmetic)->OperandHandle().get())) return false;
+		Emit(static_cast<MacroOpcode>(id));
+		return true;
+	}
+}
+
+bool MacroBytecode::EmitRelational(const RelationalOperator* relational)
+{
+	if (!relational) return false;
+	if (!EmitArithmetic(relational->LeftOperand().get()) || !EmitArithmetic(relational->RightOperand().get())) return false;
+	Emit(static_cast<MacroOpcode>(OP_EQUAL + static_cast<int>(relational->GetOperatorID())));
+	return true;
+}
+
+bool MacroBytecode::EmitLogical(const LogicalOperator* logical)
+{
+	if (!logical) return false;
+	if (!EmitOperand(logical->LeftOperand())) return false;
+
+	//AND左運算元為0,或左右運算元皆為布林值的OR左運算元成立時,跳過右運算元
+	LogicalOperatorID id(logical->GetOperatorID());
+	size_t jump(NO_JUMP);
+	if (id == AND || (id == OR && logical->Boolean())) {
+		jump = code.size();
+		Emit(id == AND ? OP_AND_SHORT_CIRCUIT : OP_OR_SHORT_CIRCUIT);
+	}
+	size_t temporary_size(temporaries.size());
+	if (!EmitOperand(logical->RightOperand())) return false;
+	Emit(static_cast<MacroOpcode>(OP_AND + static_cast<int>(id)));
+	if (jump != NO_JUMP) {
+		code[jump].argument = static_cast<unsigned>(code.size());
+		//右運算元可能未核算:其中首次保存的共同子運算式不可於其後讀取
+		temporaries.resize(temporary_size);
+	}
+	return true;
+}
+
+bool MacroBytecode::EmitOperand(const ConditionOperand& operand)
+{
+	switch (operand.Type()) {
+	case ARITHMETIC_CONDITION_OPERAND:
+		return EmitArithmetic(operand.Arithmetic());
+	case RELATIONAL_CONDITION_OPERAND:
+		return EmitRelational(operand.Relational());
+	case LOGICAL_CONDITION_OPERAND:
+		return EmitLogical(operand.Logical());
+	default:
+		return false;
+	}
+}
+
+bool MacroBytecode::EmitCondition(const ConditionOperand& condition, size_t& jump)
+{
+	//無條件式
+	jump = NO_JUMP;
+	if (condition.Empty()) {
+		return true; }
+
+	if (!EmitOperand(condition)) return false;
+	jump = code.size();
+	Emit(OP_JUMP_IF_FALSE);
+	return true;
+}
+
+bool MacroBytecode::Compile(const CompiledMacroBlock& compiled)
+{
+	Clear();
+
+	bool result(false);
+	size_t jump(NO_JUMP);
+	//通用運算子
+	if (!compiled.general_operators.empty()) {
+		const GeneralOperatorHandle& handle(compiled.general_operators.front());
+		if (handle.arithmetic) {
+			result = EmitArithmetic(handle.arithmetic.get()); }
+		else if (handle.relational) {
+			result = EmitRelational(handle.relational.get()); }
+		else if (handle.logical) {
+			result = EmitLogical(handle.logical.get()); }
+	}
+	//條件式算術運算子:IF[...] THEN
+	else if (!compiled.conditional_arithmetic_operator.Empty()) {
+		const ConditionalArithmeticOperator& conditional(compiled.conditional_arithmetic_operator);
+		result = EmitCondition(conditional.Condition(), jump) &&
+			EmitArithmetic(conditional.Arithmetic());
+	}
+	//條件式分支運算子:[IF[...]] GOTO
+	else if (!compiled.conditional_branch_operator.Empty()) {
+		const ConditionalBranchOperator& branch(compiled.conditional_branch_operator);
+		result = EmitCondition(branch.Condition(), jump) &&
+			EmitArithmetic(branch.Arithmetic());
+		if (result) {
+			Emit(OP_BRANCH); }
+	}
+	//條件式迴圈運算子:[WHILE[...]] DO,條件不成立時仍須取得迴圈識別號碼
+	else if (!compiled.conditional_loop_operator.Empty()) {
+		const ConditionalLoopOperator& loop(compiled.conditional_loop_operator);
+		result = EmitArithmetic(loop.Arithmetic());
+		if (result) {
+			Emit(OP_LOOP);
+			result = EmitCondition(loop.Condition(), jump);
+		}
+	}
+	//迴圈終點運算子:END
+	else if (!compiled.loop_end_operator.Empty()) {
+		result = EmitArithmetic(compiled.loop_end_operator.Arithmetic());
+		if (result) {
+			Emit(OP_LOOP_END); }
+	}
+
+	if (!result) {
+		Clear();
+		return false;
+	}
+	//條件不成立時跳至結束指令
+	if (jump != NO_JUMP) {
+		code[jump].argument = static_cast<unsigned>(code.size()); }
+	Emit(OP_RETURN);
+	//運算子樹可能先於位元組碼釋放,僅保留暫存區數量
+	temporaries.clear();
+	return true;
+}
+
+MacroVirtualMachine::MacroVirtualMachine(MacroVariableInterface& interface)
+	:local_values(nullptr),
+	macro_variable_interface(interface)
+{
+}
+
+double MacroVirtualMachine::ReadVariable(unsigned short variable_ID, const MacroInstruction& instruction)
+{
+	//依變數分派表直接讀取存放位址,其餘類型經由存取介面
+	MacroVariableSlot slot(macro_variable_interface.ResolveVariable(variable_ID));
+	switch (slot.type) {
+	case SLOT_LOCAL:
+		return local_values[variable_ID];
+	case SLOT_COMMON:
+	case SLOT_SYSTEM_DOUBLE:
+	case SLOT_SYSTEM_READ_ONLY:
+		return *slot.value;
+	default:
+		break;
+	}
+	double value(0.0);
+	if (macro_variable_interface.ReadVariable(slot, value)) {
+		return value; }
+	else {
+		macro_variable_interface.RaiseAlarm(ALARM_VARIABLE_NOT_EXIST, &instruction, variable_ID);
+		return NULL_VARIABLE;
+	}
+}
+
+void MacroVirtualMachine::WriteVariable(unsigned short variable_ID, double value, const MacroInstruction& instruction)
+{
+	if (variable_ID == 0) {
+		macro_variable_interface.RaiseAlarm(ALARM_READ_ONLY_VARIABLE, &instruction); }
+	//局部變數直接寫入目前變數層(與存取介面相同遞增核算世代,警報後經由存取介面停止寫入)
+	else if (variable_ID < LOCAL_VARIABLE_COUNT && !macro_variable_interface.HasAlarm()) {
+		macro_variable_interface.NextGeneration();
+		local_values[variable_ID] = value;
+	}
+	else {
+		macro_variable_interface.WriteVariable(variable_ID, value); }
+}
+
+MacroBytecodeResult MacroVirtualMachine::Run(const MacroBytecode& bytecode)
+{
+	MacroBytecodeResult result;
+	if (bytecode.Empty()) {
+		result.condition = false;
+		return result;
+	}
+	//擴充數值堆疊(僅在位元組碼所需深度超過目前容量時配置)
+	if (stack.size() < bytecode.StackDepth()) {
+		stack.resize(bytecode.StackDepth()); }
+	if (temporaries.size() < bytecode.TemporaryCount()) {
+		temporaries.resize(bytecode.TemporaryCount()); }
+
+	//變數層僅於呼叫巨集時切換,執行期間不變
+	local_values = macro_variable_interface.LocalValues();
+	const MacroInstruction* code(bytecode.Code().data());
+	const double* constants(bytecode.Constants().data());
+	//堆疊底部
+	double* const base(stack.data());
+	//下一個可用堆疊位置
+	double* top(base);
+	//指令索引
+	size_t pc(0);
+
+	for (;;) {
+		const MacroInstruction& instruction(code[pc++]);
+		switch (instruction.opcode) {
+		case OP_CONSTANT:
+			*top++ = constants[instruction.argument];
+			break;
+		case OP_MINUS:
+			top[-1] = -top[-1];
+			break;
+		case OP_VARIABLE:
+			top[-1] = ReadVariable(VariableID(top[-1]), instruction);
+			break;
+		case OP_ADD:
+			--top;
+			top[-1] = top[-1] + top[0];
+			break;
+		case OP_SUBTRACT:
+			--top;
+			top[-1] = top[-1] - top[0];
+			break;
+		case OP_MULTIPLY:
+			--top;
+			top[-1] = top[-1] * top[0];
+			break;
+		case OP_DIVIDE:
+			--top;
+			top[-1] = top[-1] / top[0];
+			break;
+		case OP_ASSIGNMENT: {
+			//堆疊頂端為變數ID,其下為寫入值
+			--top;
+			unsigned short variable_ID(VariableID(top[0]));
+			WriteVariable(variable_ID, top[-1], instruction);
+			top[-1] = ReadVariable(variable_ID, instruction);
+			break;
+		}
+		case OP_SINE:
+			top[-1] = DegreeTrigonometry::Sine(top[-1]);
+			break;
+		case OP_COSINE:
+			top[-1] = DegreeTrigonometry::Cosine(top[-1]);
+			break;
+		case OP_TANGENT:
+			top[-1] = DegreeTrigonometry::Tangent(top[-1]);
+			break;
+		case OP_ARC_SINE:
+			top[-1] = DegreeTrigonometry::ArcSine(top[-1]);
+			break;
+		case OP_ARC_COSINE:
+			top[-1] = DegreeTrigonometry::ArcCosine(top[-1]);
+			break;
+		case OP_ARC_TANGENT:
+			top[-1] = DegreeTrigonometry::ArcTangent(top[-1]);
+			break;
+		case OP_ARC_TANGENT2:
+			--top;
+			top[-1] = DegreeTrigonometry::ArcTangent2(top[-1], top[0]);
+			break;
+		case OP_SQUARE_ROOT:
+			top[-1] = sqrt(top[-1]);
+			break;
+		case OP_ABSOLUTE_VALUE:
+			top[-1] = fabs(top[-1]);
+			break;
+		case OP_BINARY_CODE:
+			top[-1] = BinaryCodeOperator::Convert(top[-1]);
+			break;
+		case OP_BINARY_CODED_DECIMAL:
+			top[-1] = BinaryCodedDecimalOperator::Convert(top[-1]);
+			break;
+		case OP_ROUND_OFF:
+			top[-1] = round(top[-1]);
+			break;
+		case OP_ROUND_DOWN:
+			top[-1] = top[-1] < 0.0 ? ceil(top[-1]) : floor(top[-1]);
+			break;
+		case OP_ROUND_UP:
+			top[-1] = top[-1] < 0.0 ? floor(top[-1]) : ceil(top[-1]);
+			break;
+		case OP_NATURAL_LOG:
+			top[-1] = log(top[-1]);
+			break;
+		case OP_EXPONENT:
+			top[-1] = exp(top[-1]);
+			break;
+		case OP_POWER:
+			--top;
+			top[-1] = pow(top[-1], top[0]);
+			break;
+		case OP_ADD_DECIMAL_POINT:
+			top[-1] = top[-1] / constants[instruction.argument];
+			break;
+		case OP_EQUAL:
+			--top;
+			top[-1] = top[-1] == top[0] ? 1.0 : 0.0;
+			break;
+		case OP_NOT_EQUAL:
+			--top;
+			top[-1] = top[-1] != top[0] ? 1.0 : 0.0;
+			break;
+		case OP_GREATER:
+			--top;
+			top[-1] = top[-1] > top[0] ? 1.0 : 0.0;
+			break;
+		case OP_GREATER_EQUAL:
+			--top;
+			top[-1] = top[-1] >= top[0] ? 1.0 : 0.0;
+			break;
+		case OP_LESS:
+			--top;
+			top[-1] = top[-1] < top[0] ? 1.0 : 0.0;
+			break;
+		case OP_LESS_EQUAL:
+			--top;
+			top[-1] = top[-1] <= top[0] ? 1.0 : 0.0;
+			break;
+		case OP_AND:
+			--top;
+			top[-1] = static_cast<double>(static_cast<unsigned>(top[-1]) & static_cast<unsigned>(top[0]));
+			break;
+		case OP_OR:
+			--top;
+			top[-1] = static_cast<double>(static_cast<unsigned>(top[-1]) | static_cast<unsigned>(top[0]));
+			break;
+		case OP_XOR:
+			--top;
+			top[-1] = static_cast<double>(static_cast<unsigned>(top[-1]) ^ static_cast<unsigned>(top[0]));
+			break;
+		case OP_JUMP_IF_FALSE:
+			--top;
+			if (*top == 0.0) {
+				result.condition = false;
+				pc = instruction.argument;
+			}
+			break;
+		case OP_BRANCH:
+			--top;
+			result.control = OP_BRANCH;
+			result.number = BranchNumber(*top);
+			break;
+		case OP_LOOP:
+			--top;
+			result.control = OP_LOOP;
+			result.number = static_cast<unsigned short>(*top);
+			break;
+		case OP_LOOP_END:
+			--top;
+			result.control = OP_LOOP_END;
+			result.number = static_cast<unsigned short>(*top);
+			break;
+		case OP_RETURN:
+			result.value = top != base ? top[-1] : 0.0;
+			return result;
+		case OP_LOAD_VARIABLE:
+			*top++ = ReadVariable(static_cast<unsigned short>(instruction.argument), instruction);
+			break;
+		case OP_STORE_VARIABLE: {
+			unsigned short variable_ID(static_cast<unsigned short>(instruction.argument));
+			WriteVariable(variable_ID, top[-1], instruction);
+			top[-1] = ReadVariable(variable_ID, instruction);
+			break;
+		}
+		case OP_STORE_TEMPORARY:
+			temporaries[instruction.argument] = top[-1];
+			break;
+		case OP_LOAD_TEMPORARY:
+			*top++ = temporaries[instruction.argument];
+			break;
+		case OP_AND_SHORT_CIRCUIT:
+			//左運算元為0:結果為0
+			if (static_cast<unsigned>(top[-1]) == 0) {
+				top[-1] = 0.0;
+				pc = instruction.argument;
+			}
+			break;
+		case OP_OR_SHORT_CIRCUIT:
+			//布林左運算元成立:結果為1
+			if (top[-1] != 0.0) {
+				pc = instruction.argument; }
+			break;
+		}
+	}
+}
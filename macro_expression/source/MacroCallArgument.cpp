@@ -0,0 +1,49 @@
+﻿#include "MacroCallArgument.h"
+
+using namespace std;
+
+bool MacroCallBinder::Bind(const vector<MacroAddressWord>& words, MacroCallArguments& arguments)
+{
+	arguments.Clear();
+	//引數指定II目前的I,J,K組別
+	unsigned char set(0);
+	//目前組別最後指定的I,J,K位置(尚未指定為-1)
+	int last_position(-1);
+	for (const MacroAddressWord& word : words) {
+		switch (word.address) {
+			//G碼及序號不是引數
+		case 'G':
+		case ADDRESS_SEQUENCE_NUMBER:
+			break;
+		case ADDRESS_CALL_PROGRAM:
+			arguments.program_number = static_cast<int>(word.value->Evaluate());
+			break;
+		case ADDRESS_CALL_REPEAT:
+			arguments.repeat = static_cast<unsigned>(word.value->Evaluate());
+			break;
+		case 'I':
+		case 'J':
+		case 'K': {
+			//同組內重複或順序倒退時進入下一組
+			int position(word.address - 'I');
+			if (position <= last_position) {
+				++set; }
+			last_position = position;
+			unsigned char variable_ID(ArgumentSpecificationII(word.address, set));
+			if (variable_ID == NOT_AN_ARGUMENT) {
+				return false; }
+			arguments.values[variable_ID] = word.value->Evaluate();
+			break;
+		}
+		default: {
+			//引數指定I及II混用時以後指定者為準
+			unsigned char variable_ID(ArgumentSpecificationI(word.address));
+			if (variable_ID == NOT_AN_ARGUMENT) {
+				return false; }
+			arguments.values[variable_ID] = word.value->Evaluate();
+			break;
+		}
+		}
+	}
+	return arguments.program_number != NO_SEQUENCE_NUMBER;
+}
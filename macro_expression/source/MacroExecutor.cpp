@@ -0,0 +1,141 @@
+﻿#include "MacroExecutor.h"
+
+using namespace std;
+
+MacroExecutor::MacroExecutor(MacroVariableInterface& variable_interface, SystemParameter& parameter)
+	:program(nullptr),
+	program_counter(0),
+	loop_depth(0),
+	iteration_limit(LOOP_ITERATION_LIMIT),
+	checkpoint_interval(RETAINED_CHECKPOINT_INTERVAL),
+	pending_blocks(0),
+	sequence_search(parameter),
+	evaluator(variable_interface),
+	macro_variable_interface(variable_interface),
+	system_parameter(parameter)
+{
+}
+
+void MacroExecutor::Load(const MacroProgram& macro_program)
+{
+	program = &macro_program;
+	sequence_search.Load(macro_program);
+	Reset();
+}
+
+void MacroExecutor::Reset()
+{
+	program_counter = 0;
+	loop_depth = 0;
+	pending_blocks = 0;
+}
+
+size_t MacroExecutor::Step()
+{
+	//程式結束或警報停止時保存#500-#999的寫入(警報前完成的寫入亦保存)
+	if (Finished() || macro_variable_interface.HasAlarm()) {
+		macro_variable_interface.CommitRetained();
+		pending_blocks = 0;
+		return NO_PROGRAM_BLOCK;
+	}
+	const vector<MacroProgramBlock>& blocks(program->Blocks());
+	size_t index(program_counter++);
+	const MacroProgramBlock& block(blocks[index]);
+	//選擇性單節跳躍
+	if (block.block_delete && system_parameter.operation_parameter.optional_skip) {
+		return index; }
+	//NC單節及不合法單節
+	if (block.bytecode.Empty()) {
+		return index; }
+
+	MacroBytecodeResult result(evaluator.Run(block.bytecode, block.jit));
+	//寫入#500-#999後每經過checkpoint_interval個單節建立檢查點
+	if (macro_variable_interface.RetainedPending() && checkpoint_interval != 0 && ++pending_blocks >= checkpoint_interval) {
+		macro_variable_interface.CommitRetained();
+		pending_blocks = 0;
+	}
+	if (macro_variable_interface.HasAlarm()) {
+		return index; }
+	switch (result.control) {
+	case OP_LOOP:
+		ExecuteLoop(index, result);
+		break;
+	case OP_LOOP_END:
+		ExecuteLoopEnd(index);
+		break;
+	case OP_BRANCH:
+		ExecuteBranch(index, result);
+		break;
+	default:
+		break;
+	}
+	return index;
+}
+
+bool MacroExecutor::Run()
+{
+	while (Step() != NO_PROGRAM_BLOCK) {}
+	return !macro_variable_interface.HasAlarm();
+}
+
+void MacroExecutor::ExecuteLoop(size_t index, const MacroBytecodeResult& result)
+{
+	const MacroProgramBlock& block(program->Blocks()[index]);
+	//由END跳回時最內層迴圈即為此DO
+	bool iterating(loop_depth != 0 && loops[loop_depth - 1].do_block == index);
+	if (!result.condition) {
+		if (iterating) {
+			--loop_depth; }
+		program_counter = block.loop_pair + 1;
+		return;
+	}
+	if (iterating) {
+		return; }
+	if (loop_depth == loops.size()) {
+		macro_variable_interface.RaiseAlarm(ALARM_LOOP_NESTING, &block);
+		return;
+	}
+	MacroLoopFrame& frame(loops[loop_depth++]);
+	frame.loop_number = static_cast<unsigned short>(result.number);
+	frame.do_block = index;
+	frame.end_block = block.loop_pair;
+	frame.iterations = 0;
+}
+
+void MacroExecutor::ExecuteLoopEnd(size_t index)
+{
+	const MacroProgramBlock& block(program->Blocks()[index]);
+	//未經DO進入迴圈(跳入迴圈內部)
+	if (loop_depth == 0 || loops[loop_depth - 1].end_block != index) {
+		macro_variable_interface.RaiseAlarm(ALARM_LOOP_NESTING, &block);
+		return;
+	}
+	MacroLoopFrame& frame(loops[loop_depth - 1]);
+	if (iteration_limit != 0 && frame.iterations == iteration_limit) {
+		macro_variable_interface.RaiseAlarm(ALARM_LOOP_WATCHDOG, &block);
+		return;
+	}
+	++frame.iterations;
+	program_counter = frame.do_block;
+}
+
+void MacroExecutor::ExecuteBranch(size_t index, const MacroBytecodeResult& result)
+{
+	if (!result.condition) {
+		return; }
+	const MacroProgramBlock& block(program->Blocks()[index]);
+	//非1~99999的整數序號不搜尋(負值可能與無序號的單節相同)
+	if (result.number < 1 || result.number > BRANCH_NUMBER_MAX) {
+		macro_variable_interface.RaiseAlarm(ALARM_SEQUENCE_NOT_EXIST, &block);
+		return;
+	}
+	size_t target(sequence_search.Find(index, result.number));
+	if (target == NO_PROGRAM_BLOCK) {
+		macro_variable_interface.RaiseAlarm(ALARM_SEQUENCE_NOT_EXIST, &block);
+		return;
+	}
+	//跳出迴圈:移除不包含目標單節的迴圈(跳至DO單節視為重新進入)
+	while (loop_depth != 0 && !(loops[loop_depth - 1].do_block < target && target <= loops[loop_depth - 1].end_block)) {
+		--loop_depth; }
+	program_counter = target;
+}
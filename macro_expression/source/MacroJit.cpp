@@ -0,0 +1,739 @@
+﻿#include "MacroJit.h"
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <cstddef>
+#include <utility>
+#if defined(MACRO_JIT_X64) && defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#elif defined(MACRO_JIT_X64)
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+//原生程式碼的核算狀態(常駐於r13)
+class MacroJitState {
+public:
+	MacroJitState(MacroVariableInterface& i, const MacroVariableSlot* s, const MacroInstruction* c)
+		:macro_variable_interface(&i), slots(s), instructions(c) {}
+	~MacroJitState() {}
+	//指令預先解析的變數存取位置
+	const MacroVariableSlot& Slot(const MacroInstruction* instruction) const {
+		return slots[instruction - instructions]; }
+
+	//執行結果(原生程式碼直接寫入運算式值)
+	MacroBytecodeResult result;
+	//巨集變數存取介面
+	MacroVariableInterface* macro_variable_interface;
+	//各指令的變數存取位置(與指令複本平行)
+	const MacroVariableSlot* slots;
+	//指令複本
+	const MacroInstruction* instructions;
+};
+
+//輔助函式(核算狀態,堆疊頂端的下一個位置,指令),返回非0時跳躍
+using MacroJitHelper = int (*)(MacroJitState*, double*, const MacroInstruction*);
+
+//讀取變數值(變數不存在時發出警報)
+static double ReadVariable(MacroJitState* state, unsigned short variable_ID, const MacroInstruction* instruction)
+{
+	double value(0.0);
+	if (state->macro_variable_interface->ReadVariable(variable_ID, value)) {
+		return value; }
+	else {
+		state->macro_variable_interface->RaiseAlarm(ALARM_VARIABLE_NOT_EXIST, instruction, variable_ID);
+		return NULL_VARIABLE;
+	}
+}
+
+//以預先解析的存取位置讀取常數ID變數值(變數不存在時發出警報)
+static double ReadSlot(MacroJitState* state, const MacroInstruction* instruction)
+{
+	const MacroVariableSlot& slot(state->Slot(instruction));
+	double value(0.0);
+	if (state->macro_variable_interface->ReadVariable(slot, value)) {
+		return value; }
+	else {
+		state->macro_variable_interface->RaiseAlarm(ALARM_VARIABLE_NOT_EXIST, instruction, slot.variable_ID);
+		return NULL_VARIABLE;
+	}
+}
+
+//寫入變數值(寫入#0時發出警報)
+static void WriteVariable(MacroJitState* state, unsigned short variable_ID, double value, const MacroInstruction* instruction)
+{
+	if (variable_ID == 0) {
+		state->macro_variable_interface->RaiseAlarm(ALARM_READ_ONLY_VARIABLE, instruction); }
+	else {
+		state->macro_variable_interface->WriteVariable(variable_ID, value); }
+}
+
+//不以內嵌指令產生的運算碼改呼叫輔助函式(核算方式與位元組碼虛擬機相同)
+static MacroJitHelper Helper(MacroOpcode opcode)
+{
+	switch (opcode) {
+	case OP_VARIABLE:
+		return [](MacroJitState* state, double* top, const MacroInstruction* instruction) {
+			top[-1] = ReadVariable(state, VariableID(top[-1]), instruction);
+			return 0; };
+	case OP_LOAD_VARIABLE:
+		return [](MacroJitState* state, double* top, const MacroInstruction* instruction) {
+			top[0] = ReadSlot(state, instruction);
+			return 0; };
+	case OP_ASSIGNMENT:
+		return [](MacroJitState* state, double* top, const MacroInstruction* instruction) {
+			unsigned short variable_ID(VariableID(top[-1]));
+			WriteVariable(state, variable_ID, top[-2], instruction);
+			top[-2] = ReadVariable(state, variable_ID, instruction);
+			return 0; };
+	case OP_STORE_VARIABLE:
+		return [](MacroJitState* state, double* top, const MacroInstruction* instruction) {
+			const MacroVariableSlot& slot(state->Slot(instruction));
+			if (slot.variable_ID == 0) {
+				state->macro_variable_interface->RaiseAlarm(ALARM_READ_ONLY_VARIABLE, instruction); }
+			else {
+				state->macro_variable_interface->WriteVariable(slot, top[-1]); }
+			top[-1] = ReadSlot(state, instruction);
+			return 0; };
+	case OP_SINE:
+		return [](MacroJitState*, double* top, const MacroInstruction*) {
+			top[-1] = DegreeTrigonometry::Sine(top[-1]);
+			return 0; };
+	case OP_COSINE:
+		return [](MacroJitState*, double* top, const MacroInstruction*) {
+			top[-1] = DegreeTrigonometry::Cosine(top[-1]);
+			return 0; };
+	case OP_TANGENT:
+		return [](MacroJitState*, double* top, const MacroInstruction*) {
+			top[-1] = DegreeTrigonometry::Tangent(top[-1]);
+			return 0; };
+	case OP_ARC_SINE:
+		return [](MacroJitState*, double* top, const MacroInstruction*) {
+			top[-1] = DegreeTrigonometry::ArcSine(top[-1]);
+			return 0; };
+	case OP_ARC_COSINE:
+		return [](MacroJitState*, double* top, const MacroInstruction*) {
+			top[-1] = DegreeTrigonometry::ArcCosine(top[-1]);
+			return 0; };
+	case OP_ARC_TANGENT:
+		return [](MacroJitState*, double* top, const MacroInstruction*) {
+			top[-1] = DegreeTrigonometry::ArcTangent(top[-1]);
+			return 0; };
+	case OP_ARC_TANGENT2:
+		return [](MacroJitState*, double* top, const MacroInstruction*) {
+			top[-2] = DegreeTrigonometry::ArcTangent2(top[-2], top[-1]);
+			return 0; };
+	case OP_BINARY_CODE:
+		return [](MacroJitState*, double* top, const MacroInstruction*) {
+			top[-1] = BinaryCodeOperator::Convert(top[-1]);
+			return 0; };
+	case OP_BINARY_CODED_DECIMAL:
+		return [](MacroJitState*, double* top, const MacroInstruction*) {
+			top[-1] = BinaryCodedDecimalOperator::Convert(top[-1]);
+			return 0; };
+	case OP_ROUND_OFF:
+		return [](MacroJitState*, double* top, const MacroInstruction*) {
+			top[-1] = round(top[-1]);
+			return 0; };
+	case OP_ROUND_DOWN:
+		return [](MacroJitState*, double* top, const MacroInstruction*) {
+			top[-1] = top[-1] < 0.0 ? ceil(top[-1]) : floor(top[-1]);
+			return 0; };
+	case OP_ROUND_UP:
+		return [](MacroJitState*, double* top, const MacroInstruction*) {
+			top[-1] = top[-1] < 0.0 ? floor(top[-1]) : ceil(top[-1]);
+			return 0; };
+	case OP_NATURAL_LOG:
+		return [](MacroJitState*, double* top, const MacroInstruction*) {
+			top[-1] = log(top[-1]);
+			return 0; };
+	case OP_EXPONENT:
+		return [](MacroJitState*, double* top, const MacroInstruction*) {
+			top[-1] = exp(top[-1]);
+			return 0; };
+	case OP_POWER:
+		return [](MacroJitState*, double* top, const MacroInstruction*) {
+			top[-2] = pow(top[-2], top[-1]);
+			return 0; };
+	case OP_AND:
+		return [](MacroJitState*, double* top, const MacroInstruction*) {
+			top[-2] = static_cast<double>(static_cast<unsigned>(top[-2]) & static_cast<unsigned>(top[-1]));
+			return 0; };
+	case OP_OR:
+		return [](MacroJitState*, double* top, const MacroInstruction*) {
+			top[-2] = static_cast<double>(static_cast<unsigned>(top[-2]) | static_cast<unsigned>(top[-1]));
+			return 0; };
+	case OP_XOR:
+		return [](MacroJitState*, double* top, const MacroInstruction*) {
+			top[-2] = static_cast<double>(static_cast<unsigned>(top[-2]) ^ static_cast<unsigned>(top[-1]));
+			return 0; };
+	case OP_AND_SHORT_CIRCUIT:
+		return [](MacroJitState*, double* top, const MacroInstruction*) {
+			if (static_cast<unsigned>(top[-1]) != 0) {
+				return 0; }
+			top[-1] = 0.0;
+			return 1; };
+	case OP_OR_SHORT_CIRCUIT:
+		return [](MacroJitState*, double* top, const MacroInstruction*) {
+			return top[-1] != 0.0 ? 1 : 0; };
+	case OP_JUMP_IF_FALSE:
+		return [](MacroJitState* state, double* top, const MacroInstruction*) {
+			if (top[-1] != 0.0) {
+				return 0; }
+			state->result.condition = false;
+			return 1; };
+	case OP_BRANCH:
+		return [](MacroJitState* state, double* top, const MacroInstruction*) {
+			state->result.control = OP_BRANCH;
+			state->result.number = BranchNumber(top[-1]);
+			return 0; };
+	case OP_LOOP:
+		return [](MacroJitState* state, double* top, const MacroInstruction*) {
+			state->result.control = OP_LOOP;
+			state->result.number = static_cast<unsigned short>(top[-1]);
+			return 0; };
+	case OP_LOOP_END:
+		return [](MacroJitState* state, double* top, const MacroInstruction*) {
+			state->result.control = OP_LOOP_END;
+			state->result.number = static_cast<unsigned short>(top[-1]);
+			return 0; };
+	default:
+		return nullptr;
+	}
+}
+
+#ifdef MACRO_JIT_X64
+//x86-64通用暫存器編號
+enum MacroX64Register :unsigned char {
+	X64_RAX, X64_RCX, X64_RDX, X64_RBX, X64_RSP, X64_RBP, X64_RSI, X64_RDI,
+	X64_R8, X64_R9, X64_R10, X64_R11, X64_R12, X64_R13, X64_R14, X64_R15 };
+
+//呼叫慣例的前四個整數引數暫存器
+#ifdef _WIN32
+constexpr MacroX64Register X64_ARGUMENTS[4] = { X64_RCX, X64_RDX, X64_R8, X64_R9 };
+#else
+constexpr MacroX64Register X64_ARGUMENTS[4] = { X64_RDI, X64_RSI, X64_RDX, X64_RCX };
+#endif
+//常駐暫存器:數值堆疊,核算狀態,常數表,共同子運算式暫存區(皆為callee-saved)
+constexpr MacroX64Register X64_STACK = X64_RBX;
+constexpr MacroX64Register X64_STATE = X64_R13;
+constexpr MacroX64Register X64_CONSTANTS = X64_R14;
+constexpr MacroX64Register X64_TEMPORARIES = X64_R15;
+
+//SSE2純量運算碼(F2 0F xx)
+constexpr unsigned char SSE_LOAD = 0x10;
+constexpr unsigned char SSE_STORE = 0x11;
+constexpr unsigned char SSE_SQUARE_ROOT = 0x51;
+constexpr unsigned char SSE_ADD = 0x58;
+constexpr unsigned char SSE_MULTIPLY = 0x59;
+constexpr unsigned char SSE_SUBTRACT = 0x5C;
+constexpr unsigned char SSE_DIVIDE = 0x5E;
+constexpr unsigned char SSE_COMPARE = 0xC2;
+//CMPSD比較條件
+constexpr unsigned char COMPARE_EQUAL = 0;
+constexpr unsigned char COMPARE_LESS = 1;
+constexpr unsigned char COMPARE_LESS_EQUAL = 2;
+constexpr unsigned char COMPARE_NOT_EQUAL = 4;
+
+//x86-64機械碼產生器(僅含核算所需的指令)
+class MacroX64Emitter {
+public:
+	MacroX64Emitter() {}
+	~MacroX64Emitter() {}
+
+	//機械碼
+	vector<unsigned char> bytes;
+
+	void Byte(unsigned char value) {
+		bytes.push_back(value); }
+	void Int32(int32_t value) {
+		for (int shift = 0; shift != 32; shift += 8) {
+			Byte(static_cast<unsigned char>(static_cast<uint32_t>(value) >> shift)); }
+	}
+	void Int64(uint64_t value) {
+		for (int shift = 0; shift != 64; shift += 8) {
+			Byte(static_cast<unsigned char>(value >> shift)); }
+	}
+	//push r64
+	void Push(MacroX64Register reg) {
+		if (reg >= X64_R8) {
+			Byte(0x41); }
+		Byte(static_cast<unsigned char>(0x50 + (reg & 7)));
+	}
+	//pop r64
+	void Pop(MacroX64Register reg) {
+		if (reg >= X64_R8) {
+			Byte(0x41); }
+		Byte(static_cast<unsigned char>(0x58 + (reg & 7)));
+	}
+	//mov r64, r64
+	void Move(MacroX64Register destination, MacroX64Register source) {
+		Byte(static_cast<unsigned char>(0x48 | (source >= X64_R8 ? 4 : 0) | (destination >= X64_R8 ? 1 : 0)));
+		Byte(0x89);
+		Byte(static_cast<unsigned char>(0xC0 | (source & 7) << 3 | (destination & 7)));
+	}
+	//mov r64, imm64
+	void MoveImmediate(MacroX64Register destination, uint64_t value) {
+		Byte(static_cast<unsigned char>(0x48 | (destination >= X64_R8 ? 1 : 0)));
+		Byte(static_cast<unsigned char>(0xB8 + (destination & 7)));
+		Int64(value);
+	}
+	//lea r64, [base+disp32]
+	void LoadAddress(MacroX64Register destination, MacroX64Register base, int32_t displacement) {
+		Byte(static_cast<unsigned char>(0x48 | (destination >= X64_R8 ? 4 : 0) | (base >= X64_R8 ? 1 : 0)));
+		Byte(0x8D);
+		Memory(destination, base, displacement);
+	}
+	//sub/add rsp, imm8
+	void AdjustStack(int8_t value) {
+		Byte(0x48);
+		Byte(0x83);
+		Byte(value > 0 ? 0xEC : 0xC4);
+		Byte(static_cast<unsigned char>(value > 0 ? value : -value));
+	}
+	//F2 [REX] 0F op xmm, [base+disp32]
+	void Scalar(unsigned char opcode, unsigned char xmm, MacroX64Register base, int32_t displacement) {
+		Byte(0xF2);
+		if (xmm >= 8 || base >= X64_R8) {
+			Byte(static_cast<unsigned char>(0x40 | (xmm >= 8 ? 4 : 0) | (base >= X64_R8 ? 1 : 0))); }
+		Byte(0x0F);
+		Byte(opcode);
+		Memory(xmm, base, displacement);
+	}
+	//movq xmm, r64
+	void MoveToXmm(unsigned char xmm, MacroX64Register source) {
+		Byte(0x66);
+		Byte(static_cast<unsigned char>(0x48 | (xmm >= 8 ? 4 : 0) | (source >= X64_R8 ? 1 : 0)));
+		Byte(0x0F);
+		Byte(0x6E);
+		Byte(static_cast<unsigned char>(0xC0 | (xmm & 7) << 3 | (source & 7)));
+	}
+	//66 0F op xmm0, xmm1(andpd 54, xorpd 57)
+	void Packed(unsigned char opcode) {
+		Byte(0x66);
+		Byte(0x0F);
+		Byte(opcode);
+		Byte(0xC1);
+	}
+	//call rax
+	void CallRax() {
+		Byte(0xFF);
+		Byte(0xD0);
+	}
+	//test eax, eax
+	void TestEax() {
+		Byte(0x85);
+		Byte(0xC0);
+	}
+	//jcc/jmp rel32,返回待填入的位移位置(condition為0F 8x的第二位元組,0表示jmp)
+	size_t Jump(unsigned char condition) {
+		if (condition) {
+			Byte(0x0F);
+			Byte(condition);
+		}
+		else {
+			Byte(0xE9); }
+		Int32(0);
+		return bytes.size() - 4;
+	}
+	//填入跳躍位移
+	void Patch(size_t position, size_t target) {
+		int32_t displacement(static_cast<int32_t>(static_cast<int64_t>(target) - static_cast<int64_t>(position + 4)));
+		memcpy(bytes.data() + position, &displacement, sizeof(displacement));
+	}
+	void Return() {
+		Byte(0xC3); }
+
+private:
+	//ModRM(mod=10,disp32);rsp及r12須SIB,常駐暫存器不使用
+	void Memory(unsigned char reg, MacroX64Register base, int32_t displacement) {
+		Byte(static_cast<unsigned char>(0x80 | (reg & 7) << 3 | (base & 7)));
+		Int32(displacement);
+	}
+};
+
+//jz及jnz的0F 8x位元組
+constexpr unsigned char JUMP_IF_ZERO = 0x84;
+constexpr unsigned char JUMP_IF_NOT_ZERO = 0x85;
+//jmp
+constexpr unsigned char JUMP_ALWAYS = 0x00;
+
+//數值堆疊第index個位置的位移
+static int32_t Slot(size_t index)
+{
+	return static_cast<int32_t>(index * sizeof(double));
+}
+
+//呼叫輔助函式(引數:核算狀態,堆疊頂端的下一個位置,指令)
+static void EmitHelper(MacroX64Emitter& emitter, MacroJitHelper helper, size_t depth, const MacroInstruction* instruction)
+{
+	emitter.Move(X64_ARGUMENTS[0], X64_STATE);
+	emitter.LoadAddress(X64_ARGUMENTS[1], X64_STACK, Slot(depth));
+	emitter.MoveImmediate(X64_ARGUMENTS[2], reinterpret_cast<uint64_t>(instruction));
+	emitter.MoveImmediate(X64_RAX, reinterpret_cast<uint64_t>(helper));
+	emitter.CallRax();
+}
+
+//以xmm1遮罩xmm0(andpd或xorpd)
+static void EmitMask(MacroX64Emitter& emitter, unsigned char opcode, uint64_t mask)
+{
+	emitter.MoveImmediate(X64_RAX, mask);
+	emitter.MoveToXmm(1, X64_RAX);
+	emitter.Packed(opcode);
+}
+
+//結束核算:設定運算式值(堆疊非空時)並跳至收尾程式碼
+static void EmitReturn(MacroX64Emitter& emitter, size_t depth, vector<size_t>& epilogue_jumps)
+{
+	if (depth) {
+		emitter.Scalar(SSE_LOAD, 0, X64_STACK, Slot(depth - 1));
+		emitter.Scalar(SSE_STORE, 0, X64_STATE, static_cast<int32_t>(offsetof(MacroJitState, result) + offsetof(MacroBytecodeResult, value)));
+	}
+	epilogue_jumps.push_back(emitter.Jump(JUMP_ALWAYS));
+}
+#endif
+
+MacroNativeCode::MacroNativeCode()
+	:stack_depth(0),
+	temporary_count(0),
+	memory(nullptr),
+	memory_size(0),
+	code_size(0),
+	entry(nullptr)
+{
+}
+
+MacroNativeCode::MacroNativeCode(MacroNativeCode&& other) noexcept
+	:instructions(std::move(other.instructions)),
+	slots(std::move(other.slots)),
+	constants(std::move(other.constants)),
+	stack_depth(other.stack_depth),
+	temporary_count(other.temporary_count),
+	memory(other.memory),
+	memory_size(other.memory_size),
+	code_size(other.code_size),
+	entry(other.entry)
+{
+	other.memory = nullptr;
+	other.entry = nullptr;
+	other.Clear();
+}
+
+MacroNativeCode& MacroNativeCode::operator=(MacroNativeCode&& other) noexcept
+{
+	if (this != &other) {
+		Clear();
+		swap(instructions, other.instructions);
+		swap(slots, other.slots);
+		swap(constants, other.constants);
+		swap(stack_depth, other.stack_depth);
+		swap(temporary_count, other.temporary_count);
+		swap(memory, other.memory);
+		swap(memory_size, other.memory_size);
+		swap(code_size, other.code_size);
+		swap(entry, other.entry);
+	}
+	return *this;
+}
+
+MacroNativeCode::~MacroNativeCode()
+{
+	Clear();
+}
+
+bool MacroNativeCode::Supported()
+{
+#ifdef MACRO_JIT_X64
+	return true;
+#else
+	return false;
+#endif
+}
+
+void MacroNativeCode::Clear()
+{
+#if defined(MACRO_JIT_X64) && defined(_WIN32)
+	if (memory) {
+		VirtualFree(memory, 0, MEM_RELEASE); }
+#elif defined(MACRO_JIT_X64)
+	if (memory) {
+		munmap(memory, memory_size); }
+#endif
+	memory = nullptr;
+	memory_size = 0;
+	code_size = 0;
+	entry = nullptr;
+	instructions.clear();
+	slots.clear();
+	constants.clear();
+	stack_depth = 0;
+	temporary_count = 0;
+}
+
+bool MacroNativeCode::Compile(const MacroBytecode& bytecode, MacroVariableInterface& macro_variable_interface)
+{
+	Clear();
+#ifdef MACRO_JIT_X64
+	if (bytecode.Empty()) {
+		return false; }
+	//指令位址嵌入機械碼:先保留複本再產生
+	instructions = bytecode.Code();
+	constants = bytecode.Constants();
+	//解析常數ID變數的存取位置
+	slots.resize(instructions.size());
+	for (size_t pc = 0; pc != instructions.size(); ++pc) {
+		if (instructions[pc].opcode == OP_LOAD_VARIABLE || instructions[pc].opcode == OP_STORE_VARIABLE) {
+			slots[pc] = macro_variable_interface.ResolveVariable(static_cast<unsigned short>(instructions[pc].argument)); }
+	}
+
+	MacroX64Emitter emitter;
+	//保存常駐暫存器,並保留呼叫輔助函式所需的對齊及影子空間
+	emitter.Push(X64_STACK);
+	emitter.Push(X64_STATE);
+	emitter.Push(X64_CONSTANTS);
+	emitter.Push(X64_TEMPORARIES);
+	emitter.AdjustStack(40);
+	emitter.Move(X64_STATE, X64_ARGUMENTS[0]);
+	emitter.Move(X64_STACK, X64_ARGUMENTS[1]);
+	emitter.Move(X64_TEMPORARIES, X64_ARGUMENTS[2]);
+	emitter.Move(X64_CONSTANTS, X64_ARGUMENTS[3]);
+
+	//各指令的機械碼位置及待填入的跳躍
+	vector<size_t> labels(instructions.size() + 1, 0);
+	vector<pair<size_t, size_t>> jumps;
+	vector<size_t> epilogue_jumps;
+	//堆疊深度於編譯時即可確定:每個堆疊位置對應固定位移
+	size_t depth(0);
+	for (size_t pc = 0; pc != instructions.size(); ++pc) {
+		labels[pc] = emitter.bytes.size();
+		const MacroInstruction& instruction(instructions[pc]);
+		const MacroInstruction* address(instructions.data() + pc);
+		switch (instruction.opcode) {
+		case OP_CONSTANT:
+			emitter.Scalar(SSE_LOAD, 0, X64_CONSTANTS, Slot(instruction.argument));
+			emitter.Scalar(SSE_STORE, 0, X64_STACK, Slot(depth));
+			break;
+		case OP_LOAD_TEMPORARY:
+			emitter.Scalar(SSE_LOAD, 0, X64_TEMPORARIES, Slot(instruction.argument));
+			emitter.Scalar(SSE_STORE, 0, X64_STACK, Slot(depth));
+			break;
+		case OP_STORE_TEMPORARY:
+			emitter.Scalar(SSE_LOAD, 0, X64_STACK, Slot(depth - 1));
+			emitter.Scalar(SSE_STORE, 0, X64_TEMPORARIES, Slot(instruction.argument));
+			break;
+		case OP_MINUS:
+		case OP_ABSOLUTE_VALUE:
+			//反轉或清除符號位元
+			emitter.Scalar(SSE_LOAD, 0, X64_STACK, Slot(depth - 1));
+			if (instruction.opcode == OP_MINUS) {
+				EmitMask(emitter, 0x57, 0x8000000000000000ull); }
+			else {
+				EmitMask(emitter, 0x54, 0x7FFFFFFFFFFFFFFFull); }
+			emitter.Scalar(SSE_STORE, 0, X64_STACK, Slot(depth - 1));
+			break;
+		case OP_SQUARE_ROOT:
+			emitter.Scalar(SSE_SQUARE_ROOT, 0, X64_STACK, Slot(depth - 1));
+			emitter.Scalar(SSE_STORE, 0, X64_STACK, Slot(depth - 1));
+			break;
+		case OP_ADD_DECIMAL_POINT:
+			emitter.Scalar(SSE_LOAD, 0, X64_STACK, Slot(depth - 1));
+			emitter.Scalar(SSE_DIVIDE, 0, X64_CONSTANTS, Slot(instruction.argument));
+			emitter.Scalar(SSE_STORE, 0, X64_STACK, Slot(depth - 1));
+			break;
+		case OP_ADD:
+		case OP_SUBTRACT:
+		case OP_MULTIPLY:
+		case OP_DIVIDE: {
+			unsigned char opcode(instruction.opcode == OP_ADD ? SSE_ADD : instruction.opcode == OP_SUBTRACT ? SSE_SUBTRACT :
+				instruction.opcode == OP_MULTIPLY ? SSE_MULTIPLY : SSE_DIVIDE);
+			emitter.Scalar(SSE_LOAD, 0, X64_STACK, Slot(depth - 2));
+			emitter.Scalar(opcode, 0, X64_STACK, Slot(depth - 1));
+			emitter.Scalar(SSE_STORE, 0, X64_STACK, Slot(depth - 2));
+			break;
+		}
+		case OP_EQUAL:
+		case OP_NOT_EQUAL:
+		case OP_GREATER:
+		case OP_GREATER_EQUAL:
+		case OP_LESS:
+		case OP_LESS_EQUAL: {
+			//大於及大於等於交換運算元後以小於及小於等於比較(NaN皆不成立)
+			bool swapped(instruction.opcode == OP_GREATER || instruction.opcode == OP_GREATER_EQUAL);
+			unsigned char predicate(instruction.opcode == OP_EQUAL ? COMPARE_EQUAL : instruction.opcode == OP_NOT_EQUAL ? COMPARE_NOT_EQUAL :
+				instruction.opcode == OP_GREATER || instruction.opcode == OP_LESS ? COMPARE_LESS : COMPARE_LESS_EQUAL);
+			emitter.Scalar(SSE_LOAD, 0, X64_STACK, Slot(swapped ? depth - 1 : depth - 2));
+			emitter.Scalar(SSE_COMPARE, 0, X64_STACK, Slot(swapped ? depth - 2 : depth - 1));
+			emitter.Byte(predicate);
+			//比較遮罩與1.0取交集即為1.0或0.0
+			EmitMask(emitter, 0x54, 0x3FF0000000000000ull);
+			emitter.Scalar(SSE_STORE, 0, X64_STACK, Slot(depth - 2));
+			break;
+		}
+		case OP_AND_SHORT_CIRCUIT:
+		case OP_OR_SHORT_CIRCUIT:
+			EmitHelper(emitter, Helper(instruction.opcode), depth, address);
+			emitter.TestEax();
+			jumps.emplace_back(emitter.Jump(JUMP_IF_NOT_ZERO), instruction.argument);
+			break;
+		case OP_JUMP_IF_FALSE: {
+			//條件不成立時以取出條件值後的堆疊深度結束核算
+			EmitHelper(emitter, Helper(OP_JUMP_IF_FALSE), depth, address);
+			emitter.TestEax();
+			size_t skip(emitter.Jump(JUMP_IF_ZERO));
+			EmitReturn(emitter, depth - 1, epilogue_jumps);
+			emitter.Patch(skip, emitter.bytes.size());
+			break;
+		}
+		case OP_LOAD_VARIABLE: {
+			//共同變數及浮點數系統變數直接讀取存放位址,其餘經由存取介面
+			const MacroVariableSlot& slot(slots[pc]);
+			if (slot.type == SLOT_COMMON || slot.type == SLOT_SYSTEM_DOUBLE || slot.type == SLOT_SYSTEM_READ_ONLY) {
+				emitter.MoveImmediate(X64_RAX, reinterpret_cast<uint64_t>(slot.value));
+				emitter.Scalar(SSE_LOAD, 0, X64_RAX, 0);
+				emitter.Scalar(SSE_STORE, 0, X64_STACK, Slot(depth));
+			}
+			else {
+				EmitHelper(emitter, Helper(OP_LOAD_VARIABLE), depth, address); }
+			break;
+		}
+		case OP_RETURN:
+			EmitReturn(emitter, depth, epilogue_jumps);
+			break;
+		default: {
+			MacroJitHelper helper(Helper(instruction.opcode));
+			if (!helper) {
+				Clear();
+				return false;
+			}
+			EmitHelper(emitter, helper, depth, address);
+			break;
+		}
+		}
+		depth += MacroBytecode::StackEffect(instruction.opcode);
+	}
+	labels[instructions.size()] = emitter.bytes.size();
+
+	//收尾程式碼
+	for (size_t jump : epilogue_jumps) {
+		emitter.Patch(jump, emitter.bytes.size()); }
+	for (const pair<size_t, size_t>& jump : jumps) {
+		emitter.Patch(jump.first, labels[jump.second]); }
+	emitter.AdjustStack(-40);
+	emitter.Pop(X64_TEMPORARIES);
+	emitter.Pop(X64_CONSTANTS);
+	emitter.Pop(X64_STATE);
+	emitter.Pop(X64_STACK);
+	emitter.Return();
+
+	//寫入後改為唯讀可執行(不同時可寫及可執行)
+	code_size = emitter.bytes.size();
+#ifdef _WIN32
+	SYSTEM_INFO system_info;
+	GetSystemInfo(&system_info);
+	size_t page_size(system_info.dwPageSize);
+#else
+	size_t page_size(static_cast<size_t>(sysconf(_SC_PAGESIZE)));
+#endif
+	memory_size = (code_size + page_size - 1) / page_size * page_size;
+#ifdef _WIN32
+	memory = VirtualAlloc(nullptr, memory_size, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+	if (!memory) {
+		Clear();
+		return false;
+	}
+	memcpy(memory, emitter.bytes.data(), code_size);
+	DWORD protection(0);
+	if (!VirtualProtect(memory, memory_size, PAGE_EXECUTE_READ, &protection)) {
+		Clear();
+		return false;
+	}
+	FlushInstructionCache(GetCurrentProcess(), memory, memory_size);
+#else
+	memory = mmap(nullptr, memory_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (memory == MAP_FAILED) {
+		memory = nullptr;
+		Clear();
+		return false;
+	}
+	memcpy(memory, emitter.bytes.data(), code_size);
+	if (mprotect(memory, memory_size, PROT_READ | PROT_EXEC) != 0) {
+		Clear();
+		return false;
+	}
+#endif
+	entry = reinterpret_cast<MacroNativeEntry>(memory);
+	stack_depth = bytecode.StackDepth();
+	temporary_count = bytecode.TemporaryCount();
+	return true;
+#else
+	return false;
+#endif
+}
+
+MacroBytecodeResult MacroNativeCode::Run(MacroVariableInterface& macro_variable_interface, double* stack, double* temporaries) const
+{
+	if (!entry) {
+		MacroBytecodeResult result;
+		result.condition = false;
+		return result;
+	}
+	MacroJitState state(macro_variable_interface, slots.data(), instructions.data());
+	entry(&state, stack, temporaries, constants.data());
+	return state.result;
+}
+
+void MacroJitBlock::Reset()
+{
+	executions = 0;
+	failed = false;
+	owner = nullptr;
+	native_code.Clear();
+}
+
+MacroJitEvaluator::MacroJitEvaluator(MacroVariableInterface& variable_interface, unsigned t)
+	:threshold(t),
+	machine(variable_interface),
+	macro_variable_interface(variable_interface)
+{
+}
+
+MacroBytecodeResult MacroJitEvaluator::Run(const MacroBytecode& bytecode, MacroJitBlock& block)
+{
+	++block.executions;
+	if (block.native_code.Empty() && !block.failed && block.executions >= threshold) {
+		block.failed = !block.native_code.Compile(bytecode, macro_variable_interface);
+		block.owner = &macro_variable_interface;
+	}
+	//原生程式碼內嵌編譯時解析的變數存取位置
+	if (block.native_code.Empty() || block.owner != &macro_variable_interface) {
+		return machine.Run(bytecode); }
+	//例外無法穿越原生程式碼:停用警報模式時先以警報模式執行(已有警報時停止寫入,由虛擬機執行)
+	bool alarm_mode(macro_variable_interface.AlarmMode());
+	if (!alarm_mode) {
+		if (macro_variable_interface.HasAlarm()) {
+			return machine.Run(bytecode); }
+		macro_variable_interface.SetAlarmMode(true);
+	}
+
+	//擴充數值堆疊(僅在原生程式碼所需深度超過目前容量時配置)
+	const MacroNativeCode& native_code(block.native_code);
+	if (stack.size() < native_code.StackDepth()) {
+		stack.resize(native_code.StackDepth()); }
+	if (temporaries.size() < native_code.TemporaryCount()) {
+		temporaries.resize(native_code.TemporaryCount()); }
+	MacroBytecodeResult result(native_code.Run(macro_variable_interface, stack.data(), temporaries.data()));
+	//警報於停止核算後轉為例外(警報前的寫入與虛擬機拋出例外時相同)
+	if (!alarm_mode) {
+		macro_variable_interface.SetAlarmMode(false);
+		if (macro_variable_interface.HasAlarm()) {
+			MacroAlarm alarm(macro_variable_interface.Alarm());
+			macro_variable_interface.ClearAlarm();
+			macro_variable_interface.RaiseAlarm(alarm.code, alarm.node, alarm.variable_ID);
+		}
+	}
+	return result;
+}
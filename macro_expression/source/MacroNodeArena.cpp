@@ -0,0 +1,355 @@
+﻿#include "MacroNodeArena.h"
+#include <cmath>
+
+using namespace std;
+
+void MacroNodeArena::Clear()
+{
+	nodes.clear();
+	constants.clear();
+}
+
+MacroNodeIndex MacroNodeArena::Append(MacroOpcode opcode, MacroNodeIndex left, MacroNodeIndex right)
+{
+	nodes.emplace_back(opcode, left, right);
+	return static_cast<MacroNodeIndex>(nodes.size() - 1);
+}
+
+MacroNodeIndex MacroNodeArena::AppendConstant(double value)
+{
+	constants.push_back(value);
+	return static_cast<MacroNodeIndex>(constants.size() - 1);
+}
+
+MacroNodeIndex MacroNodeArena::AppendArithmetic(const ArithmeticOperator* arithmetic)
+{
+	if (!arithmetic) {
+		return NO_MACRO_NODE; }
+
+	MacroOperatorID id(arithmetic->GetOperatorID());
+	switch (id) {
+		//常數運算子
+	case CONSTANT:
+		return Append(OP_CONSTANT, AppendConstant(static_cast<const UnaryOperator*>(arithmetic)->Operand()));
+
+		//變數運算子:常數變數ID直接存於節點
+	case VARIABLE: {
+		const ArithmeticOperator* variable_ID(static_cast<const UnaryOperator*>(arithmetic)->OperandHandle().get());
+		if (variable_ID && variable_ID->GetOperatorID() == CONSTANT) {
+			return Append(OP_LOAD_VARIABLE, VariableID(static_cast<const UnaryOperator*>(variable_ID)->Operand())); }
+		MacroNodeIndex operand(AppendArithmetic(variable_ID));
+		return operand == NO_MACRO_NODE ? NO_MACRO_NODE : Append(OP_VARIABLE, operand);
+	}
+
+		//賦值運算子:左節點為變數ID,右節點為寫入值
+	case ASSIGNMENT: {
+		const AssignmentOperator* assignment(static_cast<const AssignmentOperator*>(arithmetic));
+		if (!assignment->LeftVariable()) {
+			return NO_MACRO_NODE; }
+		MacroNodeIndex right(assignment->RightLogical() ? AppendLogical(assignment->RightLogical().get()) : AppendArithmetic(assignment->RightOperand().get()));
+		MacroNodeIndex left(AppendArithmetic(assignment->LeftVariable()->OperandHandle().get()));
+		return left == NO_MACRO_NODE || right == NO_MACRO_NODE ? NO_MACRO_NODE : Append(OP_ASSIGNMENT, left, right);
+	}
+
+		//轉換浮點數運算子:最小設定單位存入常數表
+	case ADD_DECIMAL_POINT: {
+		const AddDecimalPointOperator* add_decimal_point(static_cast<const AddDecimalPointOperator*>(arithmetic));
+		MacroNodeIndex operand(AppendArithmetic(add_decimal_point->OperandHandle().get()));
+		return operand == NO_MACRO_NODE ? NO_MACRO_NODE : Append(OP_ADD_DECIMAL_POINT, operand, AppendConstant(add_decimal_point->LeastIncrement()));
+	}
+
+		//共同子運算式運算子:共用同一節點
+	case COMMON_SUBEXPRESSION: {
+		const CommonSubexpressionOperator* common(static_cast<const CommonSubexpressionOperator*>(arithmetic));
+		const ArithmeticOperator* operand(common->OperandHandle().get());
+		if (common->Scope()) {
+			return AppendArithmetic(operand); }
+		for (const pair<const ArithmeticOperator*, MacroNodeIndex>& shared : shared_nodes) {
+			if (shared.first == arithmetic) {
+				return shared.second; }
+		}
+		MacroNodeIndex index(AppendArithmetic(operand));
+		if (index != NO_MACRO_NODE) {
+			shared_nodes.emplace_back(arithmetic, index); }
+		return index;
+	}
+
+		//二元運算子
+	case ADD:
+	case SUBSTRACT:
+	case MULTIPLY:
+	case DIVIDE:
+	case ARC_TANGENT2:
+	case POWER: {
+		const BinaryOperator* binary(static_cast<const BinaryOperator*>(arithmetic));
+		MacroNodeIndex left(AppendArithmetic(binary->LeftOperand().get()));
+		MacroNodeIndex right(AppendArithmetic(binary->RightOperand().get()));
+		return left == NO_MACRO_NODE || right == NO_MACRO_NODE ? NO_MACRO_NODE : Append(static_cast<MacroOpcode>(id), left, right);
+	}
+
+		//一元運算子
+	default: {
+		MacroNodeIndex operand(AppendArithmetic(static_cast<const UnaryOperator*>(arithmetic)->OperandHandle().get()));
+		return operand == NO_MACRO_NODE ? NO_MACRO_NODE : Append(static_cast<MacroOpcode>(id), operand);
+	}
+	}
+}
+
+MacroNodeIndex MacroNodeArena::AppendRelational(const RelationalOperator* relational)
+{
+	if (!relational) {
+		return NO_MACRO_NODE; }
+	MacroNodeIndex left(AppendArithmetic(relational->LeftOperand().get()));
+	MacroNodeIndex right(AppendArithmetic(relational->RightOperand().get()));
+	if (left == NO_MACRO_NODE || right == NO_MACRO_NODE) {
+		return NO_MACRO_NODE; }
+	return Append(static_cast<MacroOpcode>(OP_EQUAL + static_cast<int>(relational->GetOperatorID())), left, right);
+}
+
+MacroNodeIndex MacroNodeArena::AppendLogical(const LogicalOperator* logical)
+{
+	if (!logical) {
+		return NO_MACRO_NODE; }
+
+	MacroNodeIndex left(AppendCondition(logical->LeftOperand()));
+	MacroNodeIndex right(AppendCondition(logical->RightOperand()));
+	if (left == NO_MACRO_NODE || right == NO_MACRO_NODE) {
+		return NO_MACRO_NODE; }
+	//左右運算元皆為布林值的OR:左運算元成立時不核算右運算元
+	if (logical->GetOperatorID() == OR && logical->Boolean()) {
+		return Append(OP_OR_SHORT_CIRCUIT, left, right); }
+	return Append(static_cast<MacroOpcode>(OP_AND + static_cast<int>(logical->GetOperatorID())), left, right);
+}
+
+MacroNodeIndex MacroNodeArena::AppendCondition(const ConditionOperand& condition)
+{
+	switch (condition.Type()) {
+	case ARITHMETIC_CONDITION_OPERAND:
+		return AppendArithmetic(condition.Arithmetic());
+	case RELATIONAL_CONDITION_OPERAND:
+		return AppendRelational(condition.Relational());
+	case LOGICAL_CONDITION_OPERAND:
+		return AppendLogical(condition.Logical());
+	default:
+		return NO_MACRO_NODE;
+	}
+}
+
+bool MacroNodeArena::Compile(const CompiledMacroBlock& compiled, ArenaMacroBlock& block)
+{
+	//失敗時還原至編譯前的節點數量
+	size_t node_count(nodes.size()), constant_count(constants.size());
+	block = ArenaMacroBlock();
+	bool result(false);
+
+	//通用運算子
+	if (!compiled.general_operators.empty()) {
+		const GeneralOperatorHandle& handle(compiled.general_operators.front());
+		if (handle.arithmetic) {
+			block.expression = AppendArithmetic(handle.arithmetic.get()); }
+		else if (handle.relational) {
+			block.expression = AppendRelational(handle.relational.get()); }
+		else if (handle.logical) {
+			block.expression = AppendLogical(handle.logical.get()); }
+		result = block.expression != NO_MACRO_NODE;
+	}
+	//條件式算術運算子:IF[...] THEN
+	else if (!compiled.conditional_arithmetic_operator.Empty()) {
+		const ConditionalArithmeticOperator& conditional(compiled.conditional_arithmetic_operator);
+		block.condition = AppendCondition(conditional.Condition());
+		block.expression = AppendArithmetic(conditional.Arithmetic());
+		result = block.condition != NO_MACRO_NODE && block.expression != NO_MACRO_NODE;
+	}
+	//條件式分支運算子:[IF[...]] GOTO
+	else if (!compiled.conditional_branch_operator.Empty()) {
+		const ConditionalBranchOperator& branch(compiled.conditional_branch_operator);
+		bool conditional(!branch.Condition().Empty());
+		block.condition = AppendCondition(branch.Condition());
+		block.expression = AppendArithmetic(branch.Arithmetic());
+		block.control = OP_BRANCH;
+		result = (!conditional || block.condition != NO_MACRO_NODE) && block.expression != NO_MACRO_NODE;
+	}
+	//條件式迴圈運算子:[WHILE[...]] DO
+	else if (!compiled.conditional_loop_operator.Empty()) {
+		const ConditionalLoopOperator& loop(compiled.conditional_loop_operator);
+		bool conditional(!loop.Condition().Empty());
+		block.condition = AppendCondition(loop.Condition());
+		block.expression = AppendArithmetic(loop.Arithmetic());
+		block.control = OP_LOOP;
+		result = (!conditional || block.condition != NO_MACRO_NODE) && block.expression != NO_MACRO_NODE;
+	}
+	//迴圈終點運算子:END
+	else if (!compiled.loop_end_operator.Empty()) {
+		block.expression = AppendArithmetic(compiled.loop_end_operator.Arithmetic());
+		block.control = OP_LOOP_END;
+		result = block.expression != NO_MACRO_NODE;
+	}
+
+	if (!result) {
+		nodes.resize(node_count, MacroNode(OP_RETURN, NO_MACRO_NODE, NO_MACRO_NODE));
+		constants.resize(constant_count);
+		block = ArenaMacroBlock();
+	}
+	shared_nodes.clear();
+	return result;
+}
+
+double MacroNodeArena::ReadVariable(MacroVariableInterface& macro_variable_interface, unsigned short variable_ID, const MacroNode& node)
+{
+	double value(0.0);
+	if (macro_variable_interface.ReadVariable(variable_ID, value)) {
+		return value; }
+	else {
+		macro_variable_interface.RaiseAlarm(ALARM_VARIABLE_NOT_EXIST, &node, variable_ID);
+		return NULL_VARIABLE;
+	}
+}
+
+void MacroNodeArena::WriteVariable(MacroVariableInterface& macro_variable_interface, unsigned short variable_ID, double value, const MacroNode& node)
+{
+	if (variable_ID == 0) {
+		macro_variable_interface.RaiseAlarm(ALARM_READ_ONLY_VARIABLE, &node); }
+	else {
+		macro_variable_interface.WriteVariable(variable_ID, value); }
+}
+
+double MacroNodeArena::Evaluate(MacroNodeIndex index, MacroVariableInterface& macro_variable_interface) const
+{
+	const MacroNode& node(nodes[index]);
+	switch (node.opcode) {
+	case OP_CONSTANT:
+		return constants[node.left];
+	case OP_LOAD_VARIABLE:
+		return ReadVariable(macro_variable_interface, static_cast<unsigned short>(node.left), node);
+	case OP_VARIABLE:
+		return ReadVariable(macro_variable_interface, VariableID(Evaluate(node.left, macro_variable_interface)), node);
+	case OP_ASSIGNMENT: {
+		//先核算寫入值,再核算變數ID
+		double value(Evaluate(node.right, macro_variable_interface));
+		unsigned short variable_ID(VariableID(Evaluate(node.left, macro_variable_interface)));
+		WriteVariable(macro_variable_interface, variable_ID, value, node);
+		return ReadVariable(macro_variable_interface, variable_ID, node);
+	}
+	case OP_ADD_DECIMAL_POINT:
+		return Evaluate(node.left, macro_variable_interface) / constants[node.right];
+	default:
+		break;
+	}
+
+	double left(Evaluate(node.left, macro_variable_interface));
+	switch (node.opcode) {
+		//一元運算子
+	case OP_MINUS:
+		return -left;
+	case OP_SINE:
+		return DegreeTrigonometry::Sine(left);
+	case OP_COSINE:
+		return DegreeTrigonometry::Cosine(left);
+	case OP_TANGENT:
+		return DegreeTrigonometry::Tangent(left);
+	case OP_ARC_SINE:
+		return DegreeTrigonometry::ArcSine(left);
+	case OP_ARC_COSINE:
+		return DegreeTrigonometry::ArcCosine(left);
+	case OP_ARC_TANGENT:
+		return DegreeTrigonometry::ArcTangent(left);
+	case OP_SQUARE_ROOT:
+		return sqrt(left);
+	case OP_ABSOLUTE_VALUE:
+		return fabs(left);
+	case OP_BINARY_CODE:
+		return BinaryCodeOperator::Convert(left);
+	case OP_BINARY_CODED_DECIMAL:
+		return BinaryCodedDecimalOperator::Convert(left);
+	case OP_ROUND_OFF:
+		return round(left);
+	case OP_ROUND_DOWN:
+		return left < 0.0 ? ceil(left) : floor(left);
+	case OP_ROUND_UP:
+		return left < 0.0 ? floor(left) : ceil(left);
+	case OP_NATURAL_LOG:
+		return log(left);
+	case OP_EXPONENT:
+		return exp(left);
+		//邏輯運算子:左運算元可決定結果時不核算右運算元
+	case OP_AND:
+		if (static_cast<unsigned>(left) == 0) {
+			return 0.0; }
+		break;
+	case OP_OR_SHORT_CIRCUIT:
+		if (left != 0.0) {
+			return left; }
+		break;
+	default:
+		break;
+	}
+
+	double right(Evaluate(node.right, macro_variable_interface));
+	switch (node.opcode) {
+		//二元運算子
+	case OP_ADD:
+		return left + right;
+	case OP_SUBTRACT:
+		return left - right;
+	case OP_MULTIPLY:
+		return left * right;
+	case OP_DIVIDE:
+		return left / right;
+	case OP_ARC_TANGENT2:
+		return DegreeTrigonometry::ArcTangent2(left, right);
+	case OP_POWER:
+		return pow(left, right);
+		//關係運算子
+	case OP_EQUAL:
+		return left == right ? 1.0 : 0.0;
+	case OP_NOT_EQUAL:
+		return left != right ? 1.0 : 0.0;
+	case OP_GREATER:
+		return left > right ? 1.0 : 0.0;
+	case OP_GREATER_EQUAL:
+		return left >= right ? 1.0 : 0.0;
+	case OP_LESS:
+		return left < right ? 1.0 : 0.0;
+	case OP_LESS_EQUAL:
+		return left <= right ? 1.0 : 0.0;
+		//邏輯運算子
+	case OP_AND:
+		return static_cast<double>(static_cast<unsigned>(left) & static_cast<unsigned>(right));
+	case OP_OR:
+	case OP_OR_SHORT_CIRCUIT:
+		return static_cast<double>(static_cast<unsigned>(left) | static_cast<unsigned>(right));
+	case OP_XOR:
+		return static_cast<double>(static_cast<unsigned>(left) ^ static_cast<unsigned>(right));
+	default:
+		macro_variable_interface.RaiseAlarm(ALARM_INVALID_NODE, &node);
+		return NULL_VARIABLE;
+	}
+}
+
+MacroBytecodeResult MacroNodeArena::Run(const ArenaMacroBlock& block, MacroVariableInterface& macro_variable_interface) const
+{
+	MacroBytecodeResult result;
+	if (block.expression == NO_MACRO_NODE) {
+		result.condition = false;
+		return result;
+	}
+	result.control = block.control;
+
+	//迴圈識別號碼不受條件式影響
+	if (block.control == OP_LOOP || block.control == OP_LOOP_END) {
+		result.number = static_cast<unsigned short>(Evaluate(block.expression, macro_variable_interface));
+		if (block.condition != NO_MACRO_NODE) {
+			result.condition = Evaluate(block.condition, macro_variable_interface) != 0.0; }
+		return result;
+	}
+	//條件不成立時不核算運算式
+	if (block.condition != NO_MACRO_NODE && Evaluate(block.condition, macro_variable_interface) == 0.0) {
+		result.condition = false;
+		return result;
+	}
+	if (block.control == OP_BRANCH) {
+		result.number = BranchNumber(Evaluate(block.expression, macro_variable_interface)); }
+	else {
+		result.value = Evaluate(block.expression, macro_variable_interface); }
+	return result;
+}
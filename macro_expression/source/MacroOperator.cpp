@@ -25,8 +25,9 @@ BinaryOperator::BinaryOperator(MacroOperatorID id, const shared_ptr<ArithmeticOp
 {
 }
 
-RelationalOperator::RelationalOperator(const shared_ptr<ArithmeticOperator>& left, const shared_ptr<ArithmeticOperator>& right)
-	:left_result(NULL_FLOAT_VALUE),
+RelationalOperator::RelationalOperator(RelationalOperatorID id, const shared_ptr<ArithmeticOperator>& left, const shared_ptr<ArithmeticOperator>& right)
+	:operator_ID(id),
+	left_result(NULL_FLOAT_VALUE),
 	right_result(NULL_FLOAT_VALUE),
 	left_operand(left),
 	right_operand(right)
@@ -44,88 +45,98 @@ bool RelationalOperator::Evaluate()
 	return true;
 }
 
-LogicalOperator::LogicalOperator(const shared_ptr<ArithmeticOperator>& left_operand, const shared_ptr<ArithmeticOperator>& right_operand)
-	:left_result(0),
-	right_result(0),
-	left_arithmetic(left_operand),
-	right_arithmetic(right_operand)
+ConditionOperand::ConditionOperand(const shared_ptr<ArithmeticOperator>& operand)
+	:type(operand ? ARITHMETIC_CONDITION_OPERAND : NO_CONDITION_OPERAND),
+	handle(operand)
 {
 }
 
-LogicalOperator::LogicalOperator(const shared_ptr<RelationalOperator>& left_operand, const shared_ptr<RelationalOperator>& right_operand)
-	:left_result(0),
-	right_result(0),
-	left_relation(left_operand),
-	right_relation(right_operand)
+ConditionOperand::ConditionOperand(const shared_ptr<RelationalOperator>& operand)
+	:type(operand ? RELATIONAL_CONDITION_OPERAND : NO_CONDITION_OPERAND),
+	handle(operand)
 {
 }
 
-LogicalOperator::LogicalOperator(const shared_ptr<LogicalOperator>& left_operand, const shared_ptr<LogicalOperator>& right_operand)
-	:left_result(0),
-	right_result(0),
-	left_logical(left_operand),
-	right_logical(right_operand)
+ConditionOperand::ConditionOperand(const shared_ptr<LogicalOperator>& operand)
+	:type(operand ? LOGICAL_CONDITION_OPERAND : NO_CONDITION_OPERAND),
+	handle(operand)
 {
 }
 
-LogicalOperator::LogicalOperator(const shared_ptr<ArithmeticOperator>& left_operand, const shared_ptr<LogicalOperator>& right_operand)
-	:left_result(0),
-	right_result(0),
-	left_arithmetic(left_operand),
-	right_logical(right_operand)
+shared_ptr<ArithmeticOperator> ConditionOperand::ArithmeticHandle() const
 {
+	if (type != ARITHMETIC_CONDITION_OPERAND) {
+		return nullptr; }
+	return static_pointer_cast<ArithmeticOperator>(handle);
 }
 
-LogicalOperator::LogicalOperator(const shared_ptr<LogicalOperator>& left_operand, const shared_ptr<ArithmeticOperator>& right_operand)
-	:left_result(0),
-	right_result(0),
-	left_logical(left_operand),
-	right_arithmetic(right_operand)
+void ConditionOperand::Clear()
 {
+	type = NO_CONDITION_OPERAND;
+	handle.reset();
 }
 
-LogicalOperator::LogicalOperator(const shared_ptr<RelationalOperator>& left_operand, const shared_ptr<LogicalOperator>& right_operand)
-	:left_result(0),
-	right_result(0),
-	left_relation(left_operand),
-	right_logical(right_operand)
+LogicalOperator::LogicalOperator(LogicalOperatorID id, const shared_ptr<ArithmeticOperator>& left, const shared_ptr<ArithmeticOperator>& right)
+	:operator_ID(id),
+	left_operand(left),
+	right_operand(right),
+	boolean(left_operand.Boolean() && right_operand.Boolean())
+{
+}
+
+LogicalOperator::LogicalOperator(LogicalOperatorID id, const shared_ptr<RelationalOperator>& left, const shared_ptr<RelationalOperator>& right)
+	:operator_ID(id),
+	left_operand(left),
+	right_operand(right),
+	boolean(left_operand.Boolean() && right_operand.Boolean())
+{
+}
+
+LogicalOperator::LogicalOperator(LogicalOperatorID id, const shared_ptr<LogicalOperator>& left, const shared_ptr<LogicalOperator>& right)
+	:operator_ID(id),
+	left_operand(left),
+	right_operand(right),
+	boolean(left_operand.Boolean() && right_operand.Boolean())
+{
+}
+
+LogicalOperator::LogicalOperator(LogicalOperatorID id, const shared_ptr<ArithmeticOperator>& left, const shared_ptr<LogicalOperator>& right)
+	:operator_ID(id),
+	left_operand(left),
+	right_operand(right),
+	boolean(left_operand.Boolean() && right_operand.Boolean())
 {
 }
 
-LogicalOperator::LogicalOperator(const shared_ptr<LogicalOperator>& left_operand, const shared_ptr<RelationalOperator>& right_operand)
-	:left_result(0),
-	right_result(0),
-	left_logical(left_operand),
-	right_relation(right_operand)
+LogicalOperator::LogicalOperator(LogicalOperatorID id, const shared_ptr<LogicalOperator>& left, const shared_ptr<ArithmeticOperator>& right)
+	:operator_ID(id),
+	left_operand(left),
+	right_operand(right),
+	boolean(left_operand.Boolean() && right_operand.Boolean())
+{
+}
+
+LogicalOperator::LogicalOperator(LogicalOperatorID id, const shared_ptr<RelationalOperator>& left, const shared_ptr<LogicalOperator>& right)
+	:operator_ID(id),
+	left_operand(left),
+	right_operand(right),
+	boolean(left_operand.Boolean() && right_operand.Boolean())
+{
+}
+
+LogicalOperator::LogicalOperator(LogicalOperatorID id, const shared_ptr<LogicalOperator>& left, const shared_ptr<RelationalOperator>& right)
+	:operator_ID(id),
+	left_operand(left),
+	right_operand(right),
+	boolean(left_operand.Boolean() && right_operand.Boolean())
 {
 }
 
 unsigned LogicalOperator::Evaluate()
 {
-	if (left_arithmetic) {
-		left_result = static_cast<unsigned>(left_arithmetic->Evaluate());
-		if (right_arithmetic) {
-			right_result = static_cast<unsigned>(right_arithmetic->Evaluate()); }
-		else if (right_logical) {
-			right_result = right_logical->Evaluate(); }
-	}
-	else if (left_logical) {
-		left_result = left_logical->Evaluate();
-		if (right_relation) {
-			right_result = static_cast<unsigned>(right_relation->Evaluate()); }
-		else if (right_logical) {
-			right_result = right_logical->Evaluate(); }
-		else if (right_arithmetic) {
-			right_result = static_cast<unsigned>(right_arithmetic->Evaluate()); }
-	}
-	else if (left_relation) {
-		left_result = static_cast<unsigned>(left_relation->Evaluate());
-		if (right_logical) {
-			right_result = right_logical->Evaluate(); }
-		else if (right_relation) {
-			right_result = static_cast<unsigned>(right_relation->Evaluate()); }
-	}
-	
+	//先核算左運算元,再核算右運算元
+	left_operand.Evaluate();
+	right_operand.Evaluate();
 	return 1;
 }
 
@@ -160,25 +171,56 @@ VariableOperator::VariableOperator(MacroVariableInterface& interface, const shar
 	variable_ID(0),
 	macro_variable_interface(interface)
 {
+	//常數ID(#33)於建立時解析存取位置並檢查範圍
+	if (operand && operand->GetOperatorID() == CONSTANT) {
+		variable_ID = VariableID(operand->Evaluate());
+		slot = macro_variable_interface.ResolveVariable(variable_ID);
+	}
 }
 
 double VariableOperator::Evaluate()
 {
-	//巨集變數ID
-	variable_ID = static_cast<unsigned short>(operand_handle->Evaluate());
 	//變數值
 	double value(0.0);
-	//嘗試讀取ID所指定的變數值
-	if (macro_variable_interface.ReadVariable(variable_ID, value)) {
-		return value; }
+	//常數ID直接讀取預先解析的存取位置
+	if (slot.Resolved()) {
+		if (macro_variable_interface.ReadVariable(slot, value)) {
+			return value; }
+	}
+	//間接ID(#[#31])每次核算ID後查詢
 	else {
-		throw out_of_range("out_of_range: the variable ID is not exist."); }
+		variable_ID = VariableID(operand_handle->Evaluate());
+		//嘗試讀取ID所指定的變數值
+		if (macro_variable_interface.ReadVariable(variable_ID, value)) {
+			return value; }
+	}
+	//變數不存在(警報模式下返回空值)
+	macro_variable_interface.RaiseAlarm(ALARM_VARIABLE_NOT_EXIST, this, variable_ID);
+	return NULL_VARIABLE;
+}
+
+double VariableOperator::ReadWrittenVariable()
+{
+	double value(0.0);
+	if (slot.Resolved() ? macro_variable_interface.ReadVariable(slot, value) : macro_variable_interface.ReadVariable(variable_ID, value)) {
+		return value; }
+	macro_variable_interface.RaiseAlarm(ALARM_VARIABLE_NOT_EXIST, this, variable_ID);
+	return NULL_VARIABLE;
 }
 
 bool VariableOperator::WriteVariable(double value)
 {
 	//巨集變數ID
-	variable_ID = static_cast<unsigned short>(operand_handle->Evaluate());
+	if (!slot.Resolved()) {
+		variable_ID = VariableID(operand_handle->Evaluate()); }
+	//#0禁止寫入
+	if (variable_ID == 0) {
+		macro_variable_interface.RaiseAlarm(ALARM_READ_ONLY_VARIABLE, this);
+		return false;
+	}
+	//常數ID直接寫入預先解析的存取位置
+	else if (slot.Resolved()) {
+		return macro_variable_interface.WriteVariable(slot, value); }
 	//嘗試寫入ID所指定的變數值
 	if (macro_variable_interface.WriteVariable(variable_ID, value)) {
 		return true; }
@@ -277,6 +319,72 @@ ExponentOperator::ExponentOperator(const shared_ptr<ArithmeticOperator>& operand
 {
 }
 
+BinaryCodeOperator::BinaryCodeOperator(const shared_ptr<ArithmeticOperator>& operand)
+	:UnaryOperator(MacroOperatorID::BINARY_CODE, operand)
+{
+}
+
+double BinaryCodeOperator::Convert(double value)
+{
+	//每4位元為一個十進位數字
+	unsigned long long code(static_cast<unsigned long long>(fabs(value)));
+	double binary(0.0), weight(1.0);
+	while (code != 0) {
+		binary += static_cast<double>(code & 0xF) * weight;
+		weight *= 10.0;
+		code >>= 4;
+	}
+	return binary;
+}
+
+BinaryCodedDecimalOperator::BinaryCodedDecimalOperator(const shared_ptr<ArithmeticOperator>& operand)
+	:UnaryOperator(MacroOperatorID::BINARY_CODED_DECIMAL, operand)
+{
+}
+
+double BinaryCodedDecimalOperator::Convert(double value)
+{
+	//每一個十進位數字佔4位元
+	unsigned long long binary(static_cast<unsigned long long>(fabs(value)));
+	double code(0.0), weight(1.0);
+	while (binary != 0) {
+		code += static_cast<double>(binary % 10) * weight;
+		weight *= 16.0;
+		binary /= 10;
+	}
+	return code;
+}
+
+AddDecimalPointOperator::AddDecimalPointOperator(const shared_ptr<ArithmeticOperator>& operand, double increment)
+	:UnaryOperator(MacroOperatorID::ADD_DECIMAL_POINT, operand),
+	least_increment(increment)
+{
+}
+
+CommonSubexpressionOperator::CommonSubexpressionOperator(MacroVariableInterface& interface, const shared_ptr<ArithmeticOperator>& operand, bool s)
+	:UnaryOperator(MacroOperatorID::COMMON_SUBEXPRESSION, operand),
+	macro_variable_interface(interface),
+	scope(s),
+	generation(0)
+{
+}
+
+double CommonSubexpressionOperator::Evaluate()
+{
+	//核算範圍:使範圍內所有暫存結果失效
+	if (scope) {
+		macro_variable_interface.NextGeneration();
+		return operand_handle->Evaluate();
+	}
+	//同一核算世代且期間未寫入變數:沿用暫存結果
+	unsigned long long current(macro_variable_interface.Generation());
+	if (generation != current) {
+		result = operand_handle->Evaluate();
+		generation = current;
+	}
+	return result;
+}
+
 PowerOperator::PowerOperator(const shared_ptr<ArithmeticOperator>& left_operand, const shared_ptr<ArithmeticOperator>& right_operand)
 	:BinaryOperator(MacroOperatorID::POWER, left_operand, right_operand)
 {
@@ -312,6 +420,9 @@ AssignmentOperator::AssignmentOperator(const shared_ptr<ArithmeticOperator>& lef
 	left_variable(static_cast<VariableOperator*>(left_operand.operator ->())),
 	right_logical(nullptr)
 {
+	//左運算元須為變數運算子(剖析器不會產生空的左運算元)
+	if (!left_operand) {
+		MACRO_THROW(invalid_argument("invalid_argument: left operand(variable) is null")); }
 }
 
 AssignmentOperator::AssignmentOperator(const shared_ptr<ArithmeticOperator>& left_operand, const shared_ptr<LogicalOperator>& right_operand)
@@ -319,16 +430,15 @@ AssignmentOperator::AssignmentOperator(const shared_ptr<ArithmeticOperator>& lef
 	left_variable(static_cast<VariableOperator*>(left_operand.operator ->())),
 	right_logical(right_operand)
 {
+	//左運算元須為變數運算子(剖析器不會產生空的左運算元)
+	if (!left_operand) {
+		MACRO_THROW(invalid_argument("invalid_argument: left operand(variable) is null")); }
 }
 
 double AssignmentOperator::Evaluate()
 {
-	//左運算元(變數運算子)為空
-	if (!left_operand) {
-		throw invalid_argument("invalid_argument: left operand(variable) is null");
-	}
-	//右運算元為邏輯運算子
-	else if (right_logical) {
+	//右運算元為邏輯運算子(左運算元已於建立時檢查)
+	if (right_logical) {
 		result = right_logical->Evaluate();
 		left_variable->WriteVariable(result);
 	}
@@ -339,13 +449,15 @@ double AssignmentOperator::Evaluate()
 	}
 	//右運算元為空
 	else {
-		throw invalid_argument("invalid argument: right operand is null."); }
-
-	return left_variable->Evaluate();
+		left_variable->RaiseAlarm(ALARM_NULL_OPERAND, this);
+		return NULL_VARIABLE;
+	}
+	//讀取寫入的變數(間接ID於寫入前核算,與位元組碼及節點記憶區相同)
+	return left_variable->ReadWrittenVariable();
 }
 
 EqualOperator::EqualOperator(const shared_ptr<ArithmeticOperator>& left_operand, const shared_ptr<ArithmeticOperator>& right_operand)
-	:RelationalOperator(left_operand, right_operand)
+	:RelationalOperator(RelationalOperatorID::EQUAL, left_operand, right_operand)
 {
 }
 
@@ -356,7 +468,7 @@ bool EqualOperator::Evaluate()
 }
 
 NotEqualOperator::NotEqualOperator(const shared_ptr<ArithmeticOperator>& left_operand, const shared_ptr<ArithmeticOperator>& right_operand)
-	:RelationalOperator(left_operand, right_operand)
+	:RelationalOperator(RelationalOperatorID::NOT_EQUAL, left_operand, right_operand)
 {
 }
 
@@ -367,7 +479,7 @@ bool NotEqualOperator::Evaluate()
 }
 
 GreaterOperator::GreaterOperator(const shared_ptr<ArithmeticOperator>& left_operand, const shared_ptr<ArithmeticOperator>& right_operand)
-	:RelationalOperator(left_operand, right_operand)
+	:RelationalOperator(RelationalOperatorID::GREATER, left_operand, right_operand)
 {
 }
 
@@ -378,7 +490,7 @@ bool GreaterOperator::Evaluate()
 }
 
 GreaterEqualOperator::GreaterEqualOperator(const shared_ptr<ArithmeticOperator>& left_operand, const shared_ptr<ArithmeticOperator>& right_operand)
-	:RelationalOperator(left_operand, right_operand)
+	:RelationalOperator(RelationalOperatorID::GREATER_EQUAL, left_operand, right_operand)
 {
 }
 
@@ -389,7 +501,7 @@ bool GreaterEqualOperator::Evaluate()
 }
 
 LessOperator::LessOperator(const shared_ptr<ArithmeticOperator>& left_operand, const shared_ptr<ArithmeticOperator>& right_operand)
-	:RelationalOperator(left_operand, right_operand)
+	:RelationalOperator(RelationalOperatorID::LESS, left_operand, right_operand)
 {
 }
 
@@ -400,7 +512,7 @@ bool LessOperator::Evaluate()
 }
 
 LessEqualOperator::LessEqualOperator(const shared_ptr<ArithmeticOperator>& left_operand, const shared_ptr<ArithmeticOperator>& right_operand)
-	:RelationalOperator(left_operand, right_operand)
+	:RelationalOperator(RelationalOperatorID::LESS_EQUAL, left_operand, right_operand)
 {
 }
 
@@ -411,144 +523,149 @@ bool LessEqualOperator::Evaluate()
 }
 
 AND_Operator::AND_Operator(const shared_ptr<ArithmeticOperator>& left_operand, const shared_ptr<ArithmeticOperator>& right_operand)
-	:LogicalOperator(left_operand, right_operand)
+	:LogicalOperator(LogicalOperatorID::AND, left_operand, right_operand)
 {
 }
 
 AND_Operator::AND_Operator(const shared_ptr<RelationalOperator>& left_operand, const shared_ptr<RelationalOperator>& right_operand)
-	:LogicalOperator(left_operand, right_operand)
+	:LogicalOperator(LogicalOperatorID::AND, left_operand, right_operand)
 {
 }
 
 AND_Operator::AND_Operator(const shared_ptr<LogicalOperator>& left_operand, const shared_ptr<LogicalOperator>& right_operand)
-	:LogicalOperator(left_operand, right_operand)
+	:LogicalOperator(LogicalOperatorID::AND, left_operand, right_operand)
 {
 }
 
 AND_Operator::AND_Operator(const shared_ptr<ArithmeticOperator>& left_operand, const shared_ptr<LogicalOperator>& right_operand)
-	:LogicalOperator(left_operand, right_operand)
+	:LogicalOperator(LogicalOperatorID::AND, left_operand, right_operand)
 {
 }
 
 AND_Operator::AND_Operator(const shared_ptr<LogicalOperator>& left_operand, const shared_ptr<ArithmeticOperator>& right_operand)
-	:LogicalOperator(left_operand, right_operand)
+	:LogicalOperator(LogicalOperatorID::AND, left_operand, right_operand)
 {
 }
 
 AND_Operator::AND_Operator(const shared_ptr<RelationalOperator>& left_operand, const shared_ptr<LogicalOperator>& right_operand)
-	:LogicalOperator(left_operand, right_operand)
+	:LogicalOperator(LogicalOperatorID::AND, left_operand, right_operand)
 {
 }
 
 AND_Operator::AND_Operator(const shared_ptr<LogicalOperator>& left_operand, const shared_ptr<RelationalOperator>& right_operand)
-	:LogicalOperator(left_operand, right_operand)
+	:LogicalOperator(LogicalOperatorID::AND, left_operand, right_operand)
 {
 }
 
 unsigned AND_Operator::Evaluate()
 {
-	LogicalOperator::Evaluate();
-	return left_result & right_result;
+	//左運算元為0時結果必為0(算術運算元亦同),不核算右運算元
+	unsigned left(left_operand.Evaluate());
+	if (left == 0) {
+		return 0; }
+	return left & right_operand.Evaluate();
 }
 
 OR_Operator::OR_Operator(const shared_ptr<ArithmeticOperator>& left_operand, const shared_ptr<ArithmeticOperator>& right_operand)
-	:LogicalOperator(left_operand, right_operand)
+	:LogicalOperator(LogicalOperatorID::OR, left_operand, right_operand)
 {
 }
 
 OR_Operator::OR_Operator(const shared_ptr<RelationalOperator>& left_operand, const shared_ptr<RelationalOperator>& right_operand)
-	:LogicalOperator(left_operand, right_operand)
+	:LogicalOperator(LogicalOperatorID::OR, left_operand, right_operand)
 {
 }
 
 OR_Operator::OR_Operator(const shared_ptr<LogicalOperator>& left_operand, const shared_ptr<LogicalOperator>& right_operand)
-	:LogicalOperator(left_operand, right_operand)
+	:LogicalOperator(LogicalOperatorID::OR, left_operand, right_operand)
 {
 }
 
 OR_Operator::OR_Operator(const shared_ptr<ArithmeticOperator>& left_operand, const shared_ptr<LogicalOperator>& right_operand)
-	:LogicalOperator(left_operand, right_operand)
+	:LogicalOperator(LogicalOperatorID::OR, left_operand, right_operand)
 {
 }
 
 OR_Operator::OR_Operator(const shared_ptr<LogicalOperator>& left_operand, const shared_ptr<ArithmeticOperator>& right_operand)
-	:LogicalOperator(left_operand, right_operand)
+	:LogicalOperator(LogicalOperatorID::OR, left_operand, right_operand)
 {
 }
 
 OR_Operator::OR_Operator(const shared_ptr<RelationalOperator>& left_operand, const shared_ptr<LogicalOperator>& right_operand)
-	:LogicalOperator(left_operand, right_operand)
+	:LogicalOperator(LogicalOperatorID::OR, left_operand, right_operand)
 {
 }
 
 OR_Operator::OR_Operator(const shared_ptr<LogicalOperator>& left_operand, const shared_ptr<RelationalOperator>& right_operand)
-	:LogicalOperator(left_operand, right_operand)
+	:LogicalOperator(LogicalOperatorID::OR, left_operand, right_operand)
 {
 }
 
 unsigned OR_Operator::Evaluate()
 {
-	LogicalOperator::Evaluate();
-	return left_result | right_result;
+	//左右運算元皆為布林值且左運算元成立時,不核算右運算元(算術運算元維持位元運算)
+	unsigned left(left_operand.Evaluate());
+	if (boolean && left != 0) {
+		return left; }
+	return left | right_operand.Evaluate();
 }
 
 XOR_Operator::XOR_Operator(const shared_ptr<ArithmeticOperator>& left_operand, const shared_ptr<ArithmeticOperator>& right_operand)
-	:LogicalOperator(left_operand, right_operand)
+	:LogicalOperator(LogicalOperatorID::XOR, left_operand, right_operand)
 {
 }
 
 XOR_Operator::XOR_Operator(const shared_ptr<RelationalOperator>& left_operand, const shared_ptr<RelationalOperator>& right_operand)
-	:LogicalOperator(left_operand, right_operand)
+	:LogicalOperator(LogicalOperatorID::XOR, left_operand, right_operand)
 {
 }
 
 XOR_Operator::XOR_Operator(const shared_ptr<LogicalOperator>& left_operand, const shared_ptr<LogicalOperator>& right_operand)
-	:LogicalOperator(left_operand, right_operand)
+	:LogicalOperator(LogicalOperatorID::XOR, left_operand, right_operand)
 {
 }
 
 XOR_Operator::XOR_Operator(const shared_ptr<ArithmeticOperator>& left_operand, const shared_ptr<LogicalOperator>& right_operand)
-	:LogicalOperator(left_operand, right_operand)
+	:LogicalOperator(LogicalOperatorID::XOR, left_operand, right_operand)
 {
 }
 
 XOR_Operator::XOR_Operator(const shared_ptr<LogicalOperator>& left_operand, const shared_ptr<ArithmeticOperator>& right_operand)
-	:LogicalOperator(left_operand, right_operand)
+	:LogicalOperator(LogicalOperatorID::XOR, left_operand, right_operand)
 {
 }
 
 XOR_Operator::XOR_Operator(const shared_ptr<RelationalOperator>& left_operand, const shared_ptr<LogicalOperator>& right_operand)
-	:LogicalOperator(left_operand, right_operand)
+	:LogicalOperator(LogicalOperatorID::XOR, left_operand, right_operand)
 {
 }
 
 XOR_Operator::XOR_Operator(const shared_ptr<LogicalOperator>& left_operand, const shared_ptr<RelationalOperator>& right_operand)
-	:LogicalOperator(left_operand, right_operand)
+	:LogicalOperator(LogicalOperatorID::XOR, left_operand, right_operand)
 {
 }
 
 unsigned XOR_Operator::Evaluate()
 {
-	LogicalOperator::Evaluate();
-	return left_result ^ right_result;
+	unsigned left(left_operand.Evaluate());
+	return left ^ right_operand.Evaluate();
 }
 
 ConditionalArithmeticOperator::ConditionalArithmeticOperator(const shared_ptr<RelationalOperator>& relational, const shared_ptr<ArithmeticOperator>& arithmetic)
-	:relational_operator(relational),
+	:condition(relational),
 	arithmetic_operator(arithmetic)
 {
 }
 
 ConditionalArithmeticOperator::ConditionalArithmeticOperator(const shared_ptr<LogicalOperator>& logical, const shared_ptr<ArithmeticOperator>& arithmetic)
-	:logical_operator(logical),
+	:condition(logical),
 	arithmetic_operator(arithmetic)
 {
 }
 
 void ConditionalArithmeticOperator::Clear()
 {
-	relational_operator.reset();
-	logical_operator.reset();
+	condition.Clear();
 	arithmetic_operator.reset();
 }
 
@@ -556,28 +673,14 @@ bool ConditionalArithmeticOperator::Evaluate()
 {
 	if (Empty()) {
 		return false; }
-	//條件式為邏輯運算子
-	if (logical_operator) {
-		//滿足邏輯條件
-		if (logical_operator->Evaluate()) {
-			//對算數運算子進行核算
-			arithmetic_operator->Evaluate();
-			return true;
-		}
-		else {
-			return false; }
+	//滿足條件(關係或邏輯運算子)
+	if (condition.Evaluate()) {
+		//對算數運算子進行核算
+		arithmetic_operator->Evaluate();
+		return true;
 	}
-	//條件式為關係運算子
 	else {
-		//滿足關係條件
-		if (relational_operator->Evaluate()) {
-			//對算數運算子進行核算
-			arithmetic_operator->Evaluate();
-			return true;
-		}
-		else {
-			return false; }
-	}
+		return false; }
 }
 
 ConditionalBranchOperator::ConditionalBranchOperator(const shared_ptr<ArithmeticOperator>& arithmetic)
@@ -586,21 +689,20 @@ ConditionalBranchOperator::ConditionalBranchOperator(const shared_ptr<Arithmetic
 }
 
 ConditionalBranchOperator::ConditionalBranchOperator(const shared_ptr<RelationalOperator>& relational, const shared_ptr<ArithmeticOperator>& arithmetic)
-	:relational_operand(relational),
+	:condition(relational),
 	arithmetic_operand(arithmetic)
 {
 }
 
 ConditionalBranchOperator::ConditionalBranchOperator(const shared_ptr<LogicalOperator>& logical, const shared_ptr<ArithmeticOperator>& arithmetic)
-	:logical_operand(logical),
+	:condition(logical),
 	arithmetic_operand(arithmetic)
 {
 }
 
 void ConditionalBranchOperator::Clear()
 {
-	relational_operand.reset();
-	logical_operand.reset();
+	condition.Clear();
 	arithmetic_operand.reset();
 }
 
@@ -609,12 +711,8 @@ bool ConditionalBranchOperator::Evaluate()
 	if (Empty()) {
 		return false; }
 
-	if (relational_operand) {
-		return relational_operand->Evaluate(); }
-	else if (logical_operand) {
-		return static_cast<bool>(logical_operand->Evaluate()); }
-	else {
-		return true; }
+	//無條件式時核算結果為1
+	return condition.Evaluate() != 0;
 }
 
 int ConditionalBranchOperator::BranchNumber()
@@ -631,21 +729,20 @@ ConditionalLoopOperator::ConditionalLoopOperator(const shared_ptr<ArithmeticOper
 }
 
 ConditionalLoopOperator::ConditionalLoopOperator(const shared_ptr<RelationalOperator>& relational, const shared_ptr<ArithmeticOperator>& arithmetic)
-	:relational_operator(relational),
+	:condition(relational),
 	arithmetic_operator(arithmetic)
 {
 }
 
 ConditionalLoopOperator::ConditionalLoopOperator(const shared_ptr<LogicalOperator>& logical, const shared_ptr<ArithmeticOperator>& arithmetic)
-	:logical_operator(logical),
+	:condition(logical),
 	arithmetic_operator(arithmetic)
 {
 }
 
 void ConditionalLoopOperator::Clear()
 {
-	relational_operator.reset();
-	logical_operator.reset();
+	condition.Clear();
 	arithmetic_operator.reset();
 }
 
@@ -654,12 +751,8 @@ bool ConditionalLoopOperator::Evaluate()
 	if (Empty()) {
 		return false; }
 
-	if (relational_operator) {
-		return relational_operator->Evaluate(); }
-	else if (logical_operator) {
-		return static_cast<bool>(logical_operator->Evaluate()); }
-	else {
-		return true; }
+	//無條件式時核算結果為1
+	return condition.Evaluate() != 0;
 }
 
 unsigned short ConditionalLoopOperator::LoopNumber()
@@ -0,0 +1,174 @@
+﻿#include "MacroProgram.h"
+#include <cctype>
+
+using namespace std;
+
+MacroProgram::MacroProgram()
+	:program_number(NO_SEQUENCE_NUMBER)
+{
+}
+
+void MacroProgram::Clear()
+{
+	program_number = NO_SEQUENCE_NUMBER;
+	blocks.clear();
+	sequence_index.clear();
+	arena.Clear();
+}
+
+int MacroProgram::ExtractNumber(string_view& text)
+{
+	string_view::size_type end(0);
+	while (end != text.size() && isdigit(static_cast<unsigned char>(text[end]))) {
+		++end; }
+	if (end == 0) {
+		return NO_SEQUENCE_NUMBER; }
+	//略過前導零後計算有效位數
+	string_view::size_type begin(0);
+	while (begin != end - 1 && text[begin] == '0') {
+		++begin; }
+	int number(0);
+	if (end - begin > SEQUENCE_NUMBER_DIGITS_MAX) {
+		number = OVERFLOW_SEQUENCE_NUMBER; }
+	else {
+		for (string_view::size_type index = begin; index != end; ++index) {
+			number = number * 10 + (text[index] - '0'); }
+	}
+	text.remove_prefix(end);
+	return number;
+}
+
+bool MacroProgram::Compile(string_view program, FanucMacroParser& parser)
+{
+	Clear();
+
+	//程式區段字元數量
+	int tape_marks(0);
+	string_view::size_type begin(0);
+	//逐行切割單節
+	while (begin < program.size() && tape_marks < 2) {
+		string_view::size_type end(program.find('\n', begin));
+		if (end == string_view::npos) {
+			end = program.size(); }
+		string_view line(program.substr(begin, end - begin));
+		begin = end + 1;
+
+		//去除前後空白及行尾字元
+		while (!line.empty() && isspace(static_cast<unsigned char>(line.front()))) {
+			line.remove_prefix(1); }
+		while (!line.empty() && isspace(static_cast<unsigned char>(line.back()))) {
+			line.remove_suffix(1); }
+		if (line.empty()) continue;
+
+		//程式區段開始或結束
+		if (line.front() == ADDRESS_PROGRAM_TAPE) {
+			++tape_marks;
+			continue;
+		}
+		//程式號碼:第二個程式號碼為下一個程式的開始
+		if (line.front() == ADDRESS_PROGRAM_NUMBER) {
+			if (program_number != NO_SEQUENCE_NUMBER || !blocks.empty()) break;
+			line.remove_prefix(1);
+			program_number = ExtractNumber(line);
+			if (program_number == OVERFLOW_SEQUENCE_NUMBER) return false;
+			continue;
+		}
+
+		//單節跳躍
+		bool block_delete(line.front() == ADDRESS_BLOCK_DELETE);
+		if (block_delete) {
+			line.remove_prefix(1); }
+		//序號
+		int sequence_number(NO_SEQUENCE_NUMBER);
+		if (!line.empty() && line.front() == ADDRESS_SEQUENCE_NUMBER) {
+			string_view rest(line.substr(1));
+			sequence_number = ExtractNumber(rest);
+			if (sequence_number != NO_SEQUENCE_NUMBER) {
+				line = rest; }
+			while (!line.empty() && isspace(static_cast<unsigned char>(line.front()))) {
+				line.remove_prefix(1); }
+		}
+
+		//序號超過位數上限:不剖析,保留為不合法單節
+		bool sequence_overflow(sequence_number == OVERFLOW_SEQUENCE_NUMBER);
+		if (sequence_overflow) {
+			sequence_number = NO_SEQUENCE_NUMBER; }
+
+		blocks.emplace_back(line, sequence_number, block_delete);
+		MacroProgramBlock& block(blocks.back());
+		if (sequence_overflow) continue;
+		//剖析單節(NC單節及不合法單節保留為INVALID_COMMAND)
+		block.command_type = parser.ParseBlock(block.text);
+		if (block.command_type == MACRO_COMMAND) {
+			//運算子樹僅在編譯期間存在,單節改以節點記憶區索引及位元組碼表示
+			CompiledMacroBlock compiled(block.command_type, parser.macro_generator);
+			arena.Compile(compiled, block.statement);
+			block.bytecode.Compile(compiled);
+			block.jit.Reset();
+		}
+		//序號索引(重複序號取第一個單節)
+		if (sequence_number != NO_SEQUENCE_NUMBER) {
+			sequence_index.emplace(sequence_number, blocks.size() - 1); }
+	}
+
+	if (!MatchLoops()) return false;
+	ResolveBranches();
+	return true;
+}
+
+size_t MacroProgram::FindSequence(int sequence_number) const
+{
+	unordered_map<int, size_t>::const_iterator found(sequence_index.find(sequence_number));
+	return found == sequence_index.end() ? NO_PROGRAM_BLOCK : found->second;
+}
+
+bool MacroProgram::ConstantExpression(const ArenaMacroBlock& statement, double& value) const
+{
+	if (statement.expression == NO_MACRO_NODE) return false;
+	const MacroNode& node(arena.Node(statement.expression));
+	if (node.opcode != OP_CONSTANT) return false;
+	value = arena.Constant(node.left);
+	return true;
+}
+
+bool MacroProgram::MatchLoops()
+{
+	//未配對的DO單節(識別號碼,單節索引)
+	vector<pair<unsigned short, size_t>> loop_stack;
+	for (size_t index = 0; index != blocks.size(); ++index) {
+		const ArenaMacroBlock& statement(blocks[index].statement);
+		if (statement.control != OP_LOOP && statement.control != OP_LOOP_END) continue;
+		//迴圈識別號碼須為常數
+		double number(0.0);
+		if (!ConstantExpression(statement, number)) return false;
+		unsigned short loop_number(static_cast<unsigned short>(number));
+		//迴圈起點
+		if (statement.control == OP_LOOP) {
+			if (loop_number == 0 || loop_number > LOOP_NUMBER_MAX) return false;
+			//巢狀最多3層
+			if (loop_stack.size() == LOOP_NESTING_MAX) return false;
+			loop_stack.emplace_back(loop_number, index);
+		}
+		//迴圈終點:須與最內層DO配對
+		else {
+			if (loop_stack.empty() || loop_stack.back().first != loop_number) return false;
+			blocks[index].loop_pair = loop_stack.back().second;
+			blocks[loop_stack.back().second].loop_pair = index;
+			loop_stack.pop_back();
+		}
+	}
+	return loop_stack.empty();
+}
+
+void MacroProgram::ResolveBranches()
+{
+	for (MacroProgramBlock& block : blocks) {
+		double number(0.0);
+		if (block.statement.control == OP_BRANCH && ConstantExpression(block.statement, number)) {
+			//不合法的常數序號不解析(執行時發出警報)
+			int sequence_number(BranchNumber(number));
+			if (sequence_number != INVALID_BRANCH_NUMBER) {
+				block.branch_target = FindSequence(sequence_number); }
+		}
+	}
+}
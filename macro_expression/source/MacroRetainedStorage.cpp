@@ -0,0 +1,221 @@
+﻿#include "MacroRetainedStorage.h"
+#include <cstring>
+#include <algorithm>
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+MacroRetainedStorage::MacroRetainedStorage()
+	:base(nullptr),
+	mapped_size(0),
+	section_size(0),
+	data(nullptr),
+	count(0),
+	begin_ID(0),
+	sequence(0),
+	state(RETAINED_CLOSED),
+#ifdef _WIN32
+	file(INVALID_HANDLE_VALUE),
+	mapping(nullptr)
+#else
+	file(-1)
+#endif
+{
+}
+
+MacroRetainedStorage::~MacroRetainedStorage()
+{
+	Close();
+}
+
+bool MacroRetainedStorage::Open(const string& path, unsigned short begin, unsigned short end, double initial_value)
+{
+	Close();
+	if (end < begin) {
+		return false; }
+	begin_ID = begin;
+	count = static_cast<size_t>(end - begin) + 1;
+	section_size = (count * sizeof(double) + RETAINED_SECTION_SIZE - 1) / RETAINED_SECTION_SIZE * RETAINED_SECTION_SIZE;
+	//標頭區,目前變數值,兩個檢查點區
+	size_t file_size(RETAINED_SECTION_SIZE + 3 * section_size);
+	//檔案大小不符時重新建立
+	bool created(false);
+#ifdef _WIN32
+	file = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+	LARGE_INTEGER size;
+	if (file == INVALID_HANDLE_VALUE || !GetFileSizeEx(file, &size)) {
+		Unmap();
+		return false;
+	}
+	if (static_cast<unsigned long long>(size.QuadPart) != file_size) {
+		created = true;
+		size.QuadPart = static_cast<LONGLONG>(file_size);
+		if (!SetFilePointerEx(file, size, nullptr, FILE_BEGIN) || !SetEndOfFile(file)) {
+			Unmap();
+			return false;
+		}
+	}
+	mapping = CreateFileMappingA(file, nullptr, PAGE_READWRITE, static_cast<DWORD>(static_cast<unsigned long long>(file_size) >> 32), static_cast<DWORD>(file_size & 0xFFFFFFFFu), nullptr);
+	if (mapping) {
+		base = static_cast<unsigned char*>(MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, file_size)); }
+#else
+	file = open(path.c_str(), O_RDWR | O_CREAT, 0644);
+	struct stat status;
+	if (file < 0 || fstat(file, &status) != 0) {
+		Unmap();
+		return false;
+	}
+	if (static_cast<size_t>(status.st_size) != file_size) {
+		created = true;
+		if (ftruncate(file, static_cast<off_t>(file_size)) != 0) {
+			Unmap();
+			return false;
+		}
+	}
+	void* view(mmap(nullptr, file_size, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0));
+	if (view != MAP_FAILED) {
+		base = static_cast<unsigned char*>(view); }
+#endif
+	if (!base) {
+		Unmap();
+		return false;
+	}
+	mapped_size = file_size;
+	data = reinterpret_cast<double*>(base + RETAINED_SECTION_SIZE);
+
+	//取序號較新的有效標頭
+	sequence = 0;
+	for (uint64_t slot = 0; !created && slot != 2; ++slot) {
+		if (ValidHeader(slot) && Header(slot)->sequence > sequence) {
+			sequence = Header(slot)->sequence; }
+	}
+	size_t bytes(count * sizeof(double));
+	//無有效檢查點:以初值建立
+	if (sequence == 0) {
+		fill(data, data + count, initial_value);
+		state = RETAINED_CREATED;
+	}
+	//資料與檢查點一致,直接使用映射區
+	else if (Checksum(data, bytes) == Header(sequence)->data_checksum) {
+		state = RETAINED_CONSISTENT;
+		return true;
+	}
+	//檢查點後的寫入不保證完整,還原至最新有效檢查點
+	else {
+		memcpy(data, CheckpointData(sequence), bytes);
+		state = RETAINED_RESTORED;
+	}
+	if (!Checkpoint()) {
+		Unmap();
+		return false;
+	}
+	return true;
+}
+
+bool MacroRetainedStorage::Checkpoint()
+{
+	if (!IsOpen()) {
+		return false; }
+	size_t bytes(count * sizeof(double));
+	uint64_t next(sequence + 1);
+	//寫入順序:目前變數值,另一檢查點區,對應標頭(任一步驟中斷時前一檢查點及其標頭仍完整)
+	if (!Flush(data, bytes)) {
+		return false; }
+	double* target(CheckpointData(next));
+	memcpy(target, data, bytes);
+	if (!Flush(target, bytes)) {
+		return false; }
+	MacroRetainedHeader header;
+	header.magic = RETAINED_FILE_MAGIC;
+	header.version = RETAINED_FILE_VERSION;
+	header.begin_ID = begin_ID;
+	header.count = static_cast<uint32_t>(count);
+	header.sequence = next;
+	header.data_checksum = Checksum(target, bytes);
+	header.header_checksum = HeaderChecksum(header);
+	memcpy(Header(next), &header, sizeof(header));
+	if (!Flush(Header(next), sizeof(header))) {
+		return false; }
+	sequence = next;
+	return true;
+}
+
+void MacroRetainedStorage::Close()
+{
+	if (IsOpen()) {
+		Checkpoint(); }
+	Unmap();
+}
+
+uint64_t MacroRetainedStorage::Checksum(const void* bytes, size_t size)
+{
+	const unsigned char* byte(static_cast<const unsigned char*>(bytes));
+	uint64_t hash(0xCBF29CE484222325ull);
+	for (size_t index = 0; index != size; ++index) {
+		hash ^= byte[index];
+		hash *= 0x100000001B3ull;
+	}
+	return hash;
+}
+
+uint64_t MacroRetainedStorage::HeaderChecksum(const MacroRetainedHeader& header)
+{
+	return Checksum(&header, offsetof(MacroRetainedHeader, header_checksum));
+}
+
+bool MacroRetainedStorage::ValidHeader(uint64_t slot)
+{
+	const MacroRetainedHeader& header(*Header(slot));
+	if (header.magic != RETAINED_FILE_MAGIC || header.version != RETAINED_FILE_VERSION || header.begin_ID != begin_ID || header.count != count) {
+		return false; }
+	if (header.sequence == 0 || header.sequence % 2 != slot || header.header_checksum != HeaderChecksum(header)) {
+		return false; }
+	//標頭於檢查點區寫回後才寫入,檢查點區須與標頭一致
+	return Checksum(CheckpointData(header.sequence), count * sizeof(double)) == header.data_checksum;
+}
+
+bool MacroRetainedStorage::Flush(void* address, size_t size)
+{
+#ifdef _WIN32
+	return FlushViewOfFile(address, size) && FlushFileBuffers(file);
+#else
+	//msync起始位址須對齊記憶頁
+	uintptr_t page(static_cast<uintptr_t>(sysconf(_SC_PAGESIZE)));
+	uintptr_t begin(reinterpret_cast<uintptr_t>(address) / page * page);
+	uintptr_t end(reinterpret_cast<uintptr_t>(address) + size);
+	return msync(reinterpret_cast<void*>(begin), end - begin, MS_SYNC) == 0;
+#endif
+}
+
+void MacroRetainedStorage::Unmap()
+{
+#ifdef _WIN32
+	if (base) {
+		UnmapViewOfFile(base); }
+	if (mapping) {
+		CloseHandle(mapping); }
+	if (file != INVALID_HANDLE_VALUE) {
+		CloseHandle(file); }
+	mapping = nullptr;
+	file = INVALID_HANDLE_VALUE;
+#else
+	if (base) {
+		munmap(base, mapped_size); }
+	if (file >= 0) {
+		close(file); }
+	file = -1;
+#endif
+	base = nullptr;
+	data = nullptr;
+	mapped_size = 0;
+	state = RETAINED_CLOSED;
+}
@@ -0,0 +1,77 @@
+﻿#include "MacroSequenceSearch.h"
+
+using namespace std;
+
+MacroSequenceSearch::MacroSequenceSearch(SystemParameter& parameter)
+	:program(nullptr),
+	system_parameter(parameter)
+{
+}
+
+void MacroSequenceSearch::Load(const MacroProgram& macro_program)
+{
+	program = &macro_program;
+	Clear();
+}
+
+void MacroSequenceSearch::Clear()
+{
+	variable_cache.clear();
+	history.fill(MacroSequenceHistory());
+	statistics = MacroSequenceStatistics();
+}
+
+size_t MacroSequenceSearch::Scan(int sequence_number) const
+{
+	const vector<MacroProgramBlock>& blocks(program->Blocks());
+	for (size_t index = 0; index != blocks.size(); ++index) {
+		if (blocks[index].sequence_number == sequence_number) {
+			return index; }
+	}
+	return NO_PROGRAM_BLOCK;
+}
+
+size_t MacroSequenceSearch::Find(size_t branch_block, int sequence_number)
+{
+	//不合法的序號不搜尋(避免與無序號單節的NO_SEQUENCE_NUMBER相符)
+	if (!program || sequence_number < 1) {
+		return NO_PROGRAM_BLOCK; }
+	//固定快取:常數序號已於載入時解析
+	if (system_parameter.sequence_cache_fixed && branch_block < program->Blocks().size()) {
+		size_t target(program->Blocks()[branch_block].branch_target);
+		if (target != NO_PROGRAM_BLOCK) {
+			++statistics.fixed_hits;
+			return target;
+		}
+	}
+	//搜尋記錄快取:同一分支單節重複跳至相同序號
+	MacroSequenceHistory& record(history[(branch_block * 31 + static_cast<unsigned>(sequence_number)) % SEQUENCE_HISTORY_SIZE]);
+	if (system_parameter.sequence_cache_history && record.branch_block == branch_block && record.sequence_number == sequence_number) {
+		++statistics.history_hits;
+		return record.target;
+	}
+	//變動快取
+	size_t target(NO_PROGRAM_BLOCK);
+	unordered_map<int, size_t>::const_iterator cached(variable_cache.end());
+	if (system_parameter.sequence_cache_variable) {
+		cached = variable_cache.find(sequence_number); }
+	if (cached != variable_cache.end()) {
+		++statistics.variable_hits;
+		target = cached->second;
+	}
+	else {
+		++statistics.scans;
+		target = Scan(sequence_number);
+		//不存在的序號不保存(發出警報後停止執行)
+		if (target == NO_PROGRAM_BLOCK) {
+			return target; }
+		if (system_parameter.sequence_cache_variable) {
+			variable_cache.emplace(sequence_number, target); }
+	}
+	if (system_parameter.sequence_cache_history) {
+		record.branch_block = branch_block;
+		record.sequence_number = sequence_number;
+		record.target = target;
+	}
+	return target;
+}
@@ -0,0 +1,323 @@
+﻿#include "MacroTranspiler.h"
+#include <cmath>
+#include <cstdio>
+#include <cctype>
+#include <bit>
+
+using namespace std;
+
+double MacroTranspiledRuntime::ReadVariable(MacroVariableInterface& macro_variable_interface, unsigned short variable_ID)
+{
+	double value(0.0);
+	if (macro_variable_interface.ReadVariable(variable_ID, value)) {
+		return value; }
+	else {
+		macro_variable_interface.RaiseAlarm(ALARM_VARIABLE_NOT_EXIST, nullptr, variable_ID);
+		return NULL_VARIABLE;
+	}
+}
+
+double MacroTranspiledRuntime::AssignVariable(MacroVariableInterface& macro_variable_interface, unsigned short variable_ID, double value)
+{
+	if (variable_ID == 0) {
+		macro_variable_interface.RaiseAlarm(ALARM_READ_ONLY_VARIABLE, nullptr); }
+	else {
+		macro_variable_interface.WriteVariable(variable_ID, value); }
+	return ReadVariable(macro_variable_interface, variable_ID);
+}
+
+bool MacroTranspiler::Identifier(string_view name)
+{
+	if (name.empty() || isdigit(static_cast<unsigned char>(name.front()))) {
+		return false; }
+	for (char c : name) {
+		if (!isalnum(static_cast<unsigned char>(c)) && c != '_') {
+			return false; }
+	}
+	return true;
+}
+
+string MacroTranspiler::Literal(double value)
+{
+	if (isnan(value)) {
+		return "std::numeric_limits<double>::quiet_NaN()"; }
+	else if (isinf(value)) {
+		return value < 0.0 ? "-std::numeric_limits<double>::infinity()" : "std::numeric_limits<double>::infinity()"; }
+	char buffer[64];
+	snprintf(buffer, sizeof(buffer), "%a", value);
+	return buffer;
+}
+
+bool MacroTranspiler::TranspileBytecode(const MacroBytecode& bytecode, string_view function_name, string& source)
+{
+	if (bytecode.Empty() || !Identifier(function_name)) {
+		return false; }
+	const vector<MacroInstruction>& code(bytecode.Code());
+	const vector<double>& constants(bytecode.Constants());
+
+	//跳躍目標(結束指令的跳躍直接返回,不需標籤)
+	vector<bool> labels(code.size() + 1, false);
+	for (const MacroInstruction& instruction : code) {
+		if ((instruction.opcode == OP_AND_SHORT_CIRCUIT || instruction.opcode == OP_OR_SHORT_CIRCUIT) && instruction.argument < code.size()) {
+			labels[instruction.argument] = true; }
+		else if (instruction.opcode == OP_JUMP_IF_FALSE && (instruction.argument >= code.size() || code[instruction.argument].opcode != OP_RETURN)) {
+			return false; }
+	}
+
+	//數值堆疊對應為區域變數s0..sN,共同子運算式對應為t0..tN
+	string body;
+	auto slot = [](size_t depth) {
+		return "s" + to_string(depth); };
+	auto line = [&body](const string& statement) {
+		body += "\t" + statement + "\n"; };
+	size_t depth(0);
+	for (size_t pc = 0; pc < code.size(); ++pc) {
+		const MacroInstruction& instruction(code[pc]);
+		if (labels[pc]) {
+			body += "L" + to_string(pc) + ":\n"; }
+		//運算元位置:堆疊頂端為a,其下為b
+		const string a(depth >= 1 ? slot(depth - 1) : string()), b(depth >= 2 ? slot(depth - 2) : string());
+		const string unsigned_a("static_cast<unsigned>(" + a + ")"), unsigned_b("static_cast<unsigned>(" + b + ")");
+		switch (instruction.opcode) {
+		case OP_CONSTANT:
+			line(slot(depth) + " = " + Literal(constants[instruction.argument]) + ";");
+			break;
+		case OP_MINUS:
+			line(a + " = -" + a + ";");
+			break;
+		case OP_VARIABLE:
+			line(a + " = MacroTranspiledRuntime::ReadVariable(macro_variable_interface, VariableID(" + a + "));");
+			break;
+		case OP_ADD:
+			line(b + " = " + b + " + " + a + ";");
+			break;
+		case OP_SUBTRACT:
+			line(b + " = " + b + " - " + a + ";");
+			break;
+		case OP_MULTIPLY:
+			line(b + " = " + b + " * " + a + ";");
+			break;
+		case OP_DIVIDE:
+			line(b + " = " + b + " / " + a + ";");
+			break;
+		case OP_ASSIGNMENT:
+			line(b + " = MacroTranspiledRuntime::AssignVariable(macro_variable_interface, VariableID(" + a + "), " + b + ");");
+			break;
+		case OP_SINE:
+			line(a + " = DegreeTrigonometry::Sine(" + a + ");");
+			break;
+		case OP_COSINE:
+			line(a + " = DegreeTrigonometry::Cosine(" + a + ");");
+			break;
+		case OP_TANGENT:
+			line(a + " = DegreeTrigonometry::Tangent(" + a + ");");
+			break;
+		case OP_ARC_SINE:
+			line(a + " = DegreeTrigonometry::ArcSine(" + a + ");");
+			break;
+		case OP_ARC_COSINE:
+			line(a + " = DegreeTrigonometry::ArcCosine(" + a + ");");
+			break;
+		case OP_ARC_TANGENT:
+			line(a + " = DegreeTrigonometry::ArcTangent(" + a + ");");
+			break;
+		case OP_ARC_TANGENT2:
+			line(b + " = DegreeTrigonometry::ArcTangent2(" + b + ", " + a + ");");
+			break;
+		case OP_SQUARE_ROOT:
+			line(a + " = std::sqrt(" + a + ");");
+			break;
+		case OP_ABSOLUTE_VALUE:
+			line(a + " = std::fabs(" + a + ");");
+			break;
+		case OP_BINARY_CODE:
+			line(a + " = BinaryCodeOperator::Convert(" + a + ");");
+			break;
+		case OP_BINARY_CODED_DECIMAL:
+			line(a + " = BinaryCodedDecimalOperator::Convert(" + a + ");");
+			break;
+		case OP_ROUND_OFF:
+			line(a + " = std::round(" + a + ");");
+			break;
+		case OP_ROUND_DOWN:
+			line(a + " = " + a + " < 0.0 ? std::ceil(" + a + ") : std::floor(" + a + ");");
+			break;
+		case OP_ROUND_UP:
+			line(a + " = " + a + " < 0.0 ? std::floor(" + a + ") : std::ceil(" + a + ");");
+			break;
+		case OP_NATURAL_LOG:
+			line(a + " = std::log(" + a + ");");
+			break;
+		case OP_EXPONENT:
+			line(a + " = std::exp(" + a + ");");
+			break;
+		case OP_POWER:
+			line(b + " = std::pow(" + b + ", " + a + ");");
+			break;
+		case OP_ADD_DECIMAL_POINT:
+			line(a + " = " + a + " / " + Literal(constants[instruction.argument]) + ";");
+			break;
+		case OP_EQUAL:
+			line(b + " = " + b + " == " + a + " ? 1.0 : 0.0;");
+			break;
+		case OP_NOT_EQUAL:
+			line(b + " = " + b + " != " + a + " ? 1.0 : 0.0;");
+			break;
+		case OP_GREATER:
+			line(b + " = " + b + " > " + a + " ? 1.0 : 0.0;");
+			break;
+		case OP_GREATER_EQUAL:
+			line(b + " = " + b + " >= " + a + " ? 1.0 : 0.0;");
+			break;
+		case OP_LESS:
+			line(b + " = " + b + " < " + a + " ? 1.0 : 0.0;");
+			break;
+		case OP_LESS_EQUAL:
+			line(b + " = " + b + " <= " + a + " ? 1.0 : 0.0;");
+			break;
+		case OP_AND:
+			line(b + " = static_cast<double>(" + unsigned_b + " & " + unsigned_a + ");");
+			break;
+		case OP_OR:
+			line(b + " = static_cast<double>(" + unsigned_b + " | " + unsigned_a + ");");
+			break;
+		case OP_XOR:
+			line(b + " = static_cast<double>(" + unsigned_b + " ^ " + unsigned_a + ");");
+			break;
+		case OP_JUMP_IF_FALSE:
+			//條件不成立時直接結束(取出條件值後的堆疊頂端為運算式值)
+			line("if (" + a + " == 0.0) {");
+			line("\tresult.condition = false;");
+			line("\tresult.value = " + (depth >= 2 ? b : string("0.0")) + ";");
+			line("\treturn result;");
+			line("}");
+			break;
+		case OP_BRANCH:
+			line("result.control = OP_BRANCH;");
+			line("result.number = BranchNumber(" + a + ");");
+			break;
+		case OP_LOOP:
+			line("result.control = OP_LOOP;");
+			line("result.number = static_cast<unsigned short>(" + a + ");");
+			break;
+		case OP_LOOP_END:
+			line("result.control = OP_LOOP_END;");
+			line("result.number = static_cast<unsigned short>(" + a + ");");
+			break;
+		case OP_RETURN:
+			line("result.value = " + (depth >= 1 ? a : string("0.0")) + ";");
+			line("return result;");
+			break;
+		case OP_LOAD_VARIABLE:
+			line(slot(depth) + " = MacroTranspiledRuntime::ReadVariable(macro_variable_interface, " + to_string(instruction.argument) + ");");
+			break;
+		case OP_STORE_VARIABLE:
+			line(a + " = MacroTranspiledRuntime::AssignVariable(macro_variable_interface, " + to_string(instruction.argument) + ", " + a + ");");
+			break;
+		case OP_STORE_TEMPORARY:
+			line("t" + to_string(instruction.argument) + " = " + a + ";");
+			break;
+		case OP_LOAD_TEMPORARY:
+			line(slot(depth) + " = t" + to_string(instruction.argument) + ";");
+			break;
+		case OP_AND_SHORT_CIRCUIT:
+			line("if (" + unsigned_a + " == 0) {");
+			line("\t" + a + " = 0.0;");
+			line("\tgoto L" + to_string(instruction.argument) + ";");
+			line("}");
+			break;
+		case OP_OR_SHORT_CIRCUIT:
+			line("if (" + a + " != 0.0) {");
+			line("\tgoto L" + to_string(instruction.argument) + ";");
+			line("}");
+			break;
+		default:
+			return false;
+		}
+		depth += MacroBytecode::StackEffect(instruction.opcode);
+	}
+
+	//區域變數於開頭宣告,跳躍不會略過初始化
+	source += "inline MacroBytecodeResult " + string(function_name) + "(MacroVariableInterface& macro_variable_interface)\n{\n";
+	source += "\tMacroBytecodeResult result;\n";
+	for (size_t i = 0; i < bytecode.StackDepth(); ++i) {
+		source += "\tdouble " + slot(i) + "(0.0);\n"; }
+	for (size_t i = 0; i < bytecode.TemporaryCount(); ++i) {
+		source += "\tdouble t" + to_string(i) + "(0.0);\n"; }
+	source += body;
+	source += "}\n";
+	return true;
+}
+
+bool MacroTranspiler::Transpile(const MacroProgram& program, string_view name, string& source)
+{
+	if (!Identifier(name)) {
+		return false; }
+	const vector<MacroProgramBlock>& blocks(program.Blocks());
+
+	//UTF-8 BOM(與專案原始檔相同,使中文註解不受編譯器預設字碼頁影響)
+	source = "\xEF\xBB\xBF//由MacroTranspiler產生的巨集程式,請勿直接修改\n";
+	source += "#pragma once\n\n";
+	source += "#include <cmath>\n#include <limits>\n#include \"MacroTranspiler.h\"\n#include \"DegreeTrigonometry.h\"\n\n";
+	source += "namespace " + string(name) + " {\n";
+	source += "//程式號碼\ninline const int program_number = " + to_string(program.ProgramNumber()) + ";\n\n";
+	string table;
+	for (size_t i = 0; i < blocks.size(); ++i) {
+		const MacroProgramBlock& block(blocks[i]);
+		string function("nullptr");
+		if (!block.bytecode.Empty()) {
+			//單節內容作為註解(反斜線會接續下一行)
+			string text(block.text);
+			for (char& c : text) {
+				if (c == '\\' || c == '\r' || c == '\n') {
+					c = ' '; }
+			}
+			source += "//" + text + "\n";
+			function = "Block" + to_string(i);
+			if (!TranspileBytecode(block.bytecode, function, source)) {
+				return false; }
+			source += "\n";
+			function = "&" + function;
+		}
+		table += "\tMacroTranspiledBlock(" + to_string(block.sequence_number) + ", " + function + "),\n";
+	}
+	source += "//單節表(索引與MacroProgram::Blocks()相同)\n";
+	if (blocks.empty()) {
+		source += "inline const MacroTranspiledBlock* const blocks = nullptr;\n"; }
+	else {
+		source += "inline const MacroTranspiledBlock blocks[] = {\n" + table + "};\n"; }
+	source += "//單節數量\ninline const size_t block_count = " + to_string(blocks.size()) + ";\n";
+	source += "}\n";
+	return true;
+}
+
+size_t MacroTranspiler::Validate(const MacroProgram& program, const MacroTranspiledBlock* blocks, size_t block_count,
+	MacroVariableInterface& interpreted, MacroVariableInterface& transpiled, const vector<unsigned short>& variables)
+{
+	const vector<MacroProgramBlock>& program_blocks(program.Blocks());
+	MacroVirtualMachine machine(interpreted);
+	for (size_t i = 0; i < program_blocks.size(); ++i) {
+		//單節表與程式不一致
+		if (i >= block_count) {
+			return i; }
+		const MacroProgramBlock& block(program_blocks[i]);
+		if (blocks[i].sequence_number != block.sequence_number || block.bytecode.Empty() != (blocks[i].function == nullptr)) {
+			return i; }
+		else if (block.bytecode.Empty()) {
+			continue; }
+
+		MacroBytecodeResult expected(machine.Run(block.bytecode)), result(blocks[i].function(transpiled));
+		if (expected.condition != result.condition || expected.control != result.control || expected.number != result.number ||
+			bit_cast<unsigned long long>(expected.value) != bit_cast<unsigned long long>(result.value)) {
+			return i; }
+		else if (interpreted.Alarm().code != transpiled.Alarm().code || interpreted.Alarm().variable_ID != transpiled.Alarm().variable_ID) {
+			return i; }
+		for (unsigned short variable_ID : variables) {
+			double expected_value(0.0), value(0.0);
+			if (interpreted.ReadVariable(variable_ID, expected_value) != transpiled.ReadVariable(variable_ID, value) ||
+				bit_cast<unsigned long long>(expected_value) != bit_cast<unsigned long long>(value)) {
+				return i; }
+		}
+	}
+	return block_count == program_blocks.size() ? NO_PROGRAM_BLOCK : program_blocks.size();
+}
@@ -1,5 +1,6 @@
 ﻿#include "MacroVariable.h"
 #include <stdexcept>
+#include <algorithm>
 
 using namespace std;
 
@@ -7,7 +8,7 @@ Variable::Variable(unsigned short begin_id, unsigned short end_id)
 	:begin_ID(begin_id), end_ID(end_id)
 {
 	if (end_ID < begin_ID) {
-		throw out_of_range("end_ID smaller than begin_ID.");
+		MACRO_THROW(out_of_range("end_ID smaller than begin_ID."));
 	}
 	else {
 		//指定容器元素量
@@ -38,9 +39,9 @@ bool Variable::ReadVariable(unsigned short variable_ID, double& value)
 
 bool Variable::WriteVariable(unsigned short variable_ID, double& value)
 {
+	//#0為唯讀(由呼叫端發出警報)
 	if (variable_ID == 0) {
-		throw runtime_error("runtime_error: variable #0 is read only");
-	}
+		return false; }
 	else if (InquiryVariableID(variable_ID)) {
 		variable_table[static_cast<vector<double>::size_type>(variable_ID - begin_ID)] = value;
 		return true;
@@ -49,20 +50,106 @@ bool Variable::WriteVariable(unsigned short variable_ID, double& value)
 		return false; }
 }
 
-bool ModalVariableLevel::CreateModalLevel(map<unsigned short, double>& arguments)
+bool LocalVariableFrame::ReadVariable(unsigned short variable_ID, double& value) const
+{
+	if (InquiryVariableID(variable_ID)) {
+		value = variable_table[variable_ID];
+		return true;
+	}
+	else {
+		return false; }
+}
+
+bool LocalVariableFrame::WriteVariable(unsigned short variable_ID, double& value)
+{
+	//#0為唯讀(由呼叫端發出警報)
+	if (variable_ID == 0) {
+		return false; }
+	else if (InquiryVariableID(variable_ID)) {
+		variable_table[variable_ID] = value;
+		return true;
+	}
+	else {
+		return false; }
+}
+
+LocalVariableFramePool::LocalVariableFramePool(size_t capacity)
+	:frames(capacity),
+	free_frames(capacity)
+{
+	//反向推入使先取用的框架位於容器前端
+	for (size_t index = capacity; index != 0; --index) {
+		free_frames.Push(&frames[index - 1]); }
+}
+
+LocalVariableFrame* LocalVariableFramePool::Take()
+{
+	//無可用框架
+	if (free_frames.Empty()) {
+		return nullptr; }
+	LocalVariableFrame* frame(free_frames.Top());
+	free_frames.Pop();
+	return frame;
+}
+
+LocalVariableFrame* LocalVariableFramePool::Acquire(const LocalVariableValues& arguments)
+{
+	LocalVariableFrame* frame(Take());
+	//整個引數陣列直接複製至框架
+	if (frame) {
+		frame->Assign(arguments); }
+	return frame;
+}
+
+LocalVariableFrame* LocalVariableFramePool::Acquire(map<unsigned short, double>& arguments)
 {
-	//新建變數群
-	Variable variable(0, 33);
-	//引數迭代器
-	map<unsigned short, double>::iterator iter(arguments.begin());
+	//#0為唯讀:於取用框架前檢查,避免寫入失敗時框架未歸還
+	if (arguments.count(0) != 0) {
+		return nullptr; }
+	LocalVariableFrame* frame(Take());
+	if (!frame) {
+		return nullptr; }
+	//清除前次呼叫留下的變數值
+	frame->Clear();
 	//迭代所有輸入引數
-	for (iter; iter != arguments.end(); ++iter) {
-		//以引數設定變數群初值
-		variable.WriteVariable(iter->first, iter->second); }
+	for (map<unsigned short, double>::iterator iter = arguments.begin(); iter != arguments.end(); ++iter) {
+		//以引數設定變數初值
+		frame->WriteVariable(iter->first, iter->second); }
+	return frame;
+}
+
+void LocalVariableLevels::Capture(LocalVariableStack stack, const LocalVariableFrameStack& frame_stack)
+{
+	stacks[stack].clear();
+	for (size_t level = 0; level != frame_stack.Size(); ++level) {
+		const LocalVariableFrame* frame(frame_stack.At(level));
+		size_t index(static_cast<size_t>(find(addresses.begin(), addresses.end(), frame) - addresses.begin()));
+		//首次出現的框架保存變數值
+		if (index == addresses.size()) {
+			addresses.push_back(frame);
+			frames.push_back(frame->Values());
+		}
+		stacks[stack].push_back(index);
+	}
+}
+
+ModalVariableLevel::ModalVariableLevel(LocalVariableFramePool& pool)
+	:frame_pool(pool),
+	modal_level(pool.Capacity()),
+	next_modal_level(pool.Capacity()),
+	previous_modal_level(pool.Capacity())
+{
+}
+
+bool ModalVariableLevel::PushModalLevel(LocalVariableFrame* frame)
+{
+	//框架池已無可用變數群
+	if (!frame) {
+		return false; }
 	//新增模式變數層
-	modal_level.push(variable);
+	modal_level.Push(frame);
 	//新變數層指標加入模式變數層清單內
-	next_modal_level.push(&modal_level.top());
+	next_modal_level.Push(frame);
 	
 	return true;
 }
@@ -70,14 +157,16 @@ bool ModalVariableLevel::CreateModalLevel(map<unsigned short, double>& arguments
 bool ModalVariableLevel::DeleteModalLevel()
 {
 	//模式變數層不存在
-	if (modal_level.empty()) {
+	if (modal_level.Empty()) {
 		return false; }
 	//有模式變數層
 	else {
+		//歸還模式變數層框架
+		frame_pool.Release(modal_level.Top());
 		//刪除模式變數層
-		modal_level.pop();
+		modal_level.Pop();
 		//刪除模式變數層指標
-		next_modal_level.pop();
+		next_modal_level.Pop();
 		return true;
 	}
 }
@@ -85,14 +174,14 @@ bool ModalVariableLevel::DeleteModalLevel()
 bool ModalVariableLevel::EnterModalLevel()
 {
 	//下一個模式變數層不存在
-	if (next_modal_level.empty()) {
+	if (next_modal_level.Empty()) {
 		return false; }
 	//有下一個模式變數層
 	else {
 		//下一個模式變數層指標暫存到上一模式變數層指標清單(返回時使用)
-		previous_modal_level.push(next_modal_level.top());
+		previous_modal_level.Push(next_modal_level.Top());
 		//刪除下一模式層指標
-		next_modal_level.pop();
+		next_modal_level.Pop();
 		return true;
 	}
 }
@@ -100,46 +189,72 @@ bool ModalVariableLevel::EnterModalLevel()
 bool ModalVariableLevel::ExitModalLevel()
 {
 	//先前模式變數層不存在
-	if (previous_modal_level.empty()) {
+	if (previous_modal_level.Empty()) {
 		return false; }
 	//有先前模式變數層
 	else {
 		//先前模式變數層指標回存至下一模式變數層指標清單
-		next_modal_level.push(previous_modal_level.top());
+		next_modal_level.Push(previous_modal_level.Top());
 		//刪除先前模式變數層指標
-		previous_modal_level.pop();
+		previous_modal_level.Pop();
 		return true;
 	}
 }
 
+void ModalVariableLevel::Capture(LocalVariableLevels& levels) const
+{
+	levels.Capture(STACK_MODAL_LEVEL, modal_level);
+	levels.Capture(STACK_NEXT_MODAL_LEVEL, next_modal_level);
+	levels.Capture(STACK_PREVIOUS_MODAL_LEVEL, previous_modal_level);
+}
+
+void ModalVariableLevel::Restore(const LocalVariableLevels& levels, const vector<LocalVariableFrame*>& frames)
+{
+	for (size_t index : levels.stacks[STACK_MODAL_LEVEL]) {
+		modal_level.Push(frames[index]); }
+	for (size_t index : levels.stacks[STACK_NEXT_MODAL_LEVEL]) {
+		next_modal_level.Push(frames[index]); }
+	for (size_t index : levels.stacks[STACK_PREVIOUS_MODAL_LEVEL]) {
+		previous_modal_level.Push(frames[index]); }
+}
+
 LocalVariable::LocalVariable(unsigned short level_max)
-	:variable_level_max(level_max)
+	:variable_level_max(level_max),
+	frame_pool(static_cast<size_t>(level_max) + 1),
+	local_variable(frame_pool.Capacity()),
+	variable_list(frame_pool.Capacity()),
+	current_frame(nullptr)
 {
+	LocalVariableValues arguments;
+	arguments.fill(NULL_VARIABLE);
 	//建立變數層level 0
-	local_variable.push(Variable(0, 33));
-	//更新變數層清單
-	variable_list.push(&local_variable.top());
+	CreateVariable(frame_pool.Acquire(arguments));
 }
 
 bool LocalVariable::ExitLevel()
 {
 	//返回錯誤:目前變數層已在最底層
-	if (local_variable.size() == 1) {
+	if (local_variable.Size() == 1) {
 		return false; }
 	//目前層數不在最底層
 	else {
-		//刪除最近變數層
-		local_variable.pop();
+		//歸還最近變數層框架
+		frame_pool.Release(local_variable.Top());
+		local_variable.Pop();
 		//更新變數層指標清單
-		variable_list.pop();
+		variable_list.Pop();
+		current_frame = variable_list.Top();
 		return true;
 	}
 }
 
-bool LocalVariable::EnterModalLevel(Variable* variable)
+bool LocalVariable::EnterModalLevel(LocalVariableFrame* frame)
 {
+	//模式變數層不存在或超出最大層數
+	if (!frame || !variable_list.Push(frame)) {
+		return false; }
 	//新變數層指標加入清單內
-	variable_list.push(variable);
+	current_frame = frame;
 	
 	return true;
 }
@@ -147,38 +262,66 @@ bool LocalVariable::EnterModalLevel(Variable* variable)
 bool LocalVariable::ExitModalLevel()
 {
 	//返回錯誤:目前變數層已在最底層
-	if (variable_list.size() == 1) {
+	if (variable_list.Size() == 1) {
 		return false; }
 	//目前層數不在最底層
 	else {
 		//更新變數層指標清單
-		variable_list.pop();
+		variable_list.Pop();
+		current_frame = variable_list.Top();
 		return true;
 	}
 }
 
-bool LocalVariable::CreateVariable(map<unsigned short, double>& arguments)
+bool LocalVariable::CreateVariable(LocalVariableFrame* frame)
 {
-	//變數層暫存
-	Variable temp_variable(0, 33);
-	//引數迭代器
-	map<unsigned short, double>::iterator iter(arguments.begin());
-	//迭代所有輸入引數
-	for (iter; iter != arguments.end(); ++iter) {
-		//以引數設定變數初值
-		temp_variable.WriteVariable(iter->first, iter->second); }
+	//框架池已無可用變數層
+	if (!frame) {
+		return false; }
 	//新增變數層
-	local_variable.push(temp_variable);
+	local_variable.Push(frame);
 	//新變數層指標加入清單內
-	variable_list.push(&local_variable.top());
+	variable_list.Push(frame);
+	current_frame = frame;
 	
 	return true;
 }
 
-CommonVariable::CommonVariable(unsigned short low_begin_ID, unsigned short low_end_ID, unsigned short high_begin_ID, unsigned short high_end_ID)
+void LocalVariable::Capture(LocalVariableLevels& levels) const
+{
+	levels.Capture(STACK_LOCAL_LEVEL, local_variable);
+	levels.Capture(STACK_LEVEL_LIST, variable_list);
+}
+
+void LocalVariable::Restore(const LocalVariableLevels& levels, ModalVariableLevel& modal_variable_level)
+{
+	//歸還目前的局部變數層框架(模式層須為空)
+	while (!local_variable.Empty()) {
+		frame_pool.Release(local_variable.Top());
+		local_variable.Pop();
+	}
+	while (!variable_list.Empty()) {
+		variable_list.Pop(); }
+	//每個快照框架取用一個框架,各堆疊依框架索引推入
+	vector<LocalVariableFrame*> frames;
+	for (const LocalVariableValues& values : levels.frames) {
+		frames.push_back(frame_pool.Acquire(values)); }
+	for (size_t index : levels.stacks[STACK_LOCAL_LEVEL]) {
+		local_variable.Push(frames[index]); }
+	for (size_t index : levels.stacks[STACK_LEVEL_LIST]) {
+		variable_list.Push(frames[index]); }
+	modal_variable_level.Restore(levels, frames);
+	current_frame = variable_list.Top();
+}
+
+CommonVariable::CommonVariable(unsigned short low_begin_ID, unsigned short low_end_ID, unsigned short high_begin_ID, unsigned short high_end_ID, const string& retained_file)
 	:lower_variable(low_begin_ID, low_end_ID),
-	higher_variable(high_begin_ID, high_end_ID)
+	higher_variable(high_begin_ID, high_end_ID),
+	higher_begin_ID(high_begin_ID)
 {
+	//開啟失敗時高變數群維持在記憶體
+	if (!retained_file.empty()) {
+		retained_storage.Open(retained_file, high_begin_ID, high_end_ID, NULL_VARIABLE); }
 }
 
 bool CommonVariable::InquiryVariableID(unsigned short variable_ID)
@@ -193,148 +336,458 @@ bool CommonVariable::InquiryVariableID(unsigned short variable_ID)
 
 bool CommonVariable::ReadVariable(unsigned short variable_ID, double& value)
 {
-	if (lower_variable.InquiryVariableID(variable_ID)) {
-		return lower_variable.ReadVariable(variable_ID, value); }
-	else if (higher_variable.InquiryVariableID(variable_ID)) {
-		return higher_variable.ReadVariable(variable_ID, value); }
-	else {
+	double* address(Address(variable_ID));
+	if (!address) {
 		return false; }
+	value = *address;
+	return true;
 }
 
 bool CommonVariable::WriteVariable(unsigned short variable_ID, double& value)
+{
+	double* address(Address(variable_ID));
+	if (!address) {
+		return false; }
+	*address = value;
+	return true;
+}
+
+double* CommonVariable::Address(unsigned short variable_ID)
 {
 	if (lower_variable.InquiryVariableID(variable_ID)) {
-		return lower_variable.WriteVariable(variable_ID, value);
-	}
-	else if (higher_variable.InquiryVariableID(variable_ID)) {
-		return higher_variable.WriteVariable(variable_ID, value);
-	}
+		return lower_variable.Address(variable_ID); }
+	//保存的高變數群直接存放於映射區
+	else if (retained_storage.IsOpen()) {
+		return higher_variable.InquiryVariableID(variable_ID) ? retained_storage.Data() + (variable_ID - higher_begin_ID) : nullptr; }
 	else {
-		return false;
-	}
+		return higher_variable.Address(variable_ID); }
 }
 
 SystemVariable::SystemVariable(SystemParameter& parameter)
-	:system_parameter(parameter)
-{
-	SetVariableID(3003, &system_parameter.suppress_single_block_stop_wait_auxiliary_function);
-	SetVariableID(4201, &system_parameter.current_modal_parameter.motion_command);
-	SetVariableID(4202, &system_parameter.current_modal_parameter.working_plane);
-	SetVariableID(4203, &system_parameter.current_modal_parameter.coordinate_value_type);
-	SetVariableID(4205, &system_parameter.current_modal_parameter.feed_rate_type);
-	SetVariableID(4206, &system_parameter.current_modal_parameter.system_unit);
-	SetVariableID(4207, &system_parameter.current_modal_parameter.tool_radius_compensation);
-	SetVariableID(4208, &system_parameter.current_modal_parameter.tool_length_compensation);
-	SetVariableID(4209, &system_parameter.current_modal_parameter.canned_cycle_mode);
-	SetVariableID(4210, &system_parameter.current_modal_parameter.canned_cycle_retract_plane);
-	SetVariableID(4211, &system_parameter.current_modal_parameter.scale_mode);
-	SetVariableID(4212, &system_parameter.current_modal_parameter.macro_mode);
-	SetVariableID(4213, &system_parameter.current_modal_parameter.spindle_speed_mode);
-	SetVariableID(4214, &system_parameter.current_modal_parameter.working_coordinate_system);
-	SetVariableID(4215, &system_parameter.current_modal_parameter.corner_mode);
-	SetVariableID(4216, &system_parameter.current_modal_parameter.coordinate_system_rotation);
-
-	SetVariableID(4302, &system_parameter.current_modal_parameter.B_code);
-	SetVariableID(4307, &system_parameter.current_modal_parameter.D_code);
-	SetVariableID(4308, &system_parameter.current_modal_parameter.E_code);
-	SetVariableID(4309, &system_parameter.current_modal_parameter.F_code);
-	SetVariableID(4311, &system_parameter.current_modal_parameter.H_code);
-	SetVariableID(4313, &system_parameter.current_modal_parameter.M_code);
-	SetVariableID(4314, &system_parameter.current_modal_parameter.sequence_number);
-	SetVariableID(4315, &system_parameter.current_modal_parameter.program_number);
-	SetVariableID(4319, &system_parameter.current_modal_parameter.S_code);
-	SetVariableID(4320, &system_parameter.current_modal_parameter.T_code);
-	SetVariableID(4330, &system_parameter.current_modal_parameter.P_code);
-
-	SetVariableID(5001, &system_parameter.preview_program_position.axis_X);
-	SetVariableID(5002, &system_parameter.preview_program_position.axis_Y);
-	SetVariableID(5003, &system_parameter.preview_program_position.axis_Z);
-	SetVariableID(5114, &system_parameter.peck_drilling_retraction);
-	SetVariableID(5115, &system_parameter.peck_drilling_clearance);
-	SetVariableID(5148, &system_parameter.boring_shift_direction);
-}
-
-bool SystemVariable::InquiryVariableID(unsigned short variable_ID)
-{
-	if (table_unsigned_short.count(variable_ID)) {
-		return true; }
-	else if (table_int.count(variable_ID)) {
-		return true; }
-	else {
-		return false; }
+	:system_parameter(nullptr)
+{
+	not_exist_slot.type = SLOT_NOT_EXIST;
+	Bind(parameter);
+}
+
+void SystemVariable::Bind(SystemParameter& parameter)
+{
+	system_parameter = &parameter;
+	registry.clear();
+	SetVariableID(3003, &parameter.suppress_single_block_stop_wait_auxiliary_function);
+	SetVariableID(4201, &parameter.current_modal_parameter.motion_command);
+	SetVariableID(4202, &parameter.current_modal_parameter.working_plane);
+	SetVariableID(4203, &parameter.current_modal_parameter.coordinate_value_type);
+	SetVariableID(4205, &parameter.current_modal_parameter.feed_rate_type);
+	SetVariableID(4206, &parameter.current_modal_parameter.system_unit);
+	SetVariableID(4207, &parameter.current_modal_parameter.tool_radius_compensation);
+	SetVariableID(4208, &parameter.current_modal_parameter.tool_length_compensation);
+	SetVariableID(4209, &parameter.current_modal_parameter.canned_cycle_mode);
+	SetVariableID(4210, &parameter.current_modal_parameter.canned_cycle_retract_plane);
+	SetVariableID(4211, &parameter.current_modal_parameter.scale_mode);
+	SetVariableID(4212, &parameter.current_modal_parameter.macro_mode);
+	SetVariableID(4213, &parameter.current_modal_parameter.spindle_speed_mode);
+	SetVariableID(4214, &parameter.current_modal_parameter.working_coordinate_system);
+	SetVariableID(4215, &parameter.current_modal_parameter.corner_mode);
+	SetVariableID(4216, &parameter.current_modal_parameter.coordinate_system_rotation);
+
+	SetVariableID(4302, &parameter.current_modal_parameter.B_code);
+	SetVariableID(4307, &parameter.current_modal_parameter.D_code);
+	SetVariableID(4308, &parameter.current_modal_parameter.E_code);
+	SetVariableID(4309, &parameter.current_modal_parameter.F_code);
+	SetVariableID(4311, &parameter.current_modal_parameter.H_code);
+	SetVariableID(4313, &parameter.current_modal_parameter.M_code);
+	SetVariableID(4314, &parameter.current_modal_parameter.sequence_number);
+	SetVariableID(4315, &parameter.current_modal_parameter.program_number);
+	SetVariableID(4319, &parameter.current_modal_parameter.S_code);
+	SetVariableID(4320, &parameter.current_modal_parameter.T_code);
+	SetVariableID(4330, &parameter.current_modal_parameter.P_code);
+
+	SetVariableID(5001, &parameter.preview_program_position.axis_X);
+	SetVariableID(5002, &parameter.preview_program_position.axis_Y);
+	SetVariableID(5003, &parameter.preview_program_position.axis_Z);
+	SetVariableID(5114, &parameter.peck_drilling_retraction);
+	SetVariableID(5115, &parameter.peck_drilling_clearance);
+	SetVariableID(5148, &parameter.boring_shift_direction);
+
+	//刀具補正值(#2001起,補正表為固定容量陣列,元素位址固定)
+	for (unsigned short offset_ID = 1; offset_ID <= TOOL_LENGTH_REGISTER_MAX; ++offset_ID) {
+		SetVariableID(static_cast<unsigned short>(SYSTEM_VARIABLE_TOOL_OFFSET + offset_ID), &parameter.tool_length_offset_table[offset_ID]); }
+	//機械座標位置(唯讀)
+	SetVariableID(SYSTEM_VARIABLE_MACHINE_POSITION, static_cast<const double*>(&parameter.machine_coordinate.axis_X));
+	SetVariableID(SYSTEM_VARIABLE_MACHINE_POSITION + 1, static_cast<const double*>(&parameter.machine_coordinate.axis_Y));
+	SetVariableID(SYSTEM_VARIABLE_MACHINE_POSITION + 2, static_cast<const double*>(&parameter.machine_coordinate.axis_Z));
+	SetVariableID(SYSTEM_VARIABLE_MACHINE_POSITION + 3, static_cast<const double*>(&parameter.machine_coordinate.axis_B));
+	//工件座標位置(唯讀)
+	SetVariableID(SYSTEM_VARIABLE_PROGRAM_POSITION, parameter.program_coordinate_system.axis_X.PositionAddress());
+	SetVariableID(SYSTEM_VARIABLE_PROGRAM_POSITION + 1, parameter.program_coordinate_system.axis_Y.PositionAddress());
+	SetVariableID(SYSTEM_VARIABLE_PROGRAM_POSITION + 2, parameter.program_coordinate_system.axis_Z.PositionAddress());
+	SetVariableID(SYSTEM_VARIABLE_PROGRAM_POSITION + 3, parameter.program_coordinate_system.axis_B.PositionAddress());
+	//G54-G59工作座標系原點
+	for (unsigned short working_system_ID = 54; working_system_ID <= 59; ++working_system_ID) {
+		SetCoordinateID(static_cast<unsigned short>(SYSTEM_VARIABLE_WORK_OFFSET + (working_system_ID - 54) * SYSTEM_VARIABLE_WORK_OFFSET_STEP),
+			*parameter.working_coordinate_system.SystemPosition(working_system_ID)); }
+}
+
+void SystemVariable::Register(unsigned short variable_ID, MacroVariableSlotType type, void* variable)
+{
+	if (variable_ID < SYSTEM_VARIABLE_BEGIN) {
+		MACRO_THROW(out_of_range("system variable ID smaller than SYSTEM_VARIABLE_BEGIN.")); }
+	vector<MacroVariableSlot>::size_type index(variable_ID - SYSTEM_VARIABLE_BEGIN);
+	if (registry.size() <= index) {
+		registry.resize(index + 1, not_exist_slot); }
+	//重複登錄時保留第一個
+	if (registry[index].type == SLOT_NOT_EXIST) {
+		registry[index].type = type;
+		registry[index].variable_ID = variable_ID;
+		registry[index].value = static_cast<double*>(variable);
+	}
+}
+
+void SystemVariable::SetCoordinateID(unsigned short variable_ID, Coordinate& coordinate)
+{
+	SetVariableID(variable_ID, &coordinate.axis_X);
+	SetVariableID(variable_ID + 1, &coordinate.axis_Y);
+	SetVariableID(variable_ID + 2, &coordinate.axis_Z);
+	SetVariableID(variable_ID + 3, &coordinate.axis_B);
 }
 
 bool SystemVariable::ReadVariable(unsigned short variable_ID, double& value)
 {
-	if (table_unsigned_short.count(variable_ID)) {
-		value = static_cast<double>(*table_unsigned_short[variable_ID]);
+	const MacroVariableSlot& slot(Entry(variable_ID));
+	switch (slot.type) {
+	case SLOT_SYSTEM_UNSIGNED_SHORT:
+		value = static_cast<double>(*slot.value_unsigned_short);
 		return true;
-	}
-	else if (table_int.count(variable_ID)) {
-		value = static_cast<double>(*table_int[variable_ID]);
+	case SLOT_SYSTEM_INT:
+		value = static_cast<double>(*slot.value_int);
 		return true;
-	}
-	else if (table_double.count(variable_ID)) {
-		value = static_cast<double>(*table_double[variable_ID]);
+	case SLOT_SYSTEM_DOUBLE:
+	case SLOT_SYSTEM_READ_ONLY:
+		value = *slot.value;
 		return true;
+	default:
+		return false;
 	}
-	else {
-		return false; }
 }
 
 bool SystemVariable::WriteVariable(unsigned short variable_ID, double& value)
 {
-	if (table_unsigned_short.count(variable_ID)) {
-		*table_unsigned_short[variable_ID] = static_cast<unsigned short>(value);
+	const MacroVariableSlot& slot(Entry(variable_ID));
+	switch (slot.type) {
+	case SLOT_SYSTEM_UNSIGNED_SHORT:
+		*slot.value_unsigned_short = static_cast<unsigned short>(value);
 		return true;
+	case SLOT_SYSTEM_INT:
+		*slot.value_int = static_cast<unsigned int>(value);
+		return true;
+	case SLOT_SYSTEM_DOUBLE:
+		*slot.value = value;
+		return true;
+	default:
+		return false;
 	}
-	else if (table_int.count(variable_ID)) {
-		*table_int[variable_ID] = static_cast<unsigned int>(value);
+}
+
+bool SystemVariable::ResolveVariable(unsigned short variable_ID, MacroVariableSlot& slot)
+{
+	const MacroVariableSlot& entry(Entry(variable_ID));
+	if (entry.type == SLOT_NOT_EXIST) {
+		return false; }
+	slot = entry;
+	return true;
+}
+
+bool MacroVariableSnapshot::ReadVariable(unsigned short variable_ID, double& value) const
+{
+	if (variable_ID < LOCAL_VARIABLE_COUNT) {
+		value = levels.CurrentValues()[variable_ID];
 		return true;
 	}
-	else if (table_double.count(variable_ID)) {
-		*table_double[variable_ID] = value;
+	else if (layout.Common(variable_ID)) {
+		value = (*pages[variable_ID / MACRO_VARIABLE_PAGE_SIZE])[variable_ID % MACRO_VARIABLE_PAGE_SIZE];
 		return true;
 	}
 	else {
 		return false; }
 }
 
-MacroVariableInterface::MacroVariableInterface(SystemParameter& system_parameter)
+MacroVariableInterface::MacroVariableInterface(SystemParameter& system_parameter, const MacroVariableLayout& variable_layout)
+	:local_variable(5),
+	common_variable(variable_layout.common_lower.begin_ID, variable_layout.common_lower.end_ID, variable_layout.common_higher.begin_ID, variable_layout.common_higher.end_ID, variable_layout.retained_file),
+	system_variable(system_parameter),
+	modal_variable_level(local_variable.FramePool()),
+	generation(1),
+	alarm_mode(!MACRO_EXCEPTIONS),
+	layout(variable_layout),
+	retained_pending(false)
+{
+	BuildDispatchTable();
+}
+
+MacroVariableInterface::MacroVariableInterface(const MacroVariableSnapshot& snapshot)
 	:local_variable(5),
-	common_variable(100, 199, 500, 999),
-	system_variable(system_parameter)
+	//分岔不開啟保存映射檔
+	common_variable(snapshot.layout.common_lower.begin_ID, snapshot.layout.common_lower.end_ID, snapshot.layout.common_higher.begin_ID, snapshot.layout.common_higher.end_ID),
+	//系統變數於首次寫入前讀取共享的系統參數(系統變數以SLOT_SYSTEM_FORK存取,寫入前先複製,不經由登錄表寫入共享複本)
+	system_variable(const_cast<SystemParameter&>(*snapshot.system_parameter)),
+	modal_variable_level(local_variable.FramePool()),
+	generation(1),
+	alarm_mode(!MACRO_EXCEPTIONS),
+	layout(snapshot.layout),
+	common_pages(snapshot.pages),
+	retained_pending(false),
+	shared_parameter(snapshot.system_parameter)
 {
+	//還原快照時G65/G66呼叫中的所有變數層
+	local_variable.Restore(snapshot.levels, modal_variable_level);
+	BuildDispatchTable();
 }
 
-bool MacroVariableInterface::ReadVariable(unsigned short variable_ID, double& value)
+SystemParameter& MacroVariableInterface::WritableParameter()
 {
-	if (local_variable.ReadVariable(variable_ID, value)) {
-		return true; }
-	else if (common_variable.ReadVariable(variable_ID, value)) {
-		return true; }
-	else if (system_variable.ReadVariable(variable_ID, value)) {
-		return true; }
-	else {
+	//首次取用時複製共享的系統參數,重新連結系統變數並啟用模擬
+	if (shared_parameter && !forked_parameter) {
+		forked_parameter = make_unique<SystemParameter>(*shared_parameter);
+		forked_parameter->operation_parameter.simulation_on = true;
+		system_variable.Bind(*forked_parameter);
+	}
+	return system_variable.Parameter();
+}
+
+bool MacroVariableInterface::CheckpointRetained()
+{
+	if (!common_variable.RetainedStorage().Checkpoint()) {
 		return false; }
+	retained_pending = false;
+	return true;
+}
+
+MacroVariableSnapshot MacroVariableInterface::Snapshot()
+{
+	MacroVariableSnapshot snapshot(layout);
+	local_variable.Capture(snapshot.levels);
+	modal_variable_level.Capture(snapshot.levels);
+	//未寫入系統變數的分岔沿用共享的系統參數
+	if (shared_parameter && !forked_parameter) {
+		snapshot.system_parameter = shared_parameter; }
+	else {
+		snapshot.system_parameter = make_shared<const SystemParameter>(system_variable.Parameter()); }
+	//分岔介面:快照與分岔共享目前分頁,之後寫入時複製
+	if (Forked()) {
+		snapshot.pages = common_pages;
+		return snapshot;
+	}
+	//未寫入的分頁沿用上次快照,僅複製寫入過的分頁
+	for (size_t page = 0; page != dirty_pages.size(); ++page) {
+		if (!dirty_pages[page]) {
+			continue; }
+		dirty_pages[page] = false;
+		MacroVariablePage values;
+		bool common(false);
+		for (unsigned short offset = 0; offset != MACRO_VARIABLE_PAGE_SIZE; ++offset) {
+			unsigned short variable_ID(static_cast<unsigned short>(page * MACRO_VARIABLE_PAGE_SIZE + offset));
+			common = layout.Common(variable_ID) || common;
+			values[offset] = layout.Common(variable_ID) ? *common_variable.Address(variable_ID) : NULL_VARIABLE;
+		}
+		snapshot_pages[page] = common ? make_shared<MacroVariablePage>(values) : nullptr;
+	}
+	snapshot.pages = snapshot_pages;
+	return snapshot;
+}
+
+void MacroVariableInterface::BuildDispatchTable()
+{
+	not_exist_slot.type = SLOT_NOT_EXIST;
+	//分派表涵蓋至最大的已配置變數編號
+	unsigned short last_ID(max<unsigned short>(common_variable.LastVariableID(), system_variable.LastVariableID()));
+	dispatch_table.reserve(static_cast<vector<MacroVariableSlot>::size_type>(last_ID) + 1);
+	for (unsigned int variable_ID = 0; variable_ID <= last_ID; ++variable_ID) {
+		dispatch_table.push_back(ResolveStorage(static_cast<unsigned short>(variable_ID))); }
+	//快照分頁涵蓋至最大的共同變數編號(尚未建立快照,所有分頁視為已寫入)
+	size_t pages(static_cast<size_t>(common_variable.LastVariableID()) / MACRO_VARIABLE_PAGE_SIZE + 1);
+	snapshot_pages.assign(pages, nullptr);
+	dirty_pages.assign(pages, true);
+}
+
+void MacroVariableInterface::RaiseAlarm(MacroAlarmCode code, const void* node, unsigned short variable_ID)
+{
+#if MACRO_EXCEPTIONS
+	if (!alarm_mode) {
+		switch (code) {
+		case ALARM_VARIABLE_NOT_EXIST:
+			throw out_of_range("out_of_range: the variable ID is not exist.");
+		case ALARM_READ_ONLY_VARIABLE:
+			throw runtime_error("runtime_error: variable #0 is read only");
+		case ALARM_NULL_OPERAND:
+			throw invalid_argument("invalid argument: right operand is null.");
+		case ALARM_LOOP_NESTING:
+			throw logic_error("logic_error: DO and END are not matched.");
+		case ALARM_LOOP_WATCHDOG:
+			throw runtime_error("runtime_error: the loop iteration limit is exceeded.");
+		case ALARM_SEQUENCE_NOT_EXIST:
+			throw out_of_range("out_of_range: the sequence number is not exist.");
+		default:
+			throw invalid_argument("invalid_argument: the node opcode is not an operator.");
+		}
+	}
+#endif
+	//後續警報多由第一個警報引起,僅保留第一個
+	if (alarm.code == ALARM_NONE) {
+		alarm = MacroAlarm(code, node, variable_ID); }
 }
 
 bool MacroVariableInterface::WriteVariable(unsigned short variable_ID, double& value)
 {
-	if (local_variable.WriteVariable(variable_ID, value)) {
-		return true; }
-	else if (common_variable.WriteVariable(variable_ID, value)) {
-		return true; }
-	else if (system_variable.WriteVariable(variable_ID, value)) {
-		return true; }
+	//寫入後先前核算的共同子運算式不再有效
+	++generation;
+	//警報後停止寫入(與程式停止相同)
+	if (alarm.code != ALARM_NONE) {
+		return false; }
+	else if (variable_ID == 0) {
+		RaiseAlarm(ALARM_READ_ONLY_VARIABLE, nullptr);
+		return false;
+	}
 	else {
+		return Store(Slot(variable_ID), value); }
+}
+
+MacroVariableSlot MacroVariableInterface::ResolveStorage(unsigned short variable_ID)
+{
+	MacroVariableSlot slot;
+	slot.variable_ID = variable_ID;
+	//不合法的變數ID不對應任何變數
+	if (variable_ID == INVALID_VARIABLE_ID) {
+		slot.type = SLOT_NOT_EXIST; }
+	//局部變數層於呼叫巨集時切換,僅記錄變數ID
+	else if (local_variable.InquiryVariableID(variable_ID)) {
+		slot.type = SLOT_LOCAL; }
+	//分岔介面的共同變數依分頁存取
+	else if (Forked() && layout.Common(variable_ID)) {
+		slot.type = SLOT_COMMON_PAGE; }
+	//分岔介面的系統變數依目前連結的系統參數存取
+	else if (Forked() && system_variable.InquiryVariableID(variable_ID)) {
+		slot.type = SLOT_SYSTEM_FORK; }
+	else if ((slot.value = common_variable.Address(variable_ID)) != nullptr) {
+		slot.type = SLOT_COMMON; }
+	else if (!system_variable.ResolveVariable(variable_ID, slot)) {
+		slot.type = SLOT_NOT_EXIST; }
+	return slot;
+}
+
+bool MacroVariableInterface::Load(const MacroVariableSlot& slot, double& value)
+{
+	switch (slot.type) {
+	case SLOT_LOCAL:
+		value = *local_variable.Address(slot.variable_ID);
+		return true;
+	case SLOT_COMMON:
+	case SLOT_SYSTEM_DOUBLE:
+	case SLOT_SYSTEM_READ_ONLY:
+		value = *slot.value;
+		return true;
+	case SLOT_SYSTEM_UNSIGNED_SHORT:
+		value = static_cast<double>(*slot.value_unsigned_short);
+		return true;
+	case SLOT_SYSTEM_INT:
+		value = static_cast<double>(*slot.value_int);
+		return true;
+	case SLOT_COMMON_PAGE:
+		value = (*common_pages[slot.variable_ID / MACRO_VARIABLE_PAGE_SIZE])[slot.variable_ID % MACRO_VARIABLE_PAGE_SIZE];
+		return true;
+	case SLOT_SYSTEM_FORK:
+		return system_variable.ReadVariable(slot.variable_ID, value);
+	default:
+		return false;
+	}
+}
+
+bool MacroVariableInterface::Store(const MacroVariableSlot& slot, double& value)
+{
+	switch (slot.type) {
+	case SLOT_LOCAL:
+		*local_variable.Address(slot.variable_ID) = value;
+		return true;
+	case SLOT_COMMON:
+		//記錄寫入的分頁(下次快照重新複製)及保存變數(下次提交時建立檢查點)
+		dirty_pages[slot.variable_ID / MACRO_VARIABLE_PAGE_SIZE] = true;
+		retained_pending = retained_pending || (layout.common_higher.Contains(slot.variable_ID) && common_variable.RetainedStorage().IsOpen());
+		*slot.value = value;
+		return true;
+	case SLOT_SYSTEM_DOUBLE:
+		*slot.value = value;
+		return true;
+	case SLOT_SYSTEM_UNSIGNED_SHORT:
+		*slot.value_unsigned_short = static_cast<unsigned short>(value);
+		return true;
+	case SLOT_SYSTEM_INT:
+		*slot.value_int = static_cast<unsigned int>(value);
+		return true;
+	case SLOT_SYSTEM_READ_ONLY:
+		RaiseAlarm(ALARM_READ_ONLY_VARIABLE, nullptr, slot.variable_ID);
+		return false;
+	case SLOT_COMMON_PAGE:
+		WritablePage(slot.variable_ID)[slot.variable_ID % MACRO_VARIABLE_PAGE_SIZE] = value;
+		return true;
+	case SLOT_SYSTEM_FORK: {
+		MacroVariableSlot entry;
+		system_variable.ResolveVariable(slot.variable_ID, entry);
+		//唯讀變數發出警報而不複製系統參數,其餘先複製再依新的登錄表寫入
+		if (entry.type != SLOT_SYSTEM_READ_ONLY) {
+			WritableParameter();
+			system_variable.ResolveVariable(slot.variable_ID, entry);
+		}
+		return Store(entry, value);
+	}
+	default:
+		return false;
+	}
+}
+
+MacroVariablePage& MacroVariableInterface::WritablePage(unsigned short variable_ID)
+{
+	shared_ptr<MacroVariablePage>& page(common_pages[variable_ID / MACRO_VARIABLE_PAGE_SIZE]);
+	//分頁仍與快照共享時先複製
+	if (page.use_count() > 1) {
+		page = make_shared<MacroVariablePage>(*page); }
+	return *page;
+}
+
+bool MacroVariableInterface::ReadVariable(const MacroVariableSlot& slot, double& value)
+{
+	//未解析的位置依變數ID查詢分派表
+	return Load(slot.Resolved() ? slot : Slot(slot.variable_ID), value);
+}
+
+bool MacroVariableInterface::WriteVariable(const MacroVariableSlot& slot, double& value)
+{
+	if (!slot.Resolved()) {
+		return WriteVariable(slot.variable_ID, value); }
+	//警報後停止寫入
+	if (alarm.code != ALARM_NONE) {
 		return false; }
+	//#0禁止寫入
+	if (slot.type == SLOT_LOCAL && slot.variable_ID == 0) {
+		RaiseAlarm(ALARM_READ_ONLY_VARIABLE, nullptr);
+		return false;
+	}
+	++generation;
+	return Store(slot, value);
 }
 
 bool MacroVariableInterface::EnterLevel(map<unsigned short, double>& arguments)
 {
 	//檢查新增變數層是否會超出最大層數限制
-	if (local_variable.TotalLevel() + modal_variable_level.TotalLevel() == local_variable.TotalLevelMax()) {
+	if (!LevelAvailable()) {
+		return false; }
+	else {
+		return local_variable.EnterLevel(arguments); }
+}
+
+bool MacroVariableInterface::EnterLevel(const LocalVariableValues& arguments)
+{
+	//檢查新增變數層是否會超出最大層數限制
+	if (!LevelAvailable()) {
 		return false; }
 	else {
 		return local_variable.EnterLevel(arguments); }
@@ -343,13 +796,22 @@ bool MacroVariableInterface::EnterLevel(map<unsigned short, double>& arguments)
 bool MacroVariableInterface::CreateModalLevel(map<unsigned short, double>& arguments)
 {
 	//檢查新增變數層是否會超出最大層數限制
-	if (local_variable.TotalLevel() + modal_variable_level.TotalLevel() == local_variable.TotalLevelMax()) {
+	if (!LevelAvailable()) {
 		return false; }
 	else {
 		//嘗試建立模式變數層並回傳結果
 		return modal_variable_level.CreateModalLevel(arguments); }
 }
 
+bool MacroVariableInterface::CreateModalLevel(const LocalVariableValues& arguments)
+{
+	//檢查新增變數層是否會超出最大層數限制
+	if (!LevelAvailable()) {
+		return false; }
+	else {
+		return modal_variable_level.CreateModalLevel(arguments); }
+}
+
 bool MacroVariableInterface::EnterModalLevel()
 {
 	//局部變數群進入模式變數層
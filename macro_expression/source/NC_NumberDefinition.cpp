@@ -141,7 +141,7 @@ FloatNumberDefinition::FloatNumberDefinition(const FloatStringConverter& float_s
 {
 }
 
-bool FloatNumberDefinition::StringToFloat(const string& value_string, double& value)const
+bool FloatNumberDefinition::StringToFloat(string_view value_string, double& value)const
 {
 	//小數點計數
 	string::size_type decimal_count(0);
@@ -208,7 +208,7 @@ inline bool FloatNumberDefinition::ValueCheck(double value)const
 		return true; }
 }
 
-bool FloatNumberDefinition::VerifyString(const std::string& s, string::size_type& decimal_count)const
+bool FloatNumberDefinition::VerifyString(string_view s, string::size_type& decimal_count)const
 {
 	//小數點前有效位數
 	string::size_type lead_digit_count(0);
@@ -222,7 +222,7 @@ bool FloatNumberDefinition::VerifyString(const std::string& s, string::size_type
 	string::size_type all_digit_count(0);
 
 	//逐一處理字串內所有字元
-	for (string::const_iterator iter = s.begin(); iter != s.end(); ++iter) {
+	for (string_view::const_iterator iter = s.begin(); iter != s.end(); ++iter) {
 		//取得字元
 		char ch = *iter;
 		//字元為非零數字
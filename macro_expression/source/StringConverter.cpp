@@ -1,5 +1,6 @@
 ﻿#include "StringConverter.h"
 #include <cstdlib>
+#include <charconv>
 
 using namespace std;
 
@@ -29,17 +30,18 @@ void FloatStringConverter::FloatToString(double value,string &value_string,int s
 	value_string = buffer;
 }
 
-bool FloatStringConverter::StringToFloat(const string &value_string,double &value)const
+bool FloatStringConverter::StringToFloat(string_view value_string,double &value)const
 {
-	//字串轉換停止位置指標
-	char* end_ptr(NULL);
-	//字串轉換為浮點數值
-	value = strtod(value_string.c_str(), &end_ptr);
-	//檢查字串轉換停止位置是否在字串結束位置
-	if (end_ptr != value_string.c_str() + value_string.size()) {
+	//略過前導正號(from_chars不接受正號)
+	if (!value_string.empty() && value_string.front() == '+') {
+		value_string.remove_prefix(1); }
+	//字串直接轉換為浮點數值(不需複製為C字串)
+	from_chars_result result(from_chars(value_string.data(), value_string.data() + value_string.size(), value));
+	//檢查轉換過程是否發生錯誤或溢位
+	if (result.ec != errc()) {
 		return false; }
-	//檢查轉換過程是否發生溢位
-	if (value == HUGE_VAL || value == -HUGE_VAL) {
+	//檢查字串轉換停止位置是否在字串結束位置
+	if (result.ptr != value_string.data() + value_string.size()) {
 		return false; }
 	else {
 		return true; }